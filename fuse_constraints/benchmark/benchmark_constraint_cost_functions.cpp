@@ -0,0 +1,382 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/absolute_constraint.h>
+#include <fuse_constraints/absolute_orientation_3d_stamped_constraint.h>
+#include <fuse_constraints/absolute_orientation_3d_stamped_euler_constraint.h>
+#include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/absolute_pose_3d_stamped_constraint.h>
+#include <fuse_constraints/marginal_constraint.h>
+#include <fuse_constraints/relative_constraint.h>
+#include <fuse_constraints/relative_orientation_3d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_3d_stamped_constraint.h>
+#include <fuse_core/allocation_counter.h>
+#include <fuse_core/constraint.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/time.h>
+#include <fuse_core/variable.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/orientation_3d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/position_3d_stamped.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/iterator/indirect_iterator.hpp>
+
+#include <ceres/cost_function.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Count the heap allocations, so cost functions that allocate while being evaluated stand out
+FUSE_MALLOC_COUNTING_HOOKS()
+
+/**
+ * @brief Evaluates the cost function created by a constraint, exactly as the optimizer would
+ *
+ * The constraint cost function is created once, and the variable values are copied into parameter blocks owned by
+ * the evaluator, so the benchmark loop measures only the ceres::CostFunction::Evaluate() call.
+ */
+class ConstraintEvaluator
+{
+public:
+  ConstraintEvaluator(const fuse_core::Constraint& constraint, const std::vector<const fuse_core::Variable*>& variables)
+    : cost_function_(constraint.costFunction())
+    , residuals_(cost_function_->num_residuals())
+  {
+    const auto& block_sizes = cost_function_->parameter_block_sizes();
+    for (size_t i = 0; i < variables.size(); ++i)
+    {
+      values_.emplace_back(variables[i]->data(), variables[i]->data() + variables[i]->size());
+      J_.emplace_back(residuals_.size(), block_sizes[i]);
+    }
+    for (size_t i = 0; i < variables.size(); ++i)
+    {
+      parameters_.push_back(values_[i].data());
+      jacobians_.push_back(J_[i].data());
+    }
+  }
+
+  /**
+   * @brief Evaluate the cost function residuals, and the jacobians if requested
+   */
+  bool evaluate(const bool with_jacobians)
+  {
+    return cost_function_->Evaluate(parameters_.data(), residuals_.data(),
+                                    with_jacobians ? jacobians_.data() : nullptr);
+  }
+
+private:
+  std::unique_ptr<ceres::CostFunction> cost_function_;
+  std::vector<std::vector<double>> values_;
+  std::vector<const double*> parameters_;
+  fuse_core::VectorXd residuals_;
+  std::vector<fuse_core::MatrixXd> J_;
+  std::vector<double*> jacobians_;
+};
+
+using ConstraintEvaluatorFactory = ConstraintEvaluator (*)();
+
+// Shared variables, with values near the constraint means so the residuals are small but non-zero
+static fuse_core::TimeStamp stampAt(const double seconds)
+{
+  using TimePoint = std::chrono::time_point<fuse_core::Clock, fuse_core::Duration>;
+  return fuse_core::TimeStamp(TimePoint(fuse_core::fromSec(seconds)));
+}
+
+static fuse_variables::Position2DStamped makePosition2D(const double x, const double y)
+{
+  fuse_variables::Position2DStamped position(stampAt(x + 1.0));
+  position.x() = x;
+  position.y() = y;
+  return position;
+}
+
+static fuse_variables::Orientation2DStamped makeOrientation2D(const double yaw)
+{
+  fuse_variables::Orientation2DStamped orientation(stampAt(yaw + 1.0));
+  orientation.yaw() = yaw;
+  return orientation;
+}
+
+static fuse_variables::Position3DStamped makePosition3D(const double x, const double y, const double z)
+{
+  fuse_variables::Position3DStamped position(stampAt(x + 1.0));
+  position.x() = x;
+  position.y() = y;
+  position.z() = z;
+  return position;
+}
+
+static fuse_variables::Orientation3DStamped makeOrientation3D(const double roll, const double pitch, const double yaw)
+{
+  fuse_variables::Orientation3DStamped orientation(stampAt(yaw + 1.0));
+  const Eigen::Quaterniond q = Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()) *
+                               Eigen::AngleAxisd(pitch, Eigen::Vector3d::UnitY()) *
+                               Eigen::AngleAxisd(roll, Eigen::Vector3d::UnitX());
+  orientation.w() = q.w();
+  orientation.x() = q.x();
+  orientation.y() = q.y();
+  orientation.z() = q.z();
+  return orientation;
+}
+
+static const auto position2d_1 = makePosition2D(1.0, 2.0);
+static const auto position2d_2 = makePosition2D(2.1, 2.9);
+static const auto orientation2d_1 = makeOrientation2D(0.5);
+static const auto orientation2d_2 = makeOrientation2D(0.7);
+static const auto position3d_1 = makePosition3D(1.0, 2.0, 3.0);
+static const auto position3d_2 = makePosition3D(2.1, 2.9, 3.2);
+static const auto orientation3d_1 = makeOrientation3D(0.1, 0.2, 0.5);
+static const auto orientation3d_2 = makeOrientation3D(0.2, 0.1, 0.7);
+
+// Absolute constraints
+static ConstraintEvaluator makeAbsoluteOrientation2D()
+{
+  fuse_core::Vector1d mean;
+  mean << 0.45;
+  fuse_core::Matrix1d cov;
+  cov << 0.01;
+  fuse_constraints::AbsoluteOrientation2DStampedConstraint constraint("benchmark", orientation2d_1, mean, cov);
+  return ConstraintEvaluator(constraint, { &orientation2d_1 });
+}
+
+static ConstraintEvaluator makeAbsolutePosition2D()
+{
+  fuse_core::Vector2d mean(1.1, 1.9);
+  fuse_core::Matrix2d cov;
+  cov << 1.0, 0.1, 0.1, 2.0;
+  fuse_constraints::AbsolutePosition2DStampedConstraint constraint("benchmark", position2d_1, mean, cov);
+  return ConstraintEvaluator(constraint, { &position2d_1 });
+}
+
+static ConstraintEvaluator makeAbsolutePosition3D()
+{
+  fuse_core::Vector3d mean(1.1, 1.9, 3.1);
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_constraints::AbsolutePosition3DStampedConstraint constraint("benchmark", position3d_1, mean, cov);
+  return ConstraintEvaluator(constraint, { &position3d_1 });
+}
+
+static ConstraintEvaluator makeAbsolutePose2D()
+{
+  fuse_core::Vector3d mean(1.1, 1.9, 0.45);
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_constraints::AbsolutePose2DStampedConstraint constraint("benchmark", position2d_1, orientation2d_1, mean, cov);
+  return ConstraintEvaluator(constraint, { &position2d_1, &orientation2d_1 });
+}
+
+static ConstraintEvaluator makeAbsolutePose2DPartial()
+{
+  fuse_core::Vector2d mean(1.9, 0.45);
+  fuse_core::Matrix2d cov;
+  cov << 1.0, 0.1, 0.1, 2.0;
+  fuse_constraints::AbsolutePose2DStampedConstraint constraint(
+    "benchmark", position2d_1, orientation2d_1, mean, cov, { fuse_variables::Position2DStamped::Y },
+    { fuse_variables::Orientation2DStamped::YAW });
+  return ConstraintEvaluator(constraint, { &position2d_1, &orientation2d_1 });
+}
+
+static ConstraintEvaluator makeAbsoluteOrientation3D()
+{
+  const Eigen::Quaterniond mean(orientation3d_2.w(), orientation3d_2.x(), orientation3d_2.y(), orientation3d_2.z());
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_constraints::AbsoluteOrientation3DStampedConstraint constraint("benchmark", orientation3d_1, mean, cov);
+  return ConstraintEvaluator(constraint, { &orientation3d_1 });
+}
+
+static ConstraintEvaluator makeAbsoluteOrientation3DEuler()
+{
+  using Euler = fuse_variables::Orientation3DStamped::Euler;
+  fuse_core::Vector3d mean(0.15, 0.25, 0.45);
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_constraints::AbsoluteOrientation3DStampedEulerConstraint constraint(
+    "benchmark", orientation3d_1, mean, cov, { Euler::ROLL, Euler::PITCH, Euler::YAW });
+  return ConstraintEvaluator(constraint, { &orientation3d_1 });
+}
+
+static ConstraintEvaluator makeAbsolutePose3D()
+{
+  fuse_core::Vector7d mean;
+  mean << 1.1, 1.9, 3.1, orientation3d_2.w(), orientation3d_2.x(), orientation3d_2.y(), orientation3d_2.z();
+  fuse_core::Matrix6d cov = fuse_core::Matrix6d::Identity();
+  cov(0, 1) = cov(1, 0) = 0.1;
+  fuse_constraints::AbsolutePose3DStampedConstraint constraint("benchmark", position3d_1, orientation3d_1, mean, cov);
+  return ConstraintEvaluator(constraint, { &position3d_1, &orientation3d_1 });
+}
+
+// Relative constraints
+static ConstraintEvaluator makeRelativeOrientation2D()
+{
+  fuse_core::Vector1d delta;
+  delta << 0.25;
+  fuse_core::Matrix1d cov;
+  cov << 0.01;
+  fuse_constraints::RelativeOrientation2DStampedConstraint constraint(
+    "benchmark", orientation2d_1, orientation2d_2, delta, cov);
+  return ConstraintEvaluator(constraint, { &orientation2d_1, &orientation2d_2 });
+}
+
+static ConstraintEvaluator makeRelativePosition2D()
+{
+  fuse_core::Vector2d delta(1.0, 1.0);
+  fuse_core::Matrix2d cov;
+  cov << 1.0, 0.1, 0.1, 2.0;
+  fuse_constraints::RelativePosition2DStampedConstraint constraint(
+    "benchmark", position2d_1, position2d_2, delta, cov);
+  return ConstraintEvaluator(constraint, { &position2d_1, &position2d_2 });
+}
+
+static ConstraintEvaluator makeRelativePosition3D()
+{
+  fuse_core::Vector3d delta(1.0, 1.0, 0.1);
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_constraints::RelativePosition3DStampedConstraint constraint(
+    "benchmark", position3d_1, position3d_2, delta, cov);
+  return ConstraintEvaluator(constraint, { &position3d_1, &position3d_2 });
+}
+
+static ConstraintEvaluator makeRelativePose2D()
+{
+  fuse_core::Vector3d delta(1.0, 0.0, 0.25);
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_constraints::RelativePose2DStampedConstraint constraint(
+    "benchmark", position2d_1, orientation2d_1, position2d_2, orientation2d_2, delta, cov);
+  return ConstraintEvaluator(constraint, { &position2d_1, &orientation2d_1, &position2d_2, &orientation2d_2 });
+}
+
+static ConstraintEvaluator makeRelativeOrientation3D()
+{
+  const Eigen::Quaterniond delta(Eigen::AngleAxisd(0.25, Eigen::Vector3d::UnitZ()));
+  fuse_core::Matrix3d cov;
+  cov << 1.0, 0.1, 0.2, 0.1, 2.0, 0.3, 0.2, 0.3, 3.0;
+  fuse_constraints::RelativeOrientation3DStampedConstraint constraint(
+    "benchmark", orientation3d_1, orientation3d_2, delta, cov);
+  return ConstraintEvaluator(constraint, { &orientation3d_1, &orientation3d_2 });
+}
+
+static ConstraintEvaluator makeRelativePose3D()
+{
+  const Eigen::Quaterniond q(Eigen::AngleAxisd(0.25, Eigen::Vector3d::UnitZ()));
+  fuse_core::Vector7d delta;
+  delta << 1.0, 0.0, 0.1, q.w(), q.x(), q.y(), q.z();
+  fuse_core::Matrix6d cov = fuse_core::Matrix6d::Identity();
+  cov(0, 1) = cov(1, 0) = 0.1;
+  fuse_constraints::RelativePose3DStampedConstraint constraint(
+    "benchmark", position3d_1, orientation3d_1, position3d_2, orientation3d_2, delta, cov);
+  return ConstraintEvaluator(constraint, { &position3d_1, &orientation3d_1, &position3d_2, &orientation3d_2 });
+}
+
+// Marginal constraints, as produced by marginalizing a 2D and a 3D pose
+static ConstraintEvaluator makeMarginalPose2D()
+{
+  const std::vector<const fuse_core::Variable*> variables = { &position2d_1, &orientation2d_1 };
+  const std::vector<fuse_core::MatrixXd> A = { fuse_core::MatrixXd::Ones(3, 2), fuse_core::MatrixXd::Ones(3, 1) };
+  const fuse_core::Vector3d b(1.0, 2.0, 3.0);
+  fuse_constraints::MarginalConstraint constraint("benchmark", boost::make_indirect_iterator(variables.begin()),
+                                                 boost::make_indirect_iterator(variables.end()), A.begin(), A.end(), b);
+  return ConstraintEvaluator(constraint, variables);
+}
+
+static ConstraintEvaluator makeMarginalPose3D()
+{
+  const std::vector<const fuse_core::Variable*> variables = { &position3d_1, &orientation3d_1 };
+  const std::vector<fuse_core::MatrixXd> A = { fuse_core::MatrixXd::Ones(6, 3), fuse_core::MatrixXd::Ones(6, 3) };
+  const fuse_core::Vector6d b = fuse_core::Vector6d::Ones();
+  fuse_constraints::MarginalConstraint constraint("benchmark", boost::make_indirect_iterator(variables.begin()),
+                                                 boost::make_indirect_iterator(variables.end()), A.begin(), A.end(), b);
+  return ConstraintEvaluator(constraint, variables);
+}
+
+/**
+ * @brief Report the heap allocations and allocated bytes per evaluation
+ */
+static void addAllocationCounters(benchmark::State& state, const fuse_core::AllocationCount& count)
+{
+  const auto average = benchmark::Counter::kAvgIterations;
+  state.counters["allocations"] = benchmark::Counter(count.allocations, average);
+  state.counters["bytes"] = benchmark::Counter(count.bytes, average);
+}
+
+static void BM_residuals(benchmark::State& state, ConstraintEvaluatorFactory factory)
+{
+  auto evaluator = factory();
+  fuse_core::AllocationCounter allocation_counter;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(evaluator.evaluate(false));
+  }
+  addAllocationCounters(state, allocation_counter.elapsed());
+}
+
+static void BM_residualsAndJacobians(benchmark::State& state, ConstraintEvaluatorFactory factory)
+{
+  auto evaluator = factory();
+  fuse_core::AllocationCounter allocation_counter;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(evaluator.evaluate(true));
+  }
+  addAllocationCounters(state, allocation_counter.elapsed());
+}
+
+#define BENCHMARK_CONSTRAINT(name)                \
+  BENCHMARK_CAPTURE(BM_residuals, name, &make##name); \
+  BENCHMARK_CAPTURE(BM_residualsAndJacobians, name, &make##name)
+
+BENCHMARK_CONSTRAINT(AbsoluteOrientation2D);
+BENCHMARK_CONSTRAINT(AbsolutePosition2D);
+BENCHMARK_CONSTRAINT(AbsolutePosition3D);
+BENCHMARK_CONSTRAINT(AbsolutePose2D);
+BENCHMARK_CONSTRAINT(AbsolutePose2DPartial);
+BENCHMARK_CONSTRAINT(AbsoluteOrientation3D);
+BENCHMARK_CONSTRAINT(AbsoluteOrientation3DEuler);
+BENCHMARK_CONSTRAINT(AbsolutePose3D);
+BENCHMARK_CONSTRAINT(RelativeOrientation2D);
+BENCHMARK_CONSTRAINT(RelativePosition2D);
+BENCHMARK_CONSTRAINT(RelativePosition3D);
+BENCHMARK_CONSTRAINT(RelativePose2D);
+BENCHMARK_CONSTRAINT(RelativeOrientation3D);
+BENCHMARK_CONSTRAINT(RelativePose3D);
+BENCHMARK_CONSTRAINT(MarginalPose2D);
+BENCHMARK_CONSTRAINT(MarginalPose3D);
+
+BENCHMARK_MAIN();
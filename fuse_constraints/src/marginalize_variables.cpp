@@ -38,7 +38,6 @@
 #include <fuse_core/uuid.h>
 
 #include <boost/iterator/transform_iterator.hpp>
-#include <boost/range/empty.hpp>
 #include <Eigen/Core>
 #include <Eigen/Dense>
 #include <suitesparse/ccolamd.h>
@@ -77,27 +76,26 @@ UuidOrdering computeEliminationOrder(
   auto variable_constraints = VariableConstraints();
   for (const auto& variable_uuid : marginalized_variables)
   {
-    // Get all connected constraints to this variable
-    const auto constraints = graph.getConnectedConstraints(variable_uuid);
-
-    // If the variable is orphan (it has no constraints), add it to the VariableConstraints object without constraints
-    // New variable index is automatically generated
-    if (boost::empty(constraints))
-    {
-      variable_constraints.insert(variable_order[variable_uuid]);
-    }
-    else
-    {
-      // Add each constraint to the VariableConstraints object
-      // New constraint and variable indices are automatically generated
-      for (const auto& constraint : constraints)
+    // Add each connected constraint to the VariableConstraints object
+    // New constraint and variable indices are automatically generated
+    bool orphan = true;
+    graph.forEachConnectedConstraint(
+      variable_uuid,
+      [&orphan, &constraint_order, &variable_order, &variable_constraints](const fuse_core::Constraint& constraint)
       {
+        orphan = false;
         unsigned int constraint_index = constraint_order[constraint.uuid()];
         for (const auto& constraint_variable_uuid : constraint.variables())
         {
           variable_constraints.insert(constraint_index, variable_order[constraint_variable_uuid]);
         }
-      }
+      });  // NOLINT(whitespace/braces)
+
+    // If the variable is orphan (it has no constraints), add it to the VariableConstraints object without constraints
+    // New variable index is automatically generated
+    if (orphan)
+    {
+      variable_constraints.insert(variable_order[variable_uuid]);
     }
   }
 
@@ -210,23 +208,28 @@ fuse_core::Transaction marginalizeVariables(
   std::vector<std::vector<detail::LinearTerm>> linear_terms(variable_order.size());
   for (size_t i = 0ul; i < marginalized_variables.size(); ++i)
   {
-    const auto constraints = graph.getConnectedConstraints(variable_order[i]);
-    for (const auto& constraint : constraints)
-    {
-      if (used_constraints.find(constraint.uuid()) == used_constraints.end())
+    // The ordering grows while visiting, so take a copy of the variable UUID first
+    const auto marginalized_variable_uuid = variable_order[i];
+    auto& variable_linear_terms = linear_terms[i];
+    graph.forEachConnectedConstraint(
+      marginalized_variable_uuid,
+      [&used_constraints, &variable_order, &variable_linear_terms, &graph, &transaction](
+        const fuse_core::Constraint& constraint)
       {
-        used_constraints.insert(constraint.uuid());
-        // Ensure all connected variables are added to the ordering
-        for (const auto& variable_uuid : constraint.variables())
+        if (used_constraints.find(constraint.uuid()) == used_constraints.end())
         {
-          variable_order.push_back(variable_uuid);
+          used_constraints.insert(constraint.uuid());
+          // Ensure all connected variables are added to the ordering
+          for (const auto& variable_uuid : constraint.variables())
+          {
+            variable_order.push_back(variable_uuid);
+          }
+          // Add the linearized constraint to the lowest-ordered connected variable
+          variable_linear_terms.push_back(detail::linearize(constraint, graph, variable_order));
+          // And mark the constraint for removal from the graph
+          transaction.removeConstraint(constraint.uuid());
         }
-        // Add the linearized constraint to the lowest-ordered connected variable
-        linear_terms[i].push_back(detail::linearize(constraint, graph, variable_order));
-        // And mark the constraint for removal from the graph
-        transaction.removeConstraint(constraint.uuid());
-      }
-    }
+      });  // NOLINT(whitespace/braces)
   }
 
   // Expand the linear_terms to include all the connected variables as well
@@ -358,17 +361,13 @@ LinearTerm linearize(
     }
   }
 
-  // Correct A and b for the effects of the loss function
+  // Correct A and b for the effects of the loss function. The loss function is owned by the constraint's loss.
   auto loss_function = constraint.lossFunction();
   if (loss_function)
   {
     double squared_norm = result.b.squaredNorm();
     double rho[3];
     loss_function->Evaluate(squared_norm, rho);
-    if (fuse_core::Loss::Ownership == ceres::Ownership::TAKE_OWNERSHIP)
-    {
-      delete loss_function;
-    }
     double sqrt_rho1 = std::sqrt(rho[1]);
     double alpha = 0.0;
     if ((squared_norm > 0.0) && (rho[2] > 0.0))
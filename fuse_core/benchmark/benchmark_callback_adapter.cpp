@@ -0,0 +1,176 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/callback_wrapper.h>
+
+#include <benchmark/benchmark.h>
+#include <rclcpp/rclcpp.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @brief Several producer threads add callbacks while the benchmark thread drains them, as an executor would
+ *
+ * Each iteration adds and executes a fixed number of callbacks, split evenly across range(0) producers.
+ */
+static void BM_addCallback_producers(benchmark::State& state)
+{
+  const int64_t num_producers = state.range(0);
+  const int64_t callbacks_per_iteration = 1 << 14;
+  const int64_t callbacks_per_producer = callbacks_per_iteration / num_producers;
+
+  auto callback_queue = std::make_shared<fuse_core::CallbackAdapter>(rclcpp::contexts::get_global_default_context());
+  std::shared_ptr<void> data;
+  int64_t executed = 0;
+
+  for (auto _ : state)
+  {
+    executed = 0;
+    std::vector<std::thread> producers;
+    for (int64_t producer = 0; producer < num_producers; ++producer)
+    {
+      producers.emplace_back([&callback_queue, &executed, callbacks_per_producer]()
+      {
+        for (int64_t i = 0; i < callbacks_per_producer; ++i)
+        {
+          auto callback = std::make_shared<fuse_core::CallbackWrapper<void>>([&executed]() { ++executed; });
+          callback_queue->addCallback(std::move(callback));
+        }
+      });  // NOLINT(whitespace/braces)
+    }
+
+    while (executed < callbacks_per_producer * num_producers)
+    {
+      if (callback_queue->is_ready(nullptr))
+      {
+        callback_queue->execute(data);
+      }
+    }
+
+    for (auto& producer : producers)
+    {
+      producer.join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * callbacks_per_producer * num_producers);
+}
+
+BENCHMARK(BM_addCallback_producers)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+/**
+ * @brief Add a single callback and execute it, with no contention
+ */
+static void BM_addCallback_single(benchmark::State& state)
+{
+  auto callback_queue = std::make_shared<fuse_core::CallbackAdapter>(rclcpp::contexts::get_global_default_context());
+  std::shared_ptr<void> data;
+  int64_t executed = 0;
+
+  for (auto _ : state)
+  {
+    // A CallbackWrapper can only be executed once, as it fulfils a promise. Create a new one each time.
+    callback_queue->addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>([&executed]() { ++executed; }));
+    callback_queue->execute(data);
+  }
+  benchmark::DoNotOptimize(executed);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_addCallback_single);
+
+/**
+ * @brief Post a fire-and-forget callback and execute it. The wrapper is recycled from the adapter's pool.
+ */
+static void BM_postCallback_single(benchmark::State& state)
+{
+  auto callback_queue = std::make_shared<fuse_core::CallbackAdapter>(rclcpp::contexts::get_global_default_context());
+  std::shared_ptr<void> data;
+  int64_t executed = 0;
+
+  for (auto _ : state)
+  {
+    callback_queue->postCallback([&executed]() { ++executed; });
+    callback_queue->execute(data);
+  }
+  benchmark::DoNotOptimize(executed);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_postCallback_single);
+
+/**
+ * @brief Invoke a callback from a producer thread and block until the benchmark thread executes it
+ */
+static void BM_invokeCallback(benchmark::State& state)
+{
+  auto callback_queue = std::make_shared<fuse_core::CallbackAdapter>(rclcpp::contexts::get_global_default_context());
+  std::atomic<bool> running{true};
+  std::thread executor([&callback_queue, &running]()
+  {
+    std::shared_ptr<void> data;
+    while (running)
+    {
+      if (callback_queue->is_ready(nullptr))
+      {
+        callback_queue->execute(data);
+      }
+    }
+  });  // NOLINT(whitespace/braces)
+
+  int64_t sum = 0;
+  for (auto _ : state)
+  {
+    sum += callback_queue->invokeCallback([]() { return int64_t{1}; });
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+
+  running = false;
+  executor.join();
+}
+
+BENCHMARK(BM_invokeCallback)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/flat_serialization.h>
+
+#include <fuse_core/serialization.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <test/example_constraint.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/iostreams/stream.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief A 3-DOF pose-like variable with a flat codec, standing in for the fuse_variables stamped types
+ */
+class BenchmarkVariable : public fuse_core::Variable
+{
+public:
+  FUSE_VARIABLE_DEFINITIONS(BenchmarkVariable);
+
+  BenchmarkVariable() = default;
+
+  explicit BenchmarkVariable(const fuse_core::UUID& uuid) :
+    fuse_core::Variable(uuid)
+  {
+  }
+
+  size_t size() const override { return 3; }
+  const double* data() const override { return data_; };
+  double* data() override { return data_; };
+  void print(std::ostream& /*stream = std::cout*/) const override {}
+
+private:
+  double data_[3] = { 0.0, 0.0, 0.0 };
+
+  // Allow Boost Serialization access to private methods
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& archive, const unsigned int /* version */)
+  {
+    archive & boost::serialization::base_object<fuse_core::Variable>(*this);
+    archive & data_;
+  }
+};
+
+BOOST_CLASS_EXPORT(BenchmarkVariable);
+
+/**
+ * @brief Flat codec for BenchmarkVariable. Everything it needs is in the fixed part of the record.
+ */
+class BenchmarkVariableCodec : public fuse_core::flat::VariableCodec
+{
+public:
+  void write(const fuse_core::Variable& /* variable */, fuse_core::flat::PayloadWriter& /* payload */) const override
+  {
+  }
+
+  fuse_core::Variable::SharedPtr read(const fuse_core::flat::VariableView& view) const override
+  {
+    auto variable = BenchmarkVariable::make_shared(view.uuid());
+    std::copy(view.data(), view.data() + view.size(), variable->data());
+    return variable;
+  }
+};
+
+FUSE_FLAT_VARIABLE_CODEC_EXPORT(BenchmarkVariable, BenchmarkVariableCodec)
+
+/**
+ * @brief Create the benchmark constraint type by name, as the deserializers do with pluginlib
+ */
+fuse_core::flat::ObjectFactory benchmarkFactory()
+{
+  fuse_core::flat::ObjectFactory factory;
+  factory.create_variable = [](const std::string& type) -> fuse_core::Variable::UniquePtr
+  {
+    throw std::runtime_error("Unexpected Boost-encoded variable of type " + type);
+  };  // NOLINT(whitespace/braces)
+  factory.create_constraint = [](const std::string& /* type */) -> fuse_core::Constraint::UniquePtr
+  {
+    return ExampleConstraint::make_unique();
+  };  // NOLINT(whitespace/braces)
+  return factory;
+}
+
+/**
+ * @brief Build a transaction shaped like a short odometry chain: one variable and two constraints per stamp
+ *
+ * @param[in] num_variables The number of variables in the transaction
+ */
+fuse_core::Transaction createTransaction(const int64_t num_variables)
+{
+  fuse_core::Transaction transaction;
+  fuse_core::UUID previous_uuid = fuse_core::uuid::NIL;
+  for (int64_t i = 0; i < num_variables; ++i)
+  {
+    const auto stamp = fuse_core::TimeStamp(
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(std::chrono::milliseconds(i)));
+    transaction.addInvolvedStamp(stamp);
+
+    auto variable = BenchmarkVariable::make_shared(fuse_core::uuid::generate());
+    std::fill(variable->data(), variable->data() + variable->size(), static_cast<double>(i));
+    transaction.addVariable(variable);
+
+    transaction.addConstraint(
+      ExampleConstraint::make_shared("prior", std::initializer_list<fuse_core::UUID>{variable->uuid()}));  // NOLINT
+    if (i > 0)
+    {
+      transaction.addConstraint(ExampleConstraint::make_shared(
+        "odometry", std::initializer_list<fuse_core::UUID>{previous_uuid, variable->uuid()}));  // NOLINT
+    }
+    previous_uuid = variable->uuid();
+  }
+  return transaction;
+}
+
+void serializeBoost(const fuse_core::Transaction& transaction, std::vector<uint8_t>& data)
+{
+  data.clear();
+  boost::iostreams::stream<fuse_core::MessageBufferStreamSink> stream(data);
+  {
+    fuse_core::BinaryOutputArchive archive(stream);
+    transaction.serialize(archive);
+  }
+}
+
+static void BM_serializeTransaction_boost(benchmark::State& state)
+{
+  const auto transaction = createTransaction(state.range(0));
+  std::vector<uint8_t> data;
+  for (auto _ : state)
+  {
+    serializeBoost(transaction, data);
+    benchmark::DoNotOptimize(data.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+  state.counters["bytes"] = data.size();
+}
+
+BENCHMARK(BM_serializeTransaction_boost)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_serializeTransaction_flat(benchmark::State& state)
+{
+  const auto transaction = createTransaction(state.range(0));
+  std::vector<uint8_t> data;
+  for (auto _ : state)
+  {
+    fuse_core::flat::serializeTransaction(transaction, data);
+    benchmark::DoNotOptimize(data.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+  state.counters["bytes"] = data.size();
+}
+
+BENCHMARK(BM_serializeTransaction_flat)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_deserializeTransaction_boost(benchmark::State& state)
+{
+  std::vector<uint8_t> data;
+  serializeBoost(createTransaction(state.range(0)), data);
+  for (auto _ : state)
+  {
+    fuse_core::Transaction transaction;
+    boost::iostreams::stream<fuse_core::MessageBufferStreamSource> stream(data);
+    fuse_core::BinaryInputArchive archive(stream);
+    transaction.deserialize(archive);
+    benchmark::DoNotOptimize(transaction);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_deserializeTransaction_boost)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_deserializeTransaction_flat(benchmark::State& state)
+{
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeTransaction(createTransaction(state.range(0)), data);
+  const auto factory = benchmarkFactory();
+  for (auto _ : state)
+  {
+    auto transaction = fuse_core::flat::deserializeTransaction(fuse_core::flat::BufferReader(data), factory);
+    benchmark::DoNotOptimize(transaction);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_deserializeTransaction_flat)->RangeMultiplier(10)->Range(10, 1000);
+
+/**
+ * @brief Read every variable value and constraint connection in place, as a visualization client would
+ */
+static void BM_readInPlace_flat(benchmark::State& state)
+{
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeTransaction(createTransaction(state.range(0)), data);
+  for (auto _ : state)
+  {
+    fuse_core::flat::BufferReader reader(data);
+    double sum = 0.0;
+    for (size_t i = 0; i < reader.variableCount(); ++i)
+    {
+      const auto variable = reader.variable(i);
+      sum = std::accumulate(variable.data(), variable.data() + variable.size(), sum);
+    }
+    size_t connections = 0;
+    for (size_t i = 0; i < reader.constraintCount(); ++i)
+    {
+      connections += reader.constraint(i).variableCount();
+    }
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(connections);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_readInPlace_flat)->RangeMultiplier(10)->Range(10, 1000);
+
+BENCHMARK_MAIN();
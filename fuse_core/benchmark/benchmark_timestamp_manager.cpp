@@ -0,0 +1,150 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/timestamp_manager.h>
+
+#include <fuse_core/constraint.h>
+#include <fuse_core/time.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/variable.h>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <vector>
+
+
+/**
+ * @brief Helper function to create a stamp from a number of milliseconds
+ */
+fuse_core::TimeStamp stampFromMilliseconds(const int64_t milliseconds)
+{
+  return fuse_core::TimeStamp(
+    std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(
+      std::chrono::milliseconds(milliseconds)));
+}
+
+/**
+ * @brief A motion model generator that does no work, so the benchmarks measure the timestamp manager bookkeeping
+ */
+void generator(
+  const fuse_core::TimeStamp& /*beginning_stamp*/,
+  const fuse_core::TimeStamp& /*ending_stamp*/,
+  std::vector<fuse_core::Constraint::SharedPtr>& /*constraints*/,
+  std::vector<fuse_core::Variable::SharedPtr>& /*variables*/)
+{
+}
+
+/**
+ * @brief Fill the manager with a 1 kHz stream of stamps, covering the whole buffer length
+ *
+ * @param[in] num_stamps The number of stamps to add, one millisecond apart
+ * @param[in] manager    The timestamp manager to populate
+ */
+void populate(const int64_t num_stamps, fuse_core::TimestampManager& manager)
+{
+  for (int64_t i = 0; i < num_stamps; ++i)
+  {
+    fuse_core::Transaction transaction;
+    transaction.addInvolvedStamp(stampFromMilliseconds(i));
+    manager.query(transaction);
+  }
+}
+
+/**
+ * @brief Append a new stamp every millisecond, with the history holding range(0) milliseconds of stamps
+ */
+static void BM_query_append(benchmark::State& state)
+{
+  const int64_t buffer_length = state.range(0);
+  fuse_core::TimestampManager manager(&generator, std::chrono::milliseconds(buffer_length));
+  populate(buffer_length, manager);
+
+  int64_t milliseconds = buffer_length;
+  for (auto _ : state)
+  {
+    fuse_core::Transaction transaction;
+    transaction.addInvolvedStamp(stampFromMilliseconds(milliseconds++));
+    manager.query(transaction, true);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_query_append)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+
+/**
+ * @brief Each query involves a new stamp and a stamp half a millisecond older than the newest existing one, so every
+ * query splits the most recent segment as well as appending a new one
+ */
+static void BM_query_split(benchmark::State& state)
+{
+  const int64_t buffer_length = state.range(0);
+  fuse_core::TimestampManager manager(&generator, std::chrono::milliseconds(buffer_length));
+  populate(buffer_length, manager);
+
+  int64_t milliseconds = buffer_length;
+  for (auto _ : state)
+  {
+    fuse_core::Transaction transaction;
+    transaction.addInvolvedStamp(stampFromMilliseconds(milliseconds) - std::chrono::microseconds(1500));
+    transaction.addInvolvedStamp(stampFromMilliseconds(milliseconds++));
+    manager.query(transaction, true);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_query_split)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+
+/**
+ * @brief Query a range of range(0) existing stamps, e.g. a sensor measurement spanning several motion model segments.
+ * No new segments are generated.
+ */
+static void BM_query_existing(benchmark::State& state)
+{
+  const int64_t num_stamps = 1 << 14;
+  fuse_core::TimestampManager manager(&generator, std::chrono::milliseconds(num_stamps));
+  populate(num_stamps, manager);
+
+  fuse_core::Transaction transaction;
+  transaction.addInvolvedStamp(stampFromMilliseconds(num_stamps - 1 - state.range(0)));
+  transaction.addInvolvedStamp(stampFromMilliseconds(num_stamps - 1));
+  for (auto _ : state)
+  {
+    manager.query(transaction, true);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_query_existing)->RangeMultiplier(4)->Range(1, 1 << 10);
+
+BENCHMARK_MAIN();
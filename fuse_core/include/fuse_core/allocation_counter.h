@@ -0,0 +1,267 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_ALLOCATION_COUNTER_H
+#define FUSE_CORE_ALLOCATION_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief A number of heap allocations and the bytes they requested
+ */
+struct AllocationCount
+{
+  uint64_t allocations{ 0 };  //!< The number of allocations counted by the installed hooks
+  uint64_t bytes{ 0 };        //!< The total number of bytes requested by those allocations
+
+  AllocationCount& operator+=(const AllocationCount& other)
+  {
+    allocations += other.allocations;
+    bytes += other.bytes;
+    return *this;
+  }
+
+  friend AllocationCount operator-(AllocationCount lhs, const AllocationCount& rhs)
+  {
+    lhs.allocations -= rhs.allocations;
+    lhs.bytes -= rhs.bytes;
+    return lhs;
+  }
+};
+
+/**
+ * @brief The allocations counted by the hooks installed in the executable
+ */
+enum class AllocationCounting
+{
+  DISABLED,      //!< No hooks are installed, all counts stay zero
+  OPERATOR_NEW,  //!< FUSE_ALLOCATION_COUNTING_HOOKS(): only allocations through the global operator new are counted
+  MALLOC         //!< FUSE_MALLOC_COUNTING_HOOKS(): every allocation through the malloc family is counted
+};
+
+/**
+ * @brief The allocations counted by the hooks installed in the executable, if any
+ */
+AllocationCounting allocationCounting();
+
+/**
+ * @brief True if the executable installed either FUSE_ALLOCATION_COUNTING_HOOKS() or FUSE_MALLOC_COUNTING_HOOKS()
+ */
+inline bool allocationCountingEnabled()
+{
+  return allocationCounting() != AllocationCounting::DISABLED;
+}
+
+/**
+ * @brief The heap allocations made by the calling thread since it started
+ */
+AllocationCount threadAllocationCount();
+
+/**
+ * @brief Counts the heap allocations made by the calling thread over a section of code
+ *
+ * Counting is per thread, so allocations made concurrently by other threads are not attributed to the measured code.
+ * A single counter can measure consecutive stages by calling restart() at the end of each stage:
+ *
+ * @code{.cpp}
+ * fuse_core::AllocationCounter counter;
+ * stage1();
+ * const auto stage1_allocations = counter.restart();
+ * stage2();
+ * const auto stage2_allocations = counter.restart();
+ * @endcode
+ */
+class AllocationCounter
+{
+public:
+  /**
+   * @brief Constructor. Starts counting.
+   */
+  AllocationCounter() : start_(threadAllocationCount()) {}
+
+  /**
+   * @brief The allocations made by this thread since the counter was constructed or last restarted
+   */
+  AllocationCount elapsed() const { return threadAllocationCount() - start_; }
+
+  /**
+   * @brief Restart counting
+   *
+   * @return The allocations made by this thread since the counter was constructed or last restarted
+   */
+  AllocationCount restart()
+  {
+    const auto now = threadAllocationCount();
+    const auto elapsed = now - start_;
+    start_ = now;
+    return elapsed;
+  }
+
+private:
+  AllocationCount start_;  //!< The thread allocation count when counting started
+};
+
+namespace detail
+{
+
+/**
+ * @brief Record the installed counting hooks. Used by the hook macros.
+ */
+bool enableAllocationCounting(const AllocationCounting counting) noexcept;
+
+/**
+ * @brief Count an allocation of \p size bytes and allocate it with malloc. Used by FUSE_ALLOCATION_COUNTING_HOOKS().
+ *
+ * @throws std::bad_alloc if the allocation fails
+ */
+void* countedAllocation(std::size_t size);
+
+/**
+ * @brief Count an allocation of \p size bytes aligned to \p alignment. Used by FUSE_ALLOCATION_COUNTING_HOOKS().
+ *
+ * @throws std::bad_alloc if the allocation fails
+ */
+void* countedAlignedAllocation(std::size_t size, std::size_t alignment);
+
+/**
+ * @brief The counting malloc family, forwarding to the C library allocator. Used by FUSE_MALLOC_COUNTING_HOOKS().
+ */
+void* countedMalloc(std::size_t size) noexcept;
+void* countedCalloc(std::size_t count, std::size_t size) noexcept;
+void* countedRealloc(void* pointer, std::size_t size) noexcept;
+void* countedMemalign(std::size_t alignment, std::size_t size) noexcept;
+int countedPosixMemalign(void** pointer, std::size_t alignment, std::size_t size) noexcept;
+void uncountedFree(void* pointer) noexcept;
+
+}  // namespace detail
+
+}  // namespace fuse_core
+
+#if defined(__cpp_aligned_new)
+#define FUSE_DETAIL_ALIGNED_NEW_COUNTING_HOOKS()                                                          \
+  void* operator new(std::size_t size, std::align_val_t alignment)                                        \
+  {                                                                                                       \
+    return fuse_core::detail::countedAlignedAllocation(size, static_cast<std::size_t>(alignment));        \
+  }                                                                                                       \
+  void operator delete(void* pointer, std::align_val_t /* alignment */) noexcept                          \
+  {                                                                                                       \
+    std::free(pointer);                                                                                   \
+  }                                                                                                       \
+  void operator delete(void* pointer, std::size_t /* size */, std::align_val_t /* alignment */) noexcept  \
+  {                                                                                                       \
+    std::free(pointer);                                                                                   \
+  }
+#else
+#define FUSE_DETAIL_ALIGNED_NEW_COUNTING_HOOKS()
+#endif
+
+/**
+ * @brief Replace the global operator new and delete with versions that count allocations per thread
+ *
+ * Allocation counting is opt-in because it replaces the allocator of the whole process. Use this macro, or
+ * FUSE_MALLOC_COUNTING_HOOKS() but never both, once at global scope in one source file of the executable (a
+ * benchmark, a test or a profiling build of a node). Libraries must never use it.
+ *
+ * The plain and over-aligned forms of operator new are replaced, and the array and nothrow forms forward to them.
+ * Memory allocated with malloc is not counted, and that includes the dynamic-size Eigen matrices, so the counts are
+ * only the C++ allocator share of the heap allocations. Use FUSE_MALLOC_COUNTING_HOOKS() to count all of them.
+ */
+#define FUSE_ALLOCATION_COUNTING_HOOKS()                                                                  \
+  static const bool fuse_allocation_counting_enabled =                                                    \
+    fuse_core::detail::enableAllocationCounting(fuse_core::AllocationCounting::OPERATOR_NEW);             \
+  void* operator new(std::size_t size)                                                                    \
+  {                                                                                                       \
+    return fuse_core::detail::countedAllocation(size);                                                    \
+  }                                                                                                       \
+  void operator delete(void* pointer) noexcept                                                            \
+  {                                                                                                       \
+    std::free(pointer);                                                                                   \
+  }                                                                                                       \
+  void operator delete(void* pointer, std::size_t /* size */) noexcept                                    \
+  {                                                                                                       \
+    std::free(pointer);                                                                                   \
+  }                                                                                                       \
+  FUSE_DETAIL_ALIGNED_NEW_COUNTING_HOOKS()
+
+#if defined(__GLIBC__)
+/**
+ * @brief Interpose the C library malloc family with versions that count allocations per thread
+ *
+ * This counts every heap allocation of the process: the default operator new, Eigen's dynamic matrices and any C
+ * library all allocate through malloc. The same usage rules as FUSE_ALLOCATION_COUNTING_HOOKS() apply, and the two
+ * macros must not be combined. The hooks forward to the glibc allocator. On other C libraries, this macro falls
+ * back to FUSE_ALLOCATION_COUNTING_HOOKS(), which allocationCounting() reports.
+ */
+#define FUSE_MALLOC_COUNTING_HOOKS()                                                                      \
+  static const bool fuse_allocation_counting_enabled =                                                    \
+    fuse_core::detail::enableAllocationCounting(fuse_core::AllocationCounting::MALLOC);                   \
+  extern "C" void* malloc(std::size_t size) noexcept                                                      \
+  {                                                                                                       \
+    return fuse_core::detail::countedMalloc(size);                                                        \
+  }                                                                                                       \
+  extern "C" void* calloc(std::size_t count, std::size_t size) noexcept                                   \
+  {                                                                                                       \
+    return fuse_core::detail::countedCalloc(count, size);                                                 \
+  }                                                                                                       \
+  extern "C" void* realloc(void* pointer, std::size_t size) noexcept                                      \
+  {                                                                                                       \
+    return fuse_core::detail::countedRealloc(pointer, size);                                              \
+  }                                                                                                       \
+  extern "C" void* memalign(std::size_t alignment, std::size_t size) noexcept                             \
+  {                                                                                                       \
+    return fuse_core::detail::countedMemalign(alignment, size);                                           \
+  }                                                                                                       \
+  extern "C" void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept                        \
+  {                                                                                                       \
+    return fuse_core::detail::countedMemalign(alignment, size);                                           \
+  }                                                                                                       \
+  extern "C" int posix_memalign(void** pointer, std::size_t alignment, std::size_t size) noexcept         \
+  {                                                                                                       \
+    return fuse_core::detail::countedPosixMemalign(pointer, alignment, size);                             \
+  }                                                                                                       \
+  extern "C" void free(void* pointer) noexcept                                                            \
+  {                                                                                                       \
+    fuse_core::detail::uncountedFree(pointer);                                                            \
+  }
+#else
+#define FUSE_MALLOC_COUNTING_HOOKS() FUSE_ALLOCATION_COUNTING_HOOKS()
+#endif
+
+#endif  // FUSE_CORE_ALLOCATION_COUNTER_H
@@ -36,6 +36,7 @@
 
 #include <fuse_core/publisher.h>
 
+#include <fuse_core/covariance_blocks.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/callback_wrapper.h>
@@ -47,6 +48,7 @@
 #include <functional>
 #include <utility>
 #include <string>
+#include <vector>
 
 
 
@@ -105,6 +107,35 @@ public:
    */
   void notify(Transaction::ConstSharedPtr transaction, Graph::ConstSharedPtr graph) override;
 
+  /**
+   * @brief Notify the publisher that an optimization cycle is complete, and provide the requested covariance blocks
+   *
+   * This injects a call to AsyncPublisher::notifyCallback(transaction, graph, covariance_blocks) into the internal
+   * callback queue.
+   *
+   * @param[in] transaction       A Transaction object, describing the set of variables that have been added and/or
+   *                              removed
+   * @param[in] graph             A read-only pointer to the graph object, allowing queries to be performed whenever
+   *                              needed
+   * @param[in] covariance_blocks The covariance blocks computed from \p graph, or nullptr if none were computed
+   */
+  void notify(
+    Transaction::ConstSharedPtr transaction,
+    Graph::ConstSharedPtr graph,
+    CovarianceBlocks::ConstSharedPtr covariance_blocks) override;
+
+  /**
+   * @brief Collect the covariance requests from all callbacks registered with registerCovarianceRequest()
+   *
+   * @param[in]  transaction A Transaction object, describing the set of variables that have been added and/or removed
+   * @param[in]  graph       The optimized graph
+   * @param[out] requests    The container that collects the covariance requests
+   */
+  void covarianceRequests(
+    const Transaction& transaction,
+    const Graph& graph,
+    std::vector<CovarianceBlocks::Request>& requests) override;
+
   /**
    * @brief Function to be executed whenever the optimizer is ready to receive transactions
    *
@@ -144,6 +175,8 @@ protected:
   rclcpp::executors::MultiThreadedExecutor::SharedPtr executor_;  //!< A single/multi-threaded spinner assigned to the local callback queue
   rclcpp::node_interfaces::NodeWaitablesInterface::SharedPtr waitables_interface_;
   size_t executor_thread_count_;
+  std::vector<CovarianceBlocks::RequestCallback> covariance_request_callbacks_;  //!< The registered covariance
+                                                                                 //!< request callbacks
 
   /**
    * @brief Constructor
@@ -166,6 +199,21 @@ protected:
    */
   virtual void onInit() {}
 
+  /**
+   * @brief Register a callback that declares the covariance blocks this publisher needs after each optimization cycle
+   *
+   * This should be called from onInit(). The optimizer collects the requests of all publishers and computes them
+   * in a single batch; the results are delivered to notifyCallback(transaction, graph, covariance_blocks). See
+   * CovarianceBlocks::RequestCallback for the threading requirements of the callback.
+   *
+   * The batch is computed in the optimizer's thread before any publisher is notified. Only register a request when
+   * the publisher is configured to share the optimizer's covariance computation, as described in
+   * Publisher::covarianceRequests().
+   *
+   * @param[in] callback The request callback
+   */
+  void registerCovarianceRequest(CovarianceBlocks::RequestCallback callback);
+
   /**
    * @brief Callback method executed in response to the optimizer completing an optimization cycle. All variables
    * will now have updated values.
@@ -178,6 +226,28 @@ protected:
    */
   virtual void notifyCallback(Transaction::ConstSharedPtr /*transaction*/, Graph::ConstSharedPtr /*graph*/) {}
 
+  /**
+   * @brief Callback method executed in response to the optimizer completing an optimization cycle, with the
+   * covariance blocks requested through registerCovarianceRequest().
+   *
+   * This method is executed using the internal callback queue and local thread(s). Derived classes that register
+   * covariance requests should override this method instead of notifyCallback(transaction, graph). The default
+   * implementation calls notifyCallback(transaction, graph).
+   *
+   * @param[in] transaction       A Transaction object, describing the set of variables that have been added and/or
+   *                              removed
+   * @param[in] graph             A read-only pointer to the graph object, allowing queries to be performed whenever
+   *                              needed
+   * @param[in] covariance_blocks The covariance blocks computed from \p graph, or nullptr if none were computed
+   */
+  virtual void notifyCallback(
+    Transaction::ConstSharedPtr transaction,
+    Graph::ConstSharedPtr graph,
+    CovarianceBlocks::ConstSharedPtr /*covariance_blocks*/)
+  {
+    notifyCallback(std::move(transaction), std::move(graph));
+  }
+
   /**
    * @brief Perform any required operations to prepare for servicing calls to notify()
    *
@@ -42,7 +42,9 @@
 
 //#include <fuse_core/fuse_macros.h>
 
+#include <chrono>
 #include <functional>
+#include <mutex>
 #include <string>
 
 
@@ -83,6 +85,12 @@ namespace fuse_core
  * - _must_ call sendTransaction() every time new constraints are generated. This is how constraints are sent to the
  *   optimizer. Otherwise, the optimizer will not know about the derived sensor's constraints, and the sensor will
  *   have no effect.
+ *
+ * High-rate sensors may opt in to transaction batching, either with the "transaction_batch_size" and
+ * "transaction_batch_window" parameters or by calling batchTransactions() from onInit(). Transactions passed to
+ * sendTransaction() are then merged into a single transaction, which is sent to the optimizer once it holds
+ * transaction_batch_size transactions or once transaction_batch_window seconds have passed, whichever comes first.
+ * The merged transaction keeps every involved stamp of its parts, so motion models still see every stamp.
  */
 class AsyncSensorModel : public SensorModel
 {
@@ -133,10 +141,20 @@ public:
    * This should be called by derived classes whenever a new Transaction is generated, probably from within the sensor
    * message callback function.
    *
+   * If transaction batching is enabled, the transaction is merged into the pending batch instead, and the batch is
+   * sent once it is full. The provided transaction is not modified.
+   *
    * @param[in] transaction A Transaction object describing the set of variables that have been added and removed.
    */
   void sendTransaction(Transaction::SharedPtr transaction);
 
+  /**
+   * @brief Send the pending batch of transactions to the Optimizer now, if there is one
+   *
+   * This does nothing if transaction batching is disabled.
+   */
+  void flushTransactions();
+
   /**
    * @brief Get the unique name of this sensor
    */
@@ -155,6 +173,8 @@ public:
    * uses a single-threaded spinner, then all callbacks will fire sequentially and no semaphores are needed. If this
    * sensor model uses a multithreaded spinner, then normal multithreading rules apply and data accessed in more than
    * one place should be guarded.
+   *
+   * If transaction batching is enabled, any pending batch is dropped before onStart() is called.
    */
   void start() override;
 
@@ -170,6 +190,8 @@ public:
    * uses a single-threaded spinner, then all callbacks will fire sequentially and no semaphores are needed. If this
    * sensor model uses a multithreaded spinner, then normal multithreading rules apply and data accessed in more than
    * one place should be guarded.
+   *
+   * If transaction batching is enabled, the pending batch is sent both before and after onStop() is called.
    */
   void stop() override;
 
@@ -182,6 +204,12 @@ protected:
   rclcpp::node_interfaces::NodeWaitablesInterface::SharedPtr waitables_interface_;
   size_t executor_thread_count_;
 
+  size_t transaction_batch_size_;  //!< The number of transactions merged before sending. 1 disables batching.
+  std::mutex transaction_batch_mutex_;  //!< Guards the pending batch
+  Transaction::SharedPtr transaction_batch_;  //!< The merged transactions waiting to be sent, or nullptr
+  size_t transaction_batch_count_;  //!< The number of transactions merged into transaction_batch_
+  rclcpp::TimerBase::SharedPtr transaction_batch_timer_;  //!< Sends the pending batch once per batch window
+
   /**
    * @brief Constructor
    *
@@ -191,6 +219,18 @@ protected:
    */
   explicit AsyncSensorModel(size_t thread_count = 1);
 
+  /**
+   * @brief Configure transaction batching
+   *
+   * This overrides the "transaction_batch_size" and "transaction_batch_window" parameters. It may be called from
+   * onInit() by sensors that know they produce many small transactions. Any pending batch is sent first.
+   *
+   * @param[in] max_count The maximum number of transactions merged into one. 0 or 1 disables batching.
+   * @param[in] window    The maximum time a transaction is held before the batch is sent. If zero, batches are only
+   *                      sent once they are full, or when flushTransactions() or stop() is called.
+   */
+  void batchTransactions(size_t max_count, std::chrono::nanoseconds window);
+
   /**
    * @brief Callback fired in the local callback queue thread(s) whenever a new Graph is received from the optimizer
    * 
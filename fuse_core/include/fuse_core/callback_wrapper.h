@@ -35,9 +35,18 @@
 #ifndef FUSE_CORE_CALLBACK_WRAPPER_H
 #define FUSE_CORE_CALLBACK_WRAPPER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
 #include <functional>
 #include <future>
-#include <queue>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <rclcpp/rclcpp.hpp>
 
@@ -93,14 +102,38 @@ namespace fuse_core
  * @endcode
  */
 
+class CallbackAdapter;
+
 class CallbackWrapperBase
 {
 public:
+  virtual ~CallbackWrapperBase() = default;
+
   /**
    * @brief Call this function. This is used by the callback queue.
    */
   virtual void call() = 0;
 
+protected:
+  /**
+   * @brief Called by the callback queue once it is done with this callback, after call() or instead of it
+   *
+   * By default this drops the reference the queue held while the callback was pending, which may destroy the object.
+   * The object must not be accessed after this returns.
+   *
+   * @param[in] discarded True if the callback was removed from the queue without being called
+   */
+  virtual void release(bool /* discarded */)
+  {
+    auto self = std::move(self_);
+  }
+
+private:
+  friend class CallbackAdapter;
+
+  CallbackWrapperBase* next_{ nullptr };  //!< Intrusive link used by the callback queue while this is pending
+  std::shared_ptr<CallbackWrapperBase> self_;  //!< Keeps a shared callback alive while it is pending
+
 };
 
 template <typename T>
@@ -152,12 +185,28 @@ inline void CallbackWrapper<void>::call()
 
 
 
+/**
+ * @brief A rclcpp::Waitable that executes CallbackWrapper objects in the thread(s) of a ROS executor
+ *
+ * Callbacks may be added from any number of threads. They are pushed onto a lock-free intrusive list, so producers
+ * never block each other or the executor. Each call to execute() takes every pending callback at once and runs them in
+ * the order they were added. A callback object may only be pending once at a time.
+ *
+ * Besides CallbackWrapper objects, two allocation-free ways of queuing a function are provided:
+ *  - postCallback() for fire-and-forget calls. The function is stored in a recycled, fixed-capacity wrapper.
+ *  - invokeCallback() for blocking calls. The wrapper lives on the caller's stack until the result is available.
+ */
 class CallbackAdapter : public rclcpp::Waitable
 {
 public:
 
   CallbackAdapter(std::shared_ptr<rclcpp::Context> context_ptr);
 
+  /**
+   * @brief Destructor. Pending callbacks are discarded without being executed.
+   */
+  ~CallbackAdapter();
+
   /**
    * @brief tell the CallbackGroup how many guard conditions are ready in this waitable
    */
@@ -179,24 +228,253 @@ public:
 
   std::shared_ptr< void > take_data();
 
-  // XXX check this against the threading model of the multi-threaded executor.
+  /**
+   * @brief Run all of the callbacks that are pending, in the order they were added
+   *
+   * Callbacks added while the batch is running are left for the next call. If several executor threads call this
+   * concurrently, only one of them drains the queue; the others return immediately. If a callback throws, the rest of
+   * the batch is kept and runs first on the next call.
+   */
   void execute(std::shared_ptr<void> & /*data*/);
 
+  /**
+   * @brief Add a callback to the queue. This is lock-free and may be called from any thread.
+   */
   void addCallback(const std::shared_ptr<CallbackWrapperBase> &callback);
 
+  /**
+   * @brief Add a callback to the queue. This is lock-free and may be called from any thread.
+   */
   void addCallback(std::shared_ptr<CallbackWrapperBase> && callback);
 
+  /**
+   * @brief Queue a function without waiting for it or its result
+   *
+   * The function is moved into a wrapper taken from a pool owned by this queue, and the wrapper is returned to the
+   * pool after the call. Once the pool has grown to the number of callbacks pending at once, this does not allocate.
+   * Functions larger than PooledCallback::capacity fall back to a heap-allocated CallbackWrapper.
+   *
+   * @param[in] callable A function object taking no arguments. Its return value is ignored.
+   */
+  template <typename Callable>
+  void postCallback(Callable&& callable);
+
+  /**
+   * @brief Queue a function and block until it has been executed, returning its result
+   *
+   * The wrapper is allocated on the caller's stack, so this does not allocate. Exceptions thrown by the function are
+   * rethrown here. If the callback is discarded by removeAllCallbacks(), a std::future_error is thrown.
+   *
+   * This must not be called from the thread that executes this queue, as that would deadlock.
+   *
+   * @param[in] callable A function object taking no arguments
+   * @return The return value of the function
+   */
+  template <typename Callable>
+  auto invokeCallback(Callable&& callable) -> decltype(callable());
+
+  /**
+   * @brief Discard all pending callbacks. Callbacks already taken by a running execute() are not affected.
+   */
   void removeAllCallbacks();
 
 
 private:
+  /**
+   * @brief A fire-and-forget callback with inline storage, recycled through the owning queue's pool
+   */
+  class PooledCallback : public CallbackWrapperBase
+  {
+  public:
+    static constexpr size_t capacity = 64;  //!< The maximum size of a function stored inline
+
+    explicit PooledCallback(CallbackAdapter& adapter) :
+      adapter_(adapter)
+    {
+    }
+
+    template <typename Callable>
+    void assign(Callable&& callable)
+    {
+      using Function = typename std::decay<Callable>::type;
+      new (&storage_) Function(std::forward<Callable>(callable));
+      invoke_ = [](void* function) { (*static_cast<Function*>(function))(); };
+      destroy_ = [](void* function) { static_cast<Function*>(function)->~Function(); };
+    }
+
+    void call() override
+    {
+      invoke_(&storage_);
+    }
+
+  protected:
+    void release(bool /* discarded */) override
+    {
+      destroy_(&storage_);
+      adapter_.recycle(this);
+    }
+
+  private:
+    CallbackAdapter& adapter_;  //!< The queue that owns this callback's pool
+    typename std::aligned_storage<capacity, alignof(std::max_align_t)>::type storage_;  //!< The stored function
+    void (*invoke_)(void*) = nullptr;  //!< Calls the stored function
+    void (*destroy_)(void*) = nullptr;  //!< Destroys the stored function
+  };
+
+  /**
+   * @brief Stores the result of a blocking callback. Specialized for void.
+   */
+  template <typename Result>
+  struct BlockingResult
+  {
+    template <typename Callable>
+    void set(Callable& callable) { value.reset(new Result(callable())); }
+    Result get() { return std::move(*value); }
+    std::unique_ptr<Result> value;
+  };
+
+  /**
+   * @brief A callback that lives on the stack of a thread blocked in invokeCallback()
+   */
+  template <typename Callable>
+  class BlockingCallback : public CallbackWrapperBase
+  {
+  public:
+    using Result = decltype(std::declval<Callable&>()());
+
+    explicit BlockingCallback(Callable& callable) :
+      callable_(callable)
+    {
+    }
+
+    void call() override
+    {
+      try
+      {
+        result_.set(callable_);
+      }
+      catch (...)
+      {
+        exception_ = std::current_exception();
+      }
+    }
+
+    Result wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return done_; });
+      if (exception_)
+      {
+        std::rethrow_exception(exception_);
+      }
+      return result_.get();
+    }
+
+  protected:
+    void release(bool discarded) override
+    {
+      if (discarded)
+      {
+        exception_ = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+      }
+      // Notify while holding the lock: the waiting thread destroys this object as soon as it can take the lock
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+      condition_.notify_one();
+    }
+
+  private:
+    Callable& callable_;  //!< The function to call
+    BlockingResult<Result> result_;  //!< The return value of the function
+    std::exception_ptr exception_;  //!< The exception thrown by the function, if any
+    std::mutex mutex_;  //!< Guards done_
+    std::condition_variable condition_;  //!< Signalled when the callback is released
+    bool done_{ false };  //!< Set once the queue is done with this callback
+  };
+
+  /**
+   * @brief Queue a function using a pooled wrapper
+   */
+  template <typename Callable>
+  void postCallback(Callable&& callable, std::true_type /* fits_inline */);
+
+  /**
+   * @brief Queue a function that is too large for a pooled wrapper
+   */
+  template <typename Callable>
+  void postCallback(Callable&& callable, std::false_type /* fits_inline */);
+
+  /**
+   * @brief Push a callback onto the pending list, triggering the guard condition if the list was empty
+   */
+  void push(CallbackWrapperBase* callback);
+
+  /**
+   * @brief Release a list of callbacks without running them
+   */
+  static void discard(CallbackWrapperBase* callback);
+
+  /**
+   * @brief Take a wrapper from the pool, creating one if the pool is empty
+   */
+  PooledCallback* acquirePooled();
+
+  /**
+   * @brief Return a wrapper to the pool
+   */
+  void recycle(PooledCallback* callback);
+
   std::recursive_mutex reentrant_mutex_;  //!< mutex to allow this callback to be added to multiple callback groups simultaneously
   rcl_guard_condition_t gc_;  //!< guard condition to drive the waitable
-  
-  std::recursive_mutex queue_mutex_;  //!< mutex to allow this callback to be added to multiple callback groups simultaneously
-  std::queue<std::shared_ptr<CallbackWrapperBase> > callback_queue_;
+
+  std::atomic<CallbackWrapperBase*> pending_{ nullptr };  //!< Lock-free list of pending callbacks, newest first
+  std::atomic<CallbackWrapperBase*> batch_{ nullptr };  //!< Callbacks taken by execute() but not yet run, oldest first
+  std::mutex execute_mutex_;  //!< Ensures a single consumer drains the pending list at a time
+
+  std::mutex pool_mutex_;  //!< Guards the pool of fire-and-forget wrappers
+  std::vector<std::unique_ptr<PooledCallback>> pool_;  //!< Every fire-and-forget wrapper created by this queue
+  CallbackWrapperBase* pool_free_{ nullptr };  //!< The wrappers in the pool that are not in use, linked by next_
 };
 
+template <>
+struct CallbackAdapter::BlockingResult<void>
+{
+  template <typename Callable>
+  void set(Callable& callable) { callable(); }
+  void get() {}
+};
+
+template <typename Callable>
+void CallbackAdapter::postCallback(Callable&& callable)
+{
+  using Function = typename std::decay<Callable>::type;
+  using FitsInline = std::integral_constant<bool,
+    (sizeof(Function) <= PooledCallback::capacity) && (alignof(Function) <= alignof(std::max_align_t))>;
+  postCallback(std::forward<Callable>(callable), FitsInline());
+}
+
+template <typename Callable>
+void CallbackAdapter::postCallback(Callable&& callable, std::true_type /* fits_inline */)
+{
+  auto callback = acquirePooled();
+  callback->assign(std::forward<Callable>(callable));
+  push(callback);
+}
+
+template <typename Callable>
+void CallbackAdapter::postCallback(Callable&& callable, std::false_type /* fits_inline */)
+{
+  addCallback(std::make_shared<CallbackWrapper<void>>(std::forward<Callable>(callable)));
+}
+
+template <typename Callable>
+auto CallbackAdapter::invokeCallback(Callable&& callable) -> decltype(callable())
+{
+  BlockingCallback<typename std::remove_reference<Callable>::type> callback(callable);
+  push(&callback);
+  return callback.wait();
+}
+
 
 }  // namespace fuse_core
 
@@ -290,7 +290,9 @@ public:
   /**
    * @brief Read-only access to the Ceres loss function.
    *
-   * @return A base pointer to an instance of a derived ceres::LossFunction.
+   * The returned pointer is owned by the loss (see Loss::lossFunction()) and must not be deleted by the caller.
+   *
+   * @return A base pointer to an instance of a derived ceres::LossFunction, or nullptr if no loss is configured.
    */
   ceres::LossFunction* lossFunction() const
   {
@@ -0,0 +1,175 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_COVARIANCE_BLOCKS_H
+#define FUSE_CORE_COVARIANCE_BLOCKS_H
+
+#include <fuse_core/fuse_macros.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+
+#include <boost/functional/hash.hpp>
+#include <ceres/covariance.h>
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief A collection of marginal covariance blocks computed from a single graph snapshot
+ *
+ * Computing marginal covariances requires a factorization of the full graph, so it is much cheaper to compute all of
+ * the blocks needed by all consumers in a single batch. Plugins describe the blocks they need with a
+ * CovarianceBlocks::RequestCallback, the optimizer gathers those requests after every optimization cycle, computes
+ * them with one call to Graph::getCovariance(), and delivers the results alongside the graph snapshot.
+ *
+ * All blocks are stored in the variables' tangent space, in the same row-major layout returned by
+ * Graph::getCovariance().
+ */
+class CovarianceBlocks
+{
+public:
+  FUSE_SMART_PTR_DEFINITIONS(CovarianceBlocks)
+
+  /**
+   * @brief A request for the marginal covariance between two variables, Cov(first, second)
+   */
+  using Request = std::pair<UUID, UUID>;
+
+  /**
+   * @brief A callback used to declare the covariance blocks a plugin needs from the upcoming graph snapshot
+   *
+   * The callback is executed in the optimizer's thread after every optimization cycle, before the snapshot is sent to
+   * the plugins. It should append the requested variable pairs to the provided vector. The callback must not access
+   * state that is modified by the plugin's own callbacks without proper synchronization.
+   *
+   * @param[in]  transaction A Transaction object, describing the set of variables that have been added and/or removed
+   * @param[in]  graph       The optimized graph snapshot
+   * @param[out] requests    The container that collects the covariance requests
+   */
+  using RequestCallback = std::function<void(const Transaction& transaction,
+                                             const Graph& graph,
+                                             std::vector<Request>& requests)>;
+
+  /**
+   * @brief Compute all of the requested covariance blocks from the graph using a single covariance computation
+   *
+   * Requests for variables that do not exist in the graph and duplicate requests are silently discarded. If the
+   * covariance computation fails, an exception is thrown.
+   *
+   * @param[in] requests The requested variable pairs
+   * @param[in] graph    The graph used to compute the covariance blocks
+   * @param[in] options  A Ceres Covariance Options structure that controls the method and settings used
+   *                     to compute the covariance blocks.
+   * @return The computed covariance blocks
+   */
+  static CovarianceBlocks::SharedPtr compute(
+    const std::vector<Request>& requests,
+    const Graph& graph,
+    const ceres::Covariance::Options& options = ceres::Covariance::Options());
+
+  /**
+   * @brief Returns true if no covariance blocks are stored
+   */
+  bool empty() const { return blocks_.empty(); }
+
+  /**
+   * @brief Returns the number of stored covariance blocks
+   */
+  size_t size() const { return blocks_.size(); }
+
+  /**
+   * @brief Check if the Cov(first, second) block is available
+   *
+   * @param[in] first  The UUID of the first variable
+   * @param[in] second The UUID of the second variable
+   * @return True if the block has been computed, false otherwise
+   */
+  bool contains(const UUID& first, const UUID& second) const;
+
+  /**
+   * @brief Store the Cov(first, second) covariance block, replacing any existing block
+   *
+   * @param[in] first  The UUID of the first variable
+   * @param[in] second The UUID of the second variable
+   * @param[in] block  The dense, row-major covariance block
+   */
+  void insert(const UUID& first, const UUID& second, std::vector<double> block);
+
+  /**
+   * @brief Read-only access to the Cov(first, second) covariance block
+   *
+   * Exceptions: If the requested block was not computed, a std::out_of_range exception will be thrown.
+   *
+   * @param[in] first  The UUID of the first variable
+   * @param[in] second The UUID of the second variable
+   * @return The dense, row-major covariance block
+   */
+  const std::vector<double>& at(const UUID& first, const UUID& second) const;
+
+  /**
+   * @brief Retrieve a set of covariance blocks using the same interface as Graph::getCovariance()
+   *
+   * @param[in]  requests            The requested variable pairs
+   * @param[out] covariance_matrices The dense covariance blocks of the requests
+   * @return True if all requested blocks were available, false otherwise. The output is unchanged on failure.
+   */
+  bool get(const std::vector<Request>& requests, std::vector<std::vector<double>>& covariance_matrices) const;
+
+private:
+  /**
+   * @brief Hash function for a pair of UUIDs
+   */
+  struct RequestHash
+  {
+    size_t operator()(const Request& request) const
+    {
+      size_t seed = 0;
+      boost::hash_combine(seed, request.first);
+      boost::hash_combine(seed, request.second);
+      return seed;
+    }
+  };
+
+  std::unordered_map<Request, std::vector<double>, RequestHash> blocks_;  //!< The computed covariance blocks
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_COVARIANCE_BLOCKS_H
@@ -0,0 +1,694 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_FLAT_SERIALIZATION_H
+#define FUSE_CORE_FLAT_SERIALIZATION_H
+
+#include <fuse_core/constraint.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/time.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+
+#include <boost/preprocessor/cat.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief The encodings supported by serializeGraph() and serializeTransaction()
+ *
+ * The deserializers detect the encoding of a message, so the reader does not need to be configured to match.
+ */
+enum class SerializationFormat
+{
+  BOOST_BINARY,  //!< A Boost binary archive of the whole object, using polymorphic class export
+  FLAT           //!< The flat binary format described in fuse_core/flat_serialization.h
+};
+
+/**
+ * @brief A schema-versioned flat binary encoding of graphs and transactions
+ *
+ * A flat buffer is a sequence of fixed-layout sections that may be read in place, without constructing any fuse
+ * objects:
+ *
+ *   BufferHeader | involved stamps | removed variable UUIDs | removed constraint UUIDs |
+ *   variable records | constraint records | Boost section | string table
+ *
+ * Each variable record holds the variable's UUID, type, hold flag and values. Each constraint record holds the
+ * constraint's UUID, type, source and variable UUIDs. Type names and sources are stored once, in the string table.
+ * Every section and record starts on an 8-byte boundary, so the values of a variable may be accessed directly as a
+ * double array.
+ *
+ * The rest of an object, for example the timestamp of a stamped variable or the mean and loss of a constraint, is
+ * needed to reconstruct it. Types with a registered VariableCodec or ConstraintCodec write it as a payload following
+ * the fixed part of their record. All other types fall back to Boost serialization: those objects are written, in
+ * record order, to a single Boost binary archive stored in the Boost section. Sharing one archive keeps the fallback
+ * cost close to that of the Boost format, but those objects can only be reconstructed in record order, see
+ * ObjectReader. The fixed part of every record may always be read in any order.
+ *
+ * A graph may also be sent as a stream of keyframes and deltas, see GraphDeltaEncoder. A delta buffer uses the same
+ * layout: the removed UUID sections list the objects removed since the previous buffer of the stream, and the records
+ * hold the added objects and the new values of the variables that changed.
+ *
+ * All values are stored in host byte order.
+ */
+namespace flat
+{
+
+constexpr uint32_t VERSION = 1;  //!< The version of the format written by this library
+
+/**
+ * @brief The object stored in a flat buffer
+ */
+enum class Content : uint32_t
+{
+  GRAPH = 1,
+  TRANSACTION = 2,
+  GRAPH_DELTA = 3  //!< The changes to a graph since the previous buffer of a GraphDeltaEncoder stream
+};
+
+/**
+ * @brief How the type-specific payload of a record was written
+ */
+enum class PayloadEncoding : uint32_t
+{
+  CODEC = 1,        //!< Written by the VariableCodec or ConstraintCodec registered for the type
+  BOOST_BINARY = 2,  //!< The object is stored in the Boost section, written by its serialize() method. No payload.
+  NONE = 3           //!< Graph deltas only: the record holds the new values of an existing variable. No payload.
+};
+
+/**
+ * @brief The fixed-layout header at the start of every flat buffer
+ */
+struct BufferHeader
+{
+  char magic[8];                      //!< Always "FUSEFLAT"
+  uint32_t version;                   //!< The format version, see flat::VERSION
+  Content content;                    //!< The object stored in this buffer
+  uint32_t string_count;              //!< The number of entries in the string table
+  uint32_t involved_stamp_count;      //!< The number of involved stamps (transactions only)
+  uint32_t removed_variable_count;    //!< The number of removed variable UUIDs (transactions only)
+  uint32_t removed_constraint_count;  //!< The number of removed constraint UUIDs (transactions only)
+  uint32_t variable_count;            //!< The number of variable records
+  uint32_t constraint_count;          //!< The number of constraint records
+  int64_t stamp;                      //!< The transaction stamp, encoded with encodeStamp()
+  uint64_t boost_section_offset;      //!< The offset of the Boost section from the start of the buffer
+  uint64_t boost_section_bytes;       //!< The size of the Boost section, excluding padding
+  uint64_t string_table_offset;       //!< The offset of the string table from the start of the buffer
+  uint64_t sequence;                  //!< The position of the buffer in a GraphDeltaEncoder stream, or 0
+  uint64_t base_sequence;             //!< The sequence of the buffer a graph delta applies to, or 0
+};
+static_assert(sizeof(BufferHeader) == 88, "BufferHeader must have a fixed layout");
+
+/**
+ * @brief The fixed part of a variable record. It is followed by the variable values and the payload.
+ */
+struct VariableRecord
+{
+  uint32_t record_bytes;  //!< The size of the whole record, including padding
+  uint32_t type_index;    //!< The string table index of the variable type
+  uint32_t size;          //!< The number of values
+  uint32_t flags;         //!< See VariableRecord::HOLD
+  PayloadEncoding payload_encoding;  //!< How the payload was written
+  uint32_t payload_bytes;  //!< The size of the payload, excluding padding
+  uint8_t uuid[16];        //!< The variable UUID
+
+  static constexpr uint32_t HOLD = 1u;  //!< Flag set if the variable is held constant in the graph
+};
+static_assert(sizeof(VariableRecord) == 40, "VariableRecord must have a fixed layout");
+
+/**
+ * @brief The fixed part of a constraint record. It is followed by the variable UUIDs and the payload.
+ */
+struct ConstraintRecord
+{
+  uint32_t record_bytes;    //!< The size of the whole record, including padding
+  uint32_t type_index;      //!< The string table index of the constraint type
+  uint32_t source_index;    //!< The string table index of the constraint source
+  uint32_t variable_count;  //!< The number of variable UUIDs
+  PayloadEncoding payload_encoding;  //!< How the payload was written
+  uint32_t payload_bytes;   //!< The size of the payload, excluding padding
+  uint8_t uuid[16];         //!< The constraint UUID
+};
+static_assert(sizeof(ConstraintRecord) == 40, "ConstraintRecord must have a fixed layout");
+
+/**
+ * @brief Encode a stamp as nanoseconds since the epoch. Invalid stamps are encoded as INT64_MIN.
+ */
+int64_t encodeStamp(const TimeStamp& stamp);
+
+/**
+ * @brief Decode a stamp written by encodeStamp()
+ */
+TimeStamp decodeStamp(int64_t nanoseconds);
+
+/**
+ * @brief Appends the payload of a record to a flat buffer
+ */
+class PayloadWriter
+{
+public:
+  explicit PayloadWriter(std::vector<uint8_t>& data) :
+    data_(data)
+  {
+  }
+
+  /**
+   * @brief Append the bytes of a trivially copyable value
+   */
+  template <typename T>
+  void write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types may be written directly");
+    const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    data_.insert(data_.end(), bytes, bytes + sizeof(T));
+  }
+
+  /**
+   * @brief Append an array of trivially copyable values
+   */
+  template <typename T>
+  void write(const T* values, size_t count)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types may be written directly");
+    const auto bytes = reinterpret_cast<const uint8_t*>(values);
+    data_.insert(data_.end(), bytes, bytes + count * sizeof(T));
+  }
+
+private:
+  std::vector<uint8_t>& data_;  //!< The buffer being written
+};
+
+/**
+ * @brief Reads the payload of a record in place
+ */
+class PayloadReader
+{
+public:
+  PayloadReader(const uint8_t* data, size_t size) :
+    data_(data),
+    remaining_(size)
+  {
+  }
+
+  /**
+   * @brief Read the next trivially copyable value
+   * @throws std::runtime_error if the payload is too short
+   */
+  template <typename T>
+  T read()
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types may be read directly");
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  /**
+   * @brief Copy the next \p count trivially copyable values into \p values
+   * @throws std::runtime_error if the payload is too short
+   */
+  template <typename T>
+  void read(T* values, size_t count)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types may be read directly");
+    std::memcpy(values, take(count * sizeof(T)), count * sizeof(T));
+  }
+
+  /**
+   * @brief The unread part of the payload
+   */
+  const uint8_t* data() const { return data_; }
+
+  /**
+   * @brief The number of unread bytes
+   */
+  size_t remaining() const { return remaining_; }
+
+private:
+  const uint8_t* take(size_t bytes)
+  {
+    if (bytes > remaining_)
+    {
+      throw std::runtime_error("Flat buffer record payload is shorter than expected.");
+    }
+    const uint8_t* result = data_;
+    data_ += bytes;
+    remaining_ -= bytes;
+    return result;
+  }
+
+  const uint8_t* data_;  //!< The next unread byte
+  size_t remaining_;     //!< The number of unread bytes
+};
+
+class BufferReader;
+
+/**
+ * @brief Read-only, in-place access to a variable record
+ */
+class VariableView
+{
+public:
+  UUID uuid() const;
+  const std::string& type() const;
+  uint32_t typeIndex() const { return record_->type_index; }
+  size_t size() const { return record_->size; }
+  const double* data() const { return reinterpret_cast<const double*>(record_ + 1); }
+  bool onHold() const { return (record_->flags & VariableRecord::HOLD) != 0; }
+  PayloadEncoding payloadEncoding() const { return record_->payload_encoding; }
+  PayloadReader payload() const;
+
+private:
+  friend class BufferReader;
+
+  VariableView(const BufferReader& reader, const VariableRecord* record) :
+    reader_(&reader),
+    record_(record)
+  {
+  }
+
+  const BufferReader* reader_;    //!< The reader that owns the string table
+  const VariableRecord* record_;  //!< The record, inside the buffer
+};
+
+/**
+ * @brief Read-only, in-place access to a constraint record
+ */
+class ConstraintView
+{
+public:
+  UUID uuid() const;
+  const std::string& type() const;
+  uint32_t typeIndex() const { return record_->type_index; }
+  const std::string& source() const;
+  size_t variableCount() const { return record_->variable_count; }
+  UUID variable(size_t index) const;
+  PayloadEncoding payloadEncoding() const { return record_->payload_encoding; }
+  PayloadReader payload() const;
+
+private:
+  friend class BufferReader;
+
+  ConstraintView(const BufferReader& reader, const ConstraintRecord* record) :
+    reader_(&reader),
+    record_(record)
+  {
+  }
+
+  const BufferReader* reader_;      //!< The reader that owns the string table
+  const ConstraintRecord* record_;  //!< The record, inside the buffer
+};
+
+/**
+ * @brief Validates a flat buffer and provides in-place access to its contents
+ *
+ * Construction checks the header and the bounds of every record, and indexes the records. Nothing else is copied
+ * out of the buffer apart from the string table. The buffer must be 8-byte aligned, as the storage of a std::vector
+ * is, and must outlive the reader and any views obtained from it.
+ */
+class BufferReader
+{
+public:
+  /**
+   * @brief Constructor
+   * @throws std::runtime_error if the buffer is not a valid flat buffer of a supported version
+   */
+  BufferReader(const uint8_t* data, size_t size);
+
+  /**
+   * @brief Constructor
+   * @throws std::runtime_error if the buffer is not a valid flat buffer of a supported version
+   */
+  explicit BufferReader(const std::vector<uint8_t>& data) :
+    BufferReader(data.data(), data.size())
+  {
+  }
+
+  Content content() const { return header_.content; }
+  TimeStamp stamp() const { return decodeStamp(header_.stamp); }
+  uint64_t sequence() const { return header_.sequence; }
+  uint64_t baseSequence() const { return header_.base_sequence; }
+
+  size_t involvedStampCount() const { return header_.involved_stamp_count; }
+  TimeStamp involvedStamp(size_t index) const;
+
+  size_t removedVariableCount() const { return header_.removed_variable_count; }
+  UUID removedVariable(size_t index) const;
+
+  size_t removedConstraintCount() const { return header_.removed_constraint_count; }
+  UUID removedConstraint(size_t index) const;
+
+  size_t variableCount() const { return variable_offsets_.size(); }
+  VariableView variable(size_t index) const;
+
+  size_t constraintCount() const { return constraint_offsets_.size(); }
+  ConstraintView constraint(size_t index) const;
+
+  /**
+   * @brief Access an entry of the string table
+   */
+  const std::string& string(size_t index) const { return strings_[index]; }
+
+  /**
+   * @brief Access the Boost section, which holds the objects without a registered codec
+   */
+  PayloadReader boostSection() const
+  {
+    return PayloadReader(data_ + header_.boost_section_offset, header_.boost_section_bytes);
+  }
+
+private:
+  const uint8_t* data_;  //!< The start of the buffer
+  BufferHeader header_;  //!< A copy of the buffer header
+  size_t involved_stamps_offset_;     //!< The offset of the involved stamp array
+  size_t removed_variables_offset_;   //!< The offset of the removed variable UUID array
+  size_t removed_constraints_offset_;  //!< The offset of the removed constraint UUID array
+  std::vector<size_t> variable_offsets_;    //!< The offset of each variable record
+  std::vector<size_t> constraint_offsets_;  //!< The offset of each constraint record
+  std::vector<std::string> strings_;  //!< The decoded string table
+};
+
+/**
+ * @brief Writes and reads the payload of one variable type
+ *
+ * A codec is registered for a type with FUSE_FLAT_VARIABLE_CODEC_EXPORT(). write() is only called with variables of
+ * the registered type. read() must return a variable equal to the one written, including its UUID.
+ */
+class VariableCodec
+{
+public:
+  virtual ~VariableCodec() = default;
+  virtual void write(const Variable& variable, PayloadWriter& payload) const = 0;
+  virtual Variable::SharedPtr read(const VariableView& view) const = 0;
+};
+
+/**
+ * @brief Writes and reads the payload of one constraint type
+ *
+ * A codec is registered for a type with FUSE_FLAT_CONSTRAINT_CODEC_EXPORT(). write() is only called with constraints
+ * of the registered type. read() must return a constraint equal to the one written, including its UUID, source and
+ * variables.
+ */
+class ConstraintCodec
+{
+public:
+  virtual ~ConstraintCodec() = default;
+  virtual void write(const Constraint& constraint, PayloadWriter& payload) const = 0;
+  virtual Constraint::SharedPtr read(const ConstraintView& view) const = 0;
+};
+
+/**
+ * @brief The process-wide map from type names to flat codecs
+ *
+ * Codecs are usually registered during static initialization of the library that defines the type, so they are
+ * available as soon as the library has been loaded.
+ */
+class CodecRegistry
+{
+public:
+  static CodecRegistry& instance();
+
+  /**
+   * @brief Register a codec for a variable type. Returns false, leaving the registry unchanged, if the type already
+   *        has a codec.
+   */
+  bool registerVariableCodec(const std::string& type, std::unique_ptr<const VariableCodec> codec);
+
+  /**
+   * @brief Register a codec for a constraint type. Returns false, leaving the registry unchanged, if the type
+   *        already has a codec.
+   */
+  bool registerConstraintCodec(const std::string& type, std::unique_ptr<const ConstraintCodec> codec);
+
+  /**
+   * @brief The codec registered for a variable type, or nullptr
+   */
+  const VariableCodec* variableCodec(const std::string& type) const;
+
+  /**
+   * @brief The codec registered for a constraint type, or nullptr
+   */
+  const ConstraintCodec* constraintCodec(const std::string& type) const;
+
+private:
+  CodecRegistry() = default;
+
+  mutable std::mutex mutex_;  //!< Guards the codec maps
+  std::unordered_map<std::string, std::unique_ptr<const VariableCodec>> variable_codecs_;
+  std::unordered_map<std::string, std::unique_ptr<const ConstraintCodec>> constraint_codecs_;
+};
+
+/**
+ * @brief Creates default-constructed objects by type name, for records stored as Boost archives
+ *
+ * The GraphDeserializer and TransactionDeserializer provide factories based on pluginlib.
+ */
+struct ObjectFactory
+{
+  std::function<Variable::UniquePtr(const std::string& type)> create_variable;
+  std::function<Constraint::UniquePtr(const std::string& type)> create_constraint;
+};
+
+/**
+ * @brief Return true if the buffer starts with the flat buffer magic bytes
+ */
+bool isFlatBuffer(const uint8_t* data, size_t size);
+
+/**
+ * @brief Return true if the buffer starts with the flat buffer magic bytes
+ */
+inline bool isFlatBuffer(const std::vector<uint8_t>& data)
+{
+  return isFlatBuffer(data.data(), data.size());
+}
+
+/**
+ * @brief Write a graph into \p data, replacing its contents
+ */
+void serializeGraph(const Graph& graph, std::vector<uint8_t>& data);
+
+/**
+ * @brief Write a transaction into \p data, replacing its contents
+ */
+void serializeTransaction(const Transaction& transaction, std::vector<uint8_t>& data);
+
+/**
+ * @brief Reconstructs the variables and constraints of a flat buffer
+ *
+ * Objects written with a codec may be read in any order. Objects stored in the Boost section are read from a single
+ * archive, so they are decoded in record order: variables first, then constraints. Skipping over such a record decodes
+ * and discards it, and reading a record before the last one decoded from the Boost section throws.
+ */
+class ObjectReader
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] reader  The buffer to read. It must outlive this object.
+   * @param[in] factory Creates objects stored in the Boost section. It must outlive this object.
+   */
+  ObjectReader(const BufferReader& reader, const ObjectFactory& factory);
+
+  /**
+   * @brief Destructor
+   */
+  ~ObjectReader();
+
+  /**
+   * @brief Construct the variable stored in a record
+   * @throws std::runtime_error if the record cannot be decoded
+   */
+  Variable::SharedPtr variable(size_t index);
+
+  /**
+   * @brief Construct the constraint stored in a record
+   * @throws std::runtime_error if the record cannot be decoded
+   */
+  Constraint::SharedPtr constraint(size_t index);
+
+private:
+  class BoostSection;
+
+  /**
+   * @brief Decode and discard Boost section objects up to, but not including, the given position
+   */
+  void skipTo(size_t position);
+
+  const BufferReader& reader_;        //!< The buffer being read
+  const ObjectFactory& factory_;      //!< Creates objects stored in the Boost section
+  std::unique_ptr<BoostSection> boost_section_;  //!< The archive over the Boost section, opened on first use
+  size_t position_;  //!< The next record to be decoded from the Boost section. Constraints follow the variables.
+};
+
+/**
+ * @brief Add the contents of a flat graph buffer to \p graph, which is cleared first
+ * @throws std::runtime_error if the buffer does not hold a graph, or a record cannot be decoded
+ */
+void deserializeGraph(const BufferReader& reader, const ObjectFactory& factory, Graph& graph);
+
+/**
+ * @brief Construct the transaction stored in a flat transaction buffer
+ * @throws std::runtime_error if the buffer does not hold a transaction, or a record cannot be decoded
+ */
+Transaction deserializeTransaction(const BufferReader& reader, const ObjectFactory& factory);
+
+/**
+ * @brief Writes the state of a graph as a stream of keyframes and deltas
+ *
+ * A keyframe is a complete graph buffer. A delta holds only what changed since the previous buffer of the stream: the
+ * UUIDs of the removed variables and constraints, full records of the added ones, and value-only records for the
+ * existing variables whose values or hold state changed. Every buffer carries a sequence number, and every delta the
+ * sequence number of the buffer it applies to, so a consumer that missed a message waits for the next keyframe
+ * instead of applying a delta to the wrong graph. See applyGraphDelta().
+ *
+ * The encoder keeps a copy of the variable values it last wrote. Finding the changes costs one pass over the graph
+ * with a hash lookup per object. Constraints cannot be modified once created, so they are compared by UUID only.
+ */
+class GraphDeltaEncoder
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] keyframe_interval The number of deltas written between two keyframes. Zero writes only keyframes.
+   */
+  explicit GraphDeltaEncoder(size_t keyframe_interval = 10);
+
+  /**
+   * @brief Write the next buffer of the stream into \p data, replacing its contents
+   *
+   * @param[in]  graph The current graph
+   * @param[out] data  The keyframe or delta buffer
+   * @return True if a keyframe was written
+   */
+  bool encode(const Graph& graph, std::vector<uint8_t>& data);
+
+  /**
+   * @brief Make the next call to encode() write a keyframe, for example because a new consumer has connected
+   */
+  void requestKeyframe() { keyframe_requested_ = true; }
+
+private:
+  /**
+   * @brief The state of a variable when it was last written
+   */
+  struct VariableState
+  {
+    std::vector<double> values;  //!< The variable values
+    bool on_hold;                //!< Whether the variable was held constant
+    uint64_t sequence;           //!< The sequence number of the last buffer that found the variable in the graph
+  };
+
+  /**
+   * @brief Compare the graph to the stored state, recording the changes and updating the state
+   */
+  void findChanges(const Graph& graph);
+
+  size_t keyframe_interval_;  //!< The number of deltas between two keyframes
+  size_t deltas_since_keyframe_;  //!< The number of deltas written since the last keyframe
+  bool keyframe_requested_;  //!< Write a keyframe next, regardless of the interval
+  uint64_t sequence_;  //!< The sequence number of the last buffer written. The first buffer is number 1.
+  std::unordered_map<UUID, VariableState> variables_;  //!< The variables of the graph when it was last written
+  std::unordered_map<UUID, uint64_t> constraints_;  //!< The constraint UUIDs, with the sequence that last found them
+
+  // The changes found by findChanges(), kept as members to reuse their storage
+  std::vector<const Variable*> added_variables_;
+  std::vector<const Variable*> updated_variables_;
+  std::vector<const Constraint*> added_constraints_;
+  std::vector<UUID> removed_variables_;
+  std::vector<UUID> removed_constraints_;
+};
+
+/**
+ * @brief Apply a graph delta written by a GraphDeltaEncoder to \p graph
+ *
+ * The graph must hold the state written in the buffer the delta applies to, see BufferReader::baseSequence(). New
+ * variable values are copied into the variables already in the graph, as the optimizer does, so the graph must own
+ * modifiable variables.
+ *
+ * @throws std::runtime_error if the buffer does not hold a graph delta, or a record cannot be decoded
+ */
+void applyGraphDelta(const BufferReader& reader, const ObjectFactory& factory, Graph& graph);
+
+}  // namespace flat
+
+}  // namespace fuse_core
+
+/**
+ * @brief Register a fuse_core::flat::VariableCodec for a variable type
+ *
+ * Place this in the source file of the variable, next to BOOST_CLASS_EXPORT_IMPLEMENT().
+ *
+ * Usage:
+ * @code{.cpp}
+ * FUSE_FLAT_VARIABLE_CODEC_EXPORT(fuse_variables::Position2DStamped, MyCodec)
+ * @endcode
+ */
+#define FUSE_FLAT_VARIABLE_CODEC_EXPORT(VariableType, CodecType) \
+  namespace \
+  { \
+  const bool BOOST_PP_CAT(fuse_flat_variable_codec_registered_, __LINE__) = \
+    ::fuse_core::flat::CodecRegistry::instance().registerVariableCodec( \
+      VariableType::detail::type(), std::unique_ptr<const ::fuse_core::flat::VariableCodec>(new CodecType())); \
+  }  /* NOLINT */
+
+/**
+ * @brief Register a fuse_core::flat::ConstraintCodec for a constraint type
+ *
+ * Place this in the source file of the constraint, next to BOOST_CLASS_EXPORT_IMPLEMENT().
+ */
+#define FUSE_FLAT_CONSTRAINT_CODEC_EXPORT(ConstraintType, CodecType) \
+  namespace \
+  { \
+  const bool BOOST_PP_CAT(fuse_flat_constraint_codec_registered_, __LINE__) = \
+    ::fuse_core::flat::CodecRegistry::instance().registerConstraintCodec( \
+      ConstraintType::detail::type(), std::unique_ptr<const ::fuse_core::flat::ConstraintCodec>(new CodecType())); \
+  }  /* NOLINT */
+
+#endif  // FUSE_CORE_FLAT_SERIALIZATION_H
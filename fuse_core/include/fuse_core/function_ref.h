@@ -0,0 +1,103 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_FUNCTION_REF_H
+#define FUSE_CORE_FUNCTION_REF_H
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace fuse_core
+{
+
+template <typename Signature>
+class FunctionRef;
+
+/**
+ * @brief A non-owning reference to a callable object
+ *
+ * Unlike std::function, a FunctionRef never allocates and never copies the referenced callable. It holds a pointer to
+ * the callable and a pointer to a function that invokes it, so a call costs a single indirect call and the body of
+ * the callable can be fully inlined into that function. This makes it suitable for passing visitors through virtual
+ * interfaces in performance-critical loops.
+ *
+ * The referenced callable must outlive the FunctionRef. It is intended to be used as a function parameter type,
+ * bound to a lambda at the call site:
+ * @code{.cpp}
+ * graph.forEachVariable([&count](const fuse_core::Variable& variable) { count += variable.size(); });
+ * @endcode
+ */
+template <typename Result, typename... Args>
+class FunctionRef<Result(Args...)>
+{
+public:
+  /**
+   * @brief Construct a reference to the provided callable object
+   *
+   * @param[in] callable The callable object to reference. It must outlive this object.
+   */
+  template <typename Callable,
+            typename = std::enable_if_t<!std::is_same<std::decay_t<Callable>, FunctionRef>::value>>
+  FunctionRef(Callable&& callable) noexcept :  // NOLINT(runtime/explicit)
+    callable_(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+    invoke_(&invoke<std::remove_reference_t<Callable>>)
+  {
+  }
+
+  /**
+   * @brief Call the referenced callable object
+   */
+  Result operator()(Args... args) const
+  {
+    return invoke_(callable_, std::forward<Args>(args)...);
+  }
+
+private:
+  void* callable_;  //!< The address of the referenced callable object
+  Result (*invoke_)(void*, Args...);  //!< Invokes the referenced callable with its original type
+
+  /**
+   * @brief Restore the type of the referenced callable and call it
+   */
+  template <typename Callable>
+  static Result invoke(void* callable, Args... args)
+  {
+    return (*static_cast<Callable*>(callable))(std::forward<Args>(args)...);
+  }
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_FUNCTION_REF_H
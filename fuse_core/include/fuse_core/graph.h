@@ -35,6 +35,7 @@
 #define FUSE_CORE_GRAPH_H
 
 #include <fuse_core/constraint.h>
+#include <fuse_core/function_ref.h>
 #include <fuse_core/fuse_macros.h>
 #include <fuse_core/serialization.h>
 #include <fuse_core/transaction.h>
@@ -169,6 +170,16 @@ public:
    */
   using const_variable_range = boost::any_range<const Variable, boost::forward_traversal_tag>;
 
+  /**
+   * @brief A non-owning callback that is called once for each visited fuse_core::Constraint
+   */
+  using ConstraintVisitor = FunctionRef<void(const Constraint&)>;
+
+  /**
+   * @brief A non-owning callback that is called once for each visited fuse_core::Variable
+   */
+  using VariableVisitor = FunctionRef<void(const Variable&)>;
+
   /**
    * @brief Constructor
    *
@@ -254,6 +265,29 @@ public:
    */
   virtual const_constraint_range getConnectedConstraints(const UUID& variable_uuid) const = 0;
 
+  /**
+   * @brief Call the provided visitor for every constraint in the graph
+   *
+   * This is a faster alternative to iterating over getConstraints() for performance-critical consumers. Every
+   * increment, dereference and comparison of the type-erased range is an indirect call, while the visitor is called
+   * directly from the graph's own loop. The graph must not be modified from within the visitor.
+   *
+   * The default implementation iterates over getConstraints(). Derived classes should override it.
+   *
+   * @param[in] visitor The callback to call for each constraint
+   */
+  virtual void forEachConstraint(ConstraintVisitor visitor) const;
+
+  /**
+   * @brief Call the provided visitor for every constraint connected to the specified variable
+   *
+   * This is a faster alternative to iterating over getConnectedConstraints(). See forEachConstraint().
+   *
+   * @param[in] variable_uuid The UUID of the variable of interest
+   * @param[in] visitor       The callback to call for each connected constraint
+   */
+  virtual void forEachConnectedConstraint(const UUID& variable_uuid, ConstraintVisitor visitor) const;
+
   /**
    * @brief Check if the variable already exists in the graph
    *
@@ -298,6 +332,15 @@ public:
    */
   virtual const_variable_range getVariables() const = 0;
 
+  /**
+   * @brief Call the provided visitor for every variable in the graph
+   *
+   * This is a faster alternative to iterating over getVariables(). See forEachConstraint().
+   *
+   * @param[in] visitor The callback to call for each variable
+   */
+  virtual void forEachVariable(VariableVisitor visitor) const;
+
   /**
    * @brief Read-only access to the subset of variables that are connected to the specified constraint
    *
@@ -541,7 +584,7 @@ void Graph::getConstraintCosts(
     cost.cost =
       std::sqrt(std::inner_product(cost.residuals.begin(), cost.residuals.end(), cost.residuals.begin(), 0.0));
     // Apply the loss function, if one is configured
-    auto loss_function = std::unique_ptr<ceres::LossFunction>(constraint.lossFunction());
+    auto loss_function = constraint.lossFunction();
     if (loss_function)
     {
       double loss_result[3];  // The Loss function returns the loss-adjusted cost plus the first and second derivative
@@ -36,18 +36,43 @@
 
 #include <fuse_msgs/msg/serialized_graph.hpp>
 #include <fuse_core/constraint.h>
+#include <fuse_core/flat_serialization.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/variable.h>
 #include <pluginlib/class_loader.hpp>
 
+#include <cstdint>
+
 
 namespace fuse_core
 {
 
 /**
  * @brief Serialize a graph into a message
+ *
+ * @param[in]  graph  The graph to serialize
+ * @param[out] msg    The message to fill in
+ * @param[in]  format The encoding of the msg.data field. The GraphDeserializer detects either encoding.
+ */
+void serializeGraph(
+  const fuse_core::Graph& graph,
+  fuse_msgs::msg::SerializedGraph& msg,
+  SerializationFormat format = SerializationFormat::BOOST_BINARY);
+
+/**
+ * @brief Serialize the next keyframe or delta of a graph stream into a message
+ *
+ * The messages are read back with a GraphReconstructor. The first message written by an encoder is always a keyframe.
+ *
+ * @param[in]    graph   The current graph
+ * @param[inout] encoder The encoder of the stream, which remembers the state sent in the previous message
+ * @param[out]   msg     The message to fill in
+ * @return True if a keyframe was written
  */
-void serializeGraph(const fuse_core::Graph& graph, fuse_msgs::msg::SerializedGraph& msg);
+bool serializeGraphDelta(
+  const fuse_core::Graph& graph,
+  flat::GraphDeltaEncoder& encoder,
+  fuse_msgs::msg::SerializedGraph& msg);
 
 /**
  * @brief Deserialize a graph
@@ -86,15 +111,61 @@ public:
    */
   fuse_core::Graph::UniquePtr deserialize(const fuse_msgs::msg::SerializedGraph& msg) const;
 
+  /**
+   * @brief Create the objects of a flat buffer that have no registered flat codec using pluginlib
+   */
+  flat::ObjectFactory flatObjectFactory() const;
+
 private:
-  pluginlib::ClassLoader<fuse_core::Variable> variable_loader_;      //!< Pluginlib class loader for Variable types
-  pluginlib::ClassLoader<fuse_core::Constraint> constraint_loader_;  //!< Pluginlib class loader for Constraint types
-  pluginlib::ClassLoader<fuse_core::Loss> loss_loader_;              //!< Pluginlib class loader for Loss types
+  // The flat format creates objects through pluginlib, which is not const. See graph_loader_ below.
+  mutable pluginlib::ClassLoader<fuse_core::Variable> variable_loader_;      //!< Pluginlib loader for Variable types
+  mutable pluginlib::ClassLoader<fuse_core::Constraint> constraint_loader_;  //!< Pluginlib loader for Constraint types
+  pluginlib::ClassLoader<fuse_core::Loss> loss_loader_;                      //!< Pluginlib class loader for Loss types
   // TODO(efernandez) Try to make pluginlib::ClassLoader<T>::createUnmanagedInstance() method const, so we can remove
   // the mutable modifier here and still have the deserialize methods const
   mutable pluginlib::ClassLoader<fuse_core::Graph> graph_loader_;    //!< Pluginlib class loader for Graph types
 };
 
+/**
+ * @brief Rebuild a graph from a stream of keyframe and delta messages written by serializeGraphDelta()
+ *
+ * A keyframe replaces the graph, and a delta is applied to it in place. A delta is only applied if it follows the
+ * last message applied. After a missed message the graph keeps its last consistent state, and deltas are ignored until
+ * the next keyframe. Complete graph messages written by serializeGraph(), in either format, are accepted as keyframes
+ * that no delta follows.
+ */
+class GraphReconstructor
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  GraphReconstructor();
+
+  /**
+   * @brief Apply a keyframe or delta message to the graph
+   *
+   * If an error occurs during deserialization an exception is thrown, and the graph is discarded until the next
+   * keyframe.
+   *
+   * @param[in] msg The SerializedGraph message to be applied
+   * @return True if the message was applied. False if it was a delta that does not follow the last message applied.
+   */
+  bool apply(const fuse_msgs::msg::SerializedGraph& msg);
+
+  /**
+   * @brief The reconstructed graph, or nullptr before the first keyframe
+   *
+   * The graph is modified in place by the next call to apply().
+   */
+  const fuse_core::Graph* graph() const { return graph_.get(); }
+
+private:
+  GraphDeserializer deserializer_;  //!< Loads the plugin libraries. It must outlive graph_, so it is declared first.
+  fuse_core::Graph::UniquePtr graph_;  //!< The reconstructed graph
+  uint64_t sequence_;  //!< The sequence number of the last message applied, or zero if no delta may follow it
+};
+
 }  // namespace fuse_core
 
 #endif  // FUSE_CORE_GRAPH_DESERIALIZER_H
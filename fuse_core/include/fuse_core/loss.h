@@ -41,7 +41,10 @@
 #include <boost/type_index/stl_type_index.hpp>
 #include <ceres/loss_function.h>
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 /**
@@ -164,6 +167,12 @@ namespace fuse_core
  * It is always better to remove outliers before they make it into the optimization problem, but no method is perfect.
  * Using robust loss functions can significantly improve the results and stability of the solution in the presence
  * of outlier measurements.
+ *
+ * Each Loss instance owns a single ceres::LossFunction, created on the first call to lossFunction() and shared by
+ * every constraint and optimization problem that references this Loss. The ceres::LossFunction is immutable; any
+ * change to the loss parameters (via a mutator or deserialization) discards it, and the next call to lossFunction()
+ * builds a new one. Derived classes implement createLossFunction() and call resetLossFunction() from every method
+ * that modifies the loss parameters.
  */
 class Loss
 {
@@ -171,17 +180,37 @@ public:
   FUSE_SMART_PTR_ALIASES_ONLY(Loss)
 
   static constexpr ceres::Ownership Ownership =
-      ceres::Ownership::TAKE_OWNERSHIP;  //!< The ownership of the ceres::LossFunction* returned by lossFunction()
+      ceres::Ownership::DO_NOT_TAKE_OWNERSHIP;  //!< The ownership of the pointer returned by lossFunction()
 
   /**
    * @brief Default constructor
    */
   Loss() = default;
 
+  /**
+   * @brief Copy constructor
+   *
+   * The cached ceres::LossFunction is not shared with the copy. The copy creates its own on first use.
+   */
+  Loss(const Loss& /* other */)
+  {
+  }
+
+  /**
+   * @brief Copy assignment operator
+   *
+   * The cached ceres::LossFunction of this instance is discarded, as the loss parameters are about to change.
+   */
+  Loss& operator=(const Loss& /* other */)
+  {
+    resetLossFunction();
+    return *this;
+  }
+
   /**
    * @brief Destructor
    */
-  virtual ~Loss() = default;
+  virtual ~Loss();
 
   /**
    * @brief Perform any required post-construction initialization, such as reading from the parameter server.
@@ -208,16 +237,65 @@ public:
   virtual void print(std::ostream& stream = std::cout) const = 0;
 
   /**
-   * @brief Return a raw pointer to a ceres::LossFunction that implements the loss function
+   * @brief Return a raw pointer to the ceres::LossFunction that implements the loss function
    *
-   * The Ceres interface requires a raw pointer. Ceres will take ownership of the pointer and promises to properly
-   * delete the loss function when it is done. Additionally, Fuse promises that the Loss object will outlive any
-   * generated loss functions (i.e. the Ceres objects will be destroyed before the Loss Function objects). This
-   * guarantee may allow optimizations for the creation of the loss function objects.
+   * The ceres::LossFunction is created by createLossFunction() on the first call and cached, so repeated calls
+   * return the same pointer. The pointer remains owned by this Loss; callers must not delete it, and any
+   * ceres::Problem it is added to must be configured with Loss::Ownership (i.e. ceres::DO_NOT_TAKE_OWNERSHIP). The
+   * Loss object must outlive any ceres::Problem that references the returned pointer, and the loss parameters must
+   * not be modified while the pointer is in use.
    *
-   * @return A base pointer to an instance of a derived ceres::LossFunction.
+   * This method is thread-safe.
+   *
+   * @return A base pointer to an instance of a derived ceres::LossFunction, owned by this Loss.
    */
-  virtual ceres::LossFunction* lossFunction() const = 0;
+  ceres::LossFunction* lossFunction() const
+  {
+    auto loss_function = loss_function_.load(std::memory_order_acquire);
+    if (!loss_function)
+    {
+      std::lock_guard<std::mutex> lock(loss_function_mutex_);
+      loss_function = loss_function_.load(std::memory_order_relaxed);
+      if (!loss_function)
+      {
+        loss_function = createLossFunction();
+        loss_function_.store(loss_function, std::memory_order_release);
+      }
+    }
+    return loss_function;
+  }
+
+  /**
+   * @brief Create a new ceres::LossFunction that implements the loss function with the current parameters
+   *
+   * Ownership of the returned pointer is passed to the caller. Most users should call lossFunction() instead, which
+   * returns the instance cached by this Loss. This is useful for composite losses that need to take ownership of
+   * the loss functions they wrap.
+   *
+   * @return A base pointer to a new instance of a derived ceres::LossFunction.
+   */
+  virtual ceres::LossFunction* createLossFunction() const = 0;
+
+  /**
+   * @brief Evaluate the loss function for an array of squared residual norms
+   *
+   * The results are the same as calling lossFunction()->Evaluate(squared_norms[i], rho) for every element, with
+   * rho[0], rho[1] and rho[2] written to rho[i], rho_derivative[i] and rho_second_derivative[i], respectively. This
+   * is what the default implementation does. Derived classes should override it with a loop over an inlined kernel,
+   * which avoids a virtual call per element and allows the compiler to vectorize the loop.
+   *
+   * @param[in]  squared_norms         The squared residual norms, s = r^2
+   * @param[in]  count                 The number of elements in every array
+   * @param[out] rho                   The loss values, rho(s)
+   * @param[out] rho_derivative        The first derivatives, rho'(s)
+   * @param[out] rho_second_derivative The second derivatives, rho''(s)
+   */
+  virtual void evaluate(
+    const double* squared_norms,
+    size_t count,
+    double* rho,
+    double* rho_derivative,
+    double* rho_second_derivative) const;
 
   /**
    * @brief Perform a deep copy of the Loss and return a unique pointer to the copy
@@ -279,7 +357,23 @@ public:
    */
   virtual void deserialize(fuse_core::TextInputArchive& /* archive */) = 0;
 
+protected:
+  /**
+   * @brief Discard the cached ceres::LossFunction
+   *
+   * Derived classes must call this from every method that modifies the loss parameters, so the next call to
+   * lossFunction() creates a ceres::LossFunction with the new parameters.
+   */
+  void resetLossFunction()
+  {
+    std::lock_guard<std::mutex> lock(loss_function_mutex_);
+    delete loss_function_.exchange(nullptr);
+  }
+
 private:
+  mutable std::atomic<ceres::LossFunction*> loss_function_{ nullptr };  //!< The cached ceres::LossFunction
+  mutable std::mutex loss_function_mutex_;  //!< Serializes the creation of the cached ceres::LossFunction
+
   // Allow Boost Serialization access to private methods
   friend class boost::serialization::access;
 
@@ -292,6 +386,10 @@ private:
   template<class Archive>
   void serialize(Archive& /* archive */, const unsigned int /* version */)
   {
+    if (Archive::is_loading::value)
+    {
+      resetLossFunction();
+    }
   }
 };
 
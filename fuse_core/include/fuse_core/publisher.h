@@ -34,11 +34,14 @@
 #ifndef FUSE_CORE_PUBLISHER_H
 #define FUSE_CORE_PUBLISHER_H
 
+#include <fuse_core/covariance_blocks.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/fuse_macros.h>
 #include <fuse_core/transaction.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 
 namespace fuse_core
@@ -102,6 +105,50 @@ public:
    */
   virtual void notify(Transaction::ConstSharedPtr transaction, Graph::ConstSharedPtr graph) = 0;
 
+  /**
+   * @brief Notify the publisher that an optimization cycle is complete, and provide the covariance blocks that were
+   * requested through Publisher::covarianceRequests().
+   *
+   * The optimizer computes the covariance requests of all publishers in a single batch, so publishers that requested
+   * covariance blocks should prefer them over calling Graph::getCovariance() themselves. The default implementation
+   * discards the covariance blocks and calls Publisher::notify(transaction, graph).
+   *
+   * @param[in] transaction       A Transaction object, describing the set of variables that have been added and/or
+   *                              removed
+   * @param[in] graph             A read-only pointer to the graph object, allowing queries to be performed whenever
+   *                              needed
+   * @param[in] covariance_blocks The covariance blocks computed from \p graph, or nullptr if none were computed
+   */
+  virtual void notify(
+    Transaction::ConstSharedPtr transaction,
+    Graph::ConstSharedPtr graph,
+    CovarianceBlocks::ConstSharedPtr /* covariance_blocks */)
+  {
+    notify(std::move(transaction), std::move(graph));
+  }
+
+  /**
+   * @brief Append the marginal covariance blocks this publisher needs from the optimized graph
+   *
+   * This method is called by the optimizer, in the optimizer's thread, after every optimization cycle and before
+   * notify() is called. The requests of all publishers are computed together and delivered through
+   * notify(transaction, graph, covariance_blocks). The default implementation does not request anything.
+   *
+   * The batch is computed before any publisher is notified, so every request adds to the publishing latency of all
+   * publishers and delays the next optimization cycle. Publishers should only request covariance blocks when
+   * configured to, e.g. with a shared_covariance parameter that defaults to false.
+   *
+   * @param[in]  transaction A Transaction object, describing the set of variables that have been added and/or removed
+   * @param[in]  graph       The optimized graph
+   * @param[out] requests    The container that collects the covariance requests
+   */
+  virtual void covarianceRequests(
+    const Transaction& /* transaction */,
+    const Graph& /* graph */,
+    std::vector<CovarianceBlocks::Request>& /* requests */)
+  {
+  }
+
   /**
    * @brief Function to be executed whenever the optimizer is ready to receive transactions
    *
@@ -48,11 +48,13 @@
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/split_free.hpp>
 #include <boost/uuid/uuid_serialize.hpp>
 #include <Eigen/Core>
 
 #include <boost/iostreams/categories.hpp>
 
+#include <chrono>
 #include <ios>
 #include <vector>
 
@@ -149,14 +151,35 @@ namespace serialization
 {
 
 /**
- * @brief Serialize a fuse_core::TimeStamp variable using Boost Serialization
+ * @brief Save a fuse_core::TimeStamp variable using Boost Serialization
  */
 template<class Archive>
-void serialize(Archive& archive, fuse_core::TimeStamp& stamp, const unsigned int /* version */)
+void save(Archive& archive, const fuse_core::TimeStamp& stamp, const unsigned int /* version */)
 {
   // XXX #warning "discarding clock source in serialisation"
   int64_t time_point = stamp.time_since_epoch().count();
-  archive & time_point;
+  archive << time_point;
+}
+
+/**
+ * @brief Load a fuse_core::TimeStamp variable using Boost Serialization
+ */
+template<class Archive>
+void load(Archive& archive, fuse_core::TimeStamp& stamp, const unsigned int /* version */)
+{
+  int64_t time_point;
+  archive >> time_point;
+  stamp = fuse_core::TimeStamp(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(
+    std::chrono::nanoseconds(time_point)));
+}
+
+/**
+ * @brief Serialize a fuse_core::TimeStamp variable using Boost Serialization
+ */
+template<class Archive>
+void serialize(Archive& archive, fuse_core::TimeStamp& stamp, const unsigned int version)
+{
+  boost::serialization::split_free(archive, stamp, version);
 }
 
 
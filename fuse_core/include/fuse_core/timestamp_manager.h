@@ -37,13 +37,15 @@
 #include <fuse_core/constraint.h>
 #include <fuse_core/fuse_macros.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
 #include <fuse_core/time.h>
 
 #include <boost/range/any_range.hpp>
 
 #include <functional>
-#include <map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 
@@ -168,6 +170,7 @@ public:
   void clear()
   {
     motion_model_history_.clear();
+    history_begin_ = 0;
   }
 
   /**
@@ -223,14 +226,57 @@ protected:
    * @brief The set of previously generated motion model segments, sorted by beginning time.
    *
    * The MotionModelHistory will always contain all represented timestamps; the very last entry will be the ending
-   * time of the previous MotionModelSegment, and the very last entry will be an empty MotionModelSegment.
+   * time of the previous MotionModelSegment, and the very last entry will be an empty MotionModelSegment that only
+   * holds that beginning time.
+   *
+   * The segments are stored in a flat vector and located with binary searches. Purged segments at the front are not
+   * erased immediately; they are skipped using \p history_begin_ and erased in batches, so purging is amortized
+   * constant time.
    */
-  using MotionModelHistory = std::map<TimeStamp, MotionModelSegment>;
+  using MotionModelHistory = std::vector<MotionModelSegment>;
 
   MotionModelFunction generator_;  //!< Users upplied function that generates motion model constraints
   Duration buffer_length_;  //!< The length of the motion model history. Segments older than \p buffer_length_
                                  //!< will be removed from the motion model history
   MotionModelHistory motion_model_history_;  //!< Container that stores all previously generated motion models
+  size_t history_begin_{ 0 };  //!< The index of the oldest segment that has not been purged
+  std::vector<TimeStamp> augmented_stamps_;  //!< Scratch space for query(), reused to avoid allocations
+  std::vector<std::pair<TimeStamp, TimeStamp>> stamp_pairs_;  //!< Scratch space for query()
+  std::unordered_set<UUID> transaction_variables_;  //!< Scratch space for query()
+
+  /**
+   * @brief An iterator to the oldest segment in the motion model history
+   */
+  MotionModelHistory::iterator historyBegin()
+  {
+    return motion_model_history_.begin() + history_begin_;
+  }
+
+  /**
+   * @brief An iterator to the oldest segment in the motion model history
+   */
+  MotionModelHistory::const_iterator historyBegin() const
+  {
+    return motion_model_history_.begin() + history_begin_;
+  }
+
+  /**
+   * @brief Returns true if the motion model history contains no segments
+   */
+  bool historyEmpty() const
+  {
+    return history_begin_ == motion_model_history_.size();
+  }
+
+  /**
+   * @brief Find the first segment with a beginning stamp not less than the provided stamp
+   */
+  MotionModelHistory::iterator historyLowerBound(const TimeStamp& stamp);
+
+  /**
+   * @brief Find the first segment with a beginning stamp greater than the provided stamp
+   */
+  MotionModelHistory::iterator historyUpperBound(const TimeStamp& stamp);
 
   /**
    * @brief Create a new MotionModelSegment, updating the provided transaction.
@@ -145,6 +145,23 @@ public:
    */
   const_constraint_range addedConstraints() const;
 
+  /**
+   * @brief Call the provided visitor for every added constraint
+   *
+   * This is a faster alternative to iterating over addedConstraints() for performance-critical consumers, as it
+   * avoids the indirect calls of the type-erased range. The transaction must not be modified from within the visitor.
+   *
+   * @param[in] visitor A callable object with the signature void(const Constraint&)
+   */
+  template <typename Visitor>
+  void forEachAddedConstraint(Visitor&& visitor) const
+  {
+    for (const auto& constraint : added_constraints_)
+    {
+      visitor(static_cast<const Constraint&>(*constraint));
+    }
+  }
+
   /**
    * @brief Read-only access to the removed constraints
    *
@@ -159,6 +176,22 @@ public:
    */
   const_variable_range addedVariables() const;
 
+  /**
+   * @brief Call the provided visitor for every added variable
+   *
+   * This is a faster alternative to iterating over addedVariables(). See forEachAddedConstraint().
+   *
+   * @param[in] visitor A callable object with the signature void(const Variable&)
+   */
+  template <typename Visitor>
+  void forEachAddedVariable(Visitor&& visitor) const
+  {
+    for (const auto& variable : added_variables_)
+    {
+      visitor(static_cast<const Variable&>(*variable));
+    }
+  }
+
   /**
    * @brief Read-only access to the removed variables
    *
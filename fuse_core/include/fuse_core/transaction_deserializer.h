@@ -36,18 +36,28 @@
 
 #include <fuse_msgs/msg/serialized_transaction.hpp>
 #include <fuse_core/constraint.h>
+#include <fuse_core/flat_serialization.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/variable.h>
 #include <pluginlib/class_loader.hpp>
 
+#include <vector>
+
 
 namespace fuse_core
 {
 
 /**
  * @brief Serialize a transaction into a message
+ *
+ * @param[in]  transaction The transaction to serialize
+ * @param[out] msg         The message to fill in
+ * @param[in]  format      The encoding of the msg.data field. The TransactionDeserializer detects either encoding.
  */
-void serializeTransaction(const fuse_core::Transaction& transaction, fuse_msgs::msg::SerializedTransaction& msg);
+void serializeTransaction(
+  const fuse_core::Transaction& transaction,
+  fuse_msgs::msg::SerializedTransaction& msg,
+  SerializationFormat format = SerializationFormat::BOOST_BINARY);
 
 /**
  * @brief Deserialize a Transaction
@@ -86,10 +96,26 @@ public:
    */
   fuse_core::Transaction deserialize(const fuse_msgs::msg::SerializedTransaction& msg) const;
 
+  /**
+   * @brief Deserialize a buffer written with either SerializationFormat into a fuse Transaction object.
+   *
+   * This is used to read the records of a transaction log, see fuse_core/transaction_log.h.
+   *
+   * @param[IN]  data The serialized transaction
+   * @return          A fuse Transaction object
+   */
+  fuse_core::Transaction deserialize(const std::vector<uint8_t>& data) const;
+
 private:
-  pluginlib::ClassLoader<fuse_core::Variable> variable_loader_;      //!< Pluginlib class loader for Variable types
-  pluginlib::ClassLoader<fuse_core::Constraint> constraint_loader_;  //!< Pluginlib class loader for Constraint types
-  pluginlib::ClassLoader<fuse_core::Loss> loss_loader_;              //!< Pluginlib class loader for Loss types
+  /**
+   * @brief Create the objects of a flat buffer that have no registered flat codec using pluginlib
+   */
+  flat::ObjectFactory flatObjectFactory() const;
+
+  // The flat format creates objects through pluginlib, which is not const. See GraphDeserializer::graph_loader_.
+  mutable pluginlib::ClassLoader<fuse_core::Variable> variable_loader_;      //!< Pluginlib loader for Variable types
+  mutable pluginlib::ClassLoader<fuse_core::Constraint> constraint_loader_;  //!< Pluginlib loader for Constraint types
+  pluginlib::ClassLoader<fuse_core::Loss> loss_loader_;                      //!< Pluginlib class loader for Loss types
 };
 
 }  // namespace fuse_core
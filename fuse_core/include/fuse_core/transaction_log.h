@@ -0,0 +1,148 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_CORE_TRANSACTION_LOG_H
+#define FUSE_CORE_TRANSACTION_LOG_H
+
+#include <fuse_core/time.h>
+#include <fuse_core/transaction.h>
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+/**
+ * @brief A single sensor transaction read back from a transaction log
+ */
+struct TransactionLogEntry
+{
+  std::string sensor_name;    //!< The name of the sensor that produced the transaction
+  TimeStamp arrival_time;     //!< The time the optimizer received the transaction
+  std::vector<uint8_t> data;  //!< The transaction, in the flat format of fuse_core/flat_serialization.h
+};
+
+/**
+ * @brief Appends sensor transactions to a transaction log file
+ *
+ * A transaction log is a file header followed by one record per transaction, in arrival order. Each record holds the
+ * sensor name, the arrival time and the transaction encoded in the flat format, so recording a transaction costs one
+ * flat serialization and one buffered write. Records are only ever appended, so a log that was cut short, for example
+ * because the process was killed, is still readable up to its last complete record. See TransactionLogReader.
+ *
+ * All methods may be called concurrently from several sensor threads.
+ */
+class TransactionLogWriter
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * The file is created if it does not exist. Otherwise, new records are appended to the existing log.
+   *
+   * @param[in] filename The transaction log file
+   * @throws std::runtime_error if the file cannot be opened, or exists but is not a transaction log
+   */
+  explicit TransactionLogWriter(const std::string& filename);
+
+  /**
+   * @brief Destructor. Flushes any buffered records.
+   */
+  ~TransactionLogWriter();
+
+  /**
+   * @brief Append a transaction to the log
+   *
+   * @param[in] sensor_name  The name of the sensor that produced the transaction
+   * @param[in] transaction  The transaction, as received from the sensor
+   * @param[in] arrival_time The time the optimizer received the transaction
+   * @throws std::runtime_error if the record cannot be written
+   */
+  void write(const std::string& sensor_name, const Transaction& transaction, const TimeStamp& arrival_time);
+
+  /**
+   * @brief Write any buffered records to the file
+   */
+  void flush();
+
+private:
+  std::mutex mutex_;  //!< Serializes writes from different threads
+  std::ofstream file_;  //!< The log file, opened for appending
+  std::vector<uint8_t> buffer_;  //!< The flat encoding of the transaction being written, kept to reuse its storage
+};
+
+/**
+ * @brief Reads the records of a transaction log written by a TransactionLogWriter, in order
+ */
+class TransactionLogReader
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] filename The transaction log file
+   * @throws std::runtime_error if the file cannot be opened or is not a transaction log of a supported version
+   */
+  explicit TransactionLogReader(const std::string& filename);
+
+  /**
+   * @brief Read the next record
+   *
+   * A record that was not completely written is treated as the end of the log, see truncated(). So is a record
+   * larger than the rest of the file, which is detected before any memory is allocated for it.
+   *
+   * @param[out] entry The record. Its storage is reused.
+   * @return False if there are no more complete records
+   * @throws std::runtime_error if a record is malformed
+   */
+  bool next(TransactionLogEntry& entry);
+
+  /**
+   * @brief True if the log ended with a partially written record
+   */
+  bool truncated() const { return truncated_; }
+
+private:
+  std::ifstream file_;  //!< The log file
+  std::streamoff file_size_;  //!< The size of the log file when it was opened
+  bool truncated_;  //!< The last record read was incomplete
+};
+
+}  // namespace fuse_core
+
+#endif  // FUSE_CORE_TRANSACTION_LOG_H
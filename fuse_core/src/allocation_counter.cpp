@@ -0,0 +1,175 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/allocation_counter.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+#if defined(__GLIBC__)
+// The glibc allocator entry points, used by the interposed malloc family to reach the real allocator
+extern "C"
+{
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* pointer);
+}
+#endif
+
+namespace fuse_core
+{
+
+namespace
+{
+
+std::atomic<AllocationCounting> counting{ AllocationCounting::DISABLED };  //!< The installed counting hooks
+
+// Constant-initialized, so it is safe to use from inside the allocator, even while a thread is starting. The
+// initial-exec model keeps the TLS access itself from calling malloc.
+#if defined(__GNUC__)
+__attribute__((tls_model("initial-exec")))
+#endif
+thread_local AllocationCount thread_count;
+
+void record(const std::size_t bytes) noexcept
+{
+  ++thread_count.allocations;
+  thread_count.bytes += bytes;
+}
+
+}  // namespace
+
+AllocationCounting allocationCounting()
+{
+  return counting.load(std::memory_order_relaxed);
+}
+
+AllocationCount threadAllocationCount()
+{
+  return thread_count;
+}
+
+namespace detail
+{
+
+bool enableAllocationCounting(const AllocationCounting hooks) noexcept
+{
+  counting.store(hooks, std::memory_order_relaxed);
+  return true;
+}
+
+void* countedAllocation(std::size_t size)
+{
+  record(size);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size))
+  {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void* countedAlignedAllocation(std::size_t size, std::size_t alignment)
+{
+  record(size);
+  void* pointer = nullptr;
+  if (alignment < sizeof(void*))
+  {
+    alignment = sizeof(void*);
+  }
+  if (posix_memalign(&pointer, alignment, size == 0 ? 1 : size) == 0)
+  {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+#if defined(__GLIBC__)
+void* countedMalloc(std::size_t size) noexcept
+{
+  record(size);
+  return __libc_malloc(size);
+}
+
+void* countedCalloc(std::size_t count, std::size_t size) noexcept
+{
+  record(count * size);
+  return __libc_calloc(count, size);
+}
+
+void* countedRealloc(void* pointer, std::size_t size) noexcept
+{
+  // realloc(pointer, 0) only frees the memory
+  if (size != 0)
+  {
+    record(size);
+  }
+  return __libc_realloc(pointer, size);
+}
+
+void* countedMemalign(std::size_t alignment, std::size_t size) noexcept
+{
+  record(size);
+  return __libc_memalign(alignment, size);
+}
+
+int countedPosixMemalign(void** pointer, std::size_t alignment, std::size_t size) noexcept
+{
+  // The alignment must be a power of two multiple of sizeof(void*)
+  if ((alignment % sizeof(void*) != 0) || ((alignment & (alignment - 1)) != 0) || (alignment == 0))
+  {
+    return EINVAL;
+  }
+  void* result = countedMemalign(alignment, size);
+  if (!result)
+  {
+    return ENOMEM;
+  }
+  *pointer = result;
+  return 0;
+}
+
+void uncountedFree(void* pointer) noexcept
+{
+  __libc_free(pointer);
+}
+#endif
+
+}  // namespace detail
+
+}  // namespace fuse_core
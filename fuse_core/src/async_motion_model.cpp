@@ -60,14 +60,8 @@ bool AsyncMotionModel::apply(Transaction& transaction)
   // MotionModel objects, as the queryCallback will run within the same callback queue as subscriptions, timers, etc.
   // Thus, it is functionally similar to a service callback, and should be a familiar pattern for ROS developers.
   // This function blocks until the queryCallback() call completes, thus enforcing that motion models are generated
-  // in order.
-  auto callback = std::make_shared<CallbackWrapper<bool>>(
-    std::bind(&AsyncMotionModel::applyCallback, this, std::ref(transaction)));
-  auto result = callback->getFuture();
-  callback_queue_->addCallback(callback);
-  result.wait();
-
-  return result.get();
+  // in order. The call is queued without allocating, as this runs for every transaction.
+  return callback_queue_->invokeCallback([this, &transaction]() { return applyCallback(transaction); });
 }
 
 void AsyncMotionModel::initialize(const std::string& name)
@@ -100,12 +94,7 @@ void AsyncMotionModel::initialize(const std::string& name)
 
 void AsyncMotionModel::graphCallback(Graph::ConstSharedPtr graph)
 {
-  auto callback = std::make_shared<CallbackWrapper<void>>(
-    std::bind(&AsyncMotionModel::onGraphUpdate, this, std::move(graph))
-  );
-  auto result = callback->getFuture();
-  callback_queue_->addCallback(callback);
-  result.wait();
+  callback_queue_->invokeCallback([this, &graph]() { onGraphUpdate(std::move(graph)); });
 }
 
 void AsyncMotionModel::start()
@@ -33,6 +33,9 @@
  */
 #include <fuse_core/async_publisher.h>
 
+#include <utility>
+#include <vector>
+
 
 namespace fuse_core
 {
@@ -73,12 +76,39 @@ void AsyncPublisher::initialize(const std::string& name)
 }
 
 void AsyncPublisher::notify(Transaction::ConstSharedPtr transaction, Graph::ConstSharedPtr graph)
+{
+  notify(std::move(transaction), std::move(graph), nullptr);
+}
+
+void AsyncPublisher::notify(
+  Transaction::ConstSharedPtr transaction,
+  Graph::ConstSharedPtr graph,
+  CovarianceBlocks::ConstSharedPtr covariance_blocks)
 {
   // Insert a call to the `notifyCallback` method into the internal callback queue.
   // This minimizes the time spent by the optimizer's thread calling this function.
-  auto callback = std::make_shared<CallbackWrapper<void>>(
-    std::bind(&AsyncPublisher::notifyCallback, this, std::move(transaction), std::move(graph)));
-  callback_queue_->addCallback(callback);
+  callback_queue_->postCallback(
+    [this, transaction = std::move(transaction), graph = std::move(graph),
+     covariance_blocks = std::move(covariance_blocks)]()
+    {
+      notifyCallback(transaction, graph, covariance_blocks);
+    });  // NOLINT(whitespace/braces)
+}
+
+void AsyncPublisher::covarianceRequests(
+  const Transaction& transaction,
+  const Graph& graph,
+  std::vector<CovarianceBlocks::Request>& requests)
+{
+  for (const auto& callback : covariance_request_callbacks_)
+  {
+    callback(transaction, graph, requests);
+  }
+}
+
+void AsyncPublisher::registerCovarianceRequest(CovarianceBlocks::RequestCallback callback)
+{
+  covariance_request_callbacks_.push_back(std::move(callback));
 }
 
 void AsyncPublisher::start()
@@ -35,9 +35,13 @@
 
 #include <fuse_core/callback_wrapper.h>
 #include <fuse_core/graph.h>
+#include <fuse_core/parameter.h>
 #include <fuse_core/transaction.h>
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <mutex>
 #include <utility>
 #include <string>
 
@@ -47,7 +51,9 @@ namespace fuse_core
 
 AsyncSensorModel::AsyncSensorModel(size_t thread_count) :
   name_("uninitialized"),
-  executor_thread_count_(thread_count)
+  executor_thread_count_(thread_count),
+  transaction_batch_size_(1),
+  transaction_batch_count_(0)
 {
 }
 
@@ -78,6 +84,13 @@ void AsyncSensorModel::initialize(
 
   transaction_callback_ = transaction_callback;
 
+  // Transaction batching is disabled unless requested. Derived classes may override this in onInit().
+  const int batch_size = fuse_core::getParam(node_, "transaction_batch_size", 1);
+  const double batch_window = fuse_core::getParam(node_, "transaction_batch_window", 0.0);
+  batchTransactions(
+    static_cast<size_t>(std::max(batch_size, 1)),
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(std::max(batch_window, 0.0))));
+
   // Call the derived onInit() function to perform implementation-specific initialization
   onInit();
 
@@ -87,19 +100,83 @@ void AsyncSensorModel::initialize(
 
 void AsyncSensorModel::graphCallback(Graph::ConstSharedPtr graph)
 {
-  auto callback = std::make_shared<CallbackWrapper<void>>(
-    std::bind(&AsyncSensorModel::onGraphUpdate, this, std::move(graph))
-  );
-  callback_queue_->addCallback(callback);
+  callback_queue_->postCallback([this, graph = std::move(graph)]() { onGraphUpdate(graph); });
 }
 
 void AsyncSensorModel::sendTransaction(Transaction::SharedPtr transaction)
 {
-  transaction_callback_(std::move(transaction));
+  if (transaction_batch_size_ <= 1)
+  {
+    transaction_callback_(std::move(transaction));
+    return;
+  }
+
+  Transaction::SharedPtr batch;
+  {
+    std::lock_guard<std::mutex> lock(transaction_batch_mutex_);
+    if (transaction_batch_)
+    {
+      transaction_batch_->merge(*transaction);
+    }
+    else
+    {
+      // Copy the first transaction rather than merging into it, as the caller may still hold a reference
+      transaction_batch_ = std::make_shared<Transaction>(*transaction);
+    }
+    ++transaction_batch_count_;
+    if (transaction_batch_count_ < transaction_batch_size_)
+    {
+      return;
+    }
+    batch = std::move(transaction_batch_);
+    transaction_batch_.reset();
+    transaction_batch_count_ = 0;
+  }
+  // Send outside the lock, so the optimizer is entered once per batch and never while holding transaction_batch_mutex_
+  transaction_callback_(std::move(batch));
+}
+
+void AsyncSensorModel::flushTransactions()
+{
+  Transaction::SharedPtr batch;
+  {
+    std::lock_guard<std::mutex> lock(transaction_batch_mutex_);
+    batch = std::move(transaction_batch_);
+    transaction_batch_.reset();
+    transaction_batch_count_ = 0;
+  }
+  if (batch)
+  {
+    transaction_callback_(std::move(batch));
+  }
+}
+
+void AsyncSensorModel::batchTransactions(size_t max_count, std::chrono::nanoseconds window)
+{
+  flushTransactions();
+
+  transaction_batch_size_ = std::max<size_t>(max_count, 1);
+  if (transaction_batch_timer_)
+  {
+    transaction_batch_timer_->cancel();
+    transaction_batch_timer_.reset();
+  }
+  if (transaction_batch_size_ > 1 && window.count() > 0)
+  {
+    // The timer sends whatever has accumulated, so no transaction is held for longer than one window
+    transaction_batch_timer_ = node_->create_wall_timer(window, [this]() { flushTransactions(); });
+  }
 }
 
 void AsyncSensorModel::start()
 {
+  // Anything still pending was generated before the optimizer was reset, so it must not reach the new session
+  {
+    std::lock_guard<std::mutex> lock(transaction_batch_mutex_);
+    transaction_batch_.reset();
+    transaction_batch_count_ = 0;
+  }
+
   auto callback = std::make_shared<CallbackWrapper<void>>(
     std::bind(&AsyncSensorModel::onStart, this)
   );
@@ -110,6 +187,9 @@ void AsyncSensorModel::start()
 
 void AsyncSensorModel::stop()
 {
+  // Deliver anything generated before the stop request
+  flushTransactions();
+
   if (rclcpp::ok())
   {
     auto callback = std::make_shared<CallbackWrapper<void>>(
@@ -126,6 +206,9 @@ void AsyncSensorModel::stop()
 
     onStop();
   }
+
+  // onStop() may still send transactions, so deliver those too
+  flushTransactions();
 }
 
 }  // namespace fuse_core
@@ -51,6 +51,11 @@ namespace fuse_core
 
   }
 
+  CallbackAdapter::~CallbackAdapter(){
+    discard(batch_.exchange(nullptr, std::memory_order_relaxed));
+    discard(pending_.exchange(nullptr, std::memory_order_acquire));
+  }
+
   /**
    * @brief tell the CallbackGroup how many guard conditions are ready in this waitable
    */
@@ -62,9 +67,8 @@ namespace fuse_core
    */
   bool CallbackAdapter::is_ready(rcl_wait_set_t * wait_set) {
     (void) wait_set;
-    // std::lock_guard<std::recursive_mutex> lock(queue_mutex_);
-    // a thread glitch isn't a disaster here and a mutex wouldn't stop it anyway
-    return !callback_queue_.empty();
+    // a thread glitch isn't a disaster here; a callback added after this check triggers the guard condition again
+    return (pending_.load(std::memory_order_relaxed) != nullptr) || (batch_.load(std::memory_order_relaxed) != nullptr);
   }
 
 
@@ -89,46 +93,118 @@ namespace fuse_core
   }
 
   /**
-   * @brief hook that allows the rclcpp::waitables interface to run the next callback
+   * @brief hook that allows the rclcpp::waitables interface to run the pending callbacks
    *
    */
   void CallbackAdapter::execute(std::shared_ptr<void> & /*data*/){
-    std::shared_ptr<CallbackWrapperBase> cb_wrapper = nullptr;
-    // fetch the callback ptr and release the lock without spending time in the callback
-    {
-      std::lock_guard<std::recursive_mutex> lock(queue_mutex_);
-      if(!callback_queue_.empty()){
-        cb_wrapper = callback_queue_.front();
-        callback_queue_.pop();
+    // Only one thread drains the list at a time, so the callbacks run in order. Another thread may have been woken
+    // for callbacks the draining thread took the list before. Hand them over to the draining thread, which wakes the
+    // executor again once it is done, unless it finished in the meantime.
+    std::unique_lock<std::mutex> lock(execute_mutex_, std::try_to_lock);
+    if(!lock.owns_lock()) {
+      if(pending_.load(std::memory_order_seq_cst) == nullptr || !lock.try_lock()) {
+        return;
+      }
+    }
+    // finish any batch interrupted by an exception before taking new callbacks, to preserve the order
+    if(!batch_.load(std::memory_order_relaxed)) {
+      // take every pending callback at once, leaving the list empty for the producers
+      CallbackWrapperBase* newest = pending_.exchange(nullptr, std::memory_order_acquire);
+      // the list is newest first; reverse it so the callbacks run in the order they were added
+      CallbackWrapperBase* oldest = nullptr;
+      while(newest) {
+        CallbackWrapperBase* next = newest->next_;
+        newest->next_ = oldest;
+        oldest = newest;
+        newest = next;
       }
+      batch_.store(oldest, std::memory_order_relaxed);
     }
-    //the lock is released and the callback is no longer associated with the queue, run it.
-    if(cb_wrapper) {
-      cb_wrapper->call();
+    // the callbacks are no longer associated with the queue, run them.
+    while(CallbackWrapperBase* callback = batch_.load(std::memory_order_relaxed)) {
+      batch_.store(callback->next_, std::memory_order_relaxed);
+      try {
+        callback->call();
+      } catch(...) {
+        callback->release(false);
+        // make sure the executor comes back for the rest of the batch, and for anything added meanwhile
+        if(batch_.load(std::memory_order_relaxed) || pending_.load(std::memory_order_seq_cst)) {
+          rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+          (void) ret;
+        }
+        throw;
+      }
+      // the callback may be destroyed or reused by another thread after this
+      callback->release(false);
+    }
+    // A callback added while the list was being drained triggered the guard condition, but the thread it woke may
+    // have given up while this one held the lock. Wake the executor again so it is not left pending.
+    lock.unlock();
+    if(pending_.load(std::memory_order_seq_cst)) {
+      rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+      (void) ret;
     }
   }
 
   void CallbackAdapter::addCallback(const std::shared_ptr<CallbackWrapperBase> &callback){
-    std::lock_guard<std::recursive_mutex> lock(queue_mutex_);
-    callback_queue_.push(callback);
-    rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
-    // XXX ret needs to be used to silence a warning, pull the callback off the queue on failure
-  } 
+    callback->self_ = callback;
+    push(callback.get());
+  }
 
   void CallbackAdapter::addCallback(std::shared_ptr<CallbackWrapperBase> && callback){
-    std::lock_guard<std::recursive_mutex> lock(queue_mutex_);
-    callback_queue_.push(std::move(callback));
-    rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
-    // XXX ret needs to be used to silence a warning, pull the callback off the queue on failure
+    auto raw_callback = callback.get();
+    raw_callback->self_ = std::move(callback);
+    push(raw_callback);
   }
 
   void CallbackAdapter::removeAllCallbacks(){
-    std::lock_guard<std::recursive_mutex> lock(queue_mutex_);
-    while(!callback_queue_.empty()){
-      callback_queue_.pop();
+    discard(pending_.exchange(nullptr, std::memory_order_acquire));
+  }
+
+  void CallbackAdapter::push(CallbackWrapperBase* callback){
+    CallbackWrapperBase* next = pending_.load(std::memory_order_relaxed);
+    do {
+      callback->next_ = next;
+    } while(!pending_.compare_exchange_weak(next, callback, std::memory_order_release, std::memory_order_relaxed));
+    // Only the callback that makes the list non-empty needs to wake the executor. Any later callback is taken by the
+    // same execute() call. The callback may already be consumed, so it must not be touched here.
+    if(next == nullptr) {
+      rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+      (void) ret;
     }
   }
 
+  void CallbackAdapter::discard(CallbackWrapperBase* callback){
+    while(callback) {
+      CallbackWrapperBase* next = callback->next_;
+      callback->release(true);
+      callback = next;
+    }
+  }
+
+  CallbackAdapter::PooledCallback* CallbackAdapter::acquirePooled(){
+    {
+      std::lock_guard<std::mutex> lock(pool_mutex_);
+      if(pool_free_) {
+        auto callback = static_cast<PooledCallback*>(pool_free_);
+        pool_free_ = callback->next_;
+        return callback;
+      }
+    }
+    // the pool only grows when more callbacks are pending at once than ever before
+    auto callback = std::make_unique<PooledCallback>(*this);
+    auto raw_callback = callback.get();
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    pool_.push_back(std::move(callback));
+    return raw_callback;
+  }
+
+  void CallbackAdapter::recycle(PooledCallback* callback){
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    callback->next_ = pool_free_;
+    pool_free_ = callback;
+  }
+
 
 
 
@@ -0,0 +1,118 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/covariance_blocks.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+CovarianceBlocks::SharedPtr CovarianceBlocks::compute(
+  const std::vector<Request>& requests,
+  const Graph& graph,
+  const ceres::Covariance::Options& options)
+{
+  // Remove duplicate and invalid requests. The request order is retained so the results are deterministic.
+  std::vector<Request> unique_requests;
+  unique_requests.reserve(requests.size());
+  std::unordered_set<Request, RequestHash> known_requests;
+  for (const auto& request : requests)
+  {
+    if (graph.variableExists(request.first) &&
+        graph.variableExists(request.second) &&
+        known_requests.insert(request).second)
+    {
+      unique_requests.push_back(request);
+    }
+  }
+  // Compute all of the blocks at once
+  auto covariance_blocks = CovarianceBlocks::make_shared();
+  if (unique_requests.empty())
+  {
+    return covariance_blocks;
+  }
+  std::vector<std::vector<double>> covariance_matrices;
+  graph.getCovariance(unique_requests, covariance_matrices, options);
+  for (size_t i = 0; i < unique_requests.size(); ++i)
+  {
+    covariance_blocks->insert(unique_requests[i].first, unique_requests[i].second,
+                              std::move(covariance_matrices[i]));
+  }
+  return covariance_blocks;
+}
+
+bool CovarianceBlocks::contains(const UUID& first, const UUID& second) const
+{
+  return blocks_.find(Request(first, second)) != blocks_.end();
+}
+
+void CovarianceBlocks::insert(const UUID& first, const UUID& second, std::vector<double> block)
+{
+  blocks_[Request(first, second)] = std::move(block);
+}
+
+const std::vector<double>& CovarianceBlocks::at(const UUID& first, const UUID& second) const
+{
+  auto blocks_iter = blocks_.find(Request(first, second));
+  if (blocks_iter == blocks_.end())
+  {
+    throw std::out_of_range("The covariance block for variable UUIDs " + uuid::to_string(first) + " and " +
+                            uuid::to_string(second) + " was not computed.");
+  }
+  return blocks_iter->second;
+}
+
+bool CovarianceBlocks::get(
+  const std::vector<Request>& requests,
+  std::vector<std::vector<double>>& covariance_matrices) const
+{
+  if (!std::all_of(requests.begin(), requests.end(),
+                   [this](const Request& request) { return contains(request.first, request.second); }))  // NOLINT
+  {
+    return false;
+  }
+  covariance_matrices.resize(requests.size());
+  for (size_t i = 0; i < requests.size(); ++i)
+  {
+    covariance_matrices[i] = at(requests[i].first, requests[i].second);
+  }
+  return true;
+}
+
+}  // namespace fuse_core
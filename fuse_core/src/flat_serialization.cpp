@@ -0,0 +1,1024 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/flat_serialization.h>
+
+#include <fuse_core/constraint.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/serialization.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+namespace flat
+{
+
+namespace
+{
+
+constexpr char MAGIC[8] = { 'F', 'U', 'S', 'E', 'F', 'L', 'A', 'T' };
+constexpr size_t UUID_BYTES = 16;
+constexpr int64_t INVALID_STAMP = std::numeric_limits<int64_t>::min();
+
+static_assert(sizeof(UUID) == UUID_BYTES, "The flat format stores UUIDs as 16 raw bytes");
+
+/**
+ * @brief Round a byte count up to the next multiple of 8
+ */
+size_t padded(size_t bytes)
+{
+  return (bytes + 7u) & ~static_cast<size_t>(7u);
+}
+
+/**
+ * @brief Append zeros until the buffer size is a multiple of 8
+ */
+void pad(std::vector<uint8_t>& data)
+{
+  data.resize(padded(data.size()), 0u);
+}
+
+void appendUuid(std::vector<uint8_t>& data, const UUID& uuid)
+{
+  data.insert(data.end(), uuid.begin(), uuid.end());
+}
+
+UUID readUuid(const uint8_t* bytes)
+{
+  UUID uuid;
+  std::copy(bytes, bytes + UUID_BYTES, uuid.begin());
+  return uuid;
+}
+
+/**
+ * @brief An unbuffered stream buffer that appends to a byte vector
+ *
+ * Boost payloads are written with one small archive per object, so this avoids the buffer allocation and copy of a
+ * boost::iostreams::stream for each one.
+ */
+class AppendStreamBuffer : public std::streambuf
+{
+public:
+  explicit AppendStreamBuffer(std::vector<uint8_t>& data) :
+    data_(data)
+  {
+  }
+
+protected:
+  int_type overflow(int_type character) override
+  {
+    if (!traits_type::eq_int_type(character, traits_type::eof()))
+    {
+      data_.push_back(static_cast<uint8_t>(character));
+    }
+    return traits_type::not_eof(character);
+  }
+
+  std::streamsize xsputn(const char_type* characters, std::streamsize count) override
+  {
+    data_.insert(data_.end(), characters, characters + count);
+    return count;
+  }
+
+private:
+  std::vector<uint8_t>& data_;  //!< The buffer being written
+};
+
+/**
+ * @brief A stream buffer that reads a payload in place
+ */
+class PayloadStreamBuffer : public std::streambuf
+{
+public:
+  explicit PayloadStreamBuffer(const PayloadReader& payload)
+  {
+    // std::streambuf only reads through the get area, so the const_cast does not allow the payload to be modified
+    char_type* begin = const_cast<char_type*>(reinterpret_cast<const char_type*>(payload.data()));
+    setg(begin, begin, begin + payload.remaining());
+  }
+};
+
+/**
+ * @brief The single Boost archive holding every object of a buffer that has no codec
+ */
+class BoostSectionWriter
+{
+public:
+  explicit BoostSectionWriter(std::streambuf& buffer) :
+    archive_(buffer, boost::archive::no_header | boost::archive::no_codecvt)
+  {
+  }
+
+  template <typename Object>
+  BoostSectionWriter& operator<<(const Object& object)
+  {
+    object.serialize(archive_);
+    return *this;
+  }
+
+private:
+  BinaryOutputArchive archive_;  //!< The archive
+};
+
+/**
+ * @brief Writes the sections of a flat buffer in order, then the Boost section, string table and header
+ */
+class Writer
+{
+public:
+  Writer(std::vector<uint8_t>& data, Content content) :
+    data_(data),
+    payload_(data)
+  {
+    std::memset(&header_, 0, sizeof(header_));
+    std::copy(std::begin(MAGIC), std::end(MAGIC), header_.magic);
+    header_.version = VERSION;
+    header_.content = content;
+    header_.stamp = INVALID_STAMP;
+    data_.clear();
+    data_.resize(sizeof(BufferHeader), 0u);
+  }
+
+  void writeStamp(const TimeStamp& stamp)
+  {
+    header_.stamp = encodeStamp(stamp);
+  }
+
+  void writeSequence(uint64_t sequence, uint64_t base_sequence)
+  {
+    header_.sequence = sequence;
+    header_.base_sequence = base_sequence;
+  }
+
+  template <typename StampRange>
+  void writeInvolvedStamps(const StampRange& stamps)
+  {
+    for (const auto& stamp : stamps)
+    {
+      const int64_t encoded = encodeStamp(stamp);
+      const auto bytes = reinterpret_cast<const uint8_t*>(&encoded);
+      data_.insert(data_.end(), bytes, bytes + sizeof(encoded));
+      ++header_.involved_stamp_count;
+    }
+  }
+
+  template <typename UuidRange>
+  void writeRemovedVariables(const UuidRange& uuids)
+  {
+    header_.removed_variable_count = writeUuids(uuids);
+  }
+
+  template <typename UuidRange>
+  void writeRemovedConstraints(const UuidRange& uuids)
+  {
+    header_.removed_constraint_count = writeUuids(uuids);
+    pad(data_);
+  }
+
+  void writeVariable(const Variable& variable, bool on_hold)
+  {
+    const TypeEntry& entry = typeEntry(variable);
+    const size_t record_offset = data_.size();
+    data_.resize(record_offset + sizeof(VariableRecord));
+    payload_.write(variable.data(), variable.size());
+
+    VariableRecord record;
+    std::copy(variable.uuid().begin(), variable.uuid().end(), record.uuid);
+    record.type_index = entry.index;
+    record.size = static_cast<uint32_t>(variable.size());
+    record.flags = on_hold ? VariableRecord::HOLD : 0u;
+
+    const size_t payload_offset = data_.size();
+    if (entry.variable_codec)
+    {
+      record.payload_encoding = PayloadEncoding::CODEC;
+      entry.variable_codec->write(variable, payload_);
+    }
+    else
+    {
+      record.payload_encoding = PayloadEncoding::BOOST_BINARY;
+      boostArchive() << variable;
+    }
+    finishRecord(record, record_offset, payload_offset);
+    ++header_.variable_count;
+  }
+
+  /**
+   * @brief Write a record holding only the values and hold state of a variable, for graph deltas
+   */
+  void writeVariableValues(const Variable& variable, bool on_hold)
+  {
+    const TypeEntry& entry = typeEntry(variable);
+    const size_t record_offset = data_.size();
+    data_.resize(record_offset + sizeof(VariableRecord));
+    payload_.write(variable.data(), variable.size());
+
+    VariableRecord record;
+    std::copy(variable.uuid().begin(), variable.uuid().end(), record.uuid);
+    record.type_index = entry.index;
+    record.size = static_cast<uint32_t>(variable.size());
+    record.flags = on_hold ? VariableRecord::HOLD : 0u;
+    record.payload_encoding = PayloadEncoding::NONE;
+    finishRecord(record, record_offset, data_.size());
+    ++header_.variable_count;
+  }
+
+  void writeConstraint(const Constraint& constraint)
+  {
+    const TypeEntry& entry = typeEntry(constraint);
+    const size_t record_offset = data_.size();
+    data_.resize(record_offset + sizeof(ConstraintRecord));
+    for (const auto& variable_uuid : constraint.variables())
+    {
+      appendUuid(data_, variable_uuid);
+    }
+
+    ConstraintRecord record;
+    std::copy(constraint.uuid().begin(), constraint.uuid().end(), record.uuid);
+    record.type_index = entry.index;
+    record.source_index = stringIndex(constraint.source());
+    record.variable_count = static_cast<uint32_t>(constraint.variables().size());
+
+    const size_t payload_offset = data_.size();
+    if (entry.constraint_codec)
+    {
+      record.payload_encoding = PayloadEncoding::CODEC;
+      entry.constraint_codec->write(constraint, payload_);
+    }
+    else
+    {
+      record.payload_encoding = PayloadEncoding::BOOST_BINARY;
+      boostArchive() << constraint;
+    }
+    finishRecord(record, record_offset, payload_offset);
+    ++header_.constraint_count;
+  }
+
+  /**
+   * @brief Append the Boost section and string table, and fill in the header
+   */
+  void finish()
+  {
+    // Destroy the archive before copying its output, as it is not guaranteed to write everything until then
+    boost_archive_.reset();
+    boost_buffer_.reset();
+    header_.boost_section_offset = data_.size();
+    header_.boost_section_bytes = boost_data_.size();
+    data_.insert(data_.end(), boost_data_.begin(), boost_data_.end());
+    pad(data_);
+
+    header_.string_table_offset = data_.size();
+    header_.string_count = static_cast<uint32_t>(strings_.size());
+    for (const auto& string : strings_)
+    {
+      const uint32_t length = static_cast<uint32_t>(string->size());
+      payload_.write(length);
+      data_.insert(data_.end(), string->begin(), string->end());
+    }
+    pad(data_);
+    std::memcpy(data_.data(), &header_, sizeof(header_));
+  }
+
+private:
+  /**
+   * @brief The string table index and codec of an object type, looked up once per type
+   */
+  struct TypeEntry
+  {
+    uint32_t index;
+    const VariableCodec* variable_codec;
+    const ConstraintCodec* constraint_codec;
+  };
+
+  template <typename UuidRange>
+  uint32_t writeUuids(const UuidRange& uuids)
+  {
+    uint32_t count = 0;
+    for (const auto& uuid : uuids)
+    {
+      appendUuid(data_, uuid);
+      ++count;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Look up the type of a variable or constraint by its dynamic type, so type() is only called once per type
+   */
+  template <typename Object>
+  const TypeEntry& typeEntry(const Object& object)
+  {
+    auto result = types_.emplace(std::type_index(typeid(object)), TypeEntry());
+    if (result.second)
+    {
+      const std::string type = object.type();
+      TypeEntry& entry = result.first->second;
+      entry.index = stringIndex(type);
+      entry.variable_codec = CodecRegistry::instance().variableCodec(type);
+      entry.constraint_codec = CodecRegistry::instance().constraintCodec(type);
+    }
+    return result.first->second;
+  }
+
+  uint32_t stringIndex(const std::string& string)
+  {
+    auto result = string_indices_.emplace(string, static_cast<uint32_t>(strings_.size()));
+    if (result.second)
+    {
+      strings_.push_back(&result.first->first);
+    }
+    return result.first->second;
+  }
+
+  /**
+   * @brief The archive holding the objects without a codec, created when the first one is written
+   */
+  BoostSectionWriter& boostArchive()
+  {
+    if (!boost_archive_)
+    {
+      boost_buffer_.reset(new AppendStreamBuffer(boost_data_));
+      boost_archive_.reset(new BoostSectionWriter(*boost_buffer_));
+    }
+    return *boost_archive_;
+  }
+
+  template <typename Record>
+  void finishRecord(Record& record, size_t record_offset, size_t payload_offset)
+  {
+    record.payload_bytes = static_cast<uint32_t>(data_.size() - payload_offset);
+    pad(data_);
+    record.record_bytes = static_cast<uint32_t>(data_.size() - record_offset);
+    std::memcpy(data_.data() + record_offset, &record, sizeof(record));
+  }
+
+  std::vector<uint8_t>& data_;  //!< The buffer being written
+  PayloadWriter payload_;  //!< Appends to data_
+  BufferHeader header_;  //!< The header, written last
+  std::unordered_map<std::type_index, TypeEntry> types_;  //!< The string index and codec of each object type
+  std::unordered_map<std::string, uint32_t> string_indices_;  //!< The string table index of each string
+  std::vector<const std::string*> strings_;  //!< The string table, pointing into string_indices_
+  std::vector<uint8_t> boost_data_;  //!< The Boost section, copied into data_ by finish()
+  std::unique_ptr<AppendStreamBuffer> boost_buffer_;  //!< Appends to boost_data_
+  std::unique_ptr<BoostSectionWriter> boost_archive_;  //!< Writes the objects without a codec
+};
+
+/**
+ * @brief Check that a section of \p bytes starting at \p offset lies inside a buffer of \p size bytes
+ */
+void checkBounds(size_t offset, size_t bytes, size_t size, const char* what)
+{
+  if (offset > size || bytes > size - offset)
+  {
+    throw std::runtime_error(std::string("Flat buffer is truncated: the ") + what + " extends past the end.");
+  }
+}
+
+/**
+ * @brief Write every variable and constraint of a graph
+ */
+void writeGraph(const Graph& graph, Writer& writer)
+{
+  for (const auto& variable : graph.getVariables())
+  {
+    writer.writeVariable(variable, graph.isVariableOnHold(variable.uuid()));
+  }
+  for (const auto& constraint : graph.getConstraints())
+  {
+    writer.writeConstraint(constraint);
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief The single Boost archive holding every object of a buffer that has no codec
+ */
+class ObjectReader::BoostSection
+{
+public:
+  explicit BoostSection(const PayloadReader& section) :
+    buffer_(section),
+    archive_(buffer_, boost::archive::no_header | boost::archive::no_codecvt)
+  {
+  }
+
+  template <typename Object>
+  void read(Object& object)
+  {
+    object.deserialize(archive_);
+  }
+
+private:
+  PayloadStreamBuffer buffer_;  //!< Reads the section in place
+  BinaryInputArchive archive_;  //!< The archive
+};
+
+int64_t encodeStamp(const TimeStamp& stamp)
+{
+  return stamp.initialised() ? stamp.time_since_epoch().count() : INVALID_STAMP;
+}
+
+TimeStamp decodeStamp(int64_t nanoseconds)
+{
+  if (nanoseconds == INVALID_STAMP)
+  {
+    return TimeStamp();
+  }
+  return TimeStamp(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(
+    std::chrono::nanoseconds(nanoseconds)));
+}
+
+UUID VariableView::uuid() const
+{
+  return readUuid(record_->uuid);
+}
+
+const std::string& VariableView::type() const
+{
+  return reader_->string(record_->type_index);
+}
+
+PayloadReader VariableView::payload() const
+{
+  return PayloadReader(reinterpret_cast<const uint8_t*>(data() + record_->size), record_->payload_bytes);
+}
+
+UUID ConstraintView::uuid() const
+{
+  return readUuid(record_->uuid);
+}
+
+const std::string& ConstraintView::type() const
+{
+  return reader_->string(record_->type_index);
+}
+
+const std::string& ConstraintView::source() const
+{
+  return reader_->string(record_->source_index);
+}
+
+UUID ConstraintView::variable(size_t index) const
+{
+  return readUuid(reinterpret_cast<const uint8_t*>(record_ + 1) + index * UUID_BYTES);
+}
+
+PayloadReader ConstraintView::payload() const
+{
+  const auto variables = reinterpret_cast<const uint8_t*>(record_ + 1);
+  return PayloadReader(variables + record_->variable_count * UUID_BYTES, record_->payload_bytes);
+}
+
+BufferReader::BufferReader(const uint8_t* data, size_t size) :
+  data_(data)
+{
+  if (!isFlatBuffer(data, size) || size < sizeof(BufferHeader))
+  {
+    throw std::runtime_error("Buffer is not a flat fuse buffer.");
+  }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(double) != 0)
+  {
+    throw std::runtime_error("Flat buffers must be 8-byte aligned to be read in place.");
+  }
+  std::memcpy(&header_, data, sizeof(header_));
+  if (header_.version != VERSION)
+  {
+    throw std::runtime_error("Unsupported flat buffer version " + std::to_string(header_.version) +
+                             ". Expected version " + std::to_string(VERSION) + ".");
+  }
+  if (header_.content != Content::GRAPH && header_.content != Content::TRANSACTION &&
+      header_.content != Content::GRAPH_DELTA)
+  {
+    throw std::runtime_error("Flat buffer has an unknown content type.");
+  }
+
+  // Decode the string table
+  size_t offset = header_.string_table_offset;
+  checkBounds(offset, 0, size, "string table");
+  // The counts come from the buffer. Reject counts the buffer cannot hold before reserving any memory for them.
+  checkBounds(offset, static_cast<size_t>(header_.string_count) * sizeof(uint32_t), size, "string table");
+  strings_.reserve(header_.string_count);
+  for (uint32_t i = 0; i < header_.string_count; ++i)
+  {
+    uint32_t length;
+    checkBounds(offset, sizeof(length), size, "string table");
+    std::memcpy(&length, data + offset, sizeof(length));
+    offset += sizeof(length);
+    checkBounds(offset, length, size, "string table");
+    strings_.emplace_back(reinterpret_cast<const char*>(data + offset), length);
+    offset += length;
+  }
+  const size_t records_end = header_.boost_section_offset;
+  checkBounds(records_end, header_.boost_section_bytes, header_.string_table_offset, "Boost section");
+
+  // Locate the fixed-size sections
+  offset = sizeof(BufferHeader);
+  involved_stamps_offset_ = offset;
+  offset += static_cast<size_t>(header_.involved_stamp_count) * sizeof(int64_t);
+  removed_variables_offset_ = offset;
+  offset += static_cast<size_t>(header_.removed_variable_count) * UUID_BYTES;
+  removed_constraints_offset_ = offset;
+  offset += static_cast<size_t>(header_.removed_constraint_count) * UUID_BYTES;
+  offset = padded(offset);
+  checkBounds(0, offset, records_end, "stamp and UUID sections");
+
+  // Index the records
+  checkBounds(offset, static_cast<size_t>(header_.variable_count) * sizeof(VariableRecord), records_end,
+              "variable records");
+  variable_offsets_.reserve(header_.variable_count);
+  for (uint32_t i = 0; i < header_.variable_count; ++i)
+  {
+    checkBounds(offset, sizeof(VariableRecord), records_end, "variable records");
+    VariableRecord record;
+    std::memcpy(&record, data + offset, sizeof(record));
+    const size_t content_bytes = sizeof(VariableRecord) + record.size * sizeof(double) + record.payload_bytes;
+    if (record.record_bytes % 8 != 0 || record.record_bytes < content_bytes || record.type_index >= strings_.size())
+    {
+      throw std::runtime_error("Flat buffer variable record " + std::to_string(i) + " is malformed.");
+    }
+    checkBounds(offset, record.record_bytes, records_end, "variable records");
+    variable_offsets_.push_back(offset);
+    offset += record.record_bytes;
+  }
+  checkBounds(offset, static_cast<size_t>(header_.constraint_count) * sizeof(ConstraintRecord), records_end,
+              "constraint records");
+  constraint_offsets_.reserve(header_.constraint_count);
+  for (uint32_t i = 0; i < header_.constraint_count; ++i)
+  {
+    checkBounds(offset, sizeof(ConstraintRecord), records_end, "constraint records");
+    ConstraintRecord record;
+    std::memcpy(&record, data + offset, sizeof(record));
+    const size_t content_bytes =
+      sizeof(ConstraintRecord) + record.variable_count * UUID_BYTES + record.payload_bytes;
+    if (record.record_bytes % 8 != 0 || record.record_bytes < content_bytes ||
+        record.type_index >= strings_.size() || record.source_index >= strings_.size())
+    {
+      throw std::runtime_error("Flat buffer constraint record " + std::to_string(i) + " is malformed.");
+    }
+    checkBounds(offset, record.record_bytes, records_end, "constraint records");
+    constraint_offsets_.push_back(offset);
+    offset += record.record_bytes;
+  }
+}
+
+TimeStamp BufferReader::involvedStamp(size_t index) const
+{
+  int64_t encoded;
+  std::memcpy(&encoded, data_ + involved_stamps_offset_ + index * sizeof(int64_t), sizeof(encoded));
+  return decodeStamp(encoded);
+}
+
+UUID BufferReader::removedVariable(size_t index) const
+{
+  return readUuid(data_ + removed_variables_offset_ + index * UUID_BYTES);
+}
+
+UUID BufferReader::removedConstraint(size_t index) const
+{
+  return readUuid(data_ + removed_constraints_offset_ + index * UUID_BYTES);
+}
+
+VariableView BufferReader::variable(size_t index) const
+{
+  return VariableView(*this, reinterpret_cast<const VariableRecord*>(data_ + variable_offsets_[index]));
+}
+
+ConstraintView BufferReader::constraint(size_t index) const
+{
+  return ConstraintView(*this, reinterpret_cast<const ConstraintRecord*>(data_ + constraint_offsets_[index]));
+}
+
+CodecRegistry& CodecRegistry::instance()
+{
+  static CodecRegistry registry;
+  return registry;
+}
+
+bool CodecRegistry::registerVariableCodec(const std::string& type, std::unique_ptr<const VariableCodec> codec)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return variable_codecs_.emplace(type, std::move(codec)).second;
+}
+
+bool CodecRegistry::registerConstraintCodec(const std::string& type, std::unique_ptr<const ConstraintCodec> codec)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return constraint_codecs_.emplace(type, std::move(codec)).second;
+}
+
+const VariableCodec* CodecRegistry::variableCodec(const std::string& type) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = variable_codecs_.find(type);
+  return (iter != variable_codecs_.end()) ? iter->second.get() : nullptr;
+}
+
+const ConstraintCodec* CodecRegistry::constraintCodec(const std::string& type) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = constraint_codecs_.find(type);
+  return (iter != constraint_codecs_.end()) ? iter->second.get() : nullptr;
+}
+
+bool isFlatBuffer(const uint8_t* data, size_t size)
+{
+  return size >= sizeof(MAGIC) && std::equal(std::begin(MAGIC), std::end(MAGIC), data);
+}
+
+void serializeGraph(const Graph& graph, std::vector<uint8_t>& data)
+{
+  Writer writer(data, Content::GRAPH);
+  writeGraph(graph, writer);
+  writer.finish();
+}
+
+void serializeTransaction(const Transaction& transaction, std::vector<uint8_t>& data)
+{
+  Writer writer(data, Content::TRANSACTION);
+  writer.writeStamp(transaction.stamp());
+  writer.writeInvolvedStamps(transaction.involvedStamps());
+  writer.writeRemovedVariables(transaction.removedVariables());
+  writer.writeRemovedConstraints(transaction.removedConstraints());
+  for (const auto& variable : transaction.addedVariables())
+  {
+    writer.writeVariable(variable, false);
+  }
+  for (const auto& constraint : transaction.addedConstraints())
+  {
+    writer.writeConstraint(constraint);
+  }
+  writer.finish();
+}
+
+ObjectReader::ObjectReader(const BufferReader& reader, const ObjectFactory& factory) :
+  reader_(reader),
+  factory_(factory),
+  position_(0)
+{
+}
+
+ObjectReader::~ObjectReader() = default;
+
+Variable::SharedPtr ObjectReader::variable(size_t index)
+{
+  const auto view = reader_.variable(index);
+  if (view.payloadEncoding() == PayloadEncoding::CODEC)
+  {
+    auto codec = CodecRegistry::instance().variableCodec(view.type());
+    if (!codec)
+    {
+      throw std::runtime_error("No flat codec is registered for variable type '" + view.type() + "'.");
+    }
+    return codec->read(view);
+  }
+  else if (view.payloadEncoding() == PayloadEncoding::BOOST_BINARY)
+  {
+    skipTo(index);
+    Variable::SharedPtr variable = factory_.create_variable(view.type());
+    boost_section_->read(*variable);
+    ++position_;
+    return variable;
+  }
+  else if (view.payloadEncoding() == PayloadEncoding::NONE)
+  {
+    throw std::runtime_error("Variable record of type '" + view.type() + "' only holds the values of a variable "
+                             "sent previously. It must be applied with applyGraphDelta().");
+  }
+  throw std::runtime_error("Variable record of type '" + view.type() + "' has an unknown payload encoding.");
+}
+
+Constraint::SharedPtr ObjectReader::constraint(size_t index)
+{
+  const auto view = reader_.constraint(index);
+  if (view.payloadEncoding() == PayloadEncoding::CODEC)
+  {
+    auto codec = CodecRegistry::instance().constraintCodec(view.type());
+    if (!codec)
+    {
+      throw std::runtime_error("No flat codec is registered for constraint type '" + view.type() + "'.");
+    }
+    return codec->read(view);
+  }
+  else if (view.payloadEncoding() == PayloadEncoding::BOOST_BINARY)
+  {
+    skipTo(reader_.variableCount() + index);
+    Constraint::SharedPtr constraint = factory_.create_constraint(view.type());
+    boost_section_->read(*constraint);
+    ++position_;
+    return constraint;
+  }
+  throw std::runtime_error("Constraint record of type '" + view.type() + "' has an unknown payload encoding.");
+}
+
+void ObjectReader::skipTo(size_t position)
+{
+  if (position < position_)
+  {
+    throw std::runtime_error("Flat buffer objects without a codec must be read in record order.");
+  }
+  if (!boost_section_)
+  {
+    boost_section_.reset(new BoostSection(reader_.boostSection()));
+  }
+  const size_t variable_count = reader_.variableCount();
+  for (; position_ < position; ++position_)
+  {
+    if (position_ < variable_count)
+    {
+      const auto view = reader_.variable(position_);
+      if (view.payloadEncoding() == PayloadEncoding::BOOST_BINARY)
+      {
+        boost_section_->read(*factory_.create_variable(view.type()));
+      }
+    }
+    else
+    {
+      const auto view = reader_.constraint(position_ - variable_count);
+      if (view.payloadEncoding() == PayloadEncoding::BOOST_BINARY)
+      {
+        boost_section_->read(*factory_.create_constraint(view.type()));
+      }
+    }
+  }
+}
+
+void deserializeGraph(const BufferReader& reader, const ObjectFactory& factory, Graph& graph)
+{
+  if (reader.content() != Content::GRAPH)
+  {
+    throw std::runtime_error("Flat buffer does not contain a graph.");
+  }
+  graph.clear();
+  ObjectReader objects(reader, factory);
+  for (size_t i = 0; i < reader.variableCount(); ++i)
+  {
+    graph.addVariable(objects.variable(i));
+    const auto view = reader.variable(i);
+    if (view.onHold())
+    {
+      graph.holdVariable(view.uuid(), true);
+    }
+  }
+  for (size_t i = 0; i < reader.constraintCount(); ++i)
+  {
+    graph.addConstraint(objects.constraint(i));
+  }
+}
+
+Transaction deserializeTransaction(const BufferReader& reader, const ObjectFactory& factory)
+{
+  if (reader.content() != Content::TRANSACTION)
+  {
+    throw std::runtime_error("Flat buffer does not contain a transaction.");
+  }
+  Transaction transaction;
+  transaction.stamp(reader.stamp());
+  for (size_t i = 0; i < reader.involvedStampCount(); ++i)
+  {
+    transaction.addInvolvedStamp(reader.involvedStamp(i));
+  }
+  ObjectReader objects(reader, factory);
+  for (size_t i = 0; i < reader.variableCount(); ++i)
+  {
+    transaction.addVariable(objects.variable(i));
+  }
+  for (size_t i = 0; i < reader.constraintCount(); ++i)
+  {
+    transaction.addConstraint(objects.constraint(i));
+  }
+  for (size_t i = 0; i < reader.removedVariableCount(); ++i)
+  {
+    transaction.removeVariable(reader.removedVariable(i));
+  }
+  for (size_t i = 0; i < reader.removedConstraintCount(); ++i)
+  {
+    transaction.removeConstraint(reader.removedConstraint(i));
+  }
+  return transaction;
+}
+
+GraphDeltaEncoder::GraphDeltaEncoder(size_t keyframe_interval) :
+  keyframe_interval_(keyframe_interval),
+  deltas_since_keyframe_(0),
+  keyframe_requested_(true),
+  sequence_(0)
+{
+}
+
+bool GraphDeltaEncoder::encode(const Graph& graph, std::vector<uint8_t>& data)
+{
+  // The stored state is updated for keyframes too, so the following delta is relative to the keyframe
+  findChanges(graph);
+  const bool keyframe = keyframe_requested_ || deltas_since_keyframe_ >= keyframe_interval_;
+  if (keyframe)
+  {
+    Writer writer(data, Content::GRAPH);
+    writer.writeSequence(sequence_, 0);
+    writeGraph(graph, writer);
+    writer.finish();
+    keyframe_requested_ = false;
+    deltas_since_keyframe_ = 0;
+    return true;
+  }
+
+  Writer writer(data, Content::GRAPH_DELTA);
+  writer.writeSequence(sequence_, sequence_ - 1);
+  writer.writeRemovedVariables(removed_variables_);
+  writer.writeRemovedConstraints(removed_constraints_);
+  for (const auto variable : added_variables_)
+  {
+    writer.writeVariable(*variable, variables_[variable->uuid()].on_hold);
+  }
+  for (const auto variable : updated_variables_)
+  {
+    writer.writeVariableValues(*variable, variables_[variable->uuid()].on_hold);
+  }
+  for (const auto constraint : added_constraints_)
+  {
+    writer.writeConstraint(*constraint);
+  }
+  writer.finish();
+  ++deltas_since_keyframe_;
+  return false;
+}
+
+void GraphDeltaEncoder::findChanges(const Graph& graph)
+{
+  ++sequence_;
+  added_variables_.clear();
+  updated_variables_.clear();
+  added_constraints_.clear();
+  removed_variables_.clear();
+  removed_constraints_.clear();
+
+  // Look the objects up before inserting them: emplace() allocates a node even if the key already exists. Count the
+  // objects found, so the search for removed objects can be skipped if nothing is missing.
+  size_t found = 0;
+  graph.forEachVariable([this, &graph, &found](const Variable& variable)
+  {
+    const bool on_hold = graph.isVariableOnHold(variable.uuid());
+    const double* values = variable.data();
+    auto iter = variables_.find(variable.uuid());
+    if (iter == variables_.end())
+    {
+      iter = variables_.emplace(variable.uuid(), VariableState()).first;
+      added_variables_.push_back(&variable);
+    }
+    else if (iter->second.on_hold == on_hold && iter->second.values.size() == variable.size() &&
+             std::equal(iter->second.values.begin(), iter->second.values.end(), values))
+    {
+      ++found;
+      iter->second.sequence = sequence_;
+      return;
+    }
+    else
+    {
+      ++found;
+      updated_variables_.push_back(&variable);
+    }
+    VariableState& state = iter->second;
+    state.values.assign(values, values + variable.size());
+    state.on_hold = on_hold;
+    state.sequence = sequence_;
+  });  // NOLINT(whitespace/braces)
+  for (auto iter = variables_.begin(); found + added_variables_.size() != variables_.size();)
+  {
+    if (iter->second.sequence != sequence_)
+    {
+      removed_variables_.push_back(iter->first);
+      iter = variables_.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  found = 0;
+  graph.forEachConstraint([this, &found](const Constraint& constraint)
+  {
+    auto iter = constraints_.find(constraint.uuid());
+    if (iter == constraints_.end())
+    {
+      constraints_.emplace(constraint.uuid(), sequence_);
+      added_constraints_.push_back(&constraint);
+    }
+    else
+    {
+      ++found;
+      iter->second = sequence_;
+    }
+  });  // NOLINT(whitespace/braces)
+  for (auto iter = constraints_.begin(); found + added_constraints_.size() != constraints_.size();)
+  {
+    if (iter->second != sequence_)
+    {
+      removed_constraints_.push_back(iter->first);
+      iter = constraints_.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+}
+
+void applyGraphDelta(const BufferReader& reader, const ObjectFactory& factory, Graph& graph)
+{
+  if (reader.content() != Content::GRAPH_DELTA)
+  {
+    throw std::runtime_error("Flat buffer does not contain a graph delta.");
+  }
+  // Remove the constraints first, as a variable cannot be removed while constraints still use it
+  for (size_t i = 0; i < reader.removedConstraintCount(); ++i)
+  {
+    graph.removeConstraint(reader.removedConstraint(i));
+  }
+  for (size_t i = 0; i < reader.removedVariableCount(); ++i)
+  {
+    graph.removeVariable(reader.removedVariable(i));
+  }
+  ObjectReader objects(reader, factory);
+  for (size_t i = 0; i < reader.variableCount(); ++i)
+  {
+    const auto view = reader.variable(i);
+    if (view.payloadEncoding() == PayloadEncoding::NONE)
+    {
+      // The graph only provides const access to its variables, but owns them as modifiable objects: the optimizer
+      // writes into them in the same way.
+      auto& variable = const_cast<Variable&>(graph.getVariable(view.uuid()));
+      if (variable.size() != view.size())
+      {
+        throw std::runtime_error("Flat buffer holds " + std::to_string(view.size()) + " values for variable " +
+                                 uuid::to_string(view.uuid()) + ", which has " + std::to_string(variable.size()) +
+                                 ".");
+      }
+      std::copy(view.data(), view.data() + view.size(), variable.data());
+      graph.holdVariable(view.uuid(), view.onHold());
+    }
+    else
+    {
+      graph.addVariable(objects.variable(i));
+      if (view.onHold())
+      {
+        graph.holdVariable(view.uuid(), true);
+      }
+    }
+  }
+  for (size_t i = 0; i < reader.constraintCount(); ++i)
+  {
+    graph.addConstraint(objects.constraint(i));
+  }
+}
+
+}  // namespace flat
+
+}  // namespace fuse_core
@@ -50,6 +50,30 @@ std::ostream& operator <<(std::ostream& stream, const Graph& graph)
   return stream;
 }
 
+void Graph::forEachConstraint(ConstraintVisitor visitor) const
+{
+  for (const auto& constraint : getConstraints())
+  {
+    visitor(constraint);
+  }
+}
+
+void Graph::forEachConnectedConstraint(const UUID& variable_uuid, ConstraintVisitor visitor) const
+{
+  for (const auto& constraint : getConnectedConstraints(variable_uuid))
+  {
+    visitor(constraint);
+  }
+}
+
+void Graph::forEachVariable(VariableVisitor visitor) const
+{
+  for (const auto& variable : getVariables())
+  {
+    visitor(variable);
+  }
+}
+
 Graph::const_variable_range Graph::getConnectedVariables(const UUID& constraint_uuid) const
 {
   std::function<const fuse_core::Variable&(const UUID& variable_uuid)> uuid_to_variable_ref =
@@ -73,15 +97,15 @@ void Graph::update(const Transaction& transaction)
   // the variable usage is updated. Finally, variables are removed.
 
   // Insert the new variables into the graph
-  for (const auto& variable : transaction.addedVariables())
-  {
-    addVariable(variable.clone());
-  }
+  transaction.forEachAddedVariable([this](const Variable& variable)
+    {
+      addVariable(variable.clone());
+    });  // NOLINT(whitespace/braces)
   // Insert the new constraints into the graph
-  for (const auto& constraint : transaction.addedConstraints())
-  {
-    addConstraint(constraint.clone());
-  }
+  transaction.forEachAddedConstraint([this](const Constraint& constraint)
+    {
+      addConstraint(constraint.clone());
+    });  // NOLINT(whitespace/braces)
   // Delete constraints from the graph
   for (const auto& constraint_uuid : transaction.removedConstraints())
   {
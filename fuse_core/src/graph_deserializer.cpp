@@ -37,12 +37,21 @@
 
 #include <boost/iostreams/stream.hpp>
 
+#include <string>
+
 
 namespace fuse_core
 {
 
-void serializeGraph(const fuse_core::Graph& graph, fuse_msgs::msg::SerializedGraph& msg)
+void serializeGraph(const fuse_core::Graph& graph, fuse_msgs::msg::SerializedGraph& msg, SerializationFormat format)
 {
+  // Set the plugin name using the graph's type() member function (blindly assuming these are the same thing)
+  msg.plugin_name = graph.type();
+  if (format == SerializationFormat::FLAT)
+  {
+    flat::serializeGraph(graph, msg.data);
+    return;
+  }
   // Serialize the graph into the msg.data field
   boost::iostreams::stream<fuse_core::MessageBufferStreamSink> stream(msg.data);
   // Scope the archive object. The archive is not guaranteed to write to the stream until the archive goes out of scope.
@@ -50,8 +59,15 @@ void serializeGraph(const fuse_core::Graph& graph, fuse_msgs::msg::SerializedGra
     BinaryOutputArchive archive(stream);
     graph.serialize(archive);
   }
-  // Set the plugin name using the graph's type() member function (blindly assuming these are the same thing)
+}
+
+bool serializeGraphDelta(
+  const fuse_core::Graph& graph,
+  flat::GraphDeltaEncoder& encoder,
+  fuse_msgs::msg::SerializedGraph& msg)
+{
   msg.plugin_name = graph.type();
+  return encoder.encode(graph, msg.data);
 }
 
 GraphDeserializer::GraphDeserializer() :
@@ -89,6 +105,11 @@ fuse_core::Graph::UniquePtr GraphDeserializer::deserialize(const fuse_msgs::msg:
   // back to the user as the output is not equivalent to fuse_core::Graph::UniquePtr. Instead, wrap an
   // unmanaged raw pointer in a unique_ptr, and handle the library unloading in the destructor.
   auto graph = fuse_core::Graph::UniquePtr(graph_loader_.createUnmanagedInstance(msg.plugin_name));
+  if (flat::isFlatBuffer(msg.data))
+  {
+    flat::deserializeGraph(flat::BufferReader(msg.data), flatObjectFactory(), *graph);
+    return graph;
+  }
   // Deserialize the msg.data field into the graph.
   // This will throw if something goes wrong in the deserialization.
   boost::iostreams::stream<fuse_core::MessageBufferStreamSource> stream(msg.data);
@@ -99,4 +120,60 @@ fuse_core::Graph::UniquePtr GraphDeserializer::deserialize(const fuse_msgs::msg:
   return graph;
 }
 
+flat::ObjectFactory GraphDeserializer::flatObjectFactory() const
+{
+  flat::ObjectFactory factory;
+  factory.create_variable = [this](const std::string& type)
+  {
+    return fuse_core::Variable::UniquePtr(variable_loader_.createUnmanagedInstance(type));
+  };  // NOLINT(whitespace/braces)
+  factory.create_constraint = [this](const std::string& type)
+  {
+    return fuse_core::Constraint::UniquePtr(constraint_loader_.createUnmanagedInstance(type));
+  };  // NOLINT(whitespace/braces)
+  return factory;
+}
+
+GraphReconstructor::GraphReconstructor() :
+  sequence_(0)
+{
+}
+
+bool GraphReconstructor::apply(const fuse_msgs::msg::SerializedGraph& msg)
+{
+  uint64_t sequence = 0;
+  if (flat::isFlatBuffer(msg.data))
+  {
+    flat::BufferReader reader(msg.data);
+    if (reader.content() == flat::Content::GRAPH_DELTA)
+    {
+      if (!graph_ || sequence_ == 0 || reader.baseSequence() != sequence_)
+      {
+        return false;
+      }
+      try
+      {
+        flat::applyGraphDelta(reader, deserializer_.flatObjectFactory(), *graph_);
+      }
+      catch (...)
+      {
+        // The delta may have been partially applied
+        graph_.reset();
+        sequence_ = 0;
+        throw;
+      }
+      sequence_ = reader.sequence();
+      return true;
+    }
+    sequence = reader.sequence();
+  }
+
+  // Any other message is a complete graph. Discard the old one first, so nothing is left behind if this one fails.
+  graph_.reset();
+  sequence_ = 0;
+  graph_ = deserializer_.deserialize(msg);
+  sequence_ = sequence;
+  return true;
+}
+
 }  // namespace fuse_core
@@ -39,6 +39,29 @@
 namespace fuse_core
 {
 
+Loss::~Loss()
+{
+  delete loss_function_.load();
+}
+
+void Loss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  const auto loss_function = lossFunction();
+  for (size_t i = 0; i < count; ++i)
+  {
+    double values[3];
+    loss_function->Evaluate(squared_norms[i], values);
+    rho[i] = values[0];
+    rho_derivative[i] = values[1];
+    rho_second_derivative[i] = values[2];
+  }
+}
+
 std::ostream& operator <<(std::ostream& stream, const Loss& loss)
 {
   loss.print(stream);
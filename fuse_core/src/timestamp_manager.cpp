@@ -37,7 +37,6 @@
 
 #include <algorithm>
 #include <iterator>
-#include <set>
 #include <stdexcept>
 #include <utility>
 
@@ -62,91 +61,93 @@ void TimestampManager::query(
     return;
   }
   // Verify the query is within the buffer length
-  if ( (!motion_model_history_.empty())
+  if ( (!historyEmpty())
     && (buffer_length_ != Duration::max())
-    && (stamps.front() < motion_model_history_.begin()->first)
-    && (stamps.front() < (motion_model_history_.rbegin()->first - buffer_length_)))
+    && (stamps.front() < historyBegin()->beginning_stamp)
+    && (stamps.front() < (motion_model_history_.back().beginning_stamp - buffer_length_)))
   {
     throw std::invalid_argument("All timestamps must be within the defined buffer length of the motion model");
   }
   // Create a list of all the required timestamps involved in motion model segments that must be created
   // Add all of the existing timestamps between the first and last input stamp
+  // The involved stamps are already sorted and unique.
   Transaction motion_model_transaction;
-  std::set<TimeStamp> augmented_stamps(stamps.begin(), stamps.end());
-  auto first_stamp = *augmented_stamps.begin();
-  auto last_stamp = *augmented_stamps.rbegin();
+  augmented_stamps_.assign(stamps.begin(), stamps.end());
+  const auto first_stamp = augmented_stamps_.front();
+  const auto last_stamp = augmented_stamps_.back();
   {
-    auto begin = motion_model_history_.upper_bound(first_stamp);
-    if (begin != motion_model_history_.begin())
+    auto begin = historyUpperBound(first_stamp);
+    if (begin != historyBegin())
     {
       --begin;
     }
-    auto end = motion_model_history_.upper_bound(last_stamp);
+    auto end = historyUpperBound(last_stamp);
     for (auto iter = begin; iter != end; ++iter)
     {
-      augmented_stamps.insert(iter->first);
+      augmented_stamps_.push_back(iter->beginning_stamp);
     }
     if (end != motion_model_history_.end())
     {
-      augmented_stamps.insert(end->first);
+      augmented_stamps_.push_back(end->beginning_stamp);
     }
+    std::sort(augmented_stamps_.begin(), augmented_stamps_.end());
+    augmented_stamps_.erase(std::unique(augmented_stamps_.begin(), augmented_stamps_.end()), augmented_stamps_.end());
   }
   // Convert the sequence of stamps into stamp pairs that must be generated
-  std::vector<std::pair<TimeStamp, TimeStamp>> stamp_pairs;
+  stamp_pairs_.clear();
+  bool transaction_variables_valid = false;
+  for (size_t i = 1; i < augmented_stamps_.size(); ++i)
   {
-    for (auto previous_iter = augmented_stamps.begin(), current_iter = std::next(augmented_stamps.begin());
-         current_iter != augmented_stamps.end();
-         ++previous_iter, ++current_iter)
+    const TimeStamp& previous_stamp = augmented_stamps_[i - 1];
+    const TimeStamp& current_stamp = augmented_stamps_[i];
+    // Check if the timestamp pair is exactly an existing pair. If so, don't add it.
+    auto history_iter = historyLowerBound(previous_stamp);
+    if ((history_iter != motion_model_history_.end()) &&
+        (history_iter->beginning_stamp == previous_stamp) &&
+        (history_iter->ending_stamp == current_stamp))
     {
-      const TimeStamp& previous_stamp = *previous_iter;
-      const TimeStamp& current_stamp = *current_iter;
-      // Check if the timestamp pair is exactly an existing pair. If so, don't add it.
-      auto history_iter = motion_model_history_.lower_bound(previous_stamp);
-      if ((history_iter != motion_model_history_.end()) &&
-          (history_iter->second.beginning_stamp == previous_stamp) &&
-          (history_iter->second.ending_stamp == current_stamp))
+      if (update_variables)
       {
-        if (update_variables)
+        // Add the motion model version of the variables involved in this motion model segment
+        // This ensures that the variables in the final transaction will be overwritten with the motion model version
+        if (!transaction_variables_valid)
         {
-          // Add the motion model version of the variables involved in this motion model segment
-          // This ensures that the variables in the final transaction will be overwritten with the motion model version
-          auto transaction_variables = transaction.addedVariables();
-          for (const auto& variable : history_iter->second.variables)
+          transaction_variables_.clear();
+          transaction.forEachAddedVariable([this](const Variable& variable)
           {
-            if (std::any_of(
-                  transaction_variables.begin(),
-                  transaction_variables.end(),
-                  [variable_uuid = variable->uuid()](const auto& input_variable)
-                  {
-                    return input_variable.uuid() == variable_uuid;
-                  }))  // NOLINT
-            {
-              motion_model_transaction.addVariable(variable, update_variables);
-            }
+            transaction_variables_.insert(variable.uuid());
+          });  // NOLINT(whitespace/braces)
+          transaction_variables_valid = true;
+        }
+        for (const auto& variable : history_iter->variables)
+        {
+          if (transaction_variables_.count(variable->uuid()) > 0)
+          {
+            motion_model_transaction.addVariable(variable, update_variables);
           }
         }
-        continue;
       }
-      // Check if this stamp is in the middle of an existing entry. If so, delete it.
-      if ((history_iter != motion_model_history_.end()) &&
-          (history_iter->second.beginning_stamp < current_stamp) &&
-          (history_iter->second.ending_stamp >= current_stamp))
-      {
-        removeSegment(history_iter, motion_model_transaction);
-      }
-      // Add this pair
-      stamp_pairs.emplace_back(previous_stamp, current_stamp);
+      continue;
     }
+    // Check if this stamp is in the middle of an existing entry. If so, delete it.
+    if ((history_iter != motion_model_history_.end()) &&
+        (history_iter->beginning_stamp < current_stamp) &&
+        (history_iter->ending_stamp >= current_stamp))
+    {
+      removeSegment(history_iter, motion_model_transaction);
+    }
+    // Add this pair
+    stamp_pairs_.emplace_back(previous_stamp, current_stamp);
   }
   // Create the required segments
-  for (const auto& stamp_pair : stamp_pairs)
+  for (const auto& stamp_pair : stamp_pairs_)
   {
     addSegment(stamp_pair.first, stamp_pair.second, motion_model_transaction);
   }
   // Add a dummy entry for the last stamp if one does not already exist
-  if (motion_model_history_.empty() || (motion_model_history_.rbegin()->first < last_stamp))
+  if (historyEmpty() || (motion_model_history_.back().beginning_stamp < last_stamp))
   {
-    if (motion_model_history_.empty())
+    if (historyEmpty())
     {
       // Call the motion model generator so it inserts the last timestamp into its state history.
       std::vector<Constraint::SharedPtr> constraints;
@@ -156,7 +157,9 @@ void TimestampManager::query(
 
     // Insert the last timestamp into the motion model history, but with no constraints. The last entry in the motion
     // model history will always contain no constraints.
-    motion_model_history_.emplace(last_stamp, MotionModelSegment());
+    MotionModelSegment last_segment;
+    last_segment.beginning_stamp = last_stamp;
+    motion_model_history_.push_back(std::move(last_segment));
   }
   // Purge any old entries from the motion model history
   purgeHistory();
@@ -168,13 +171,37 @@ TimestampManager::const_stamp_range TimestampManager::stamps() const
 {
   auto extract_stamp = +[](const MotionModelHistory::value_type& element) -> const TimeStamp&
   {
-    return element.first;
+    return element.beginning_stamp;
   };
 
-  return const_stamp_range(boost::make_transform_iterator(motion_model_history_.begin(), extract_stamp),
+  return const_stamp_range(boost::make_transform_iterator(historyBegin(), extract_stamp),
                            boost::make_transform_iterator(motion_model_history_.end(), extract_stamp));
 }
 
+TimestampManager::MotionModelHistory::iterator TimestampManager::historyLowerBound(const TimeStamp& stamp)
+{
+  return std::lower_bound(
+    historyBegin(),
+    motion_model_history_.end(),
+    stamp,
+    [](const MotionModelSegment& segment, const TimeStamp& stamp)
+    {
+      return segment.beginning_stamp < stamp;
+    });  // NOLINT(whitespace/braces)
+}
+
+TimestampManager::MotionModelHistory::iterator TimestampManager::historyUpperBound(const TimeStamp& stamp)
+{
+  return std::upper_bound(
+    historyBegin(),
+    motion_model_history_.end(),
+    stamp,
+    [](const TimeStamp& stamp, const MotionModelSegment& segment)
+    {
+      return stamp < segment.beginning_stamp;
+    });  // NOLINT(whitespace/braces)
+}
+
 void TimestampManager::addSegment(
   const TimeStamp& beginning_stamp,
   const TimeStamp& ending_stamp,
@@ -195,11 +222,22 @@ void TimestampManager::addSegment(
   {
     transaction.addVariable(variable);
   }
-  // Add the motion model segment to the history
-  motion_model_history_[beginning_stamp] = MotionModelSegment(beginning_stamp,
-                                                              ending_stamp,
-                                                              constraints,
-                                                              variables);
+  // Add the motion model segment to the history, replacing any existing segment with the same beginning stamp.
+  // New segments are usually appended to the end, which makes the insertion cheap.
+  MotionModelSegment segment;
+  segment.beginning_stamp = beginning_stamp;
+  segment.ending_stamp = ending_stamp;
+  segment.constraints = std::move(constraints);
+  segment.variables = std::move(variables);
+  auto iter = historyLowerBound(beginning_stamp);
+  if ((iter != motion_model_history_.end()) && (iter->beginning_stamp == beginning_stamp))
+  {
+    *iter = std::move(segment);
+  }
+  else
+  {
+    motion_model_history_.insert(iter, std::move(segment));
+  }
 }
 
 void TimestampManager::removeSegment(
@@ -207,9 +245,9 @@ void TimestampManager::removeSegment(
   Transaction& transaction)
 {
   // Mark the previously generated constraints for removal
-  transaction.addInvolvedStamp(iter->second.beginning_stamp);
-  transaction.addInvolvedStamp(iter->second.ending_stamp);
-  for (const auto& constraint : iter->second.constraints)
+  transaction.addInvolvedStamp(iter->beginning_stamp);
+  transaction.addInvolvedStamp(iter->ending_stamp);
+  for (const auto& constraint : iter->constraints)
   {
     transaction.removeConstraint(constraint->uuid());
   }
@@ -224,8 +262,8 @@ void TimestampManager::splitSegment(
     const TimeStamp& stamp,
     Transaction& transaction)
 {
-  TimeStamp removed_beginning_stamp = iter->second.beginning_stamp;
-  TimeStamp removed_ending_stamp = iter->second.ending_stamp;
+  TimeStamp removed_beginning_stamp = iter->beginning_stamp;
+  TimeStamp removed_ending_stamp = iter->ending_stamp;
   // We need to remove the existing constraint.
   removeSegment(iter, transaction);
   // And add a new constraint from the beginning of the removed constraint to the provided stamp
@@ -239,7 +277,8 @@ void TimestampManager::purgeHistory()
   // Purge any motion model segments that are more than buffer_length_ seconds older than the most recent entry
   // A setting of fuse_core::Duration::max() means "keep everything"
   // And we want to keep at least one entry in motion model history, regardless of the stamps.
-  if ((buffer_length_ == Duration::max()) || (motion_model_history_.size() <= 1))
+  const auto history_size = motion_model_history_.size() - history_begin_;
+  if ((buffer_length_ == Duration::max()) || (history_size <= 1))
   {
     return;
   }
@@ -247,11 +286,20 @@ void TimestampManager::purgeHistory()
   // (a) are left with only one entry, OR
   // (b) the time delta between the beginning and end is within the buffer_length_
   // We compare with the ending timestamp of each segment to be conservative
-  TimeStamp ending_stamp = motion_model_history_.rbegin()->first;
-  while ( (motion_model_history_.size() > 1)
-      && ((ending_stamp - motion_model_history_.begin()->second.ending_stamp) > buffer_length_))
+  TimeStamp ending_stamp = motion_model_history_.back().beginning_stamp;
+  while ( (history_begin_ + 1 < motion_model_history_.size())
+      && ((ending_stamp - motion_model_history_[history_begin_].ending_stamp) > buffer_length_))
+  {
+    // Release the segment contents now, but leave the element in place
+    motion_model_history_[history_begin_] = MotionModelSegment();
+    ++history_begin_;
+  }
+  // Erase the purged segments once they make up half of the container, so each segment is moved a bounded number of
+  // times on average
+  if (history_begin_ >= motion_model_history_.size() - history_begin_)
   {
-    motion_model_history_.erase(motion_model_history_.begin());
+    motion_model_history_.erase(motion_model_history_.begin(), historyBegin());
+    history_begin_ = 0;
   }
 }
 
@@ -37,12 +37,23 @@
 
 #include <boost/iostreams/stream.hpp>
 
+#include <string>
+#include <vector>
+
 
 namespace fuse_core
 {
 
-void serializeTransaction(const fuse_core::Transaction& transaction, fuse_msgs::msg::SerializedTransaction& msg)
+void serializeTransaction(
+  const fuse_core::Transaction& transaction,
+  fuse_msgs::msg::SerializedTransaction& msg,
+  SerializationFormat format)
 {
+  if (format == SerializationFormat::FLAT)
+  {
+    flat::serializeTransaction(transaction, msg.data);
+    return;
+  }
   // Serialize the transaction into the msg.data field
   boost::iostreams::stream<fuse_core::MessageBufferStreamSink> stream(msg.data);
   // Scope the archive object. The archive is not guaranteed to write to the stream until the archive goes out of scope.
@@ -81,11 +92,20 @@ fuse_core::Transaction TransactionDeserializer::deserialize(const fuse_msgs::msg
 
 fuse_core::Transaction TransactionDeserializer::deserialize(const fuse_msgs::msg::SerializedTransaction& msg) const
 {
+  return deserialize(msg.data);
+}
+
+fuse_core::Transaction TransactionDeserializer::deserialize(const std::vector<uint8_t>& data) const
+{
+  if (flat::isFlatBuffer(data))
+  {
+    return flat::deserializeTransaction(flat::BufferReader(data), flatObjectFactory());
+  }
   // The Transaction object is not a plugin and has no derived types. That makes it much easier to use.
   auto transaction = fuse_core::Transaction();
   // Deserialize the msg.data field into the transaction.
   // This will throw if something goes wrong in the deserialization.
-  boost::iostreams::stream<fuse_core::MessageBufferStreamSource> stream(msg.data);
+  boost::iostreams::stream<fuse_core::MessageBufferStreamSource> stream(data);
   {
     BinaryInputArchive archive(stream);
     transaction.deserialize(archive);
@@ -93,4 +113,18 @@ fuse_core::Transaction TransactionDeserializer::deserialize(const fuse_msgs::msg
   return transaction;
 }
 
+flat::ObjectFactory TransactionDeserializer::flatObjectFactory() const
+{
+  flat::ObjectFactory factory;
+  factory.create_variable = [this](const std::string& type)
+  {
+    return fuse_core::Variable::UniquePtr(variable_loader_.createUnmanagedInstance(type));
+  };  // NOLINT(whitespace/braces)
+  factory.create_constraint = [this](const std::string& type)
+  {
+    return fuse_core::Constraint::UniquePtr(constraint_loader_.createUnmanagedInstance(type));
+  };  // NOLINT(whitespace/braces)
+  return factory;
+}
+
 }  // namespace fuse_core
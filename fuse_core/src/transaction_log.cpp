@@ -0,0 +1,250 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/transaction_log.h>
+
+#include <fuse_core/flat_serialization.h>
+#include <fuse_core/time.h>
+#include <fuse_core/transaction.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace fuse_core
+{
+
+namespace
+{
+
+constexpr char MAGIC[8] = { 'F', 'U', 'S', 'E', 'T', 'L', 'O', 'G' };
+constexpr uint32_t VERSION = 1;
+
+/**
+ * @brief The fixed-layout header at the start of every transaction log
+ */
+struct LogHeader
+{
+  char magic[8];     //!< Always "FUSETLOG"
+  uint32_t version;  //!< The format version
+  uint32_t reserved;
+};
+static_assert(sizeof(LogHeader) == 16, "LogHeader must have a fixed layout");
+
+/**
+ * @brief The fixed part of a record. It is followed by the sensor name and the flat transaction, each padded to a
+ *        multiple of 8 bytes.
+ */
+struct RecordHeader
+{
+  uint64_t transaction_bytes;  //!< The size of the flat transaction, excluding padding
+  uint32_t sensor_name_bytes;  //!< The size of the sensor name, excluding padding
+  uint32_t reserved;
+  int64_t arrival_time;  //!< The arrival time, encoded with flat::encodeStamp()
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader must have a fixed layout");
+
+constexpr char PADDING[8] = {};
+
+/**
+ * @brief The number of bytes needed to round a byte count up to the next multiple of 8
+ */
+size_t padding(size_t bytes)
+{
+  return (8u - (bytes & 7u)) & 7u;
+}
+
+/**
+ * @brief Read and check the header of a transaction log
+ * @throws std::runtime_error if the stream does not start with a supported transaction log header
+ */
+void readHeader(std::istream& stream, const std::string& filename)
+{
+  LogHeader header;
+  if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    throw std::runtime_error("File '" + filename + "' is not a transaction log.");
+  }
+  if (header.version != VERSION)
+  {
+    throw std::runtime_error("Transaction log '" + filename + "' has unsupported version " +
+                             std::to_string(header.version) + ".");
+  }
+}
+
+}  // namespace
+
+TransactionLogWriter::TransactionLogWriter(const std::string& filename)
+{
+  // Check the existing log, if any, before appending to it. New records appended after a partially written record
+  // would not be readable.
+  bool empty = true;
+  {
+    std::ifstream existing(filename, std::ios::binary | std::ios::ate);
+    empty = !existing || existing.tellg() <= 0;
+    if (!empty)
+    {
+      TransactionLogReader reader(filename);
+      TransactionLogEntry entry;
+      while (reader.next(entry))
+      {
+      }
+      if (reader.truncated())
+      {
+        throw std::runtime_error("Transaction log '" + filename + "' ends with a partially written record. It can "
+                                 "not be appended to.");
+      }
+    }
+  }
+
+  file_.open(filename, std::ios::binary | std::ios::app);
+  if (!file_)
+  {
+    throw std::runtime_error("Failed to open transaction log '" + filename + "' for writing.");
+  }
+  if (empty)
+  {
+    LogHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.reserved = 0;
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+}
+
+TransactionLogWriter::~TransactionLogWriter()
+{
+  file_.flush();
+}
+
+void TransactionLogWriter::write(
+  const std::string& sensor_name,
+  const Transaction& transaction,
+  const TimeStamp& arrival_time)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  flat::serializeTransaction(transaction, buffer_);
+
+  RecordHeader record;
+  record.transaction_bytes = buffer_.size();
+  record.sensor_name_bytes = static_cast<uint32_t>(sensor_name.size());
+  record.reserved = 0;
+  record.arrival_time = flat::encodeStamp(arrival_time);
+
+  file_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  file_.write(sensor_name.data(), sensor_name.size());
+  file_.write(PADDING, padding(sensor_name.size()));
+  file_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+  file_.write(PADDING, padding(buffer_.size()));
+  if (!file_)
+  {
+    throw std::runtime_error("Failed to write the transaction from sensor '" + sensor_name + "' to the transaction "
+                             "log.");
+  }
+}
+
+void TransactionLogWriter::flush()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_.flush();
+}
+
+TransactionLogReader::TransactionLogReader(const std::string& filename) :
+  file_(filename, std::ios::binary | std::ios::ate),
+  file_size_(0),
+  truncated_(false)
+{
+  if (!file_)
+  {
+    throw std::runtime_error("Failed to open transaction log '" + filename + "'.");
+  }
+  file_size_ = file_.tellg();
+  file_.seekg(0);
+  readHeader(file_, filename);
+}
+
+bool TransactionLogReader::next(TransactionLogEntry& entry)
+{
+  if (truncated_)
+  {
+    return false;
+  }
+
+  RecordHeader record;
+  file_.read(reinterpret_cast<char*>(&record), sizeof(record));
+  if (file_.gcount() == 0 && file_.eof())
+  {
+    return false;
+  }
+
+  // Any short read from here on means the writer stopped in the middle of this record
+  char skipped[8];
+  if (file_.gcount() != sizeof(record))
+  {
+    truncated_ = true;
+    return false;
+  }
+  // The sizes come from the file. Check them against the rest of the file before allocating memory for them.
+  const auto remaining = static_cast<uint64_t>(file_size_ - file_.tellg());
+  if (record.sensor_name_bytes > remaining ||
+      record.transaction_bytes > remaining - record.sensor_name_bytes)
+  {
+    truncated_ = true;
+    return false;
+  }
+  entry.sensor_name.resize(record.sensor_name_bytes);
+  entry.data.resize(record.transaction_bytes);
+  if (!file_.read(&entry.sensor_name[0], entry.sensor_name.size()) ||
+      !file_.read(skipped, padding(entry.sensor_name.size())) ||
+      !file_.read(reinterpret_cast<char*>(entry.data.data()), entry.data.size()) ||
+      !file_.read(skipped, padding(entry.data.size())))
+  {
+    truncated_ = true;
+    return false;
+  }
+  if (!flat::isFlatBuffer(entry.data))
+  {
+    throw std::runtime_error("Transaction log record from sensor '" + entry.sensor_name + "' does not hold a flat "
+                             "transaction.");
+  }
+  entry.arrival_time = flat::decodeStamp(record.arrival_time);
+  return true;
+}
+
+}  // namespace fuse_core
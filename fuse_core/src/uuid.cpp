@@ -35,6 +35,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <mutex>
 #include <random>
 
@@ -45,6 +46,36 @@ namespace fuse_core
 namespace uuid
 {
 
+namespace
+{
+
+/**
+ * @brief The number of bytes written by packStamp(), the size of the TimeStamp object
+ */
+constexpr size_t STAMP_BYTES = sizeof(TimeStamp);
+static_assert(STAMP_BYTES == 2 * sizeof(int64_t),
+              "packStamp() assumes a validity flag padded to 8 bytes, followed by the nanosecond count");
+
+/**
+ * @brief Write a stamp into a hash buffer, with the same layout as the TimeStamp object and zeroed padding
+ *
+ * The TimeStamp object itself must not be hashed directly: its padding bytes are indeterminate, so equal stamps could
+ * produce different UUIDs. Reproducing the object layout keeps the UUIDs of stamps whose padding happened to be zero
+ * unchanged.
+ */
+template <typename OutputIterator>
+OutputIterator packStamp(const TimeStamp& stamp, OutputIterator iter)
+{
+  *iter++ = stamp.initialised() ? 1 : 0;
+  iter = std::fill_n(iter, STAMP_BYTES - 1 - sizeof(int64_t), 0);
+  const int64_t nanoseconds = stamp.time_since_epoch().count();
+  return std::copy(reinterpret_cast<const unsigned char*>(&nanoseconds),
+                   reinterpret_cast<const unsigned char*>(&nanoseconds) + sizeof(nanoseconds),
+                   iter);
+}
+
+}  // namespace
+
 UUID generate()
 {
   static boost::uuids::random_generator generator;
@@ -61,14 +92,10 @@ UUID generate()
 
 UUID generate(const std::string& namespace_string, const TimeStamp& stamp)
 {
-  constexpr size_t buffer_size = sizeof(stamp);
+  constexpr size_t buffer_size = STAMP_BYTES;
   std::array<unsigned char, buffer_size> buffer;
   auto iter = buffer.begin();
-
-  // XXX #warning "unsafe time packing"
-  iter = std::copy(reinterpret_cast<const unsigned char*>(&stamp),
-                   reinterpret_cast<const unsigned char*>(&stamp) + sizeof(stamp),
-                   iter);
+  iter = packStamp(stamp, iter);
   return generate(namespace_string, buffer.data(), buffer.size());
 }
 
@@ -87,14 +114,10 @@ UUID generate(const std::string& namespace_string, const rclcpp::Time& stamp)
 
 UUID generate(const std::string& namespace_string, const TimeStamp& stamp, const UUID& id)
 {
-  constexpr size_t buffer_size = sizeof(stamp) + UUID::static_size();
+  constexpr size_t buffer_size = STAMP_BYTES + UUID::static_size();
   std::array<unsigned char, buffer_size> buffer;
   auto iter = buffer.begin();
-
-  // XXX #warning "unsafe time packing"
-  iter = std::copy(reinterpret_cast<const unsigned char*>(&stamp),
-                   reinterpret_cast<const unsigned char*>(&stamp) + sizeof(stamp),
-                   iter);
+  iter = packStamp(stamp, iter);
   iter = std::copy(id.begin(),
                    id.end(),
                    iter);
@@ -62,7 +62,7 @@ public:
 
   void print(std::ostream& /*stream = std::cout*/) const override {}
 
-  ceres::LossFunction* lossFunction() const override
+  ceres::LossFunction* createLossFunction() const override
   {
     return new ceres::HuberLoss(a);
   }
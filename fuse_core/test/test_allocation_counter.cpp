@@ -0,0 +1,121 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/allocation_counter.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Count the allocations of this test executable
+FUSE_ALLOCATION_COUNTING_HOOKS()
+
+
+TEST(AllocationCounter, Enabled)
+{
+  EXPECT_TRUE(fuse_core::allocationCountingEnabled());
+  EXPECT_EQ(fuse_core::AllocationCounting::OPERATOR_NEW, fuse_core::allocationCounting());
+}
+
+TEST(AllocationCounter, CountsAllocationsAndBytes)
+{
+  fuse_core::AllocationCounter counter;
+  auto value = std::make_unique<double>(1.0);
+  auto values = std::make_unique<double[]>(8);
+  const auto count = counter.elapsed();
+
+  EXPECT_EQ(2u, count.allocations);
+  EXPECT_EQ(9 * sizeof(double), count.bytes);
+}
+
+#if defined(__cpp_aligned_new)
+TEST(AllocationCounter, CountsOverAlignedAllocations)
+{
+  struct alignas(64) OverAligned
+  {
+    double values[16];
+  };
+
+  fuse_core::AllocationCounter counter;
+  auto value = std::make_unique<OverAligned>();
+  const auto count = counter.elapsed();
+
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(value.get()) % 64);
+  EXPECT_EQ(1u, count.allocations);
+  EXPECT_EQ(sizeof(OverAligned), count.bytes);
+}
+#endif
+
+TEST(AllocationCounter, Restart)
+{
+  fuse_core::AllocationCounter counter;
+  std::vector<int> stage1(4);
+  const auto stage1_count = counter.restart();
+  const auto stage2_count = counter.restart();
+  std::vector<int> stage3(16);
+  const auto stage3_count = counter.restart();
+
+  EXPECT_EQ(1u, stage1_count.allocations);
+  EXPECT_EQ(4 * sizeof(int), stage1_count.bytes);
+  EXPECT_EQ(0u, stage2_count.allocations);
+  EXPECT_EQ(0u, stage2_count.bytes);
+  EXPECT_EQ(1u, stage3_count.allocations);
+  EXPECT_EQ(16 * sizeof(int), stage3_count.bytes);
+}
+
+TEST(AllocationCounter, IgnoresOtherThreads)
+{
+  fuse_core::AllocationCounter counter;
+  auto other_thread_count = fuse_core::AllocationCount();
+  std::thread thread([&other_thread_count]()
+    {
+      fuse_core::AllocationCounter thread_counter;
+      std::vector<double> values(32);
+      other_thread_count = thread_counter.elapsed();
+    });  // NOLINT(whitespace/braces)
+  thread.join();
+
+  EXPECT_EQ(1u, other_thread_count.allocations);
+  EXPECT_EQ(32 * sizeof(double), other_thread_count.bytes);
+  // Only the thread state is allocated by this thread
+  EXPECT_GT(other_thread_count.bytes, counter.elapsed().bytes);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -36,6 +36,11 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <iterator>
+#include <utility>
+#include <vector>
+
 
 /**
  * @brief Flag used to track the execution of the transaction callback
@@ -118,6 +123,104 @@ TEST(AsyncSensorModel, SendTransaction)
   EXPECT_TRUE(received_transaction);
 }
 
+/**
+ * @brief Derived AsyncSensorModel that merges every three transactions into one
+ */
+class MyBatchedSensor : public fuse_core::AsyncSensorModel
+{
+public:
+  MyBatchedSensor() :
+    fuse_core::AsyncSensorModel(1)
+  {
+  }
+
+  virtual ~MyBatchedSensor() = default;
+
+  void onInit() override
+  {
+    batchTransactions(3, std::chrono::nanoseconds(0));
+  }
+
+  void onStop() override
+  {
+    // Send one last transaction while stopping
+    auto transaction = fuse_core::Transaction::make_shared();
+    transaction->stamp(ros::Time(10, 0));
+    sendTransaction(transaction);
+  }
+};
+
+TEST(AsyncSensorModel, SendTransactionBatched)
+{
+  std::vector<fuse_core::Transaction::SharedPtr> received;
+  MyBatchedSensor sensor;
+  sensor.initialize("my_batched_sensor", [&received](fuse_core::Transaction::SharedPtr transaction)
+  {
+    received.push_back(std::move(transaction));
+  });  // NOLINT(whitespace/braces)
+
+  std::vector<fuse_core::Transaction::SharedPtr> sent;
+  for (int i = 1; i <= 5; ++i)
+  {
+    auto transaction = fuse_core::Transaction::make_shared();
+    transaction->stamp(ros::Time(i, 0));
+    transaction->addInvolvedStamp(ros::Time(i, 0));
+    sensor.sendTransaction(transaction);
+    sent.push_back(transaction);
+  }
+
+  // The first three transactions are merged and sent together. The rest are pending.
+  ASSERT_EQ(1u, received.size());
+  EXPECT_EQ(ros::Time(3, 0), received[0]->stamp());
+  auto involved_stamps = received[0]->involvedStamps();
+  ASSERT_EQ(3, std::distance(involved_stamps.begin(), involved_stamps.end()));
+  EXPECT_EQ(ros::Time(1, 0), *involved_stamps.begin());
+
+  // The transactions passed to sendTransaction() are not modified
+  auto first_stamps = sent[0]->involvedStamps();
+  EXPECT_EQ(1, std::distance(first_stamps.begin(), first_stamps.end()));
+
+  sensor.flushTransactions();
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(ros::Time(5, 0), received[1]->stamp());
+  involved_stamps = received[1]->involvedStamps();
+  EXPECT_EQ(2, std::distance(involved_stamps.begin(), involved_stamps.end()));
+
+  // Flushing with nothing pending sends nothing
+  sensor.flushTransactions();
+  EXPECT_EQ(2u, received.size());
+}
+
+TEST(AsyncSensorModel, StopStartBatched)
+{
+  std::vector<fuse_core::Transaction::SharedPtr> received;
+  MyBatchedSensor sensor;
+  sensor.initialize("my_batched_sensor", [&received](fuse_core::Transaction::SharedPtr transaction)
+  {
+    received.push_back(std::move(transaction));
+  });  // NOLINT(whitespace/braces)
+  sensor.start();
+
+  auto transaction = fuse_core::Transaction::make_shared();
+  transaction->stamp(ros::Time(1, 0));
+  sensor.sendTransaction(transaction);
+  EXPECT_TRUE(received.empty());
+
+  // The pending batch is sent before onStop(), and the transaction sent from onStop() is sent after it
+  sensor.stop();
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(ros::Time(1, 0), received[0]->stamp());
+  EXPECT_EQ(ros::Time(10, 0), received[1]->stamp());
+
+  // A batch left pending while stopped is dropped on start
+  transaction = fuse_core::Transaction::make_shared();
+  transaction->stamp(ros::Time(2, 0));
+  sensor.sendTransaction(transaction);
+  sensor.start();
+  sensor.flushTransactions();
+  EXPECT_EQ(2u, received.size());
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,426 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/allocation_counter.h>
+#include <fuse_core/callback_wrapper.h>
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Count the allocations of this test executable, to verify the pooled callbacks are recycled
+FUSE_ALLOCATION_COUNTING_HOOKS()
+
+
+/**
+ * @brief Run the pending callbacks on the calling thread, as an executor would
+ */
+void execute(fuse_core::CallbackAdapter& queue)
+{
+  auto data = queue.take_data();
+  queue.execute(data);
+}
+
+TEST(CallbackAdapter, ExecutesInOrder)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+  EXPECT_FALSE(queue.is_ready(nullptr));
+
+  std::vector<int> executed;
+  for (int i = 0; i < 100; ++i)
+  {
+    queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>([&executed, i]() { executed.push_back(i); }));
+  }
+  EXPECT_TRUE(queue.is_ready(nullptr));
+  EXPECT_TRUE(executed.empty());
+
+  execute(queue);
+  EXPECT_FALSE(queue.is_ready(nullptr));
+  ASSERT_EQ(100u, executed.size());
+  for (int i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(i, executed[i]);
+  }
+}
+
+TEST(CallbackAdapter, ResumesAfterException)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  std::vector<int> executed;
+  auto add = [&queue, &executed](const int i)
+  {
+    queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>([&executed, i]() { executed.push_back(i); }));
+  };  // NOLINT(whitespace/braces)
+  add(0);
+  queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>([]() { throw std::runtime_error("test"); }));
+  add(1);
+  add(2);
+
+  // The exception reaches the executor, and the rest of the batch is kept
+  EXPECT_THROW(execute(queue), std::runtime_error);
+  EXPECT_EQ(std::vector<int>({0}), executed);
+  EXPECT_TRUE(queue.is_ready(nullptr));
+
+  // A callback added in between runs after the rest of the interrupted batch
+  add(3);
+  execute(queue);
+  execute(queue);
+  EXPECT_FALSE(queue.is_ready(nullptr));
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), executed);
+}
+
+TEST(CallbackAdapter, RemoveAllCallbacks)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  auto executed = 0;
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 3; ++i)
+  {
+    auto callback = std::make_shared<fuse_core::CallbackWrapper<void>>([&executed]() { ++executed; });
+    futures.push_back(callback->getFuture());
+    queue.addCallback(std::move(callback));
+  }
+
+  // The discarded callbacks are destroyed without being called, which breaks their promises
+  queue.removeAllCallbacks();
+  EXPECT_FALSE(queue.is_ready(nullptr));
+  execute(queue);
+  EXPECT_EQ(0, executed);
+  for (auto& future : futures)
+  {
+    try
+    {
+      future.get();
+      FAIL() << "The future of a discarded callback should not be satisfied.";
+    }
+    catch (const std::future_error& ex)
+    {
+      EXPECT_EQ(std::future_errc::broken_promise, ex.code());
+    }
+  }
+
+  // The queue is still usable
+  queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>([&executed]() { ++executed; }));
+  execute(queue);
+  EXPECT_EQ(1, executed);
+}
+
+TEST(CallbackAdapter, AddDuringExecute)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  // A callback added while a batch runs is left for the next call
+  std::vector<int> executed;
+  queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>(
+    [&queue, &executed]()
+    {
+      executed.push_back(0);
+      queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>([&executed]() { executed.push_back(2); }));
+    }));  // NOLINT(whitespace/braces)
+  queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>([&executed]() { executed.push_back(1); }));
+
+  execute(queue);
+  EXPECT_EQ(std::vector<int>({0, 1}), executed);
+  EXPECT_TRUE(queue.is_ready(nullptr));
+
+  execute(queue);
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), executed);
+  EXPECT_FALSE(queue.is_ready(nullptr));
+}
+
+TEST(CallbackAdapter, ConcurrentProducers)
+{
+  // Several threads add callbacks while this thread drains the queue. Every callback must run exactly once, and the
+  // callbacks of each producer must run in the order that producer added them.
+  const int producer_count = 4;
+  const int callbacks_per_producer = 10000;
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  std::vector<std::vector<int>> executed(producer_count);
+  std::atomic<int> executed_count{ 0 };
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < producer_count; ++producer)
+  {
+    producers.emplace_back(
+      [&queue, &executed, &executed_count, producer, callbacks_per_producer]()
+      {
+        for (int i = 0; i < callbacks_per_producer; ++i)
+        {
+          queue.addCallback(std::make_shared<fuse_core::CallbackWrapper<void>>(
+            [&executed, &executed_count, producer, i]()
+            {
+              executed[producer].push_back(i);
+              ++executed_count;
+            }));  // NOLINT(whitespace/braces)
+        }
+      });  // NOLINT(whitespace/braces)
+  }
+
+  while (executed_count < producer_count * callbacks_per_producer)
+  {
+    if (queue.is_ready(nullptr))
+    {
+      execute(queue);
+    }
+  }
+  for (auto& producer : producers)
+  {
+    producer.join();
+  }
+
+  EXPECT_FALSE(queue.is_ready(nullptr));
+  for (int producer = 0; producer < producer_count; ++producer)
+  {
+    ASSERT_EQ(static_cast<size_t>(callbacks_per_producer), executed[producer].size());
+    for (int i = 0; i < callbacks_per_producer; ++i)
+    {
+      ASSERT_EQ(i, executed[producer][i]);
+    }
+  }
+}
+
+TEST(CallbackAdapter, ConcurrentExecutors)
+{
+  // Two executor threads share the queue while another thread adds callbacks. A thread woken for new callbacks while
+  // the other one drains the queue must not leave them pending without waking the executor again.
+  const int callback_count = 10000;
+  auto node = rclcpp::Node::make_shared("test_callback_adapter_concurrent_executors");
+  auto queue = std::make_shared<fuse_core::CallbackAdapter>(rclcpp::contexts::get_global_default_context());
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  node->get_node_waitables_interface()->add_waitable(queue, group);
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2);
+  executor.add_node(node);
+  std::thread spinner([&executor]() { executor.spin(); });
+
+  std::atomic<int> executed_count{ 0 };
+  std::thread producer(
+    [&queue, &executed_count, callback_count]()
+    {
+      for (int i = 0; i < callback_count; ++i)
+      {
+        queue->postCallback(
+          [&executed_count, i]()
+          {
+            // Keep the draining thread busy now and then, so the other executor thread finds the queue locked
+            if (i % 100 == 0)
+            {
+              std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            ++executed_count;
+          });  // NOLINT(whitespace/braces)
+      }
+    });  // NOLINT(whitespace/braces)
+  producer.join();
+
+  // Nothing else wakes the executor, so a lost wakeup leaves callbacks pending until the deadline
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (executed_count < callback_count && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  executor.cancel();
+  spinner.join();
+  EXPECT_EQ(callback_count, executed_count);
+}
+
+/**
+ * @brief Run the pending callbacks on the calling thread until the future is ready
+ */
+template <typename T>
+void executeUntilReady(fuse_core::CallbackAdapter& queue, std::future<T>& future)
+{
+  while (future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+  {
+    if (queue.is_ready(nullptr))
+    {
+      execute(queue);
+    }
+  }
+}
+
+TEST(CallbackAdapter, PostCallbackReusesPool)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  // The first callbacks grow the pool to the number of callbacks pending at once
+  auto executed = 0;
+  auto token = std::make_shared<int>(0);
+  for (int i = 0; i < 3; ++i)
+  {
+    queue.postCallback([&executed, token]() { ++executed; });
+  }
+  execute(queue);
+  EXPECT_EQ(3, executed);
+  EXPECT_EQ(1, token.use_count());
+
+  // Later callbacks reuse the same wrappers, so posting and executing them does not allocate
+  fuse_core::AllocationCounter counter;
+  for (int i = 0; i < 3; ++i)
+  {
+    queue.postCallback([&executed, token]() { ++executed; });
+  }
+  execute(queue);
+  EXPECT_EQ(0u, counter.elapsed().allocations);
+  EXPECT_EQ(6, executed);
+
+  // The stored functions are destroyed once they have been called, or discarded
+  EXPECT_EQ(1, token.use_count());
+  queue.postCallback([&executed, token]() { ++executed; });
+  EXPECT_EQ(2, token.use_count());
+  queue.removeAllCallbacks();
+  execute(queue);
+  EXPECT_EQ(6, executed);
+  EXPECT_EQ(1, token.use_count());
+}
+
+TEST(CallbackAdapter, PostCallbackLargeFunction)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  // Warm up the pool
+  auto executed = 0;
+  queue.postCallback([&executed]() { ++executed; });
+  execute(queue);
+
+  // A function larger than the pooled storage falls back to a heap-allocated wrapper
+  std::array<double, 16> values;
+  values.fill(1.0);
+  auto sum = 0.0;
+  auto large = [values, &sum]()
+  {
+    for (const auto value : values)
+    {
+      sum += value;
+    }
+  };  // NOLINT(whitespace/braces)
+  static_assert(sizeof(large) > 64, "The function must not fit in the pooled storage");
+
+  fuse_core::AllocationCounter counter;
+  queue.postCallback(large);
+  EXPECT_LT(0u, counter.restart().allocations);
+  execute(queue);
+  EXPECT_EQ(16.0, sum);
+
+  // A small function still uses the pool
+  counter.restart();
+  queue.postCallback([&executed]() { ++executed; });
+  execute(queue);
+  EXPECT_EQ(0u, counter.elapsed().allocations);
+  EXPECT_EQ(2, executed);
+}
+
+TEST(CallbackAdapter, InvokeCallback)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  auto executing_thread = std::this_thread::get_id();
+  auto result = std::async(
+    std::launch::async,
+    [&queue, &executing_thread]()
+    {
+      return queue.invokeCallback(
+        [&executing_thread]()
+        {
+          executing_thread = std::this_thread::get_id();
+          return 42;
+        });  // NOLINT(whitespace/braces)
+    });  // NOLINT(whitespace/braces)
+  executeUntilReady(queue, result);
+
+  EXPECT_EQ(42, result.get());
+  EXPECT_EQ(std::this_thread::get_id(), executing_thread);
+}
+
+TEST(CallbackAdapter, InvokeCallbackException)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  // The exception is rethrown in the invoking thread, not in the executor
+  auto result = std::async(
+    std::launch::async,
+    [&queue]()
+    {
+      queue.invokeCallback([]() { throw std::runtime_error("test"); });
+    });  // NOLINT(whitespace/braces)
+  EXPECT_NO_THROW(executeUntilReady(queue, result));
+  EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+TEST(CallbackAdapter, InvokeCallbackDiscarded)
+{
+  fuse_core::CallbackAdapter queue(rclcpp::contexts::get_global_default_context());
+
+  auto executed = false;
+  auto result = std::async(
+    std::launch::async,
+    [&queue, &executed]()
+    {
+      queue.invokeCallback([&executed]() { executed = true; });
+    });  // NOLINT(whitespace/braces)
+
+  // Discard the callback once it is pending. The invoking thread is released with a broken promise.
+  while (!queue.is_ready(nullptr))
+  {
+    std::this_thread::yield();
+  }
+  queue.removeAllCallbacks();
+  try
+  {
+    result.get();
+    FAIL() << "invokeCallback() should throw when its callback is discarded.";
+  }
+  catch (const std::future_error& ex)
+  {
+    EXPECT_EQ(std::future_errc::broken_promise, ex.code());
+  }
+  EXPECT_FALSE(executed);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  int ret = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return ret;
+}
@@ -0,0 +1,108 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/covariance_blocks.h>
+#include <fuse_core/uuid.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+TEST(CovarianceBlocks, InsertAndAccess)
+{
+  auto uuid1 = fuse_core::uuid::generate();
+  auto uuid2 = fuse_core::uuid::generate();
+
+  fuse_core::CovarianceBlocks covariance_blocks;
+  EXPECT_TRUE(covariance_blocks.empty());
+  EXPECT_FALSE(covariance_blocks.contains(uuid1, uuid1));
+
+  covariance_blocks.insert(uuid1, uuid1, {1.0, 2.0, 3.0, 4.0});
+  covariance_blocks.insert(uuid1, uuid2, {5.0, 6.0});
+  EXPECT_FALSE(covariance_blocks.empty());
+  EXPECT_EQ(2u, covariance_blocks.size());
+  EXPECT_TRUE(covariance_blocks.contains(uuid1, uuid1));
+  EXPECT_TRUE(covariance_blocks.contains(uuid1, uuid2));
+  // The blocks are stored exactly as requested; Cov(Y,X) is a different block than Cov(X,Y)
+  EXPECT_FALSE(covariance_blocks.contains(uuid2, uuid1));
+
+  EXPECT_EQ(std::vector<double>({1.0, 2.0, 3.0, 4.0}), covariance_blocks.at(uuid1, uuid1));
+  EXPECT_EQ(std::vector<double>({5.0, 6.0}), covariance_blocks.at(uuid1, uuid2));
+  EXPECT_THROW(covariance_blocks.at(uuid2, uuid1), std::out_of_range);
+
+  // Inserting an existing block replaces it
+  covariance_blocks.insert(uuid1, uuid2, {7.0, 8.0});
+  EXPECT_EQ(2u, covariance_blocks.size());
+  EXPECT_EQ(std::vector<double>({7.0, 8.0}), covariance_blocks.at(uuid1, uuid2));
+}
+
+TEST(CovarianceBlocks, Get)
+{
+  auto uuid1 = fuse_core::uuid::generate();
+  auto uuid2 = fuse_core::uuid::generate();
+
+  fuse_core::CovarianceBlocks covariance_blocks;
+  covariance_blocks.insert(uuid1, uuid1, {1.0});
+  covariance_blocks.insert(uuid1, uuid2, {2.0});
+
+  // All requested blocks are available
+  {
+    std::vector<fuse_core::CovarianceBlocks::Request> requests;
+    requests.emplace_back(uuid1, uuid2);
+    requests.emplace_back(uuid1, uuid1);
+    std::vector<std::vector<double>> covariance_matrices;
+    ASSERT_TRUE(covariance_blocks.get(requests, covariance_matrices));
+    ASSERT_EQ(2u, covariance_matrices.size());
+    EXPECT_EQ(std::vector<double>({2.0}), covariance_matrices[0]);
+    EXPECT_EQ(std::vector<double>({1.0}), covariance_matrices[1]);
+  }
+
+  // A missing block leaves the output untouched
+  {
+    std::vector<fuse_core::CovarianceBlocks::Request> requests;
+    requests.emplace_back(uuid1, uuid1);
+    requests.emplace_back(uuid2, uuid2);
+    std::vector<std::vector<double>> covariance_matrices;
+    EXPECT_FALSE(covariance_blocks.get(requests, covariance_matrices));
+    EXPECT_TRUE(covariance_matrices.empty());
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,334 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/flat_serialization.h>
+#include <fuse_core/serialization.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <rclcpp/time.hpp>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <boost/iostreams/stream.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using fuse_core::Transaction;
+using fuse_core::UUID;
+
+
+/**
+ * @brief Variable with a caller-provided UUID, so it can be rebuilt by a flat codec
+ */
+class CodecVariable : public fuse_core::Variable
+{
+public:
+  FUSE_VARIABLE_DEFINITIONS(CodecVariable);
+
+  CodecVariable() = default;
+
+  explicit CodecVariable(const UUID& uuid) :
+    fuse_core::Variable(uuid)
+  {
+  }
+
+  size_t size() const override { return 2; }
+  const double* data() const override { return data_; };
+  double* data() override { return data_; };
+  void print(std::ostream& /*stream = std::cout*/) const override {}
+
+private:
+  double data_[2] = { 0.0, 0.0 };
+
+  // Allow Boost Serialization access to private methods
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& archive, const unsigned int /* version */)
+  {
+    archive & boost::serialization::base_object<fuse_core::Variable>(*this);
+    archive & data_;
+  }
+};
+
+BOOST_CLASS_EXPORT(CodecVariable);
+
+/**
+ * @brief Flat codec for CodecVariable. The UUID and values are in the fixed part of the record, so the payload only
+ *        holds a marker used to check that the codec was called.
+ */
+class CodecVariableCodec : public fuse_core::flat::VariableCodec
+{
+public:
+  static constexpr uint32_t MARKER = 0xC0DEC0DE;
+
+  void write(const fuse_core::Variable& /* variable */, fuse_core::flat::PayloadWriter& payload) const override
+  {
+    payload.write(MARKER);
+  }
+
+  fuse_core::Variable::SharedPtr read(const fuse_core::flat::VariableView& view) const override
+  {
+    auto payload = view.payload();
+    if (payload.read<uint32_t>() != MARKER)
+    {
+      throw std::runtime_error("Unexpected CodecVariable payload");
+    }
+    auto variable = CodecVariable::make_shared(view.uuid());
+    std::copy(view.data(), view.data() + view.size(), variable->data());
+    return variable;
+  }
+};
+
+constexpr uint32_t CodecVariableCodec::MARKER;
+
+FUSE_FLAT_VARIABLE_CODEC_EXPORT(CodecVariable, CodecVariableCodec)
+
+/**
+ * @brief Create the test types by name, as the deserializers do with pluginlib
+ */
+fuse_core::flat::ObjectFactory exampleFactory()
+{
+  fuse_core::flat::ObjectFactory factory;
+  factory.create_variable = [](const std::string& type) -> fuse_core::Variable::UniquePtr
+  {
+    if (type == ExampleVariable::detail::type())
+    {
+      return ExampleVariable::make_unique();
+    }
+    throw std::runtime_error("Unknown variable type " + type);
+  };  // NOLINT(whitespace/braces)
+  factory.create_constraint = [](const std::string& type) -> fuse_core::Constraint::UniquePtr
+  {
+    if (type == ExampleConstraint::detail::type())
+    {
+      return ExampleConstraint::make_unique();
+    }
+    throw std::runtime_error("Unknown constraint type " + type);
+  };  // NOLINT(whitespace/braces)
+  return factory;
+}
+
+/**
+ * @brief Build a transaction exercising every section of the flat format
+ */
+Transaction exampleTransaction()
+{
+  auto variable1 = ExampleVariable::make_shared();
+  variable1->data()[0] = 1.5;
+  auto variable2 = CodecVariable::make_shared(fuse_core::uuid::generate());
+  variable2->data()[0] = 2.5;
+  variable2->data()[1] = -3.5;
+
+  auto constraint1 = ExampleConstraint::make_shared("source1", std::initializer_list<UUID>{variable1->uuid()});  // NOLINT
+  constraint1->data = 4.5;
+  auto constraint2 = ExampleConstraint::make_shared(
+    "source2",
+    std::initializer_list<UUID>{variable1->uuid(), variable2->uuid()});  // NOLINT
+
+  Transaction transaction;
+  transaction.stamp(rclcpp::Time(12347, 0));
+  transaction.addInvolvedStamp(rclcpp::Time(12345, 6789));
+  transaction.addInvolvedStamp(rclcpp::Time(12346, 6789));
+  transaction.addVariable(variable1);
+  transaction.addVariable(variable2);
+  transaction.addConstraint(constraint1);
+  transaction.addConstraint(constraint2);
+  transaction.removeVariable(fuse_core::uuid::generate());
+  transaction.removeConstraint(fuse_core::uuid::generate());
+  transaction.removeConstraint(fuse_core::uuid::generate());
+  return transaction;
+}
+
+TEST(FlatSerialization, TransactionRoundTrip)
+{
+  const Transaction expected = exampleTransaction();
+
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeTransaction(expected, data);
+  ASSERT_TRUE(fuse_core::flat::isFlatBuffer(data));
+
+  const Transaction actual =
+    fuse_core::flat::deserializeTransaction(fuse_core::flat::BufferReader(data), exampleFactory());
+
+  EXPECT_EQ(expected.stamp(), actual.stamp());
+  EXPECT_TRUE(std::equal(
+    expected.involvedStamps().begin(), expected.involvedStamps().end(),
+    actual.involvedStamps().begin(), actual.involvedStamps().end()));
+  EXPECT_TRUE(std::equal(
+    expected.removedVariables().begin(), expected.removedVariables().end(),
+    actual.removedVariables().begin(), actual.removedVariables().end()));
+  EXPECT_TRUE(std::equal(
+    expected.removedConstraints().begin(), expected.removedConstraints().end(),
+    actual.removedConstraints().begin(), actual.removedConstraints().end()));
+
+  auto expected_variable = expected.addedVariables().begin();
+  auto actual_variable = actual.addedVariables().begin();
+  for (; expected_variable != expected.addedVariables().end(); ++expected_variable, ++actual_variable)
+  {
+    ASSERT_NE(actual.addedVariables().end(), actual_variable);
+    EXPECT_EQ(expected_variable->uuid(), actual_variable->uuid());
+    EXPECT_EQ(expected_variable->type(), actual_variable->type());
+    ASSERT_EQ(expected_variable->size(), actual_variable->size());
+    for (size_t i = 0; i < expected_variable->size(); ++i)
+    {
+      EXPECT_EQ(expected_variable->data()[i], actual_variable->data()[i]);
+    }
+  }
+  EXPECT_EQ(actual.addedVariables().end(), actual_variable);
+
+  auto expected_constraint = expected.addedConstraints().begin();
+  auto actual_constraint = actual.addedConstraints().begin();
+  for (; expected_constraint != expected.addedConstraints().end(); ++expected_constraint, ++actual_constraint)
+  {
+    ASSERT_NE(actual.addedConstraints().end(), actual_constraint);
+    EXPECT_EQ(expected_constraint->uuid(), actual_constraint->uuid());
+    EXPECT_EQ(expected_constraint->source(), actual_constraint->source());
+    EXPECT_EQ(expected_constraint->variables(), actual_constraint->variables());
+    EXPECT_EQ(
+      dynamic_cast<const ExampleConstraint&>(*expected_constraint).data,
+      dynamic_cast<const ExampleConstraint&>(*actual_constraint).data);
+  }
+  EXPECT_EQ(actual.addedConstraints().end(), actual_constraint);
+}
+
+TEST(FlatSerialization, ReadInPlace)
+{
+  const Transaction transaction = exampleTransaction();
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeTransaction(transaction, data);
+
+  fuse_core::flat::BufferReader reader(data);
+  EXPECT_EQ(fuse_core::flat::Content::TRANSACTION, reader.content());
+  EXPECT_EQ(transaction.stamp(), reader.stamp());
+  ASSERT_EQ(2u, reader.involvedStampCount());
+  EXPECT_EQ(fuse_core::TimeStamp(rclcpp::Time(12345, 6789)), reader.involvedStamp(0));
+  EXPECT_EQ(1u, reader.removedVariableCount());
+  EXPECT_EQ(2u, reader.removedConstraintCount());
+
+  ASSERT_EQ(2u, reader.variableCount());
+  const auto example_variable = reader.variable(0);
+  EXPECT_EQ(transaction.addedVariables().begin()->uuid(), example_variable.uuid());
+  EXPECT_EQ(ExampleVariable::detail::type(), example_variable.type());
+  ASSERT_EQ(1u, example_variable.size());
+  EXPECT_EQ(1.5, example_variable.data()[0]);
+  EXPECT_FALSE(example_variable.onHold());
+  EXPECT_EQ(fuse_core::flat::PayloadEncoding::BOOST_BINARY, example_variable.payloadEncoding());
+
+  // Registered types are written with their codec
+  const auto codec_variable = reader.variable(1);
+  EXPECT_EQ(CodecVariable::detail::type(), codec_variable.type());
+  ASSERT_EQ(2u, codec_variable.size());
+  EXPECT_EQ(2.5, codec_variable.data()[0]);
+  EXPECT_EQ(-3.5, codec_variable.data()[1]);
+  EXPECT_EQ(fuse_core::flat::PayloadEncoding::CODEC, codec_variable.payloadEncoding());
+  EXPECT_EQ(sizeof(uint32_t), codec_variable.payload().remaining());
+
+  ASSERT_EQ(2u, reader.constraintCount());
+  const auto constraint = reader.constraint(1);
+  EXPECT_EQ(ExampleConstraint::detail::type(), constraint.type());
+  EXPECT_EQ("source2", constraint.source());
+  ASSERT_EQ(2u, constraint.variableCount());
+  EXPECT_EQ(example_variable.uuid(), constraint.variable(0));
+  EXPECT_EQ(codec_variable.uuid(), constraint.variable(1));
+}
+
+TEST(FlatSerialization, ObjectReaderOrder)
+{
+  const Transaction transaction = exampleTransaction();
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeTransaction(transaction, data);
+  fuse_core::flat::BufferReader reader(data);
+  const auto factory = exampleFactory();
+
+  // Objects stored in the Boost section may be skipped, but not read out of order
+  fuse_core::flat::ObjectReader objects(reader, factory);
+  auto constraint = objects.constraint(1);
+  EXPECT_EQ(reader.constraint(1).uuid(), constraint->uuid());
+  EXPECT_THROW(objects.constraint(0), std::runtime_error);
+  EXPECT_THROW(objects.variable(0), std::runtime_error);
+
+  // Objects written with a codec may be read at any time
+  auto variable = objects.variable(1);
+  EXPECT_EQ(reader.variable(1).uuid(), variable->uuid());
+}
+
+TEST(FlatSerialization, Malformed)
+{
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeTransaction(exampleTransaction(), data);
+
+  // Truncated buffers are rejected before any record is accessed
+  std::vector<uint8_t> truncated(data.begin(), data.begin() + data.size() / 2);
+  EXPECT_THROW(fuse_core::flat::BufferReader reader(truncated), std::runtime_error);
+
+  // A Boost archive is not mistaken for a flat buffer
+  std::vector<uint8_t> boost_data;
+  {
+    boost::iostreams::stream<fuse_core::MessageBufferStreamSink> stream(boost_data);
+    fuse_core::BinaryOutputArchive archive(stream);
+    exampleTransaction().serialize(archive);
+  }
+  EXPECT_FALSE(fuse_core::flat::isFlatBuffer(boost_data));
+  EXPECT_THROW(fuse_core::flat::BufferReader reader(boost_data), std::runtime_error);
+
+  // Buffers written by a different format version are rejected
+  std::vector<uint8_t> other_version = data;
+  other_version[offsetof(fuse_core::flat::BufferHeader, version)] += 1;
+  EXPECT_THROW(fuse_core::flat::BufferReader reader(other_version), std::runtime_error);
+
+  // Counts that cannot fit in the buffer are rejected without allocating memory for them
+  const uint32_t huge_count = 0xFFFFFFFF;
+  for (const auto field : { offsetof(fuse_core::flat::BufferHeader, string_count),
+                            offsetof(fuse_core::flat::BufferHeader, variable_count),
+                            offsetof(fuse_core::flat::BufferHeader, constraint_count) })
+  {
+    std::vector<uint8_t> huge = data;
+    std::memcpy(huge.data() + field, &huge_count, sizeof(huge_count));
+    EXPECT_THROW(fuse_core::flat::BufferReader reader(huge), std::runtime_error);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
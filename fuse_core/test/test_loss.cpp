@@ -35,6 +35,8 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+
 
 TEST(Loss, Constructor)
 {
@@ -45,11 +47,27 @@ TEST(Loss, Constructor)
   auto loss_function = loss.lossFunction();
 
   ASSERT_NE(nullptr, loss_function);
+}
+
+TEST(Loss, LossFunctionCache)
+{
+  ExampleLoss loss(0.3);
+
+  // The ceres::LossFunction is created once and shared
+  auto loss_function = loss.lossFunction();
+  ASSERT_NE(nullptr, loss_function);
+  EXPECT_EQ(loss_function, loss.lossFunction());
+
+  // Copies create their own ceres::LossFunction
+  auto clone = loss.clone();
+  ASSERT_NE(nullptr, clone->lossFunction());
+  EXPECT_NE(loss_function, clone->lossFunction());
+  EXPECT_EQ(loss_function, loss.lossFunction());
 
-  if (fuse_core::Loss::Ownership == ceres::Ownership::TAKE_OWNERSHIP)
-  {
-    delete loss_function;
-  }
+  // Fresh instances are owned by the caller and never alias the cached one
+  std::unique_ptr<ceres::LossFunction> created(loss.createLossFunction());
+  ASSERT_NE(nullptr, created);
+  EXPECT_NE(loss_function, created.get());
 }
 
 int main(int argc, char **argv)
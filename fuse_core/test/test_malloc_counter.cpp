@@ -0,0 +1,105 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/allocation_counter.h>
+
+#include <Eigen/Core>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// Count every heap allocation of this test executable
+FUSE_MALLOC_COUNTING_HOOKS()
+
+
+TEST(MallocCounter, Enabled)
+{
+#if defined(__GLIBC__)
+  EXPECT_EQ(fuse_core::AllocationCounting::MALLOC, fuse_core::allocationCounting());
+#else
+  EXPECT_EQ(fuse_core::AllocationCounting::OPERATOR_NEW, fuse_core::allocationCounting());
+#endif
+}
+
+#if defined(__GLIBC__)
+TEST(MallocCounter, CountsMallocFamily)
+{
+  fuse_core::AllocationCounter counter;
+  void* a = std::malloc(16);
+  void* b = std::calloc(4, 8);
+  a = std::realloc(a, 64);
+  void* c = nullptr;
+  EXPECT_EQ(0, posix_memalign(&c, 64, 128));
+  void* d = aligned_alloc(32, 64);
+  const auto count = counter.elapsed();
+  std::free(a);
+  std::free(b);
+  std::free(c);
+  std::free(d);
+
+  EXPECT_EQ(5u, count.allocations);
+  EXPECT_EQ(16u + 32u + 64u + 128u + 64u, count.bytes);
+  // Freeing is not an allocation
+  EXPECT_EQ(count.allocations, counter.elapsed().allocations);
+}
+
+TEST(MallocCounter, CountsOperatorNew)
+{
+  fuse_core::AllocationCounter counter;
+  auto value = std::make_unique<double>(1.0);
+  std::vector<int> values(8);
+  const auto count = counter.elapsed();
+
+  EXPECT_EQ(2u, count.allocations);
+  EXPECT_EQ(sizeof(double) + 8 * sizeof(int), count.bytes);
+}
+
+TEST(MallocCounter, CountsEigenDynamicMatrices)
+{
+  fuse_core::AllocationCounter counter;
+  Eigen::MatrixXd matrix(6, 10);
+  matrix.setZero();
+  const auto count = counter.elapsed();
+
+  EXPECT_EQ(1u, count.allocations);
+  EXPECT_LE(60 * sizeof(double), count.bytes);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -279,6 +279,41 @@ TEST_F(TimestampManagerTestFixture, Purge)
   }
 }
 
+TEST_F(TimestampManagerTestFixture, PurgeHighRate)
+{
+  // Stream many stamps through a short buffer, so purged segments accumulate and are compacted several times
+  manager.bufferLength(ros::Duration(0.1));
+  for (uint32_t i = 1; i <= 1000; ++i)
+  {
+    const auto stamp = ros::Time(1 + i / 1000, (i % 1000) * 1000000);
+    fuse_core::Transaction transaction;
+    transaction.addInvolvedStamp(stamp);
+    manager.query(transaction);
+
+    // Split the newest segment every few queries
+    if (i % 7 == 0)
+    {
+      fuse_core::Transaction split_transaction;
+      split_transaction.addInvolvedStamp(stamp - ros::Duration(0, 500000));
+      manager.query(split_transaction);
+    }
+  }
+
+  // The stamps are sorted and span the buffer length, measured to the ending stamp of the oldest segment
+  auto stamp_range = manager.stamps();
+  ASSERT_LT(1, std::distance(stamp_range.begin(), stamp_range.end()));
+  auto previous_iter = stamp_range.begin();
+  for (auto iter = std::next(previous_iter); iter != stamp_range.end(); ++previous_iter, ++iter)
+  {
+    EXPECT_LT(*previous_iter, *iter);
+  }
+  EXPECT_EQ(ros::Time(2, 0), *previous_iter);
+  EXPECT_LE(*previous_iter - *std::next(stamp_range.begin()), ros::Duration(0.1));
+
+  // One segment is generated per new stamp, and two per split
+  EXPECT_EQ(1000ul + 2ul * (1000ul / 7ul), generated_time_spans.size());
+}
+
 TEST_F(TimestampManagerTestFixture, Existing)
 {
   // Test:
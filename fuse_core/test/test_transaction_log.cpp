@@ -0,0 +1,229 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/flat_serialization.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/transaction_log.h>
+#include <fuse_core/uuid.h>
+#include <rclcpp/time.hpp>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using fuse_core::Transaction;
+using fuse_core::TransactionLogEntry;
+using fuse_core::TransactionLogReader;
+using fuse_core::TransactionLogWriter;
+
+
+/**
+ * @brief Create the test types by name, as the TransactionDeserializer does with pluginlib
+ */
+fuse_core::flat::ObjectFactory exampleFactory()
+{
+  fuse_core::flat::ObjectFactory factory;
+  factory.create_variable = [](const std::string& type) -> fuse_core::Variable::UniquePtr
+  {
+    if (type == ExampleVariable::detail::type())
+    {
+      return ExampleVariable::make_unique();
+    }
+    throw std::runtime_error("Unknown variable type " + type);
+  };  // NOLINT(whitespace/braces)
+  factory.create_constraint = [](const std::string& type) -> fuse_core::Constraint::UniquePtr
+  {
+    if (type == ExampleConstraint::detail::type())
+    {
+      return ExampleConstraint::make_unique();
+    }
+    throw std::runtime_error("Unknown constraint type " + type);
+  };  // NOLINT(whitespace/braces)
+  return factory;
+}
+
+/**
+ * @brief Build a transaction with one variable and one constraint
+ */
+Transaction exampleTransaction(const int32_t seconds, const double value)
+{
+  auto variable = ExampleVariable::make_shared();
+  variable->data()[0] = value;
+  auto constraint = ExampleConstraint::make_shared(
+    "source",
+    std::initializer_list<fuse_core::UUID>{variable->uuid()});  // NOLINT
+
+  Transaction transaction;
+  transaction.stamp(rclcpp::Time(seconds, 0));
+  transaction.addInvolvedStamp(rclcpp::Time(seconds, 0));
+  transaction.addVariable(variable);
+  transaction.addConstraint(constraint);
+  return transaction;
+}
+
+/**
+ * @brief A log file name that is removed when the test ends
+ */
+class TransactionLogTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    filename_ = ::testing::TempDir() + "test_transaction_log_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".fuselog";
+  }
+
+  void TearDown() override
+  {
+    std::remove(filename_.c_str());
+  }
+
+  std::string filename_;
+};
+
+TEST_F(TransactionLogTest, RoundTrip)
+{
+  {
+    TransactionLogWriter writer(filename_);
+    writer.write("sensor1", exampleTransaction(10, 1.5), rclcpp::Time(10, 5));
+    writer.write("sensor2", exampleTransaction(11, 2.5), rclcpp::Time(11, 5));
+  }
+  // Reopening the log appends to it
+  {
+    TransactionLogWriter writer(filename_);
+    writer.write("odom", exampleTransaction(12, 3.5), rclcpp::Time(12, 5));
+  }
+
+  TransactionLogReader reader(filename_);
+  TransactionLogEntry entry;
+  const std::vector<std::string> sensor_names = { "sensor1", "sensor2", "odom" };  // NOLINT(whitespace/braces)
+  for (size_t i = 0; i < sensor_names.size(); ++i)
+  {
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(sensor_names[i], entry.sensor_name);
+    EXPECT_EQ(fuse_core::TimeStamp(rclcpp::Time(10 + i, 5)), entry.arrival_time);
+
+    const auto transaction =
+      fuse_core::flat::deserializeTransaction(fuse_core::flat::BufferReader(entry.data), exampleFactory());
+    EXPECT_EQ(fuse_core::TimeStamp(rclcpp::Time(10 + i, 0)), transaction.stamp());
+    ASSERT_EQ(1, std::distance(transaction.addedVariables().begin(), transaction.addedVariables().end()));
+    EXPECT_EQ(1.5 + i, transaction.addedVariables().begin()->data()[0]);
+    EXPECT_EQ(1, std::distance(transaction.addedConstraints().begin(), transaction.addedConstraints().end()));
+  }
+  EXPECT_FALSE(reader.next(entry));
+  EXPECT_FALSE(reader.truncated());
+}
+
+TEST_F(TransactionLogTest, Truncated)
+{
+  {
+    TransactionLogWriter writer(filename_);
+    writer.write("sensor1", exampleTransaction(10, 1.5), rclcpp::Time(10, 5));
+    writer.write("sensor2", exampleTransaction(11, 2.5), rclcpp::Time(11, 5));
+  }
+
+  // Cut the last record short, as if the recording process was killed while writing it
+  std::vector<char> bytes;
+  {
+    std::ifstream file(filename_, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream file(filename_, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size() - 12);
+  }
+
+  // The complete records are still readable
+  TransactionLogReader reader(filename_);
+  TransactionLogEntry entry;
+  ASSERT_TRUE(reader.next(entry));
+  EXPECT_EQ("sensor1", entry.sensor_name);
+  EXPECT_FALSE(reader.next(entry));
+  EXPECT_TRUE(reader.truncated());
+
+  // But the log cannot be appended to
+  EXPECT_THROW(TransactionLogWriter writer(filename_), std::runtime_error);
+}
+
+TEST_F(TransactionLogTest, CorruptSizes)
+{
+  // The record sizes start after the 16 byte log header: the 8 byte transaction size, then the 4 byte name size
+  const std::vector<std::streamoff> size_offsets = { 16, 24 };  // NOLINT(whitespace/braces)
+  for (const auto size_offset : size_offsets)
+  {
+    {
+      std::remove(filename_.c_str());
+      TransactionLogWriter writer(filename_);
+      writer.write("sensor1", exampleTransaction(10, 1.5), rclcpp::Time(10, 5));
+    }
+
+    // Replace the size with one far larger than the file
+    {
+      std::fstream file(filename_, std::ios::binary | std::ios::in | std::ios::out);
+      const uint32_t huge_size = 0xFFFFFFFF;
+      file.seekp(size_offset);
+      file.write(reinterpret_cast<const char*>(&huge_size), sizeof(huge_size));
+    }
+
+    // The record is treated as cut short, without allocating memory for it
+    TransactionLogReader reader(filename_);
+    TransactionLogEntry entry;
+    EXPECT_FALSE(reader.next(entry));
+    EXPECT_TRUE(reader.truncated());
+    EXPECT_TRUE(entry.data.empty());
+  }
+}
+
+TEST_F(TransactionLogTest, NotALog)
+{
+  {
+    std::ofstream file(filename_, std::ios::binary);
+    file << "this is not a transaction log";
+  }
+  EXPECT_THROW(TransactionLogReader reader(filename_), std::runtime_error);
+  EXPECT_THROW(TransactionLogWriter writer(filename_), std::runtime_error);
+  EXPECT_THROW(TransactionLogReader reader(filename_ + ".missing"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
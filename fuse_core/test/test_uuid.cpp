@@ -31,11 +31,15 @@
  *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  *  POSSIBILITY OF SUCH DAMAGE.
  */
+#include <fuse_core/time.h>
 #include <fuse_core/uuid.h>
 #include <ros/time.h>
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstring>
+#include <new>
 #include <string>
 #include <thread>
 #include <unordered_set>
@@ -175,6 +179,27 @@ void generateUUIDs(UUIDs& uuids)
   }
 }
 
+TEST(UUID, StampPadding)
+{
+  // Equal stamps must generate the same UUID, whatever the padding bytes of the TimeStamp objects contain
+  const auto time_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(
+    std::chrono::nanoseconds(1234000005678));
+  alignas(fuse_core::TimeStamp) unsigned char zeroed[sizeof(fuse_core::TimeStamp)];
+  alignas(fuse_core::TimeStamp) unsigned char garbage[sizeof(fuse_core::TimeStamp)];
+  std::memset(zeroed, 0, sizeof(zeroed));
+  std::memset(garbage, 0xA5, sizeof(garbage));
+  const auto* stamp1 = new (zeroed) fuse_core::TimeStamp(time_point);
+  const auto* stamp2 = new (garbage) fuse_core::TimeStamp(time_point);
+  const UUID device = fuse_core::uuid::generate();
+
+  EXPECT_EQ(fuse_core::uuid::generate("Kaylee", *stamp1), fuse_core::uuid::generate("Kaylee", *stamp2));
+  EXPECT_EQ(fuse_core::uuid::generate("Kaylee", *stamp1, device),
+            fuse_core::uuid::generate("Kaylee", *stamp2, device));
+
+  // A stamp with zero padding keeps the UUID it got when the object bytes were hashed directly
+  EXPECT_EQ(fuse_core::uuid::generate("Kaylee", zeroed, sizeof(zeroed)), fuse_core::uuid::generate("Kaylee", *stamp1));
+}
+
 TEST(UUID, CollisionSingleThread)
 {
   // Create many UUIDs
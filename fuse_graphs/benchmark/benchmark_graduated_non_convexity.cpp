@@ -0,0 +1,349 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/loss.h>
+#include <fuse_core/serialization.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/graduated_non_convexity.h>
+#include <fuse_graphs/hash_graph.h>
+
+#include <test/example_variable.h>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <ceres/autodiff_cost_function.h>
+#include <ceres/loss_function.h>
+#include <ceres/solver.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Functor that computes the whitened error of a measured 2D relative pose between two (x, y, yaw) poses
+ */
+class RelativePose2DFunctor
+{
+public:
+  RelativePose2DFunctor(const std::array<double, 3>& delta, const std::array<double, 3>& sigma) :
+    delta_(delta),
+    sigma_(sigma)
+  {
+  }
+
+  template <typename T>
+  bool operator()(const T* const pose1, const T* const pose2, T* residual) const
+  {
+    using std::atan2;
+    using std::cos;
+    using std::sin;
+    const T dx = pose2[0] - pose1[0];
+    const T dy = pose2[1] - pose1[1];
+    const T cos_yaw = cos(pose1[2]);
+    const T sin_yaw = sin(pose1[2]);
+    const T yaw_error = pose2[2] - pose1[2] - T(delta_[2]);
+    residual[0] = (cos_yaw * dx + sin_yaw * dy - T(delta_[0])) / T(sigma_[0]);
+    residual[1] = (-sin_yaw * dx + cos_yaw * dy - T(delta_[1])) / T(sigma_[1]);
+    residual[2] = atan2(sin(yaw_error), cos(yaw_error)) / T(sigma_[2]);
+    return true;
+  }
+
+private:
+  std::array<double, 3> delta_;
+  std::array<double, 3> sigma_;
+};
+
+/**
+ * @brief Relative 2D pose constraint, used for both the odometry and the loop closures
+ */
+class RelativePose2DConstraint : public fuse_core::Constraint
+{
+public:
+  FUSE_CONSTRAINT_DEFINITIONS(RelativePose2DConstraint);
+
+  RelativePose2DConstraint() = default;
+
+  RelativePose2DConstraint(
+    const fuse_core::UUID& pose1,
+    const fuse_core::UUID& pose2,
+    const std::array<double, 3>& delta,
+    const std::array<double, 3>& sigma) :
+      fuse_core::Constraint("benchmark", {pose1, pose2}),  // NOLINT
+      delta(delta),
+      sigma(sigma)
+  {
+  }
+
+  void print(std::ostream& /*stream = std::cout*/) const override {}
+  ceres::CostFunction* costFunction() const override
+  {
+    return new ceres::AutoDiffCostFunction<RelativePose2DFunctor, 3, 3, 3>(new RelativePose2DFunctor(delta, sigma));
+  }
+
+  std::array<double, 3> delta;  //!< The measured relative pose
+  std::array<double, 3> sigma;  //!< The measurement standard deviations
+
+private:
+  // Allow Boost Serialization access to private methods
+  friend class boost::serialization::access;
+
+  /**
+   * @brief The Boost Serialize method that serializes all of the data members in to/out of the archive
+   *
+   * @param[in/out] archive - The archive object that holds the serialized class members
+   * @param[in] version - The version of the archive being read/written. Generally unused.
+   */
+  template<class Archive>
+  void serialize(Archive& archive, const unsigned int /* version */)
+  {
+    archive & boost::serialization::base_object<fuse_core::Constraint>(*this);
+    archive & delta;
+    archive & sigma;
+  }
+};
+
+BOOST_CLASS_EXPORT(RelativePose2DConstraint);
+
+/**
+ * @brief Tukey loss applied to the whitened loop closure residuals
+ */
+class TukeyBenchmarkLoss : public fuse_core::Loss
+{
+public:
+  FUSE_LOSS_DEFINITIONS(TukeyBenchmarkLoss);
+
+  explicit TukeyBenchmarkLoss(const double a = 3.0) : a(a)
+  {
+  }
+
+  void initialize(const std::string& /*name*/) override {}
+
+  void print(std::ostream& /*stream = std::cout*/) const override {}
+
+  ceres::LossFunction* createLossFunction() const override
+  {
+    return new ceres::TukeyLoss(a);
+  }
+
+  double a{ 3.0 };  //!< The loss scale, in standard deviations
+
+private:
+  // Allow Boost Serialization access to private methods
+  friend class boost::serialization::access;
+
+  /**
+   * @brief The Boost Serialize method that serializes all of the data members in to/out of the archive
+   *
+   * @param[in/out] archive - The archive object that holds the serialized class members
+   * @param[in] version - The version of the archive being read/written. Generally unused.
+   */
+  template<class Archive>
+  void serialize(Archive& archive, const unsigned int /* version */)
+  {
+    archive & boost::serialization::base_object<fuse_core::Loss>(*this);
+    archive & a;
+  }
+};
+
+BOOST_CLASS_EXPORT(TukeyBenchmarkLoss);
+
+/**
+ * @brief A synthetic 2D pose graph with outlier-contaminated loop closures
+ *
+ * The robot drives twice around a circle. Consecutive poses are connected by odometry constraints, and every pose
+ * on the second lap is connected to the pose at the same place on the first lap by a robust loop closure. The
+ * requested fraction of the loop closures is replaced by random measurements. The initial values are the dead-reckoned
+ * odometry, so the drift must be corrected by the loop closures.
+ */
+struct OutlierPoseGraph
+{
+  std::vector<std::array<double, 3>> ground_truth;  //!< The true pose of each variable
+  std::vector<fuse_core::UUID> poses;  //!< The UUID of each pose variable
+  fuse_graphs::HashGraph graph;  //!< The graph, with the dead-reckoned initial values
+
+  OutlierPoseGraph(const size_t pose_count, const double outlier_fraction, const fuse_graphs::HashGraphParams& params) :
+    graph(params)
+  {
+    std::mt19937 generator(42);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const std::array<double, 3> odometry_sigma = { 0.05, 0.05, 0.01 };
+    const std::array<double, 3> loop_closure_sigma = { 0.1, 0.1, 0.02 };
+
+    // Ground truth: two laps around a circle, with one pose per meter
+    const auto lap_length = pose_count / 2;
+    const auto radius = lap_length / (2.0 * M_PI);
+    for (size_t i = 0; i < pose_count; ++i)
+    {
+      const auto angle = 2.0 * M_PI * i / lap_length;
+      ground_truth.push_back({ radius * std::sin(angle), radius * (1.0 - std::cos(angle)), angle });
+    }
+
+    auto relative = [](const std::array<double, 3>& pose1, const std::array<double, 3>& pose2)
+    {
+      const auto dx = pose2[0] - pose1[0];
+      const auto dy = pose2[1] - pose1[1];
+      return std::array<double, 3>{
+        std::cos(pose1[2]) * dx + std::sin(pose1[2]) * dy,
+        -std::sin(pose1[2]) * dx + std::cos(pose1[2]) * dy,
+        pose2[2] - pose1[2] };
+    };  // NOLINT(whitespace/braces)
+    auto measure = [&noise, &generator](std::array<double, 3> delta, const std::array<double, 3>& sigma)
+    {
+      for (size_t j = 0; j < 3; ++j)
+      {
+        delta[j] += sigma[j] * noise(generator);
+      }
+      return delta;
+    };  // NOLINT(whitespace/braces)
+
+    // Odometry, dead-reckoned into the initial values. The first pose is held at its true value.
+    auto estimate = ground_truth.front();
+    for (size_t i = 0; i < pose_count; ++i)
+    {
+      auto variable = ExampleVariable::make_shared(3);
+      if (i > 0)
+      {
+        const auto delta = measure(relative(ground_truth[i - 1], ground_truth[i]), odometry_sigma);
+        const auto yaw = estimate[2];
+        estimate[0] += std::cos(yaw) * delta[0] - std::sin(yaw) * delta[1];
+        estimate[1] += std::sin(yaw) * delta[0] + std::cos(yaw) * delta[1];
+        estimate[2] += delta[2];
+        graph.addConstraint(RelativePose2DConstraint::make_shared(poses.back(), variable->uuid(), delta,
+                                                                  odometry_sigma));
+      }
+      std::copy(estimate.begin(), estimate.end(), variable->data());
+      poses.push_back(variable->uuid());
+      graph.addVariable(variable);
+    }
+    graph.holdVariable(poses.front());
+
+    // Loop closures, with a fraction of the measurements replaced by random relative poses
+    auto loss = TukeyBenchmarkLoss::make_shared();
+    for (size_t i = lap_length; i < pose_count; ++i)
+    {
+      auto delta = measure(relative(ground_truth[i - lap_length], ground_truth[i]), loop_closure_sigma);
+      if (uniform(generator) < outlier_fraction)
+      {
+        delta = { 10.0 * (uniform(generator) - 0.5), 10.0 * (uniform(generator) - 0.5),
+                  2.0 * M_PI * (uniform(generator) - 0.5) };
+      }
+      auto constraint = RelativePose2DConstraint::make_shared(poses[i - lap_length], poses[i], delta,
+                                                              loop_closure_sigma);
+      constraint->loss(loss);
+      graph.addConstraint(constraint);
+    }
+  }
+
+  /**
+   * @brief Compute the root-mean-square position error of the provided graph against the ground truth
+   */
+  double positionError(const fuse_core::Graph& optimized) const
+  {
+    auto sum = 0.0;
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+      const auto data = optimized.getVariable(poses[i]).data();
+      sum += std::pow(data[0] - ground_truth[i][0], 2) + std::pow(data[1] - ground_truth[i][1], 2);
+    }
+    return std::sqrt(sum / poses.size());
+  }
+};
+
+/**
+ * @brief Optimize the outlier-contaminated pose graph, with or without graduated non-convexity
+ *
+ * The benchmark arguments are the number of poses and the percentage of loop closure outliers. Along with the time,
+ * the number of solver iterations to convergence and the final position error against the ground truth are reported.
+ */
+static void optimizeOutlierPoseGraph(benchmark::State& state, const bool gnc)
+{
+  fuse_graphs::HashGraphParams params;
+  params.gnc.enable = gnc;
+  const OutlierPoseGraph pose_graph(state.range(0), state.range(1) / 100.0, params);
+
+  ceres::Solver::Options options;
+  options.max_num_iterations = 200;
+
+  auto iterations = 0.0;
+  auto error = 0.0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto graph = pose_graph.graph;
+    state.ResumeTiming();
+
+    auto summary = graph.optimize(options);
+
+    state.PauseTiming();
+    iterations += summary.num_successful_steps + summary.num_unsuccessful_steps;
+    error += pose_graph.positionError(graph);
+    state.ResumeTiming();
+  }
+  state.counters["iterations"] = benchmark::Counter(iterations, benchmark::Counter::kAvgIterations);
+  state.counters["position_error"] = benchmark::Counter(error, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_optimize(benchmark::State& state)
+{
+  optimizeOutlierPoseGraph(state, false);
+}
+
+static void BM_optimizeGraduatedNonConvexity(benchmark::State& state)
+{
+  optimizeOutlierPoseGraph(state, true);
+}
+
+static void outlierArguments(benchmark::internal::Benchmark* benchmark)
+{
+  for (const auto pose_count : { 200, 1000 })
+  {
+    for (const auto outlier_percentage : { 0, 10, 30 })
+    {
+      benchmark->Args({pose_count, outlier_percentage});
+    }
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_optimize)->Apply(outlierArguments);
+BENCHMARK(BM_optimizeGraduatedNonConvexity)->Apply(outlierArguments);
+
+BENCHMARK_MAIN();
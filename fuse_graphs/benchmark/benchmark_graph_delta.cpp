@@ -0,0 +1,280 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/flat_serialization.h>
+#include <fuse_core/serialization.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <fuse_graphs/hash_graph.h>
+
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/iostreams/stream.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @brief Create the test objects by type name, as the GraphDeserializer does with pluginlib
+ */
+fuse_core::flat::ObjectFactory exampleFactory()
+{
+  fuse_core::flat::ObjectFactory factory;
+  factory.create_variable = [](const std::string& /* type */)
+  {
+    return fuse_core::Variable::UniquePtr(new ExampleVariable());
+  };  // NOLINT(whitespace/braces)
+  factory.create_constraint = [](const std::string& /* type */)
+  {
+    return fuse_core::Constraint::UniquePtr(new ExampleConstraint());
+  };  // NOLINT(whitespace/braces)
+  return factory;
+}
+
+/**
+ * @brief A graph maintained like the window of a fixed-lag smoother
+ *
+ * Each step adds a new variable and constraint, removes the oldest ones, and changes the values of the newest
+ * variables as an optimization would.
+ */
+class SlidingWindow
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] size    The number of variables in the window
+   * @param[in] changed The number of variables whose values change in each step
+   */
+  SlidingWindow(const size_t size, const size_t changed) :
+    changed_(changed),
+    step_(0)
+  {
+    for (size_t i = 0; i < size; ++i)
+    {
+      add();
+    }
+  }
+
+  void step()
+  {
+    ++step_;
+    graph.removeConstraint(window_.front().second);
+    graph.removeVariable(window_.front().first->uuid());
+    window_.pop_front();
+    add();
+
+    const size_t changed = std::min(changed_, window_.size());
+    for (auto iter = window_.end() - changed; iter != window_.end(); ++iter)
+    {
+      auto& variable = *iter->first;
+      std::fill(variable.data(), variable.data() + variable.size(), static_cast<double>(step_));
+    }
+  }
+
+  fuse_graphs::HashGraph graph;  //!< The graph
+
+private:
+  void add()
+  {
+    auto variable = ExampleVariable::make_shared(3);
+    graph.addVariable(variable);
+    auto constraint = ExampleConstraint::make_shared("benchmark", variable->uuid());
+    graph.addConstraint(constraint);
+    window_.emplace_back(variable, constraint->uuid());
+  }
+
+  size_t changed_;  //!< The number of variables whose values change in each step
+  size_t step_;     //!< The number of steps taken
+  std::deque<std::pair<ExampleVariable::SharedPtr, fuse_core::UUID>> window_;  //!< Variables and their constraints
+};
+
+/**
+ * @brief Serialize a complete graph with Boost, as the SerializedPublisher "graph" topic does by default
+ */
+void serializeBoost(const fuse_core::Graph& graph, std::vector<uint8_t>& data)
+{
+  data.clear();
+  boost::iostreams::stream<fuse_core::MessageBufferStreamSink> stream(data);
+  {
+    fuse_core::BinaryOutputArchive archive(stream);
+    graph.serialize(archive);
+  }
+}
+
+/**
+ * @brief Publisher side: the cost of serializing the complete graph every cycle, with the message size as "bytes"
+ */
+static void BM_publishGraph_boost(benchmark::State& state)
+{
+  SlidingWindow window(state.range(0), state.range(1));
+  std::vector<uint8_t> data;
+  size_t bytes = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    window.step();
+    state.ResumeTiming();
+    serializeBoost(window.graph, data);
+    bytes += data.size();
+  }
+  state.counters["bytes"] = benchmark::Counter(bytes, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_publishGraph_flat(benchmark::State& state)
+{
+  SlidingWindow window(state.range(0), state.range(1));
+  std::vector<uint8_t> data;
+  size_t bytes = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    window.step();
+    state.ResumeTiming();
+    fuse_core::flat::serializeGraph(window.graph, data);
+    bytes += data.size();
+  }
+  state.counters["bytes"] = benchmark::Counter(bytes, benchmark::Counter::kAvgIterations);
+}
+
+/**
+ * @brief Publisher side: the cost of the delta stream, including a keyframe every 10 messages
+ */
+static void BM_publishGraphDelta(benchmark::State& state)
+{
+  SlidingWindow window(state.range(0), state.range(1));
+  fuse_core::flat::GraphDeltaEncoder encoder(10);
+  std::vector<uint8_t> data;
+  encoder.encode(window.graph, data);
+  size_t bytes = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    window.step();
+    state.ResumeTiming();
+    encoder.encode(window.graph, data);
+    bytes += data.size();
+  }
+  state.counters["bytes"] = benchmark::Counter(bytes, benchmark::Counter::kAvgIterations);
+}
+
+/**
+ * @brief Consumer side: the cost of rebuilding the complete graph from each message
+ */
+static void BM_receiveGraph_boost(benchmark::State& state)
+{
+  SlidingWindow window(state.range(0), state.range(1));
+  std::vector<uint8_t> data;
+  serializeBoost(window.graph, data);
+  for (auto _ : state)
+  {
+    fuse_graphs::HashGraph graph;
+    boost::iostreams::stream<fuse_core::MessageBufferStreamSource> stream(data);
+    fuse_core::BinaryInputArchive archive(stream);
+    graph.deserialize(archive);
+    benchmark::DoNotOptimize(graph);
+  }
+}
+
+static void BM_receiveGraph_flat(benchmark::State& state)
+{
+  SlidingWindow window(state.range(0), state.range(1));
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeGraph(window.graph, data);
+  const auto factory = exampleFactory();
+  for (auto _ : state)
+  {
+    fuse_graphs::HashGraph graph;
+    fuse_core::flat::deserializeGraph(fuse_core::flat::BufferReader(data), factory, graph);
+    benchmark::DoNotOptimize(graph);
+  }
+}
+
+/**
+ * @brief Consumer side: the cost of applying one delta to the reconstructed graph
+ */
+static void BM_receiveGraphDelta(benchmark::State& state)
+{
+  // Record a keyframe followed by a run of deltas
+  constexpr size_t delta_count = 100;
+  SlidingWindow window(state.range(0), state.range(1));
+  fuse_core::flat::GraphDeltaEncoder encoder(delta_count);
+  std::vector<uint8_t> keyframe;
+  encoder.encode(window.graph, keyframe);
+  std::vector<std::vector<uint8_t>> deltas(delta_count);
+  for (auto& delta : deltas)
+  {
+    window.step();
+    encoder.encode(window.graph, delta);
+  }
+
+  const auto factory = exampleFactory();
+  fuse_graphs::HashGraph graph;
+  size_t next = delta_count;
+  for (auto _ : state)
+  {
+    if (next == delta_count)
+    {
+      state.PauseTiming();
+      fuse_core::flat::deserializeGraph(fuse_core::flat::BufferReader(keyframe), factory, graph);
+      next = 0;
+      state.ResumeTiming();
+    }
+    fuse_core::flat::applyGraphDelta(fuse_core::flat::BufferReader(deltas[next]), factory, graph);
+    ++next;
+  }
+}
+
+/**
+ * @brief The benchmark arguments: the window size, and the number of variables whose values change each cycle
+ */
+static void graphDeltaArguments(benchmark::internal::Benchmark* benchmark)
+{
+  benchmark->Args({100, 100})->Args({1000, 1000})->Args({1000, 10})->Args({10000, 10000})->Args({10000, 10});
+}
+
+BENCHMARK(BM_publishGraph_boost)->Apply(graphDeltaArguments);
+BENCHMARK(BM_publishGraph_flat)->Apply(graphDeltaArguments);
+BENCHMARK(BM_publishGraphDelta)->Apply(graphDeltaArguments);
+BENCHMARK(BM_receiveGraph_boost)->Apply(graphDeltaArguments);
+BENCHMARK(BM_receiveGraph_flat)->Apply(graphDeltaArguments);
+BENCHMARK(BM_receiveGraphDelta)->Apply(graphDeltaArguments);
+
+BENCHMARK_MAIN();
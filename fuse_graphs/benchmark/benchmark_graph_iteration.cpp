@@ -0,0 +1,206 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_graphs/slot_graph.h>
+
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+/**
+ * @brief Helper function to populate a graph with variables, each of which has several constraints
+ *
+ * @param[in] num_variables Number of variables the graph should have
+ * @param[in] num_constraints_per_variable Number of constraints connected to each variable
+ * @param[out] graph The graph to populate
+ * @return The UUIDs of the added variables
+ */
+std::vector<fuse_core::UUID> populateGraph(
+  const size_t num_variables,
+  const size_t num_constraints_per_variable,
+  fuse_core::Graph& graph)
+{
+  std::vector<fuse_core::UUID> variable_uuids;
+  variable_uuids.reserve(num_variables);
+  for (size_t i = 0; i < num_variables; ++i)
+  {
+    auto variable = ExampleVariable::make_shared();
+    graph.addVariable(variable);
+    for (size_t j = 0; j < num_constraints_per_variable; ++j)
+    {
+      graph.addConstraint(ExampleConstraint::make_shared("test", variable->uuid()));
+    }
+    variable_uuids.push_back(variable->uuid());
+  }
+  return variable_uuids;
+}
+
+template <typename Graph>
+static void BM_getVariables(benchmark::State& state)
+{
+  Graph graph;
+  populateGraph(state.range(0), 1, graph);
+
+  for (auto _ : state)
+  {
+    size_t size = 0;
+    for (const auto& variable : graph.getVariables())
+    {
+      size += variable.size();
+    }
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Graph>
+static void BM_forEachVariable(benchmark::State& state)
+{
+  Graph graph;
+  populateGraph(state.range(0), 1, graph);
+
+  for (auto _ : state)
+  {
+    size_t size = 0;
+    graph.forEachVariable([&size](const fuse_core::Variable& variable) { size += variable.size(); });  // NOLINT
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Graph>
+static void BM_getConnectedConstraints(benchmark::State& state)
+{
+  Graph graph;
+  const auto variable_uuids = populateGraph(state.range(0), 4, graph);
+
+  for (auto _ : state)
+  {
+    size_t size = 0;
+    for (const auto& variable_uuid : variable_uuids)
+    {
+      for (const auto& constraint : graph.getConnectedConstraints(variable_uuid))
+      {
+        size += constraint.variables().size();
+      }
+    }
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Graph>
+static void BM_forEachConnectedConstraint(benchmark::State& state)
+{
+  Graph graph;
+  const auto variable_uuids = populateGraph(state.range(0), 4, graph);
+
+  for (auto _ : state)
+  {
+    size_t size = 0;
+    for (const auto& variable_uuid : variable_uuids)
+    {
+      graph.forEachConnectedConstraint(
+        variable_uuid,
+        [&size](const fuse_core::Constraint& constraint) { size += constraint.variables().size(); });  // NOLINT
+    }
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * @brief Helper function to make a transaction with the requested number of added variables
+ */
+fuse_core::Transaction makeTransaction(const size_t num_variables)
+{
+  fuse_core::Transaction transaction;
+  for (size_t i = 0; i < num_variables; ++i)
+  {
+    transaction.addVariable(ExampleVariable::make_shared());
+  }
+  return transaction;
+}
+
+static void BM_addedVariables(benchmark::State& state)
+{
+  const auto transaction = makeTransaction(state.range(0));
+
+  for (auto _ : state)
+  {
+    size_t size = 0;
+    for (const auto& variable : transaction.addedVariables())
+    {
+      size += variable.size();
+    }
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_forEachAddedVariable(benchmark::State& state)
+{
+  const auto transaction = makeTransaction(state.range(0));
+
+  for (auto _ : state)
+  {
+    size_t size = 0;
+    transaction.forEachAddedVariable(
+      [&size](const fuse_core::Variable& variable) { size += variable.size(); });  // NOLINT
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_getVariables, fuse_graphs::HashGraph)->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_forEachVariable, fuse_graphs::HashGraph)->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_getVariables, fuse_graphs::SlotGraph)->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_forEachVariable, fuse_graphs::SlotGraph)->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_getConnectedConstraints, fuse_graphs::HashGraph)
+  ->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_forEachConnectedConstraint, fuse_graphs::HashGraph)
+  ->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_getConnectedConstraints, fuse_graphs::SlotGraph)
+  ->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_forEachConnectedConstraint, fuse_graphs::SlotGraph)
+  ->RangeMultiplier(10)->Range(100, 100000);  // NOLINT
+BENCHMARK(BM_addedVariables)->RangeMultiplier(10)->Range(10, 10000);  // NOLINT
+BENCHMARK(BM_forEachAddedVariable)->RangeMultiplier(10)->Range(10, 10000);  // NOLINT
+
+BENCHMARK_MAIN();
@@ -0,0 +1,226 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/serialization.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_graphs/slot_graph.h>
+
+#include <test/example_variable.h>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <ceres/autodiff_cost_function.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Testable graph that exposes the protected createProblem method as public
+ */
+template <typename Graph>
+class TestableGraph : public Graph
+{
+public:
+  using Graph::createProblem;
+};
+
+/**
+ * @brief Example functor that computes the difference between two scalar variables
+ */
+class BetweenFunctor
+{
+public:
+  template <typename T>
+  bool operator()(const T* const variable1, const T* const variable2, T* residual) const
+  {
+    residual[0] = variable2[0] - variable1[0] - T(1.0);
+    return true;
+  }
+};
+
+/**
+ * @brief Example constraint that connects two consecutive variables, similar to an odometry constraint
+ */
+class BetweenConstraint : public fuse_core::Constraint
+{
+public:
+  FUSE_CONSTRAINT_DEFINITIONS(BetweenConstraint);
+
+  BetweenConstraint() = default;
+
+  BetweenConstraint(const std::string& source, const fuse_core::UUID& variable1, const fuse_core::UUID& variable2) :
+    fuse_core::Constraint(source, {variable1, variable2})  // NOLINT
+  {
+  }
+
+  void print(std::ostream& /*stream = std::cout*/) const override {}
+  ceres::CostFunction* costFunction() const override
+  {
+    return new ceres::AutoDiffCostFunction<BetweenFunctor, 1, 1, 1>(new BetweenFunctor());
+  }
+
+private:
+  // Allow Boost Serialization access to private methods
+  friend class boost::serialization::access;
+
+  /**
+   * @brief The Boost Serialize method that serializes all of the data members in to/out of the archive
+   *
+   * @param[in/out] archive - The archive object that holds the serialized class members
+   * @param[in] version - The version of the archive being read/written. Generally unused.
+   */
+  template<class Archive>
+  void serialize(Archive& archive, const unsigned int /* version */)
+  {
+    archive & boost::serialization::base_object<fuse_core::Constraint>(*this);
+  }
+};
+
+BOOST_CLASS_EXPORT(BetweenConstraint);
+
+/**
+ * @brief Helper function to make a chain graph, where each constraint connects two consecutive variables
+ *
+ * @param[in] num_constraints Number of constraints the graph should have
+ * @param[out] graph The graph to populate
+ * @param[out] variable_uuids The variable UUIDs, in chain order
+ * @param[out] constraint_uuids The constraint UUIDs, in chain order
+ */
+template <typename Graph>
+void makeChainGraph(
+  const size_t num_constraints,
+  Graph& graph,
+  std::deque<fuse_core::UUID>& variable_uuids,
+  std::deque<fuse_core::UUID>& constraint_uuids)
+{
+  auto variable = ExampleVariable::make_shared();
+  graph.addVariable(variable);
+  variable_uuids.push_back(variable->uuid());
+  for (size_t i = 0; i < num_constraints; ++i)
+  {
+    variable = ExampleVariable::make_shared();
+    graph.addVariable(variable);
+    auto constraint = BetweenConstraint::make_shared("test", variable_uuids.back(), variable->uuid());
+    graph.addConstraint(constraint);
+    variable_uuids.push_back(variable->uuid());
+    constraint_uuids.push_back(constraint->uuid());
+  }
+}
+
+template <typename Graph>
+static void BM_createProblem(benchmark::State& state)
+{
+  TestableGraph<Graph> graph;
+  std::deque<fuse_core::UUID> variable_uuids;
+  std::deque<fuse_core::UUID> constraint_uuids;
+  makeChainGraph(state.range(0), graph, variable_uuids, constraint_uuids);
+
+  for (auto _ : state)
+  {
+    ceres::Problem problem;
+    graph.createProblem(problem);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Graph>
+static void BM_getConnectedConstraints(benchmark::State& state)
+{
+  Graph graph;
+  std::deque<fuse_core::UUID> variable_uuids;
+  std::deque<fuse_core::UUID> constraint_uuids;
+  makeChainGraph(state.range(0), graph, variable_uuids, constraint_uuids);
+
+  // Visit every constraint connected to every variable, as done when selecting variables for marginalization
+  for (auto _ : state)
+  {
+    size_t count = 0;
+    for (const auto& variable_uuid : variable_uuids)
+    {
+      for (const auto& constraint : graph.getConnectedConstraints(variable_uuid))
+      {
+        count += constraint.variables().size();
+      }
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Graph>
+static void BM_slideWindow(benchmark::State& state)
+{
+  Graph graph;
+  std::deque<fuse_core::UUID> variable_uuids;
+  std::deque<fuse_core::UUID> constraint_uuids;
+  makeChainGraph(state.range(0), graph, variable_uuids, constraint_uuids);
+
+  // Remove the oldest constraint and variable and append a new one to the end of the chain, as done by a fixed-lag
+  // smoother. The new objects are created outside of the timed region.
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto variable = ExampleVariable::make_shared();
+    auto constraint = BetweenConstraint::make_shared("test", variable_uuids.back(), variable->uuid());
+    state.ResumeTiming();
+
+    graph.removeConstraint(constraint_uuids.front());
+    graph.removeVariable(variable_uuids.front());
+    graph.addVariable(variable);
+    graph.addConstraint(constraint);
+
+    state.PauseTiming();
+    constraint_uuids.pop_front();
+    variable_uuids.pop_front();
+    constraint_uuids.push_back(constraint->uuid());
+    variable_uuids.push_back(variable->uuid());
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_createProblem, fuse_graphs::HashGraph)->RangeMultiplier(10)->Range(10000, 1000000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_createProblem, fuse_graphs::SlotGraph)->RangeMultiplier(10)->Range(10000, 1000000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_getConnectedConstraints, fuse_graphs::HashGraph)
+  ->RangeMultiplier(10)->Range(10000, 1000000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_getConnectedConstraints, fuse_graphs::SlotGraph)
+  ->RangeMultiplier(10)->Range(10000, 1000000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_slideWindow, fuse_graphs::HashGraph)->RangeMultiplier(10)->Range(10000, 1000000);  // NOLINT
+BENCHMARK_TEMPLATE(BM_slideWindow, fuse_graphs::SlotGraph)->RangeMultiplier(10)->Range(10000, 1000000);  // NOLINT
+
+BENCHMARK_MAIN();
@@ -0,0 +1,218 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_GRADUATED_NON_CONVEXITY_H
+#define FUSE_GRAPHS_GRADUATED_NON_CONVEXITY_H
+
+#include <fuse_core/parameter.h>
+#include <rclcpp/node_interfaces/node_parameters_interface.hpp>
+
+#include <ceres/loss_function.h>
+#include <ceres/problem.h>
+#include <ceres/solver.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief Defines the parameters of the graduated non-convexity (GNC) optimization mode
+ *
+ * In GNC mode the robust losses are first evaluated with their scale inflated by initial_scale, which keeps nearly
+ * all residuals inside the convex, quadratic region of the loss. The scale is then divided by scale_decay after each
+ * stage until the configured losses are reached. Each stage is warm-started from the previous solution, so outliers
+ * are progressively down-weighted instead of trapping the solver in a bad local minimum from the start.
+ */
+struct GraduatedNonConvexityParams
+{
+public:
+  /**
+   * @brief Flag indicating the GNC mode is used by Graph::optimize() and Graph::optimizeFor()
+   */
+  bool enable { false };
+
+  /**
+   * @brief The multiplier applied to the scale of every robust loss in the first stage. Must be >= 1.
+   */
+  double initial_scale { 32.0 };
+
+  /**
+   * @brief The factor the scale multiplier is divided by after each stage. Must be > 1.
+   */
+  double scale_decay { 2.0 };
+
+  /**
+   * @brief The maximum number of solver iterations of each intermediate stage
+   *
+   * The final stage, which uses the configured losses, is limited only by the solver options.
+   */
+  int stage_max_num_iterations { 5 };
+
+  /**
+   * @brief Method for loading parameter values from ROS.
+   *
+   * @param[in] nh - The ROS Node with which to load parameters
+   * @param[in] ns - The parameter namespace
+   */
+  void loadFromROS(rclcpp::Node& nh, const std::string& ns = "gnc")
+  {
+    enable = fuse_core::getParam(nh, ns + ".enable", enable);
+    initial_scale = fuse_core::getParam(nh, ns + ".initial_scale", initial_scale);
+    scale_decay = fuse_core::getParam(nh, ns + ".scale_decay", scale_decay);
+    stage_max_num_iterations = fuse_core::getParam(nh, ns + ".stage_max_num_iterations", stage_max_num_iterations);
+    validate();
+  }
+
+  /**
+   * @brief Throw a std::invalid_argument exception if the parameter values are not valid
+   */
+  void validate() const;
+
+  /**
+   * @brief The Boost Serialize method that serializes all of the data members in to/out of the archive
+   *
+   * @param[in/out] archive - The archive object that holds the serialized class members
+   * @param[in] version - The version of the archive being read/written. Generally unused.
+   */
+  template<class Archive>
+  void serialize(Archive& archive, const unsigned int /* version */)
+  {
+    archive & enable;
+    archive & initial_scale;
+    archive & scale_decay;
+    archive & stage_max_num_iterations;
+  }
+};
+
+/**
+ * @brief A ceres::LossFunction that evaluates another loss function with its scale multiplied by a shared factor
+ *
+ * The robust losses are a scale family, rho_a(s) = a^2 * rho_1(s / a^2), where a is the residual magnitude at which
+ * the loss departs from the quadratic. Multiplying the scale by c gives:
+ *
+ *   rho(s) = c^2 * rho_a(s / c^2),  rho'(s) = rho_a'(s / c^2),  rho''(s) = rho_a''(s / c^2) / c^2
+ *
+ * This applies to any loss, so the fuse_core::Loss plugins do not need to expose their parameters. The wrapped loss
+ * function is not owned.
+ */
+class GraduatedLossFunction : public ceres::LossFunction
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] loss_function The loss function to scale. Must outlive this object.
+   * @param[in] scale         The scale multiplier, shared by all loss functions of one optimization. Must outlive
+   *                          this object.
+   */
+  GraduatedLossFunction(const ceres::LossFunction* loss_function, const double& scale) :
+    loss_function_(loss_function),
+    scale_(scale)
+  {
+  }
+
+  void Evaluate(double s, double rho[3]) const override
+  {
+    const double scale_squared = scale_ * scale_;
+    loss_function_->Evaluate(s / scale_squared, rho);
+    rho[0] *= scale_squared;
+    rho[2] /= scale_squared;
+  }
+
+private:
+  const ceres::LossFunction* loss_function_;  //!< The loss function evaluated at the scaled residual
+  const double& scale_;  //!< The current scale multiplier
+};
+
+/**
+ * @brief Runs the Ceres solver in graduated non-convexity stages
+ *
+ * Usage:
+ * @code{.cpp}
+ * GraduatedNonConvexity gnc(params);  // Must outlive the problem
+ * ceres::Problem problem(problem_options);
+ * problem.AddResidualBlock(cost_function, gnc.lossFunction(loss_function), parameter_blocks);
+ * auto summary = gnc.solve(solver_options, problem);
+ * @endcode
+ *
+ * The ceres::Problem must not take ownership of the loss functions (see fuse_core::Loss::Ownership). If the GNC mode
+ * is disabled, the configured loss functions are used as-is and the problem is solved in a single stage.
+ */
+class GraduatedNonConvexity
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param[in] params The GNC parameters
+   */
+  explicit GraduatedNonConvexity(const GraduatedNonConvexityParams& params);
+
+  /**
+   * @brief Return the loss function to add to the ceres::Problem in place of the provided one
+   *
+   * One wrapper is created per distinct loss function, and it is owned by this object.
+   *
+   * @param[in] loss_function The configured loss function of a constraint, or nullptr for the trivial loss
+   * @return The annealed loss function, or the provided loss function if it is nullptr or GNC is disabled
+   */
+  ceres::LossFunction* lossFunction(ceres::LossFunction* loss_function);
+
+  /**
+   * @brief Solve the problem, annealing the loss scale from the initial scale down to the configured losses
+   *
+   * The iteration and time limits of the provided options are shared by all stages. The returned summary is the
+   * summary of the last stage, with the initial cost, iterations, step counts, evaluation counts and timings
+   * accumulated over all stages. If a stage fails, its summary is returned immediately.
+   *
+   * @param[in]     options The Ceres solver options
+   * @param[in,out] problem The problem, built with the loss functions returned by lossFunction()
+   * @return The accumulated optimization summary
+   */
+  ceres::Solver::Summary solve(const ceres::Solver::Options& options, ceres::Problem& problem);
+
+private:
+  using Wrappers = std::unordered_map<const ceres::LossFunction*, std::unique_ptr<GraduatedLossFunction>>;
+
+  GraduatedNonConvexityParams params_;  //!< The GNC parameters
+  double scale_;  //!< The scale multiplier of the current stage, shared by all wrappers
+  Wrappers wrappers_;  //!< The wrapper of each distinct loss function
+};
+
+}  // namespace fuse_graphs
+
+#endif  // FUSE_GRAPHS_GRADUATED_NON_CONVEXITY_H
@@ -36,11 +36,14 @@
 
 #include <fuse_core/constraint.h>
 #include <fuse_core/graph.h>
+#include <fuse_core/loss.h>
 #include <fuse_core/fuse_macros.h>
 #include <fuse_core/serialization.h>
 #include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
+#include <fuse_graphs/graduated_non_convexity.h>
 #include <fuse_graphs/hash_graph_params.h>
+#include <fuse_graphs/serialization.h>
 
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/base_object.hpp>
@@ -48,10 +51,13 @@
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/unordered_map.hpp>
 #include <boost/serialization/unordered_set.hpp>
+#include <boost/serialization/version.hpp>
 #include <ceres/covariance.h>
 #include <ceres/problem.h>
 #include <ceres/solver.h>
 
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -67,8 +73,8 @@ namespace fuse_graphs
  *
  * This is reasonable graph implementation when a large number of variables and constraints are expected, such as with
  * full SLAM and mapping applications. The hashmap overhead may be too expensive for use in high-frequency systems with
- * a basically fixed graph size. Something base on a boost::flat_map or similar may perform better in those situations.
- * The final decision on the graph type should be based actual performance testing.
+ * a basically fixed graph size. The fuse_graphs::SlotGraph, which stores everything in flat arrays, may perform better
+ * in those situations. The final decision on the graph type should be based actual performance testing.
  *
  * This class is not thread-safe. If used in a multi-threaded application, standard thread synchronization techniques
  * should be used to guard access to the graph.
@@ -190,6 +196,23 @@ public:
    */
   fuse_core::Graph::const_constraint_range getConnectedConstraints(const fuse_core::UUID& variable_uuid) const override;
 
+  /**
+   * @brief Call the provided visitor for every constraint in the graph
+   *
+   * @param[in] visitor The callback to call for each constraint
+   */
+  void forEachConstraint(ConstraintVisitor visitor) const override;
+
+  /**
+   * @brief Call the provided visitor for every constraint connected to the specified variable
+   *
+   * Exceptions: If the variable does not exist, a std::logic_error exception will be thrown.
+   *
+   * @param[in] variable_uuid The UUID of the variable of interest
+   * @param[in] visitor       The callback to call for each connected constraint
+   */
+  void forEachConnectedConstraint(const fuse_core::UUID& variable_uuid, ConstraintVisitor visitor) const override;
+
   /**
    * @brief Check if the variable already exists in the graph
    *
@@ -252,6 +275,13 @@ public:
    */
   fuse_core::Graph::const_variable_range getVariables() const noexcept override;
 
+  /**
+   * @brief Call the provided visitor for every variable in the graph
+   *
+   * @param[in] visitor The callback to call for each variable
+   */
+  void forEachVariable(VariableVisitor visitor) const override;
+
   /**
    * @brief Configure a variable to hold its current value during optimization
    *
@@ -282,11 +312,19 @@ public:
    * of the request pair. Computing the marginal covariance is an expensive operation; grouping multiple
    * variable pairs into a single call will be much faster than calling this function for each pair individually.
    *
+   * When the default SPARSE_QR algorithm is requested, the graph factors the information matrix (J^T * J) once and
+   * retains that factorization until the graph is next modified. The requested blocks are then recovered by selective
+   * inversion, solving only for the columns of the requested variables. Repeated requests against the same graph,
+   * such as several publishers querying the same optimizer snapshot, only pay for the triangular solves. If the
+   * factorization cannot be computed or is numerically rank deficient, the full ceres::Covariance computation is
+   * used instead.
+   *
    * Exceptions: If the request contains unknown variables, a std::out_of_range exception will be thrown.
    *             If the covariance calculation fails, a std::runtime_error exception will be thrown.
    * Complexity: O(N) in the best case, O(N^3) in the worst case, where N is the total number of variables in
    *             the graph. In practice, it is significantly cheaper than the worst-case bound, but it is still
-   *             an expensive operation.
+   *             an expensive operation. Subsequent calls that reuse the retained factorization are O(K * nnz(L)),
+   *             where K is the number of requested columns and nnz(L) the number of nonzeros in the factor.
    *
    * @param[in]  covariance_requests A set of variable UUID pairs for which the marginal covariance is desired.
    * @param[out] covariance_matrices The dense covariance blocks of the requests.
@@ -372,19 +410,68 @@ protected:
 
   Constraints constraints_;  //!< The set of all constraints
   CrossReference constraints_by_variable_uuid_;  //!< Index all of the constraints by variable uuids
+  GraduatedNonConvexityParams gnc_params_;  //!< The graduated non-convexity settings used when optimizing
   ceres::Problem::Options problem_options_;  //!< User-defined options to be applied to all constructed ceres::Problems
   Variables variables_;  //!< The set of all variables
   VariableSet variables_on_hold_;  //!< The set of variables that should be held constant
 
+  /**
+   * @brief A factorization of the information matrix of the graph, used to answer marginal covariance requests
+   *
+   * The factorization is stored by variable UUID rather than by memory address, so it remains valid for deep copies
+   * of the graph. It is immutable once constructed, and may be shared between graph copies.
+   */
+  struct CovarianceFactorization;
+
+  mutable std::shared_ptr<const CovarianceFactorization> covariance_factorization_;  //!< The retained factorization
+                                                                                      //!< of the information matrix,
+                                                                                      //!< or nullptr if the graph
+                                                                                      //!< changed since the last
+                                                                                      //!< covariance request
+  mutable std::mutex covariance_factorization_mutex_;  //!< Guards access to the retained factorization
+
   /**
    * @brief Populate a ceres::Problem object using the current set of variables and constraints
    *
    * This function assumes the provided variables and constraints are consistent. No checks are performed for missing
    * variables or constraints.
    *
-   * @param[out] problem The ceres::Problem object to modify
+   * @param[out]    problem The ceres::Problem object to modify
+   * @param[in,out] gnc     If provided, the constraint loss functions are replaced by its annealed loss functions
    */
-  void createProblem(ceres::Problem& problem) const;
+  void createProblem(ceres::Problem& problem, GraduatedNonConvexity* gnc = nullptr) const;
+
+  /**
+   * @brief Discard the retained information matrix factorization
+   *
+   * This must be called whenever the variables, constraints, or variable values of the graph change.
+   */
+  void invalidateCovarianceFactorization();
+
+  /**
+   * @brief Access the retained information matrix factorization, computing it if needed
+   *
+   * @param[in] options The Ceres Covariance Options used to evaluate the graph Jacobian
+   * @return The retained factorization, or nullptr if the information matrix could not be factored
+   */
+  std::shared_ptr<const CovarianceFactorization> covarianceFactorization(
+    const ceres::Covariance::Options& options) const;
+
+  /**
+   * @brief Compute the requested covariance blocks by selective inversion of the retained factorization
+   *
+   * @param[in]  covariance_requests A set of variable UUID pairs for which the marginal covariance is desired.
+   * @param[out] covariance_matrices The dense covariance blocks of the requests.
+   * @param[in]  options             The Ceres Covariance Options used to evaluate the graph Jacobian
+   * @param[in]  use_tangent_space   Flag indicating if the covariance should be computed in the variable's tangent
+   *                                 space/local coordinates.
+   * @return True if all requested blocks were computed, false if the full Ceres computation is required instead
+   */
+  bool getCovarianceFromFactorization(
+    const std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>>& covariance_requests,
+    std::vector<std::vector<double>>& covariance_matrices,
+    const ceres::Covariance::Options& options,
+    const bool use_tangent_space) const;
 
 private:
   // Allow Boost Serialization access to private methods
@@ -397,40 +484,30 @@ private:
    * @param[in] version - The version of the archive being read/written. Generally unused.
    */
   template<class Archive>
-  void serialize(Archive& archive, const unsigned int /* version */)
+  void serialize(Archive& archive, const unsigned int version)
   {
     archive & boost::serialization::base_object<fuse_core::Graph>(*this);
     archive & constraints_;
     archive & constraints_by_variable_uuid_;
     archive & problem_options_;
+    if (Archive::is_loading::value)
+    {
+      // The graph never hands ownership of the cached fuse_core::Loss loss functions to Ceres, whatever the archive
+      // says. Older archives were written with TAKE_OWNERSHIP.
+      problem_options_.loss_function_ownership = fuse_core::Loss::Ownership;
+    }
     archive & variables_;
     archive & variables_on_hold_;
+    if (version >= 1)
+    {
+      archive & gnc_params_;
+    }
   }
 };
 
 }  // namespace fuse_graphs
 
-namespace boost
-{
-namespace serialization
-{
-
-/**
- * @brief Serialize a ceres::Problem::Options object using Boost Serialization
- */
-template<class Archive>
-void serialize(Archive& archive, ceres::Problem::Options& options, const unsigned int /* version */)
-{
-  archive & options.cost_function_ownership;
-  archive & options.disable_all_safety_checks;
-  archive & options.enable_fast_removal;
-  archive & options.local_parameterization_ownership;
-  archive & options.loss_function_ownership;
-}
-
-}  // namespace serialization
-}  // namespace boost
-
 BOOST_CLASS_EXPORT_KEY(fuse_graphs::HashGraph)
+BOOST_CLASS_VERSION(fuse_graphs::HashGraph, 1)
 
 #endif  // FUSE_GRAPHS_HASH_GRAPH_H
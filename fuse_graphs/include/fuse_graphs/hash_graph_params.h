@@ -35,6 +35,7 @@
 #define FUSE_GRAPHS_HASH_GRAPH_PARAMS_H
 
 #include <fuse_core/ceres_options.h>
+#include <fuse_graphs/graduated_non_convexity.h>
 #include <rclcpp/node_interfaces/node_parameters_interface.hpp>
 
 #include <ceres/problem.h>
@@ -56,6 +57,11 @@ public:
    */
   ceres::Problem::Options problem_options;
 
+  /**
+   * @brief The graduated non-convexity settings used when optimizing. Disabled by default.
+   */
+  GraduatedNonConvexityParams gnc;
+
   /**
    * @brief Method for loading parameter values from ROS.
    *
@@ -65,6 +71,7 @@ public:
   {
     // XXX lost "problem_options" namespace
     fuse_core::loadProblemOptionsFromROS(nh, problem_options);
+    gnc.loadFromROS(nh);
   }
 };
 
@@ -0,0 +1,148 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_PARAMETER_ARENA_H
+#define FUSE_GRAPHS_PARAMETER_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief A bump allocator that packs variable values into a few contiguous, cache-line aligned buffers
+ *
+ * Memory is handed out sequentially from fixed-capacity buffers. A buffer is never resized, so an allocated block
+ * keeps its address until the arena is cleared or destroyed. Released blocks are not reused; instead, the owner is
+ * expected to rebuild the arena once fragmented() reports that too much of the allocated space is unused.
+ *
+ * This class is not thread-safe.
+ */
+class ParameterArena
+{
+public:
+  /**
+   * @brief The alignment, in bytes, of every buffer in the arena
+   */
+  static constexpr size_t alignment = 64;
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] buffer_size The number of doubles held by each buffer. Blocks larger than this are given a dedicated
+   *                        buffer.
+   */
+  explicit ParameterArena(size_t buffer_size = 4096);
+
+  ParameterArena(ParameterArena&&) = default;
+  ParameterArena& operator=(ParameterArena&&) = default;
+
+  /**
+   * @brief Allocate a contiguous block of doubles
+   *
+   * The returned block is uninitialized, and remains valid until clear() is called or the arena is destroyed.
+   *
+   * @param[in] size The number of doubles in the block
+   * @return A pointer to the first double of the block
+   */
+  double* allocate(size_t size);
+
+  /**
+   * @brief Mark a previously allocated block as unused
+   *
+   * The memory is not reclaimed until the arena is rebuilt.
+   *
+   * @param[in] size The number of doubles in the released block
+   */
+  void release(size_t size) noexcept;
+
+  /**
+   * @brief Release all blocks. The first buffer is retained for reuse.
+   */
+  void clear() noexcept;
+
+  /**
+   * @brief The number of doubles in blocks that are still in use
+   */
+  size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /**
+   * @brief The number of doubles handed out since the arena was last cleared, including released blocks
+   */
+  size_t allocated() const noexcept
+  {
+    return allocated_;
+  }
+
+  /**
+   * @brief Returns true if more than half of the allocated space belongs to released blocks
+   */
+  bool fragmented() const noexcept
+  {
+    return (allocated_ > buffer_size_) && (allocated_ > 2 * size_);
+  }
+
+private:
+  /**
+   * @brief Deleter for buffers obtained from the aligned operator new
+   */
+  struct AlignedDelete
+  {
+    void operator()(double* buffer) const noexcept;
+  };
+
+  /**
+   * @brief A single fixed-capacity buffer
+   */
+  struct Buffer
+  {
+    std::unique_ptr<double[], AlignedDelete> data;  //!< The aligned storage
+    size_t capacity;  //!< The number of doubles in the storage
+    size_t used;  //!< The number of doubles already handed out
+  };
+
+  std::vector<Buffer> buffers_;  //!< The buffers, in allocation order. Only the last one receives new blocks.
+  size_t buffer_size_;  //!< The capacity of each regular buffer
+  size_t size_ { 0 };  //!< The number of doubles in blocks that are still in use
+  size_t allocated_ { 0 };  //!< The number of doubles handed out since the last clear()
+};
+
+}  // namespace fuse_graphs
+
+#endif  // FUSE_GRAPHS_PARAMETER_ARENA_H
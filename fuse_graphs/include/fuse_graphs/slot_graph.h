@@ -0,0 +1,572 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_SLOT_GRAPH_H
+#define FUSE_GRAPHS_SLOT_GRAPH_H
+
+#include <fuse_core/constraint.h>
+#include <fuse_core/graph.h>
+#include <fuse_core/loss.h>
+#include <fuse_core/fuse_macros.h>
+#include <fuse_core/serialization.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <fuse_graphs/graduated_non_convexity.h>
+#include <fuse_graphs/parameter_arena.h>
+#include <fuse_graphs/serialization.h>
+#include <fuse_graphs/slot_graph_params.h>
+#include <fuse_graphs/uuid_index.h>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+#include <ceres/covariance.h>
+#include <ceres/problem.h>
+#include <ceres/solver.h>
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief This is a concrete implementation of the Graph interface that stores the constraints and variables in flat,
+ * contiguous arrays.
+ *
+ * Every variable and constraint occupies a slot in a dense array, and the connections between them are stored as
+ * integer slot indices rather than UUIDs. A single open-addressing hash table per collection maps UUIDs to slots.
+ * As a result, building the Ceres problem, walking the constraints connected to a variable, or iterating over all of
+ * the variables never hashes a UUID or visits a node of a node-based container. Removing an entry moves the last
+ * entry of the array into the vacated slot, so the arrays remain dense, but the iteration order is not preserved.
+ *
+ * Optionally, the variable values handed to Ceres by optimize() and optimizeFor() may be packed into a ParameterArena
+ * (see SlotGraphParams::use_parameter_arena). Ceres then streams through a few contiguous buffers during Jacobian
+ * evaluation and state updates, rather than through the individually allocated variable objects. The arena is
+ * rebuilt in slot order whenever removed variables leave too much of it unused. The const queries, such as
+ * getCovariance() and evaluate(), never touch the arena, so they may run concurrently on a shared graph.
+ *
+ * This implementation is a good fit for high-frequency systems with a roughly constant graph size, such as a
+ * fixed-lag smoother, where the graph is traversed many times for every entry added or removed. The final decision
+ * on the graph type should be based actual performance testing.
+ *
+ * This class is not thread-safe. If used in a multi-threaded application, standard thread synchronization techniques
+ * should be used to guard access to the graph.
+ */
+class SlotGraph : public fuse_core::Graph
+{
+public:
+  FUSE_GRAPH_DEFINITIONS(SlotGraph);
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] params SlotGraph parameters.
+   */
+  explicit SlotGraph(const SlotGraphParams& params = SlotGraphParams());
+
+  /**
+   * @brief Copy constructor
+   *
+   * Performs a deep copy of the graph
+   */
+  SlotGraph(const SlotGraph& other);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~SlotGraph() = default;
+
+  /**
+   * @brief Assignment operator
+   *
+   * Performs a deep copy of the graph
+   */
+  SlotGraph& operator=(const SlotGraph& other);
+
+  /**
+   * @brief Clear all variables and constraints from the graph object.
+   *
+   * The object should be equivalent to a newly constructed object after clear() has been called.
+   */
+  void clear() override;
+
+  /**
+   * @brief Return a deep copy of the graph object.
+   *
+   * This should include deep copies of all variables and constraints; not pointer copies.
+   */
+  fuse_core::Graph::UniquePtr clone() const override;
+
+  /**
+   * @brief Check if the constraint already exists in the graph
+   *
+   * Exceptions: None
+   * Complexity: O(1) (average)
+   *
+   * @param[in] constraint_uuid The UUID of the constraint being searched for
+   * @return                    True if this constraint already exists, False otherwise
+   */
+  bool constraintExists(const fuse_core::UUID& constraint_uuid) const noexcept override;
+
+  /**
+   * @brief Add a new constraint to the graph
+   *
+   * Any referenced variables must exist in the graph before the constraint is added. The Graph will share ownership
+   * of the constraint.
+   *
+   * Behavior: If this constraint already exists in the graph, the function will return false.
+   * Exceptions: If the constraint's variables do not exist in the graph, a std::logic_error exception will be thrown.
+   *             If any unexpected errors occur, an exception will be thrown.
+   * Complexity: O(1) (amortized)
+   *
+   * @param[in] constraint The new constraint to be added
+   * @return               True if the constraint was added, false otherwise
+   */
+  bool addConstraint(fuse_core::Constraint::SharedPtr constraint) override;
+
+  /**
+   * @brief Remove a constraint from the graph
+   *
+   * Behavior: If this constraint does not exist in the graph, the function will return false.
+   * Exceptions: If any unexpected errors occur, an exception will be thrown.
+   * Complexity: O(1) (average)
+   *
+   * @param[in] constraint_uuid The UUID of the constraint to be removed
+   * @return                    True if the constraint was removed, false otherwise
+   */
+  bool removeConstraint(const fuse_core::UUID& constraint_uuid) override;
+
+  /**
+   * @brief Read-only access to a constraint from the graph by UUID
+   *
+   * Exceptions: If the constraint UUID does not exist, a std::out_of_range exception will be thrown.
+   * Complexity: O(1) (average)
+   *
+   * @param[in] constraint_uuid The UUID of the requested constraint
+   * @return                    The constraint in the graph with the specified UUID
+   */
+  const fuse_core::Constraint& getConstraint(const fuse_core::UUID& constraint_uuid) const override;
+
+  /**
+   * @brief Read-only access to all of the constraints in the graph
+   *
+   * Behavior: This function returns iterators pointing to the beginning and end of the collection. No copies
+   *           of the constraints are performed at this time.
+   * Exceptions: None
+   * Complexity: O(1) This function returns in constant time. However, iterating through the returned
+   *                  range is naturally O(N).
+   *
+   * @return A read-only iterator range containing all constraints
+   */
+  fuse_core::Graph::const_constraint_range getConstraints() const noexcept override;
+
+  /**
+   * @brief Read-only access to the subset of constraints that are connected to the specified variable
+   *
+   * Only the variable UUID is hashed. The connected constraints are then accessed directly by slot index.
+   *
+   * @param[in] variable_uuid The UUID of the variable of interest
+   * @return A read-only iterator range containing all constraints that involve the specified variable
+   */
+  fuse_core::Graph::const_constraint_range getConnectedConstraints(const fuse_core::UUID& variable_uuid) const override;
+
+  /**
+   * @brief Call the provided visitor for every constraint in the graph
+   *
+   * @param[in] visitor The callback to call for each constraint
+   */
+  void forEachConstraint(ConstraintVisitor visitor) const override;
+
+  /**
+   * @brief Call the provided visitor for every constraint connected to the specified variable
+   *
+   * Exceptions: If the variable does not exist, a std::logic_error exception will be thrown.
+   *
+   * @param[in] variable_uuid The UUID of the variable of interest
+   * @param[in] visitor       The callback to call for each connected constraint
+   */
+  void forEachConnectedConstraint(const fuse_core::UUID& variable_uuid, ConstraintVisitor visitor) const override;
+
+  /**
+   * @brief Check if the variable already exists in the graph
+   *
+   * Exceptions: None
+   * Complexity: O(1) (average)
+   *
+   * @param[in] variable_uuid The UUID of the variable being searched for
+   * @return                  True if this variable already exists, False otherwise
+   */
+  bool variableExists(const fuse_core::UUID& variable_uuid) const noexcept override;
+
+  /**
+   * @brief Add a new variable to the graph
+   *
+   * The Graph will share ownership of the Variable. If this variable already exists in the graph, the function will
+   * return false.
+   *
+   * Behavior: If this variable already exists in the graph, the function will return false.
+   * Exceptions: If any unexpected errors occur, an exception will be thrown.
+   * Complexity: O(1) (amortized)
+   *
+   * @param[in] variable The new variable to be added
+   * @return             True if the variable was added, false otherwise
+   */
+  bool addVariable(fuse_core::Variable::SharedPtr variable) override;
+
+  /**
+   * @brief Remove a variable from the graph
+   *
+   * Exceptions: If constraints still exist that refer to this variable, a std::logic_error exception will be thrown.
+   *             If an unexpected error occurs during the removal, an exception will be thrown.
+   * Complexity: O(1) (average)
+   *
+   * @param[in] variable_uuid The UUID of the variable to be removed
+   * @return                  True if the variable was removed, false otherwise
+   */
+  bool removeVariable(const fuse_core::UUID& variable_uuid) override;
+
+  /**
+   * @brief Read-only access to a variable in the graph by UUID
+   *
+   * Exceptions: If the variable UUID does not exist, a std::out_of_range exception will be thrown.
+   * Complexity: O(1) (average)
+   *
+   * @param[in] variable_uuid The UUID of the requested variable
+   * @return                  The variable in the graph with the specified UUID
+   */
+  const fuse_core::Variable& getVariable(const fuse_core::UUID& variable_uuid) const override;
+
+  /**
+   * @brief Read-only access to all of the variables in the graph
+   *
+   * Behavior: This function returns iterators pointing to the beginning and end of the collection. No copies
+   *           of the variables are performed at this time.
+   * Exceptions: None
+   * Complexity: O(1) This function returns in constant time. However, iterating through the returned
+   *                  range is naturally O(N).
+   *
+   * @return A read-only iterator range containing all variables
+   */
+  fuse_core::Graph::const_variable_range getVariables() const noexcept override;
+
+  /**
+   * @brief Call the provided visitor for every variable in the graph
+   *
+   * @param[in] visitor The callback to call for each variable
+   */
+  void forEachVariable(VariableVisitor visitor) const override;
+
+  /**
+   * @brief Read-only access to the subset of variables that are connected to the specified constraint
+   *
+   * Only the constraint UUID is hashed. The connected variables are then accessed directly by slot index.
+   *
+   * @param[in] constraint_uuid The UUID of the constraint of interest
+   * @return A read-only iterator range containing all variables that involve the specified constraint
+   */
+  fuse_core::Graph::const_variable_range getConnectedVariables(const fuse_core::UUID& constraint_uuid) const override;
+
+  /**
+   * @brief Configure a variable to hold its current value during optimization
+   *
+   * Once set, the specified variable's value will no longer change during any subsequent optimization. To 'unhold'
+   * a previously held variable, call Graph::holdVariable() with the \p hold_constant parameter set to false.
+   *
+   * Exceptions: If the variable does not exist, a std::out_of_range exception will be thrown.
+   * Complexity: O(1) (average)
+   *
+   * @param[in] variable_uuid The variable to adjust
+   * @param[in] hold_constant Flag indicating if the variable's value should be held constant during optimization,
+   *                          or if the variable's value is allowed to change during optimization.
+   */
+  void holdVariable(const fuse_core::UUID& variable_uuid, bool hold_constant = true) override;
+
+  /**
+   * @brief Check whether a variable is on hold or not
+   *
+   * @param[in] variable_uuid The variable to test
+   * @return True if the variable is on hold, false otherwise
+   */
+  bool isVariableOnHold(const fuse_core::UUID& variable_uuid) const override;
+
+  /**
+   * @brief Compute the marginal covariance blocks for the requested set of variable pairs.
+   *
+   * To compute the marginal variance of a single variable, simply supply the same variable UUID for both members of
+   * of the request pair. Computing the marginal covariance is an expensive operation; grouping multiple
+   * variable pairs into a single call will be much faster than calling this function for each pair individually.
+   *
+   * Exceptions: If the request contains unknown variables, a std::out_of_range exception will be thrown.
+   *             If the covariance calculation fails, a std::runtime_error exception will be thrown.
+   * Complexity: O(N) in the best case, O(N^3) in the worst case, where N is the total number of variables in
+   *             the graph. In practice, it is significantly cheaper than the worst-case bound, but it is still
+   *             an expensive operation.
+   *
+   * @param[in]  covariance_requests A set of variable UUID pairs for which the marginal covariance is desired.
+   * @param[out] covariance_matrices The dense covariance blocks of the requests.
+   * @param[in]  options             A Ceres Covariance Options structure that controls the method and settings used
+   *                                 to compute the covariance blocks.
+   * @param[in]  use_tangent_space   Flag indicating if the covariance should be computed in the variable's tangent
+   *                                 space/local coordinates. Otherwise it is computed in the variable's parameter
+   *                                 space.
+   */
+  void getCovariance(
+    const std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>>& covariance_requests,
+    std::vector<std::vector<double>>& covariance_matrices,
+    const ceres::Covariance::Options& options = ceres::Covariance::Options(),
+    const bool use_tangent_space = true) const override;
+
+  /**
+   * @brief Optimize the values of the current set of variables, given the current set of constraints.
+   *
+   * After the call, the values in the graph will be updated to the latest values. This is where the
+   * "work" of the optimization system is performed. As such, it is often a long-running process.
+   *
+   * Complexity: O(N) in the best case, O(M*N^3) in the worst case, where N is the total number of variables
+   *             in the graph, and M is the maximum number of allowed iterations.
+   *
+   * @param[in] options An optional Ceres Solver::Options object that controls various aspects of the optimizer.
+   *                    See https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/solver.h#59
+   * @return            A Ceres Solver Summary structure containing information about the optimization process
+   */
+  ceres::Solver::Summary optimize(const ceres::Solver::Options& options = ceres::Solver::Options()) override;
+
+  /**
+   * @brief Optimize the values of the current set of variables, given the current set of constraints for a maximum
+   * amount of time.
+   *
+   * The \p max_optimization_time should be viewed as a "best effort" limit, and the actual optimization time may
+   * exceed this limit by a small amount. After the call, the values in the graph will be updated to the latest values.
+   *
+   * @param[in] max_optimization_time The maximum allowed duration of the optimization call
+   * @param[in] options An optional Ceres Solver::Options object that controls various aspects of the optimizer.
+   *                    See https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/solver.h#59
+   * @return            A Ceres Solver Summary structure containing information about the optimization process
+   */
+  ceres::Solver::Summary optimizeFor(
+    const std::chrono::nanoseconds& max_optimization_time,
+    const ceres::Solver::Options& options = ceres::Solver::Options()) override;
+
+  /**
+   * @brief Evalute the values of the current set of variables, given the current set of constraints.
+   *
+   * The values in the graph do not change after the call.
+   *
+   * If any of the output arguments is nullptr, it will not be evaluated. This mimics the ceres::Problem::Evaluate
+   * method API. Here all output arguments default to nullptr except for the cost.
+   *
+   * @param[out] cost      The cost of the entire problem represented by the graph.
+   * @param[out] residuals The residuals of all constraints.
+   * @param[out] gradient  The gradient for all constraints evaluated at the values of the current set of variables.
+   * @param[in]  options   An optional Ceres Problem::EvaluateOptions object that controls various aspects of the
+   *                       problem evaluation.
+   *                       See https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/problem.h#401
+   * @return True if the problem evaluation was successful; False, otherwise.
+   */
+  bool evaluate(double* cost, std::vector<double>* residuals = nullptr, std::vector<double>* gradient = nullptr,
+                const ceres::Problem::EvaluateOptions& options = ceres::Problem::EvaluateOptions()) const override;
+
+  /**
+   * @brief Print a human-readable description of the graph to the provided stream.
+   *
+   * @param[out] stream The stream to write to. Defaults to stdout.
+   */
+  void print(std::ostream& stream = std::cout) const override;
+
+protected:
+  using Index = UuidIndex::Index;
+
+  /**
+   * @brief The storage of a single constraint
+   */
+  struct ConstraintSlot
+  {
+    fuse_core::Constraint::SharedPtr constraint;  //!< The constraint
+    std::vector<Index> variables;  //!< The slot indices of the constraint's variables, in the constraint's order
+  };
+
+  /**
+   * @brief The storage of a single variable
+   */
+  struct VariableSlot
+  {
+    fuse_core::Variable::SharedPtr variable;  //!< The variable
+    std::vector<Index> constraints;  //!< The slot indices of the constraints that use this variable
+    bool on_hold { false };  //!< Flag indicating the variable should be held constant
+    double* parameters { nullptr };  //!< The values given to Ceres by the optimization methods. Either the
+                                     //!< variable's own data or a block of the parameter arena.
+  };
+
+  std::vector<ConstraintSlot> constraints_;  //!< The dense array of all constraints
+  UuidIndex constraint_index_;  //!< Maps each constraint UUID to its slot in constraints_
+  GraduatedNonConvexityParams gnc_params_;  //!< The graduated non-convexity settings used when optimizing
+  ParameterArena parameter_arena_;  //!< The packed variable values, if use_parameter_arena_ is enabled
+  ceres::Problem::Options problem_options_;  //!< User-defined options to be applied to all constructed ceres::Problems
+  bool use_parameter_arena_;  //!< Flag indicating the variable values are packed into the parameter arena
+  std::vector<VariableSlot> variables_;  //!< The dense array of all variables
+  UuidIndex variable_index_;  //!< Maps each variable UUID to its slot in variables_
+
+  /**
+   * @brief Populate a ceres::Problem object using the current set of variables and constraints
+   *
+   * This function assumes the provided variables and constraints are consistent. No checks are performed for missing
+   * variables or constraints.
+   *
+   * The problem refers to the parameter arena only if \p use_parameter_arena is true. The arena is shared by all
+   * users of the graph, so only the non-const optimization methods may use it, after refreshing it with
+   * copyVariablesToParameters(). Const queries build the problem over the variable values instead.
+   *
+   * @param[out]    problem             The ceres::Problem object to modify
+   * @param[in]     use_parameter_arena Flag indicating the parameter blocks are the parameter arena blocks
+   * @param[in,out] gnc                 If provided, the constraint loss functions are replaced by its annealed loss
+   *                                    functions
+   */
+  void createProblem(ceres::Problem& problem, const bool use_parameter_arena = false,
+                     GraduatedNonConvexity* gnc = nullptr) const;
+
+  /**
+   * @brief Assign the Ceres parameter block of a variable slot, copying the current variable value into the arena
+   *
+   * @param[in,out] slot The variable slot
+   */
+  void assignParameters(VariableSlot& slot);
+
+  /**
+   * @brief Rebuild the parameter arena in slot order, reclaiming the space of removed variables
+   *
+   * Any Ceres problem that refers to the previous parameter blocks must not be used afterwards.
+   */
+  void compactParameterArena();
+
+  /**
+   * @brief Copy the current variable values into the parameter arena
+   */
+  void copyVariablesToParameters();
+
+  /**
+   * @brief Copy the optimized values from the parameter arena back into the variables
+   */
+  void copyParametersToVariables();
+
+private:
+  // Allow Boost Serialization access to private methods
+  friend class boost::serialization::access;
+
+  /**
+   * @brief The Boost Serialize method that serializes all of the data members in to the archive
+   *
+   * Only the constraints, variables and hold flags are stored. The slot indices are rebuilt when loading.
+   *
+   * @param[out] archive - The archive object into which class members will be serialized
+   * @param[in] version - The version of the archive being written.
+   */
+  template<class Archive>
+  void save(Archive& archive, const unsigned int /* version */) const
+  {
+    std::vector<fuse_core::Constraint::SharedPtr> constraints;
+    constraints.reserve(constraints_.size());
+    for (const auto& slot : constraints_)
+    {
+      constraints.push_back(slot.constraint);
+    }
+    std::vector<fuse_core::Variable::SharedPtr> variables;
+    std::vector<bool> variables_on_hold;
+    variables.reserve(variables_.size());
+    variables_on_hold.reserve(variables_.size());
+    for (const auto& slot : variables_)
+    {
+      variables.push_back(slot.variable);
+      variables_on_hold.push_back(slot.on_hold);
+    }
+    archive << boost::serialization::base_object<fuse_core::Graph>(*this);
+    archive << constraints;
+    archive << problem_options_;
+    archive << use_parameter_arena_;
+    archive << variables;
+    archive << variables_on_hold;
+    archive << gnc_params_;
+  }
+
+  /**
+   * @brief The Boost Serialize method that serializes all of the data members out of the archive
+   *
+   * @param[in] archive - The archive object that holds the serialized class members
+   * @param[in] version - The version of the archive being read.
+   */
+  template<class Archive>
+  void load(Archive& archive, const unsigned int version)
+  {
+    std::vector<fuse_core::Constraint::SharedPtr> constraints;
+    std::vector<fuse_core::Variable::SharedPtr> variables;
+    std::vector<bool> variables_on_hold;
+    archive >> boost::serialization::base_object<fuse_core::Graph>(*this);
+    archive >> constraints;
+    archive >> problem_options_;
+    // The graph never hands ownership of the cached fuse_core::Loss loss functions to Ceres, whatever the archive says.
+    // Older archives were written with TAKE_OWNERSHIP.
+    problem_options_.loss_function_ownership = fuse_core::Loss::Ownership;
+    archive >> use_parameter_arena_;
+    archive >> variables;
+    archive >> variables_on_hold;
+    if (version >= 1)
+    {
+      archive >> gnc_params_;
+    }
+    clear();
+    for (size_t i = 0; i < variables.size(); ++i)
+    {
+      addVariable(variables[i]);
+      holdVariable(variables[i]->uuid(), variables_on_hold[i]);
+    }
+    for (const auto& constraint : constraints)
+    {
+      addConstraint(constraint);
+    }
+  }
+
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+};
+
+}  // namespace fuse_graphs
+
+BOOST_CLASS_EXPORT_KEY(fuse_graphs::SlotGraph)
+BOOST_CLASS_VERSION(fuse_graphs::SlotGraph, 1)
+
+#endif  // FUSE_GRAPHS_SLOT_GRAPH_H
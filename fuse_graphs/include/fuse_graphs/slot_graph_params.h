@@ -0,0 +1,89 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_SLOT_GRAPH_PARAMS_H
+#define FUSE_GRAPHS_SLOT_GRAPH_PARAMS_H
+
+#include <fuse_core/ceres_options.h>
+#include <fuse_core/parameter.h>
+#include <fuse_graphs/graduated_non_convexity.h>
+#include <rclcpp/node_interfaces/node_parameters_interface.hpp>
+
+#include <ceres/problem.h>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief Defines the set of parameters required by the fuse_graphs::SlotGraph class
+ */
+struct SlotGraphParams
+{
+public:
+  /**
+   * @brief Ceres Problem::Options object that controls various aspects of the optimization problem.
+   *
+   * See https://ceres-solver.googlesource.com/ceres-solver/+/master/include/ceres/problem.h#123
+   */
+  ceres::Problem::Options problem_options;
+
+  /**
+   * @brief The graduated non-convexity settings used when optimizing. Disabled by default.
+   */
+  GraduatedNonConvexityParams gnc;
+
+  /**
+   * @brief Store the variable values used by Ceres in a contiguous, cache-line aligned arena
+   *
+   * When enabled, the optimizer works on a packed copy of the variable values instead of the values scattered across
+   * the individual variable objects. The results are copied back into the variables after every optimization.
+   */
+  bool use_parameter_arena { false };
+
+  /**
+   * @brief Method for loading parameter values from ROS.
+   *
+   * @param[in] nh - The ROS Node with which to load parameters
+   */
+  void loadFromROS(rclcpp::Node& nh)
+  {
+    fuse_core::loadProblemOptionsFromROS(nh, problem_options);
+    use_parameter_arena = fuse_core::getParam(nh, "use_parameter_arena", use_parameter_arena);
+    gnc.loadFromROS(nh);
+  }
+};
+
+}  // namespace fuse_graphs
+
+#endif  // FUSE_GRAPHS_SLOT_GRAPH_PARAMS_H
@@ -0,0 +1,275 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_UUID_INDEX_H
+#define FUSE_GRAPHS_UUID_INDEX_H
+
+#include <fuse_core/uuid.h>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+/**
+ * @brief An open-addressing hash table that maps UUIDs to dense integer indices
+ *
+ * The keys and values are stored inline in a single contiguous array and collisions are resolved by linear probing,
+ * so a lookup touches one or two cache lines instead of chasing the node pointers of a std::unordered_map. Erased
+ * entries are removed by shifting the subsequent members of the probe sequence backwards, so no tombstones accumulate
+ * when entries are frequently added and removed, as happens in a fixed-lag smoother.
+ */
+class UuidIndex
+{
+public:
+  using Index = std::uint32_t;
+
+  /**
+   * @brief The value returned by find() when the UUID is not present in the index
+   */
+  static constexpr Index npos = std::numeric_limits<Index>::max();
+
+  /**
+   * @brief Remove all entries from the index. The allocated capacity is retained.
+   */
+  void clear() noexcept
+  {
+    for (auto& entry : entries_)
+    {
+      entry.index = npos;
+    }
+    size_ = 0;
+  }
+
+  /**
+   * @brief Returns true if the index contains no entries
+   */
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  /**
+   * @brief The number of entries in the index
+   */
+  size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /**
+   * @brief Allocate enough capacity to hold \p count entries without rehashing
+   */
+  void reserve(size_t count)
+  {
+    size_t capacity = minimum_capacity;
+    while (count * max_load_denominator > capacity * max_load_numerator)
+    {
+      capacity *= 2;
+    }
+    if (capacity > entries_.size())
+    {
+      rehash(capacity);
+    }
+  }
+
+  /**
+   * @brief Look up the index associated with a UUID
+   *
+   * @param[in] uuid The UUID to search for
+   * @return The associated index, or npos if the UUID is not present
+   */
+  Index find(const fuse_core::UUID& uuid) const noexcept
+  {
+    if (entries_.empty())
+    {
+      return npos;
+    }
+    for (size_t position = hash(uuid) & mask(); ; position = (position + 1) & mask())
+    {
+      const auto& entry = entries_[position];
+      if (entry.index == npos)
+      {
+        return npos;
+      }
+      if (entry.uuid == uuid)
+      {
+        return entry.index;
+      }
+    }
+  }
+
+  /**
+   * @brief Associate an index with a UUID, replacing any existing association
+   *
+   * @param[in] uuid  The UUID key
+   * @param[in] index The index to associate with the UUID. Must not be npos.
+   * @return True if the UUID was newly inserted, false if an existing entry was updated
+   */
+  bool assign(const fuse_core::UUID& uuid, Index index)
+  {
+    if ((size_ + 1) * max_load_denominator > entries_.size() * max_load_numerator)
+    {
+      rehash(entries_.empty() ? minimum_capacity : 2 * entries_.size());
+    }
+    for (size_t position = hash(uuid) & mask(); ; position = (position + 1) & mask())
+    {
+      auto& entry = entries_[position];
+      if (entry.index == npos)
+      {
+        entry.uuid = uuid;
+        entry.index = index;
+        ++size_;
+        return true;
+      }
+      if (entry.uuid == uuid)
+      {
+        entry.index = index;
+        return false;
+      }
+    }
+  }
+
+  /**
+   * @brief Remove a UUID from the index
+   *
+   * @param[in] uuid The UUID to remove
+   * @return True if the UUID was removed, false if it was not present
+   */
+  bool erase(const fuse_core::UUID& uuid) noexcept
+  {
+    if (entries_.empty())
+    {
+      return false;
+    }
+    size_t hole = hash(uuid) & mask();
+    for (; entries_[hole].uuid != uuid; hole = (hole + 1) & mask())
+    {
+      if (entries_[hole].index == npos)
+      {
+        return false;
+      }
+    }
+    if (entries_[hole].index == npos)
+    {
+      return false;
+    }
+    entries_[hole].index = npos;
+    --size_;
+    // Shift the remainder of the probe sequence back into the hole. An entry may only move if its home position does
+    // not lie cyclically within (hole, position].
+    for (size_t position = (hole + 1) & mask(); entries_[position].index != npos; position = (position + 1) & mask())
+    {
+      const size_t home = hash(entries_[position].uuid) & mask();
+      const bool reachable = (hole <= position) ? ((hole < home) && (home <= position))
+                                                : ((hole < home) || (home <= position));
+      if (!reachable)
+      {
+        entries_[hole] = entries_[position];
+        entries_[position].index = npos;
+        hole = position;
+      }
+    }
+    return true;
+  }
+
+private:
+  /**
+   * @brief A single slot of the table. The slot is unoccupied when the index is npos.
+   */
+  struct Entry
+  {
+    fuse_core::UUID uuid;  //!< The key
+    Index index { npos };  //!< The associated value
+  };
+
+  static constexpr size_t minimum_capacity = 16;  //!< Initial number of slots. Must be a power of two.
+  static constexpr size_t max_load_numerator = 3;  //!< The table is grown when it is more than 3/4 full
+  static constexpr size_t max_load_denominator = 4;
+
+  std::vector<Entry> entries_;  //!< The slots of the table. The size is always zero or a power of two.
+  size_t size_ { 0 };  //!< The number of occupied slots
+
+  /**
+   * @brief The bit mask that maps a hash value to a slot position
+   */
+  size_t mask() const noexcept
+  {
+    return entries_.size() - 1;
+  }
+
+  /**
+   * @brief Compute the hash of a UUID
+   *
+   * Generated UUIDs are already close to uniformly distributed, but name-based UUIDs and hand-crafted test UUIDs may
+   * not be. The two halves are folded together and passed through a 64-bit finalizer to spread any structure.
+   */
+  static size_t hash(const fuse_core::UUID& uuid) noexcept
+  {
+    std::uint64_t low;
+    std::uint64_t high;
+    std::memcpy(&low, uuid.data, sizeof(low));
+    std::memcpy(&high, uuid.data + sizeof(low), sizeof(high));
+    std::uint64_t value = low ^ (high * 0x9E3779B97F4A7C15ull);
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    return static_cast<size_t>(value);
+  }
+
+  /**
+   * @brief Move all entries into a new table with the provided number of slots
+   */
+  void rehash(size_t capacity)
+  {
+    std::vector<Entry> entries(capacity);
+    std::swap(entries_, entries);
+    size_ = 0;
+    for (const auto& entry : entries)
+    {
+      if (entry.index != npos)
+      {
+        assign(entry.uuid, entry.index);
+      }
+    }
+  }
+};
+
+}  // namespace fuse_graphs
+
+#endif  // FUSE_GRAPHS_UUID_INDEX_H
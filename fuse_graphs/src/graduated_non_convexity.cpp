@@ -0,0 +1,170 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/graduated_non_convexity.h>
+
+#include <ceres/loss_function.h>
+#include <ceres/problem.h>
+#include <ceres/solver.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+void GraduatedNonConvexityParams::validate() const
+{
+  if (initial_scale < 1.0)
+  {
+    throw std::invalid_argument("The GNC initial_scale must be greater than or equal to 1, but it is " +
+                                std::to_string(initial_scale) + ".");
+  }
+  if (scale_decay <= 1.0)
+  {
+    throw std::invalid_argument("The GNC scale_decay must be greater than 1, but it is " +
+                                std::to_string(scale_decay) + ".");
+  }
+  if (stage_max_num_iterations < 1)
+  {
+    throw std::invalid_argument("The GNC stage_max_num_iterations must be positive, but it is " +
+                                std::to_string(stage_max_num_iterations) + ".");
+  }
+}
+
+GraduatedNonConvexity::GraduatedNonConvexity(const GraduatedNonConvexityParams& params) :
+  params_(params),
+  scale_(1.0)
+{
+  params_.validate();
+}
+
+ceres::LossFunction* GraduatedNonConvexity::lossFunction(ceres::LossFunction* loss_function)
+{
+  // The trivial loss is already convex, and is not affected by the scale
+  if (!params_.enable || !loss_function)
+  {
+    return loss_function;
+  }
+  auto& wrapper = wrappers_[loss_function];
+  if (!wrapper)
+  {
+    wrapper = std::make_unique<GraduatedLossFunction>(loss_function, scale_);
+  }
+  return wrapper.get();
+}
+
+ceres::Solver::Summary GraduatedNonConvexity::solve(const ceres::Solver::Options& options, ceres::Problem& problem)
+{
+  ceres::Solver::Summary summary;
+  if (wrappers_.empty())
+  {
+    // There are no robust losses to anneal
+    scale_ = 1.0;
+    ceres::Solve(options, &problem, &summary);
+    return summary;
+  }
+  // The totals over all stages
+  auto initial_cost = 0.0;
+  auto iterations = std::vector<ceres::IterationSummary>();
+  auto num_successful_steps = 0;
+  auto num_unsuccessful_steps = 0;
+  auto num_residual_evaluations = 0;
+  auto num_jacobian_evaluations = 0;
+  auto preprocessor_time = 0.0;
+  auto minimizer_time = 0.0;
+  auto postprocessor_time = 0.0;
+  auto total_time = 0.0;
+  auto stage_options = options;
+  auto final_stage = false;
+  scale_ = params_.initial_scale;
+  for (auto stage = 0; !final_stage; ++stage)
+  {
+    const auto remaining_iterations = std::max(0, options.max_num_iterations - num_successful_steps -
+                                                   num_unsuccessful_steps);
+    const auto remaining_time = std::max(0.0, options.max_solver_time_in_seconds - total_time);
+    // Once the budget is spent, the final stage still runs to evaluate the solution with the configured losses
+    final_stage = (scale_ <= 1.0) || (remaining_iterations == 0) || (remaining_time == 0.0);
+    if (final_stage)
+    {
+      scale_ = 1.0;
+      stage_options.max_num_iterations = remaining_iterations;
+    }
+    else
+    {
+      stage_options.max_num_iterations = std::min(params_.stage_max_num_iterations, remaining_iterations);
+    }
+    stage_options.max_solver_time_in_seconds = remaining_time;
+    ceres::Solve(stage_options, &problem, &summary);
+    if (stage == 0)
+    {
+      initial_cost = summary.initial_cost;
+    }
+    iterations.insert(iterations.end(), summary.iterations.begin(), summary.iterations.end());
+    num_successful_steps += summary.num_successful_steps;
+    num_unsuccessful_steps += summary.num_unsuccessful_steps;
+    num_residual_evaluations += summary.num_residual_evaluations;
+    num_jacobian_evaluations += summary.num_jacobian_evaluations;
+    preprocessor_time += summary.preprocessor_time_in_seconds;
+    minimizer_time += summary.minimizer_time_in_seconds;
+    postprocessor_time += summary.postprocessor_time_in_seconds;
+    total_time += summary.total_time_in_seconds;
+    if (!summary.IsSolutionUsable())
+    {
+      break;
+    }
+    if (!final_stage)
+    {
+      scale_ /= params_.scale_decay;
+    }
+  }
+  // Report the totals in the summary of the last stage
+  summary.initial_cost = initial_cost;
+  summary.iterations = std::move(iterations);
+  summary.num_successful_steps = num_successful_steps;
+  summary.num_unsuccessful_steps = num_unsuccessful_steps;
+  summary.num_residual_evaluations = num_residual_evaluations;
+  summary.num_jacobian_evaluations = num_jacobian_evaluations;
+  summary.preprocessor_time_in_seconds = preprocessor_time;
+  summary.minimizer_time_in_seconds = minimizer_time;
+  summary.postprocessor_time_in_seconds = postprocessor_time;
+  summary.total_time_in_seconds = total_time;
+  return summary;
+}
+
+}  // namespace fuse_graphs
@@ -33,36 +33,90 @@
  */
 #include <fuse_graphs/hash_graph.h>
 
+#include <fuse_core/eigen.h>
 #include <fuse_core/uuid.h>
 #include <pluginlib/class_list_macros.hpp>
 
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/serialization/export.hpp>
+#include <ceres/crs_matrix.h>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
 
 #include <algorithm>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 
+namespace
+{
+
+/**
+ * @brief Compute the Jacobian of the variable's parameter space with respect to its tangent space
+ *
+ * @param[in] variable The variable of interest
+ * @return The (size x localSize) Jacobian, or the identity if the variable has no local parameterization
+ */
+fuse_core::MatrixXd parameterSpaceJacobian(const fuse_core::Variable& variable)
+{
+  auto local_parameterization = std::unique_ptr<fuse_core::LocalParameterization>(variable.localParameterization());
+  if (!local_parameterization)
+  {
+    return fuse_core::MatrixXd::Identity(variable.size(), variable.size());
+  }
+  fuse_core::MatrixXd jacobian(variable.size(), variable.localSize());
+  local_parameterization->ComputeJacobian(variable.data(), jacobian.data());
+  return jacobian;
+}
+
+}  // namespace
+
 namespace fuse_graphs
 {
 
+struct HashGraph::CovarianceFactorization
+{
+  /**
+   * @brief The location of a variable's tangent space within the information matrix
+   */
+  struct Columns
+  {
+    Eigen::Index offset;  //!< The index of the first column belonging to the variable
+    Eigen::Index size;  //!< The number of columns belonging to the variable
+  };
+
+  bool apply_loss_function { true };  //!< The loss function setting used when evaluating the Jacobian
+  Eigen::Index dimension { 0 };  //!< The total dimension of the information matrix
+  std::unordered_map<fuse_core::UUID, Columns, fuse_core::uuid::hash> columns;  //!< The columns of each variable
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;  //!< The factorization of the information matrix
+  bool valid { false };  //!< Flag indicating the information matrix was factored successfully
+};
+
 HashGraph::HashGraph(const HashGraphParams& params) :
+  gnc_params_(params.gnc),
   problem_options_(params.problem_options)
 {
+  gnc_params_.validate();
   // Set Ceres loss function ownership according to the fuse_core::Loss specification
   problem_options_.loss_function_ownership = fuse_core::Loss::Ownership;
 }
 
 HashGraph::HashGraph(const HashGraph& other) :
   constraints_by_variable_uuid_(other.constraints_by_variable_uuid_),
+  gnc_params_(other.gnc_params_),
   problem_options_(other.problem_options_),
   variables_on_hold_(other.variables_on_hold_)
 {
+  // The retained factorization is indexed by UUID, so it remains valid for the copied variables
+  {
+    std::lock_guard<std::mutex> lock(other.covariance_factorization_mutex_);
+    covariance_factorization_ = other.covariance_factorization_;
+  }
   // Make a deep copy of the constraints
   std::transform(other.constraints_.begin(),
                  other.constraints_.end(),
@@ -88,9 +142,14 @@ HashGraph& HashGraph::operator=(const HashGraph& other)
   // Then swap (won't throw an exception)
   std::swap(constraints_, tmp.constraints_);
   std::swap(constraints_by_variable_uuid_, tmp.constraints_by_variable_uuid_);
+  std::swap(gnc_params_, tmp.gnc_params_);
   std::swap(problem_options_, tmp.problem_options_);
   std::swap(variables_, tmp.variables_);
   std::swap(variables_on_hold_, tmp.variables_on_hold_);
+  {
+    std::lock_guard<std::mutex> lock(covariance_factorization_mutex_);
+    std::swap(covariance_factorization_, tmp.covariance_factorization_);
+  }
   return *this;
 }
 
@@ -100,6 +159,7 @@ void HashGraph::clear()
   constraints_by_variable_uuid_.clear();
   variables_.clear();
   variables_on_hold_.clear();
+  invalidateCovarianceFactorization();
 }
 
 fuse_core::Graph::UniquePtr HashGraph::clone() const
@@ -138,6 +198,7 @@ bool HashGraph::addConstraint(fuse_core::Constraint::SharedPtr constraint)
   {
     constraints_by_variable_uuid_[variable_uuid].push_back(constraint->uuid());
   }
+  invalidateCovarianceFactorization();
   return true;
 }
 
@@ -157,6 +218,7 @@ bool HashGraph::removeConstraint(const fuse_core::UUID& constraint_uuid)
   }
   // And remove the constraint
   constraints_.erase(constraints_iter);  // This does not throw
+  invalidateCovarianceFactorization();
   return true;
 }
 
@@ -212,6 +274,31 @@ fuse_core::Graph::const_constraint_range HashGraph::getConnectedConstraints(cons
   }
 }
 
+void HashGraph::forEachConstraint(ConstraintVisitor visitor) const
+{
+  for (const auto& uuid__constraint : constraints_)
+  {
+    visitor(*uuid__constraint.second);
+  }
+}
+
+void HashGraph::forEachConnectedConstraint(const fuse_core::UUID& variable_uuid, ConstraintVisitor visitor) const
+{
+  auto cross_reference_iter = constraints_by_variable_uuid_.find(variable_uuid);
+  if (cross_reference_iter != constraints_by_variable_uuid_.end())
+  {
+    for (const auto& constraint_uuid : cross_reference_iter->second)
+    {
+      visitor(*constraints_.at(constraint_uuid));
+    }
+  }
+  else if (!variableExists(variable_uuid))
+  {
+    throw std::logic_error("Attempting to access constraints connected to variable ("
+        + fuse_core::uuid::to_string(variable_uuid) + "), but that variable does not exist in this graph.");
+  }
+}
+
 bool HashGraph::variableExists(const fuse_core::UUID& variable_uuid) const noexcept
 {
   auto variables_iter = variables_.find(variable_uuid);
@@ -230,6 +317,7 @@ bool HashGraph::addVariable(fuse_core::Variable::SharedPtr variable)
   {
     variables_on_hold_.insert(variable->uuid());
   }
+  invalidateCovarianceFactorization();
   return true;
 }
 
@@ -256,6 +344,7 @@ bool HashGraph::removeVariable(const fuse_core::UUID& variable_uuid)
     constraints_by_variable_uuid_.erase(cross_reference_iter);
   }
   variables_on_hold_.erase(variable_uuid);
+  invalidateCovarianceFactorization();
   return true;
 }
 
@@ -282,6 +371,14 @@ fuse_core::Graph::const_variable_range HashGraph::getVariables() const noexcept
     boost::make_transform_iterator(variables_.cend(), to_variable_ref));
 }
 
+void HashGraph::forEachVariable(VariableVisitor visitor) const
+{
+  for (const auto& uuid__variable : variables_)
+  {
+    visitor(*uuid__variable.second);
+  }
+}
+
 void HashGraph::holdVariable(const fuse_core::UUID& variable_uuid, bool hold_constant)
 {
   // Adjust the variable setting in the Ceres Problem object
@@ -293,6 +390,7 @@ void HashGraph::holdVariable(const fuse_core::UUID& variable_uuid, bool hold_con
   {
     variables_on_hold_.erase(variable_uuid);
   }
+  invalidateCovarianceFactorization();
 }
 
 bool HashGraph::isVariableOnHold(const fuse_core::UUID& variable_uuid) const
@@ -311,6 +409,13 @@ void HashGraph::getCovariance(
   {
     return;
   }
+  // Try to answer the request from the retained factorization first. The DENSE_SVD algorithm handles rank deficient
+  // problems differently, so leave those requests to Ceres.
+  if ((options.algorithm_type == ceres::SPARSE_QR) &&
+      getCovarianceFromFactorization(covariance_requests, covariance_matrices, options, use_tangent_space))
+  {
+    return;
+  }
   // Construct the ceres::Problem object from scratch
   ceres::Problem problem(problem_options_);
   createProblem(problem);
@@ -413,14 +518,169 @@ void HashGraph::getCovariance(
   }
 }
 
+bool HashGraph::getCovarianceFromFactorization(
+  const std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>>& covariance_requests,
+  std::vector<std::vector<double>>& covariance_matrices,
+  const ceres::Covariance::Options& options,
+  const bool use_tangent_space) const
+{
+  // Verify all of the requested variables exist before doing any work
+  for (const auto& request : covariance_requests)
+  {
+    if (!variableExists(request.first))
+    {
+      throw std::out_of_range("The variable UUID " + fuse_core::uuid::to_string(request.first)
+                            + " does not exist.");
+    }
+    if (!variableExists(request.second))
+    {
+      throw std::out_of_range("The variable UUID " + fuse_core::uuid::to_string(request.second)
+                            + " does not exist.");
+    }
+  }
+  auto factorization = covarianceFactorization(options);
+  if (!factorization)
+  {
+    return false;
+  }
+  // Selective inversion: only the columns of the inverse information matrix that belong to the second variable of
+  // each request are computed. Variables held constant have zero covariance and are not part of the factorization.
+  std::unordered_map<fuse_core::UUID, Eigen::Index, fuse_core::uuid::hash> rhs_offsets;
+  Eigen::Index rhs_size = 0;
+  for (const auto& request : covariance_requests)
+  {
+    if (isVariableOnHold(request.first) || isVariableOnHold(request.second))
+    {
+      continue;
+    }
+    if ((factorization->columns.find(request.first) == factorization->columns.end()) ||
+        (factorization->columns.find(request.second) == factorization->columns.end()))
+    {
+      // This variable is not connected to any constraint. Let Ceres report the problem.
+      return false;
+    }
+    if (rhs_offsets.emplace(request.second, rhs_size).second)
+    {
+      rhs_size += factorization->columns.at(request.second).size;
+    }
+  }
+  Eigen::MatrixXd inverse_columns;
+  if (rhs_size > 0)
+  {
+    Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(factorization->dimension, rhs_size);
+    for (const auto& uuid__offset : rhs_offsets)
+    {
+      const auto& columns = factorization->columns.at(uuid__offset.first);
+      rhs.block(columns.offset, uuid__offset.second, columns.size, columns.size).setIdentity();
+    }
+    inverse_columns = factorization->solver.solve(rhs);
+    if (factorization->solver.info() != Eigen::Success)
+    {
+      return false;
+    }
+  }
+  // Extract the requested blocks into the output structure
+  covariance_matrices.resize(covariance_requests.size());
+  for (size_t i = 0; i < covariance_requests.size(); ++i)
+  {
+    const auto& request = covariance_requests[i];
+    const auto& variable1 = *variables_.at(request.first);
+    const auto& variable2 = *variables_.at(request.second);
+    const auto rows = use_tangent_space ? variable1.localSize() : variable1.size();
+    const auto cols = use_tangent_space ? variable2.localSize() : variable2.size();
+    auto& output_matrix = covariance_matrices[i];
+    output_matrix.assign(rows * cols, 0.0);
+    auto rhs_offsets_iter = rhs_offsets.find(request.second);
+    if (isVariableOnHold(request.first) || rhs_offsets_iter == rhs_offsets.end())
+    {
+      continue;
+    }
+    const auto& columns1 = factorization->columns.at(request.first);
+    const auto& columns2 = factorization->columns.at(request.second);
+    Eigen::MatrixXd block =
+      inverse_columns.block(columns1.offset, rhs_offsets_iter->second, columns1.size, columns2.size);
+    if (!use_tangent_space)
+    {
+      block = parameterSpaceJacobian(variable1) * block * parameterSpaceJacobian(variable2).transpose();
+    }
+    fuse_core::MatrixXd::Map(output_matrix.data(), rows, cols) = block;
+  }
+  return true;
+}
+
+std::shared_ptr<const HashGraph::CovarianceFactorization> HashGraph::covarianceFactorization(
+  const ceres::Covariance::Options& options) const
+{
+  std::lock_guard<std::mutex> lock(covariance_factorization_mutex_);
+  if (!covariance_factorization_ || (covariance_factorization_->apply_loss_function != options.apply_loss_function))
+  {
+    auto factorization = std::make_shared<CovarianceFactorization>();
+    factorization->apply_loss_function = options.apply_loss_function;
+    // Only variables that are free to move and are involved in at least one constraint contribute columns
+    ceres::Problem::EvaluateOptions evaluate_options;
+    evaluate_options.apply_loss_function = options.apply_loss_function;
+    evaluate_options.num_threads = options.num_threads;
+    for (const auto& uuid__variable : variables_)
+    {
+      const auto& variable_uuid = uuid__variable.first;
+      auto cross_reference_iter = constraints_by_variable_uuid_.find(variable_uuid);
+      if (isVariableOnHold(variable_uuid) ||
+          cross_reference_iter == constraints_by_variable_uuid_.end() ||
+          cross_reference_iter->second.empty())
+      {
+        continue;
+      }
+      const auto local_size = static_cast<Eigen::Index>(uuid__variable.second->localSize());
+      evaluate_options.parameter_blocks.push_back(uuid__variable.second->data());
+      factorization->columns.emplace(variable_uuid, CovarianceFactorization::Columns{factorization->dimension,
+                                                                                     local_size});
+      factorization->dimension += local_size;
+    }
+    // Evaluate the Jacobian at the current variable values and factor the information matrix
+    ceres::Problem problem(problem_options_);
+    createProblem(problem);
+    ceres::CRSMatrix jacobian;
+    if ((factorization->dimension > 0) &&
+        problem.Evaluate(evaluate_options, nullptr, nullptr, nullptr, &jacobian))
+    {
+      Eigen::Map<const Eigen::SparseMatrix<double, Eigen::RowMajor, int>> jacobian_map(
+        jacobian.num_rows,
+        jacobian.num_cols,
+        static_cast<Eigen::Index>(jacobian.values.size()),
+        jacobian.rows.data(),
+        jacobian.cols.data(),
+        jacobian.values.data());
+      Eigen::SparseMatrix<double> information = jacobian_map.transpose() * jacobian_map;
+      factorization->solver.compute(information);
+      // Reject factorizations that are numerically rank deficient. Ceres is better equipped to report those.
+      if (factorization->solver.info() == Eigen::Success)
+      {
+        const auto& d = factorization->solver.vectorD();
+        factorization->valid = (d.minCoeff() > 0.0) &&
+                               (d.minCoeff() >= options.min_reciprocal_condition_number * d.maxCoeff());
+      }
+    }
+    // Retain the result, even on failure, so the factorization is not attempted again until the graph changes
+    covariance_factorization_ = std::move(factorization);
+  }
+  return covariance_factorization_->valid ? covariance_factorization_ : nullptr;
+}
+
+void HashGraph::invalidateCovarianceFactorization()
+{
+  std::lock_guard<std::mutex> lock(covariance_factorization_mutex_);
+  covariance_factorization_.reset();
+}
+
 ceres::Solver::Summary HashGraph::optimize(const ceres::Solver::Options& options)
 {
-  // Construct the ceres::Problem object from scratch
+  // Construct the ceres::Problem object from scratch. The GNC loss functions must outlive the problem.
+  GraduatedNonConvexity gnc(gnc_params_);
   ceres::Problem problem(problem_options_);
-  createProblem(problem);
+  createProblem(problem, &gnc);
   // Run the solver. This will update the variables in place.
-  ceres::Solver::Summary summary;
-  ceres::Solve(options, &problem, &summary);
+  invalidateCovarianceFactorization();
+  auto summary = gnc.solve(options, problem);
   // Return the optimization summary
   return summary;
 }
@@ -430,17 +690,18 @@ ceres::Solver::Summary HashGraph::optimizeFor(
   const ceres::Solver::Options& options)
 {
   auto start = std::chrono::system_clock::now();
-  // Construct the ceres::Problem object from scratch
+  // Construct the ceres::Problem object from scratch. The GNC loss functions must outlive the problem.
+  GraduatedNonConvexity gnc(gnc_params_);
   ceres::Problem problem(problem_options_);
-  createProblem(problem);
+  createProblem(problem, &gnc);
   auto created_problem = std::chrono::system_clock::now();
   // Modify the options to enforce the maximum time
   std::chrono::nanoseconds remaining = max_optimization_time - (created_problem - start);
   auto time_constrained_options = options;
   time_constrained_options.max_solver_time_in_seconds = std::max(0.0, std::chrono::duration<double>(remaining).count());
   // Run the solver. This will update the variables in place.
-  ceres::Solver::Summary summary;
-  ceres::Solve(time_constrained_options, &problem, &summary);
+  invalidateCovarianceFactorization();
+  auto summary = gnc.solve(time_constrained_options, problem);
   // Return the optimization summary
   return summary;
 }
@@ -472,7 +733,7 @@ void HashGraph::print(std::ostream& stream) const
   }
 }
 
-void HashGraph::createProblem(ceres::Problem& problem) const
+void HashGraph::createProblem(ceres::Problem& problem, GraduatedNonConvexity* gnc) const
 {
   // Add all the variables to the problem
   for (auto& uuid__variable : variables_)
@@ -516,7 +777,7 @@ void HashGraph::createProblem(ceres::Problem& problem) const
     }
     problem.AddResidualBlock(
       constraint.costFunction(),
-      constraint.lossFunction(),
+      gnc ? gnc->lossFunction(constraint.lossFunction()) : constraint.lossFunction(),
       parameter_blocks);
   }
 }
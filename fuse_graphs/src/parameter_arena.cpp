@@ -0,0 +1,92 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/parameter_arena.h>
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+
+namespace fuse_graphs
+{
+
+constexpr size_t ParameterArena::alignment;
+
+void ParameterArena::AlignedDelete::operator()(double* buffer) const noexcept
+{
+  ::operator delete[](buffer, std::align_val_t(alignment));
+}
+
+ParameterArena::ParameterArena(size_t buffer_size) :
+  buffer_size_(std::max<size_t>(buffer_size, 1))
+{
+}
+
+double* ParameterArena::allocate(size_t size)
+{
+  if (buffers_.empty() || (buffers_.back().capacity - buffers_.back().used < size))
+  {
+    // Start a new buffer. Oversized blocks get a buffer of their own.
+    const auto capacity = std::max(size, buffer_size_);
+    auto data = static_cast<double*>(::operator new[](capacity * sizeof(double), std::align_val_t(alignment)));
+    buffers_.push_back(Buffer{std::unique_ptr<double[], AlignedDelete>(data), capacity, 0});
+  }
+  auto& buffer = buffers_.back();
+  double* block = buffer.data.get() + buffer.used;
+  buffer.used += size;
+  size_ += size;
+  allocated_ += size;
+  return block;
+}
+
+void ParameterArena::release(size_t size) noexcept
+{
+  size_ -= std::min(size, size_);
+}
+
+void ParameterArena::clear() noexcept
+{
+  if (buffers_.size() > 1)
+  {
+    buffers_.erase(std::next(buffers_.begin()), buffers_.end());
+  }
+  if (!buffers_.empty())
+  {
+    buffers_.front().used = 0;
+  }
+  size_ = 0;
+  allocated_ = 0;
+}
+
+}  // namespace fuse_graphs
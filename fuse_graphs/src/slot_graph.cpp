@@ -0,0 +1,633 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/slot_graph.h>
+
+#include <fuse_core/uuid.h>
+#include <pluginlib/class_list_macros.hpp>
+
+#include <boost/iterator/transform_iterator.hpp>
+#include <boost/serialization/export.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_graphs
+{
+
+SlotGraph::SlotGraph(const SlotGraphParams& params) :
+  gnc_params_(params.gnc),
+  problem_options_(params.problem_options),
+  use_parameter_arena_(params.use_parameter_arena)
+{
+  gnc_params_.validate();
+  // Set Ceres loss function ownership according to the fuse_core::Loss specification
+  problem_options_.loss_function_ownership = fuse_core::Loss::Ownership;
+}
+
+SlotGraph::SlotGraph(const SlotGraph& other) :
+  constraints_(other.constraints_),
+  constraint_index_(other.constraint_index_),
+  gnc_params_(other.gnc_params_),
+  problem_options_(other.problem_options_),
+  use_parameter_arena_(other.use_parameter_arena_),
+  variables_(other.variables_),
+  variable_index_(other.variable_index_)
+{
+  // The slot layout is copied as-is. Replace the shared pointers with deep copies of the constraints and variables.
+  for (auto& slot : constraints_)
+  {
+    slot.constraint = slot.constraint->clone();
+  }
+  // The parameter blocks of the other graph must not be shared. This also packs the copied arena in slot order.
+  for (auto& slot : variables_)
+  {
+    slot.variable = slot.variable->clone();
+    assignParameters(slot);
+  }
+}
+
+SlotGraph& SlotGraph::operator=(const SlotGraph& other)
+{
+  // Make a copy (might throw an exception)
+  SlotGraph tmp(other);
+  // Then swap (won't throw an exception)
+  std::swap(constraints_, tmp.constraints_);
+  std::swap(constraint_index_, tmp.constraint_index_);
+  std::swap(gnc_params_, tmp.gnc_params_);
+  std::swap(parameter_arena_, tmp.parameter_arena_);
+  std::swap(problem_options_, tmp.problem_options_);
+  std::swap(use_parameter_arena_, tmp.use_parameter_arena_);
+  std::swap(variables_, tmp.variables_);
+  std::swap(variable_index_, tmp.variable_index_);
+  return *this;
+}
+
+void SlotGraph::clear()
+{
+  constraints_.clear();
+  constraint_index_.clear();
+  parameter_arena_.clear();
+  variables_.clear();
+  variable_index_.clear();
+}
+
+fuse_core::Graph::UniquePtr SlotGraph::clone() const
+{
+  return SlotGraph::make_unique(*this);
+}
+
+bool SlotGraph::constraintExists(const fuse_core::UUID& constraint_uuid) const noexcept
+{
+  return constraint_index_.find(constraint_uuid) != UuidIndex::npos;
+}
+
+bool SlotGraph::addConstraint(fuse_core::Constraint::SharedPtr constraint)
+{
+  // Do nothing if the constraint is empty, or the constraint already exists
+  if (!constraint || constraintExists(constraint->uuid()))
+  {
+    return false;
+  }
+  // Resolve the slots of all of the referenced variables. Throw a logic_error if they do not exist.
+  ConstraintSlot slot;
+  slot.constraint = std::move(constraint);
+  slot.variables.reserve(slot.constraint->variables().size());
+  for (const auto& variable_uuid : slot.constraint->variables())
+  {
+    auto variable_index = variable_index_.find(variable_uuid);
+    if (variable_index == UuidIndex::npos)
+    {
+      throw std::logic_error("Attempting to add a constraint (" + fuse_core::uuid::to_string(slot.constraint->uuid()) +
+                             ") that uses an unknown variable (" + fuse_core::uuid::to_string(variable_uuid) + ").");
+    }
+    slot.variables.push_back(variable_index);
+  }
+  // Add the constraint to the end of the constraint array
+  const auto constraint_index = static_cast<Index>(constraints_.size());
+  for (const auto& variable_index : slot.variables)
+  {
+    variables_[variable_index].constraints.push_back(constraint_index);
+  }
+  constraint_index_.assign(slot.constraint->uuid(), constraint_index);
+  constraints_.push_back(std::move(slot));
+  return true;
+}
+
+bool SlotGraph::removeConstraint(const fuse_core::UUID& constraint_uuid)
+{
+  // Check if the constraint exists
+  const auto constraint_index = constraint_index_.find(constraint_uuid);
+  if (constraint_index == UuidIndex::npos)
+  {
+    return false;
+  }
+  // Remove the constraint from the cross-reference of each variable
+  for (const auto& variable_index : constraints_[constraint_index].variables)
+  {
+    auto& constraints = variables_[variable_index].constraints;
+    constraints.erase(std::remove(constraints.begin(), constraints.end(), constraint_index), constraints.end());
+  }
+  // Move the last constraint into the vacated slot, and update the references to the moved constraint
+  const auto last_index = static_cast<Index>(constraints_.size() - 1);
+  if (constraint_index != last_index)
+  {
+    auto& slot = constraints_[constraint_index];
+    slot = std::move(constraints_[last_index]);
+    for (const auto& variable_index : slot.variables)
+    {
+      auto& constraints = variables_[variable_index].constraints;
+      std::replace(constraints.begin(), constraints.end(), last_index, constraint_index);
+    }
+    constraint_index_.assign(slot.constraint->uuid(), constraint_index);
+  }
+  constraints_.pop_back();
+  constraint_index_.erase(constraint_uuid);
+  return true;
+}
+
+const fuse_core::Constraint& SlotGraph::getConstraint(const fuse_core::UUID& constraint_uuid) const
+{
+  const auto constraint_index = constraint_index_.find(constraint_uuid);
+  if (constraint_index == UuidIndex::npos)
+  {
+    throw std::out_of_range("The constraint UUID " + fuse_core::uuid::to_string(constraint_uuid) + " does not exist.");
+  }
+  return *constraints_[constraint_index].constraint;
+}
+
+fuse_core::Graph::const_constraint_range SlotGraph::getConstraints() const noexcept
+{
+  std::function<const fuse_core::Constraint&(const ConstraintSlot& slot)> to_constraint_ref =
+    [](const ConstraintSlot& slot) -> const fuse_core::Constraint&
+    {
+      return *slot.constraint;
+    };
+
+  return fuse_core::Graph::const_constraint_range(
+    boost::make_transform_iterator(constraints_.cbegin(), to_constraint_ref),
+    boost::make_transform_iterator(constraints_.cend(), to_constraint_ref));
+}
+
+fuse_core::Graph::const_constraint_range SlotGraph::getConnectedConstraints(const fuse_core::UUID& variable_uuid) const
+{
+  const auto variable_index = variable_index_.find(variable_uuid);
+  if (variable_index == UuidIndex::npos)
+  {
+    // We only want to throw if the requested variable does not exist.
+    throw std::logic_error("Attempting to access constraints connected to variable ("
+        + fuse_core::uuid::to_string(variable_uuid) + "), but that variable does not exist in this graph.");
+  }
+
+  std::function<const fuse_core::Constraint&(Index constraint_index)> index_to_constraint_ref =
+    [this](Index constraint_index) -> const fuse_core::Constraint&
+    {
+      return *this->constraints_[constraint_index].constraint;
+    };
+
+  const auto& constraints = variables_[variable_index].constraints;
+  return fuse_core::Graph::const_constraint_range(
+    boost::make_transform_iterator(constraints.cbegin(), index_to_constraint_ref),
+    boost::make_transform_iterator(constraints.cend(), index_to_constraint_ref));
+}
+
+void SlotGraph::forEachConstraint(ConstraintVisitor visitor) const
+{
+  for (const auto& slot : constraints_)
+  {
+    visitor(*slot.constraint);
+  }
+}
+
+void SlotGraph::forEachConnectedConstraint(const fuse_core::UUID& variable_uuid, ConstraintVisitor visitor) const
+{
+  const auto variable_index = variable_index_.find(variable_uuid);
+  if (variable_index == UuidIndex::npos)
+  {
+    throw std::logic_error("Attempting to access constraints connected to variable ("
+        + fuse_core::uuid::to_string(variable_uuid) + "), but that variable does not exist in this graph.");
+  }
+  for (const auto& constraint_index : variables_[variable_index].constraints)
+  {
+    visitor(*constraints_[constraint_index].constraint);
+  }
+}
+
+bool SlotGraph::variableExists(const fuse_core::UUID& variable_uuid) const noexcept
+{
+  return variable_index_.find(variable_uuid) != UuidIndex::npos;
+}
+
+bool SlotGraph::addVariable(fuse_core::Variable::SharedPtr variable)
+{
+  // Do nothing if the variable is empty, or the variable already exists
+  if (!variable || variableExists(variable->uuid()))
+  {
+    return false;
+  }
+  VariableSlot slot;
+  slot.on_hold = variable->holdConstant();
+  slot.variable = std::move(variable);
+  assignParameters(slot);
+  variable_index_.assign(slot.variable->uuid(), static_cast<Index>(variables_.size()));
+  variables_.push_back(std::move(slot));
+  return true;
+}
+
+bool SlotGraph::removeVariable(const fuse_core::UUID& variable_uuid)
+{
+  // Check if the variable exists
+  const auto variable_index = variable_index_.find(variable_uuid);
+  if (variable_index == UuidIndex::npos)
+  {
+    return false;
+  }
+  // Check that this variable is not used by any constraint. Throw a logic_error if the variable is currently used.
+  const auto& constraints = variables_[variable_index].constraints;
+  if (!constraints.empty())
+  {
+    throw std::logic_error("Attempting to remove a variable (" + fuse_core::uuid::to_string(variable_uuid)
+      + ") that is used by existing constraints ("
+      + fuse_core::uuid::to_string(constraints_[constraints.front()].constraint->uuid())
+      + " plus " + std::to_string(constraints.size() - 1) + " others).");
+  }
+  if (use_parameter_arena_)
+  {
+    parameter_arena_.release(variables_[variable_index].variable->size());
+  }
+  // Move the last variable into the vacated slot, and update the references to the moved variable
+  const auto last_index = static_cast<Index>(variables_.size() - 1);
+  if (variable_index != last_index)
+  {
+    auto& slot = variables_[variable_index];
+    slot = std::move(variables_[last_index]);
+    for (const auto& constraint_index : slot.constraints)
+    {
+      auto& variables = constraints_[constraint_index].variables;
+      std::replace(variables.begin(), variables.end(), last_index, variable_index);
+    }
+    variable_index_.assign(slot.variable->uuid(), variable_index);
+  }
+  variables_.pop_back();
+  variable_index_.erase(variable_uuid);
+  // Reclaim the space of the removed variables once enough of the arena is unused, such as after marginalization
+  if (use_parameter_arena_ && parameter_arena_.fragmented())
+  {
+    compactParameterArena();
+  }
+  return true;
+}
+
+const fuse_core::Variable& SlotGraph::getVariable(const fuse_core::UUID& variable_uuid) const
+{
+  const auto variable_index = variable_index_.find(variable_uuid);
+  if (variable_index == UuidIndex::npos)
+  {
+    throw std::out_of_range("The variable UUID " + fuse_core::uuid::to_string(variable_uuid) + " does not exist.");
+  }
+  return *variables_[variable_index].variable;
+}
+
+fuse_core::Graph::const_variable_range SlotGraph::getVariables() const noexcept
+{
+  std::function<const fuse_core::Variable&(const VariableSlot& slot)> to_variable_ref =
+    [](const VariableSlot& slot) -> const fuse_core::Variable&
+    {
+      return *slot.variable;
+    };
+
+  return fuse_core::Graph::const_variable_range(
+    boost::make_transform_iterator(variables_.cbegin(), to_variable_ref),
+    boost::make_transform_iterator(variables_.cend(), to_variable_ref));
+}
+
+void SlotGraph::forEachVariable(VariableVisitor visitor) const
+{
+  for (const auto& slot : variables_)
+  {
+    visitor(*slot.variable);
+  }
+}
+
+fuse_core::Graph::const_variable_range SlotGraph::getConnectedVariables(const fuse_core::UUID& constraint_uuid) const
+{
+  const auto constraint_index = constraint_index_.find(constraint_uuid);
+  if (constraint_index == UuidIndex::npos)
+  {
+    throw std::out_of_range("The constraint UUID " + fuse_core::uuid::to_string(constraint_uuid) + " does not exist.");
+  }
+
+  std::function<const fuse_core::Variable&(Index variable_index)> index_to_variable_ref =
+    [this](Index variable_index) -> const fuse_core::Variable&
+    {
+      return *this->variables_[variable_index].variable;
+    };
+
+  const auto& variables = constraints_[constraint_index].variables;
+  return fuse_core::Graph::const_variable_range(
+    boost::make_transform_iterator(variables.cbegin(), index_to_variable_ref),
+    boost::make_transform_iterator(variables.cend(), index_to_variable_ref));
+}
+
+void SlotGraph::holdVariable(const fuse_core::UUID& variable_uuid, bool hold_constant)
+{
+  const auto variable_index = variable_index_.find(variable_uuid);
+  if (variable_index == UuidIndex::npos)
+  {
+    throw std::out_of_range("The variable UUID " + fuse_core::uuid::to_string(variable_uuid) + " does not exist.");
+  }
+  variables_[variable_index].on_hold = hold_constant;
+}
+
+bool SlotGraph::isVariableOnHold(const fuse_core::UUID& variable_uuid) const
+{
+  const auto variable_index = variable_index_.find(variable_uuid);
+  return (variable_index != UuidIndex::npos) && variables_[variable_index].on_hold;
+}
+
+void SlotGraph::getCovariance(
+  const std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>>& covariance_requests,
+  std::vector<std::vector<double>>& covariance_matrices,
+  const ceres::Covariance::Options& options,
+  const bool use_tangent_space) const
+{
+  // Avoid doing a bunch of work if the request is empty
+  if (covariance_requests.empty())
+  {
+    return;
+  }
+  // Construct the ceres::Problem object from scratch
+  ceres::Problem problem(problem_options_);
+  createProblem(problem);
+  // The Ceres interface requires that the variable pairs not contain duplicates. Since the covariance matrix is
+  // symmetric, requesting Cov(A,B) and Cov(B,A) counts as a duplicate. Create an expression to test a pair of data
+  // pointers such that (A,B) == (A,B) OR (B,A)
+  auto symmetric_equal = [](const std::pair<const double*, const double*>& x,
+                            const std::pair<const double*, const double*>& y)
+  {
+    return ((x.first == y.first) && (x.second == y.second))
+        || ((x.first == y.second) && (x.second == y.first));
+  };
+  // Convert the covariance requests into the input structure needed by Ceres. Namely, we must convert the variable
+  // UUIDs into memory addresses. We create two containers of covariance blocks: one only contains the unique variable
+  // pairs that we give to Ceres, and a second that contains all requested variable pairs used to keep the output
+  // structure in sync with the request structure.
+  std::vector<std::pair<const double*, const double*> > unique_covariance_blocks;
+  std::vector<std::pair<const double*, const double*> > all_covariance_blocks;
+  all_covariance_blocks.resize(covariance_requests.size());
+  covariance_matrices.resize(covariance_requests.size());
+  for (size_t i = 0; i < covariance_requests.size(); ++i)
+  {
+    const auto& request = covariance_requests.at(i);
+    const auto& variable1 = getVariable(request.first);
+    const auto& variable2 = getVariable(request.second);
+    // Both variables exist. Create the output covariance matrix.
+    if (use_tangent_space)
+    {
+      covariance_matrices[i].resize(variable1.localSize() * variable2.localSize());
+    }
+    else
+    {
+      covariance_matrices[i].resize(variable1.size() * variable2.size());
+    }
+    // Add this covariance block to the container of all covariance blocks. This container is in sync with the
+    // covariance_requests vector.
+    auto& block = all_covariance_blocks.at(i);
+    block.first = variables_[variable_index_.find(request.first)].variable->data();
+    block.second = variables_[variable_index_.find(request.second)].variable->data();
+    // Also maintain a container of unique covariance blocks. Since the covariance matrix is symmetric, requesting
+    // Cov(X,Y) and Cov(Y,X) counts as a duplicate, so we use our special symmetric_equal function to test.
+    if (std::none_of(unique_covariance_blocks.begin(),
+                     unique_covariance_blocks.end(),
+                     std::bind<bool>(symmetric_equal, block, std::placeholders::_1)))
+    {
+      unique_covariance_blocks.push_back(block);
+    }
+  }
+  // Call the Ceres function to compute the unique set of requested covariance blocks
+  ceres::Covariance covariance(options);
+  if (!covariance.Compute(unique_covariance_blocks, &problem))
+  {
+    throw std::runtime_error("Could not compute requested covariance blocks.");
+  }
+  // Populate the computed covariance blocks into the output variable.
+  for (size_t i = 0; i < covariance_requests.size(); ++i)
+  {
+    const auto& block = all_covariance_blocks.at(i);
+    auto& output_matrix = covariance_matrices.at(i);
+    const bool success = use_tangent_space ?
+      covariance.GetCovarianceBlockInTangentSpace(block.first, block.second, output_matrix.data()) :
+      covariance.GetCovarianceBlock(block.first, block.second, output_matrix.data());
+    if (!success)
+    {
+      const auto& request = covariance_requests.at(i);
+      throw std::runtime_error("Could not get covariance block for variable UUIDs " +
+                               fuse_core::uuid::to_string(request.first) + " and " +
+                               fuse_core::uuid::to_string(request.second) + ".");
+    }
+  }
+}
+
+ceres::Solver::Summary SlotGraph::optimize(const ceres::Solver::Options& options)
+{
+  // Construct the ceres::Problem object from scratch. The GNC loss functions must outlive the problem.
+  GraduatedNonConvexity gnc(gnc_params_);
+  ceres::Problem problem(problem_options_);
+  copyVariablesToParameters();
+  createProblem(problem, use_parameter_arena_, &gnc);
+  // Run the solver. This will update the variables in place.
+  auto summary = gnc.solve(options, problem);
+  copyParametersToVariables();
+  // Return the optimization summary
+  return summary;
+}
+
+ceres::Solver::Summary SlotGraph::optimizeFor(
+  const std::chrono::nanoseconds& max_optimization_time,
+  const ceres::Solver::Options& options)
+{
+  auto start = std::chrono::system_clock::now();
+  // Construct the ceres::Problem object from scratch. The GNC loss functions must outlive the problem.
+  GraduatedNonConvexity gnc(gnc_params_);
+  ceres::Problem problem(problem_options_);
+  copyVariablesToParameters();
+  createProblem(problem, use_parameter_arena_, &gnc);
+  auto created_problem = std::chrono::system_clock::now();
+  // Modify the options to enforce the maximum time
+  std::chrono::nanoseconds remaining = max_optimization_time - (created_problem - start);
+  auto time_constrained_options = options;
+  time_constrained_options.max_solver_time_in_seconds = std::max(0.0, std::chrono::duration<double>(remaining).count());
+  // Run the solver. This will update the variables in place.
+  auto summary = gnc.solve(time_constrained_options, problem);
+  copyParametersToVariables();
+  // Return the optimization summary
+  return summary;
+}
+
+bool SlotGraph::evaluate(double* cost, std::vector<double>* residuals, std::vector<double>* gradient,
+                         const ceres::Problem::EvaluateOptions& options) const
+{
+  ceres::Problem problem(problem_options_);
+  createProblem(problem);
+
+  return problem.Evaluate(options, cost, residuals, gradient, nullptr);
+}
+
+void SlotGraph::print(std::ostream& stream) const
+{
+  stream << "SlotGraph\n"
+         << "  constraints:\n";
+  for (const auto& slot : constraints_)
+  {
+    stream << "   - " << *slot.constraint << "\n";
+  }
+  stream << "  variables:\n";
+  for (const auto& slot : variables_)
+  {
+    stream << "   - " << *slot.variable << "\n"
+           << "     on_hold: " << std::boolalpha << slot.on_hold << "\n";
+  }
+}
+
+void SlotGraph::createProblem(ceres::Problem& problem, const bool use_parameter_arena,
+                              GraduatedNonConvexity* gnc) const
+{
+  // Const queries must not touch the shared parameter arena, so they use the variable values directly
+  auto parameter_block = [use_parameter_arena](const VariableSlot& slot)
+  {
+    return use_parameter_arena ? slot.parameters : slot.variable->data();
+  };  // NOLINT(whitespace/braces)
+  // Add all the variables to the problem
+  for (const auto& slot : variables_)
+  {
+    const fuse_core::Variable& variable = *slot.variable;
+    double* parameters = parameter_block(slot);
+    problem.AddParameterBlock(
+      parameters,
+      variable.size(),
+      variable.localParameterization());
+    // Handle optimization bounds
+    for (size_t index = 0; index < variable.size(); ++index)
+    {
+      auto lower_bound = variable.lowerBound(index);
+      if (lower_bound > std::numeric_limits<double>::lowest())
+      {
+        problem.SetParameterLowerBound(parameters, index, lower_bound);
+      }
+      auto upper_bound = variable.upperBound(index);
+      if (upper_bound < std::numeric_limits<double>::max())
+      {
+        problem.SetParameterUpperBound(parameters, index, upper_bound);
+      }
+    }
+    // Handle variables that are held constant
+    if (slot.on_hold)
+    {
+      problem.SetParameterBlockConstant(parameters);
+    }
+  }
+  // Add the constraints. The variable slots are resolved directly, without any UUID lookups.
+  std::vector<double*> parameter_blocks;
+  for (const auto& slot : constraints_)
+  {
+    const fuse_core::Constraint& constraint = *slot.constraint;
+    parameter_blocks.clear();
+    parameter_blocks.reserve(slot.variables.size());
+    for (const auto& variable_index : slot.variables)
+    {
+      parameter_blocks.push_back(parameter_block(variables_[variable_index]));
+    }
+    problem.AddResidualBlock(
+      constraint.costFunction(),
+      gnc ? gnc->lossFunction(constraint.lossFunction()) : constraint.lossFunction(),
+      parameter_blocks);
+  }
+}
+
+void SlotGraph::assignParameters(VariableSlot& slot)
+{
+  if (use_parameter_arena_)
+  {
+    const auto& variable = *slot.variable;
+    slot.parameters = parameter_arena_.allocate(variable.size());
+    std::copy_n(variable.data(), variable.size(), slot.parameters);
+  }
+  else
+  {
+    slot.parameters = slot.variable->data();
+  }
+}
+
+void SlotGraph::compactParameterArena()
+{
+  parameter_arena_.clear();
+  for (auto& slot : variables_)
+  {
+    assignParameters(slot);
+  }
+}
+
+void SlotGraph::copyVariablesToParameters()
+{
+  if (!use_parameter_arena_)
+  {
+    return;
+  }
+  for (const auto& slot : variables_)
+  {
+    std::copy_n(slot.variable->data(), slot.variable->size(), slot.parameters);
+  }
+}
+
+void SlotGraph::copyParametersToVariables()
+{
+  if (!use_parameter_arena_)
+  {
+    return;
+  }
+  for (const auto& slot : variables_)
+  {
+    std::copy_n(slot.parameters, slot.variable->size(), slot.variable->data());
+  }
+}
+
+}  // namespace fuse_graphs
+
+BOOST_CLASS_EXPORT_IMPLEMENT(fuse_graphs::SlotGraph)
+PLUGINLIB_EXPORT_CLASS(fuse_graphs::SlotGraph, fuse_core::Graph)
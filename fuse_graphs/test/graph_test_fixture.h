@@ -0,0 +1,152 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_GRAPHS_TEST_GRAPH_TEST_FIXTURE_H  // NOLINT{build/header_guard}
+#define FUSE_GRAPHS_TEST_GRAPH_TEST_FIXTURE_H  // NOLINT{build/header_guard}
+
+#include <fuse_core/constraint.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+
+/**
+ * @brief Test fixture shared by the graph implementation tests
+ *
+ * This test fixture provides methods to compare variables and constraints, and allows to retrieve the last failure
+ * description, if any.
+ *
+ * @tparam GraphType The fuse_core::Graph implementation under test
+ */
+template <typename GraphType>
+class GraphTestFixture : public ::testing::Test
+{
+public:
+  /**
+   * @brief Compare all the properties of two Variable objects
+   *
+   * @param[in] expected - The expected variable
+   * @param[in] actual - The actual variable
+   * @return True if all the properties match, false otherwise
+   */
+  bool compareVariables(const fuse_core::Variable& expected, const fuse_core::Variable& actual)
+  {
+    failure_description = "";
+    bool variables_equal = true;
+    if (expected.type() != actual.type())
+    {
+      variables_equal = false;
+      failure_description += "The variables have different types.\n"
+        "  expected type is '" + expected.type() + "'\n"
+        "    actual type is '" + actual.type() + "'\n";
+    }
+    if (expected.size() != actual.size())
+    {
+      variables_equal = false;
+      failure_description += "The variables have different sizes.\n"
+        "  expected size is '" + std::to_string(expected.size()) + "'\n"
+        "    actual size is '" + std::to_string(actual.size()) + "'\n";
+    }
+    if (expected.uuid() != actual.uuid())
+    {
+      variables_equal = false;
+      failure_description += "The variables have different UUIDs.\n"
+        "  expected UUID is '" + fuse_core::uuid::to_string(expected.uuid()) + "'\n"
+        "    actual UUID is '" + fuse_core::uuid::to_string(actual.uuid()) + "'\n";
+    }
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+      if (expected.data()[i] != actual.data()[i])
+      {
+        variables_equal = false;
+        failure_description += "The variables have different values.\n"
+          "  expected data(" + std::to_string(i) + ") is '" + std::to_string(expected.data()[i]) + "'\n"
+          "    actual data(" + std::to_string(i) + ") is '" + std::to_string(actual.data()[i]) + "'\n";
+      }
+    }
+    return variables_equal;
+  }
+
+  /**
+   * @brief Compare all the properties of two Constraint objects
+   *
+   * @param[in] expected - The expected constraint
+   * @param[in] actual - The actual constraint
+   * @return True if all the properties match, false otherwise
+   */
+  bool compareConstraints(const fuse_core::Constraint& expected, const fuse_core::Constraint& actual)
+  {
+    failure_description = "";
+    bool constraints_equal = true;
+    if (expected.type() != actual.type())
+    {
+      constraints_equal = false;
+      failure_description += "The constraints have different types.\n"
+        "  expected type is '" + expected.type() + "'\n"
+        "    actual type is '" + actual.type() + "'\n";
+    }
+    if (expected.uuid() != actual.uuid())
+    {
+      constraints_equal = false;
+      failure_description += "The constraints have different UUIDs.\n"
+        "  expected UUID is '" + fuse_core::uuid::to_string(expected.uuid()) + "'\n"
+        "    actual UUID is '" + fuse_core::uuid::to_string(actual.uuid()) + "'\n";
+    }
+    if (expected.variables().size() != actual.variables().size())
+    {
+      constraints_equal = false;
+      failure_description += "The constraints involve a different number of variables.\n"
+        "  expected variable count is '" + std::to_string(expected.variables().size()) + "'\n"
+        "    actual variable count is '" + std::to_string(actual.variables().size()) + "'\n";
+    }
+    for (size_t i = 0; i < expected.variables().size(); ++i)
+    {
+      if (expected.variables().at(i) != actual.variables().at(i))
+      {
+        constraints_equal = false;
+        std::string i_str = std::to_string(i);
+        failure_description += "The constraints involve different variable UUIDs.\n"
+          "  expected variables(" + i_str + ") is '" + fuse_core::uuid::to_string(expected.variables()[i]) + "'\n"
+          "    actual variables(" + i_str + ") is '" + fuse_core::uuid::to_string(actual.variables()[i]) + "'\n";
+      }
+    }
+    return constraints_equal;
+  }
+
+  std::string failure_description { "" };  //!< The last failure description. Empty if no failure happened
+};
+
+#endif  // FUSE_GRAPHS_TEST_GRAPH_TEST_FIXTURE_H  // NOLINT{build/header_guard}
@@ -0,0 +1,269 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/loss.h>
+#include <fuse_core/serialization.h>
+#include <fuse_graphs/graduated_non_convexity.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_graphs/slot_graph.h>
+
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <ceres/loss_function.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+
+/**
+ * @brief Redescending loss used for testing. Residuals beyond 'a' have no influence on the solution.
+ */
+class TukeyTestLoss : public fuse_core::Loss
+{
+public:
+  FUSE_LOSS_DEFINITIONS(TukeyTestLoss);
+
+  explicit TukeyTestLoss(const double a = 1.0) : a(a)
+  {
+  }
+
+  void initialize(const std::string& /*name*/) override {}
+
+  void print(std::ostream& /*stream = std::cout*/) const override {}
+
+  ceres::LossFunction* createLossFunction() const override
+  {
+    return new ceres::TukeyLoss(a);
+  }
+
+  double a{ 1.0 };  //!< Public member variable just for testing
+
+private:
+  // Allow Boost Serialization access to private methods
+  friend class boost::serialization::access;
+
+  /**
+   * @brief The Boost Serialize method that serializes all of the data members in to/out of the archive
+   *
+   * @param[in/out] archive - The archive object that holds the serialized class members
+   * @param[in] version - The version of the archive being read/written. Generally unused.
+   */
+  template<class Archive>
+  void serialize(Archive& archive, const unsigned int /* version */)
+  {
+    archive & boost::serialization::base_object<fuse_core::Loss>(*this);
+    archive & a;
+  }
+};
+
+BOOST_CLASS_EXPORT(TukeyTestLoss);
+
+/**
+ * @brief Populate a graph with a single variable measured by a cluster of inliers around 0.0 and a smaller cluster
+ *        of outliers around 8.0, starting from an initial value close to the outliers
+ *
+ * @return The UUID of the variable
+ */
+fuse_core::UUID makeOutlierGraph(fuse_core::Graph& graph)
+{
+  auto variable = ExampleVariable::make_shared();
+  variable->data()[0] = 7.5;
+  graph.addVariable(variable);
+
+  auto loss = TukeyTestLoss::make_shared(1.0);
+  auto add_measurement = [&graph, &variable, &loss](const double data)
+  {
+    auto constraint = ExampleConstraint::make_shared("test", variable->uuid());
+    constraint->data = data;
+    constraint->loss(loss);
+    graph.addConstraint(constraint);
+  };  // NOLINT(whitespace/braces)
+  for (auto i = 0; i < 10; ++i)
+  {
+    add_measurement(0.01 * (i - 5));
+  }
+  for (auto i = 0; i < 6; ++i)
+  {
+    add_measurement(8.0 + 0.01 * (i - 3));
+  }
+  return variable->uuid();
+}
+
+TEST(GraduatedNonConvexity, LossFunction)
+{
+  // Scaling the loss by 'c' is equivalent to a loss with the parameter 'c * a'
+  const auto a = 0.5;
+  const auto c = 3.0;
+  ceres::HuberLoss loss(a);
+  ceres::HuberLoss expected_loss(c * a);
+
+  auto scale = 1.0;
+  fuse_graphs::GraduatedLossFunction graduated_loss(&loss, scale);
+  for (const auto s : { 0.01, 0.2, 1.0, 2.5, 10.0, 100.0 })
+  {
+    double expected[3];
+    double actual[3];
+    scale = 1.0;
+    loss.Evaluate(s, expected);
+    graduated_loss.Evaluate(s, actual);
+    for (auto i = 0; i < 3; ++i)
+    {
+      EXPECT_NEAR(expected[i], actual[i], 1.0e-12);
+    }
+
+    scale = c;
+    expected_loss.Evaluate(s, expected);
+    graduated_loss.Evaluate(s, actual);
+    for (auto i = 0; i < 3; ++i)
+    {
+      EXPECT_NEAR(expected[i], actual[i], 1.0e-12);
+    }
+  }
+}
+
+TEST(GraduatedNonConvexity, Wrappers)
+{
+  fuse_graphs::GraduatedNonConvexityParams params;
+  ceres::HuberLoss loss1(1.0);
+  ceres::HuberLoss loss2(2.0);
+
+  // Disabled, the configured loss functions are used as-is
+  {
+    fuse_graphs::GraduatedNonConvexity gnc(params);
+    EXPECT_EQ(nullptr, gnc.lossFunction(nullptr));
+    EXPECT_EQ(&loss1, gnc.lossFunction(&loss1));
+  }
+
+  // Enabled, a single wrapper is created for each distinct loss function
+  params.enable = true;
+  {
+    fuse_graphs::GraduatedNonConvexity gnc(params);
+    EXPECT_EQ(nullptr, gnc.lossFunction(nullptr));
+    auto wrapper1 = gnc.lossFunction(&loss1);
+    auto wrapper2 = gnc.lossFunction(&loss2);
+    EXPECT_NE(&loss1, wrapper1);
+    EXPECT_NE(wrapper1, wrapper2);
+    EXPECT_EQ(wrapper1, gnc.lossFunction(&loss1));
+  }
+}
+
+TEST(GraduatedNonConvexity, Validate)
+{
+  fuse_graphs::GraduatedNonConvexityParams params;
+  EXPECT_NO_THROW(params.validate());
+
+  params.initial_scale = 0.5;
+  EXPECT_THROW(params.validate(), std::invalid_argument);
+
+  params = fuse_graphs::GraduatedNonConvexityParams();
+  params.scale_decay = 1.0;
+  EXPECT_THROW(params.validate(), std::invalid_argument);
+
+  params = fuse_graphs::GraduatedNonConvexityParams();
+  params.stage_max_num_iterations = 0;
+  EXPECT_THROW(params.validate(), std::invalid_argument);
+  EXPECT_THROW(fuse_graphs::GraduatedNonConvexity gnc(params), std::invalid_argument);
+}
+
+TEST(GraduatedNonConvexity, HashGraph)
+{
+  // Without GNC, the redescending loss locks onto the outliers closest to the initial value
+  {
+    fuse_graphs::HashGraph graph;
+    auto uuid = makeOutlierGraph(graph);
+    auto summary = graph.optimize();
+    ASSERT_TRUE(summary.IsSolutionUsable());
+    EXPECT_NEAR(8.0, graph.getVariable(uuid).data()[0], 0.1);
+  }
+
+  // With GNC, the solution starts from the convex problem and converges to the inliers
+  {
+    fuse_graphs::HashGraphParams params;
+    params.gnc.enable = true;
+    fuse_graphs::HashGraph graph(params);
+    auto uuid = makeOutlierGraph(graph);
+    auto summary = graph.optimize();
+    ASSERT_TRUE(summary.IsSolutionUsable());
+    EXPECT_NEAR(0.0, graph.getVariable(uuid).data()[0], 0.1);
+    EXPECT_LT(summary.final_cost, summary.initial_cost);
+  }
+}
+
+TEST(GraduatedNonConvexity, SlotGraph)
+{
+  fuse_graphs::SlotGraphParams params;
+  params.gnc.enable = true;
+  fuse_graphs::SlotGraph graph(params);
+  auto uuid = makeOutlierGraph(graph);
+  auto summary = graph.optimize();
+  ASSERT_TRUE(summary.IsSolutionUsable());
+  EXPECT_NEAR(0.0, graph.getVariable(uuid).data()[0], 0.1);
+}
+
+TEST(GraduatedNonConvexity, Serialization)
+{
+  fuse_graphs::HashGraphParams params;
+  params.gnc.enable = true;
+  params.gnc.initial_scale = 16.0;
+  fuse_graphs::HashGraph expected(params);
+  auto uuid = makeOutlierGraph(expected);
+
+  std::stringstream stream;
+  {
+    fuse_core::BinaryOutputArchive archive(stream);
+    expected.serialize(archive);
+  }
+  fuse_graphs::HashGraph actual;
+  {
+    fuse_core::BinaryInputArchive archive(stream);
+    actual.deserialize(archive);
+  }
+
+  // The deserialized graph optimizes in GNC mode as well
+  actual.optimize();
+  EXPECT_NEAR(0.0, actual.getVariable(uuid).data()[0], 0.1);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
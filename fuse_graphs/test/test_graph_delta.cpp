@@ -0,0 +1,199 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/constraint.h>
+#include <fuse_core/flat_serialization.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+#include <fuse_graphs/hash_graph.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Create the test objects by type name
+ */
+fuse_core::flat::ObjectFactory exampleFactory()
+{
+  fuse_core::flat::ObjectFactory factory;
+  factory.create_variable = [](const std::string& /* type */)
+  {
+    return fuse_core::Variable::UniquePtr(new ExampleVariable());
+  };  // NOLINT(whitespace/braces)
+  factory.create_constraint = [](const std::string& /* type */)
+  {
+    return fuse_core::Constraint::UniquePtr(new ExampleConstraint());
+  };  // NOLINT(whitespace/braces)
+  return factory;
+}
+
+/**
+ * @brief Check that two graphs hold the same variables, values, holds and constraints
+ */
+void expectSameGraph(const fuse_core::Graph& expected, const fuse_core::Graph& actual)
+{
+  const auto expected_variables = expected.getVariables();
+  const auto actual_variables = actual.getVariables();
+  ASSERT_EQ(std::distance(expected_variables.begin(), expected_variables.end()),
+            std::distance(actual_variables.begin(), actual_variables.end()));
+  for (const auto& variable : expected_variables)
+  {
+    ASSERT_TRUE(actual.variableExists(variable.uuid()));
+    const auto& actual_variable = actual.getVariable(variable.uuid());
+    ASSERT_EQ(variable.size(), actual_variable.size());
+    EXPECT_TRUE(std::equal(variable.data(), variable.data() + variable.size(), actual_variable.data()));
+    EXPECT_EQ(expected.isVariableOnHold(variable.uuid()), actual.isVariableOnHold(variable.uuid()));
+  }
+
+  const auto expected_constraints = expected.getConstraints();
+  const auto actual_constraints = actual.getConstraints();
+  ASSERT_EQ(std::distance(expected_constraints.begin(), expected_constraints.end()),
+            std::distance(actual_constraints.begin(), actual_constraints.end()));
+  for (const auto& constraint : expected_constraints)
+  {
+    EXPECT_TRUE(actual.constraintExists(constraint.uuid()));
+  }
+}
+
+TEST(GraphDelta, Reconstruct)
+{
+  // Create a graph with a chain of variables, each with a constraint
+  fuse_graphs::HashGraph graph;
+  std::vector<ExampleVariable::SharedPtr> variables;
+  std::vector<ExampleConstraint::SharedPtr> constraints;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    variables.push_back(ExampleVariable::make_shared(2));
+    variables.back()->data()[0] = static_cast<double>(i);
+    graph.addVariable(variables.back());
+    constraints.push_back(ExampleConstraint::make_shared("test", variables.back()->uuid()));
+    graph.addConstraint(constraints.back());
+  }
+
+  // The first buffer is a keyframe, which is read like any flat graph
+  const auto factory = exampleFactory();
+  fuse_core::flat::GraphDeltaEncoder encoder(10);
+  std::vector<uint8_t> data;
+  EXPECT_TRUE(encoder.encode(graph, data));
+  fuse_core::flat::BufferReader keyframe(data);
+  EXPECT_EQ(fuse_core::flat::Content::GRAPH, keyframe.content());
+  EXPECT_EQ(1u, keyframe.sequence());
+  fuse_graphs::HashGraph reconstructed;
+  fuse_core::flat::deserializeGraph(keyframe, factory, reconstructed);
+  expectSameGraph(graph, reconstructed);
+
+  // Change one variable value and one hold, remove the oldest variable and add a new one
+  variables[2]->data()[1] = 4.5;
+  graph.holdVariable(variables[3]->uuid(), true);
+  graph.removeConstraint(constraints[0]->uuid());
+  graph.removeVariable(variables[0]->uuid());
+  auto added_variable = ExampleVariable::make_shared(2);
+  added_variable->data()[0] = 7.0;
+  graph.addVariable(added_variable);
+  graph.addConstraint(ExampleConstraint::make_shared("test", added_variable->uuid()));
+
+  // The delta only holds the changes
+  EXPECT_FALSE(encoder.encode(graph, data));
+  fuse_core::flat::BufferReader delta(data);
+  EXPECT_EQ(fuse_core::flat::Content::GRAPH_DELTA, delta.content());
+  EXPECT_EQ(2u, delta.sequence());
+  EXPECT_EQ(1u, delta.baseSequence());
+  ASSERT_EQ(1u, delta.removedVariableCount());
+  EXPECT_EQ(variables[0]->uuid(), delta.removedVariable(0));
+  ASSERT_EQ(1u, delta.removedConstraintCount());
+  EXPECT_EQ(constraints[0]->uuid(), delta.removedConstraint(0));
+  EXPECT_EQ(3u, delta.variableCount());
+  EXPECT_EQ(1u, delta.constraintCount());
+
+  fuse_core::flat::applyGraphDelta(delta, factory, reconstructed);
+  expectSameGraph(graph, reconstructed);
+
+  // An unchanged graph produces an empty delta
+  EXPECT_FALSE(encoder.encode(graph, data));
+  fuse_core::flat::BufferReader empty(data);
+  EXPECT_EQ(3u, empty.sequence());
+  EXPECT_EQ(2u, empty.baseSequence());
+  EXPECT_EQ(0u, empty.removedVariableCount());
+  EXPECT_EQ(0u, empty.removedConstraintCount());
+  EXPECT_EQ(0u, empty.variableCount());
+  EXPECT_EQ(0u, empty.constraintCount());
+
+  // A value-only record cannot be read as a new variable
+  variables[4]->data()[0] = -1.0;
+  EXPECT_FALSE(encoder.encode(graph, data));
+  fuse_core::flat::BufferReader update(data);
+  ASSERT_EQ(1u, update.variableCount());
+  EXPECT_EQ(fuse_core::flat::PayloadEncoding::NONE, update.variable(0).payloadEncoding());
+  fuse_core::flat::ObjectReader objects(update, factory);
+  EXPECT_THROW(objects.variable(0), std::runtime_error);
+}
+
+TEST(GraphDelta, KeyframeInterval)
+{
+  fuse_graphs::HashGraph graph;
+  graph.addVariable(ExampleVariable::make_shared());
+
+  fuse_core::flat::GraphDeltaEncoder encoder(2);
+  std::vector<uint8_t> data;
+  EXPECT_TRUE(encoder.encode(graph, data));
+  EXPECT_FALSE(encoder.encode(graph, data));
+  EXPECT_FALSE(encoder.encode(graph, data));
+  EXPECT_TRUE(encoder.encode(graph, data));
+  EXPECT_FALSE(encoder.encode(graph, data));
+
+  // A requested keyframe restarts the interval
+  encoder.requestKeyframe();
+  EXPECT_TRUE(encoder.encode(graph, data));
+  EXPECT_FALSE(encoder.encode(graph, data));
+
+  // An interval of zero only writes keyframes
+  fuse_core::flat::GraphDeltaEncoder keyframes_only(0);
+  EXPECT_TRUE(keyframes_only.encode(graph, data));
+  EXPECT_TRUE(keyframes_only.encode(graph, data));
+  fuse_core::flat::BufferReader reader(data);
+  EXPECT_EQ(2u, reader.sequence());
+  EXPECT_EQ(0u, reader.baseSequence());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -36,10 +36,12 @@
 #include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
 #include <fuse_graphs/hash_graph.h>
+#include <fuse_graphs/slot_graph.h>
 #include <test/covariance_constraint.h>
 #include <test/example_constraint.h>
 #include <test/example_loss.h>
 #include <test/example_variable.h>
+#include <test/graph_test_fixture.h>
 
 #include <gtest/gtest.h>
 
@@ -50,115 +52,19 @@
 #include <vector>
 
 /**
- * @brief Test fixture for the HashGraph
- *
- * This test fixture provides methods to compare variables and constraints, and allows to retrieve the last failure
- * description, if any.
+ * The graph implementations must behave identically through the fuse_core::Graph interface. Tests that exercise
+ * implementation-specific behavior live in the test file of that implementation.
  */
-class HashGraphTestFixture : public ::testing::Test
-{
-public:
-  /**
-   * @brief Compare all the properties of two Variable objects
-   *
-   * @param[in] expected - The expected variable
-   * @param[in] actual - The actual variable
-   * @return True if all the properties match, false otherwise
-   */
-  bool compareVariables(const fuse_core::Variable& expected, const fuse_core::Variable& actual)
-  {
-    failure_description = "";
-    bool variables_equal = true;
-    if (expected.type() != actual.type())
-    {
-      variables_equal = false;
-      failure_description += "The variables have different types.\n"
-        "  expected type is '" + expected.type() + "'\n"
-        "    actual type is '" + actual.type() + "'\n";
-    }
-    if (expected.size() != actual.size())
-    {
-      variables_equal = false;
-      failure_description += "The variables have different sizes.\n"
-        "  expected size is '" + std::to_string(expected.size()) + "'\n"
-        "    actual size is '" + std::to_string(actual.size()) + "'\n";
-    }
-    if (expected.uuid() != actual.uuid())
-    {
-      variables_equal = false;
-      failure_description += "The variables have different UUIDs.\n"
-        "  expected UUID is '" + fuse_core::uuid::to_string(expected.uuid()) + "'\n"
-        "    actual UUID is '" + fuse_core::uuid::to_string(actual.uuid()) + "'\n";
-    }
-    for (size_t i = 0; i < expected.size(); ++i)
-    {
-      if (expected.data()[i] != actual.data()[i])
-      {
-        variables_equal = false;
-        failure_description += "The variables have different values.\n"
-          "  expected data(" + std::to_string(i) + ") is '" + std::to_string(expected.data()[i]) + "'\n"
-          "    actual data(" + std::to_string(i) + ") is '" + std::to_string(actual.data()[i]) + "'\n";
-      }
-    }
-    return variables_equal;
-  }
+using GraphTypes = ::testing::Types<fuse_graphs::HashGraph, fuse_graphs::SlotGraph>;
+TYPED_TEST_SUITE(GraphTestFixture, GraphTypes);
 
-  /**
-   * @brief Compare all the properties of two Constraint objects
-   *
-   * @param[in] expected - The expected constraint
-   * @param[in] actual - The actual constraint
-   * @return True if all the properties match, false otherwise
-   */
-  bool compareConstraints(const fuse_core::Constraint& expected, const fuse_core::Constraint& actual)
-  {
-    failure_description = "";
-    bool constraints_equal = true;
-    if (expected.type() != actual.type())
-    {
-      constraints_equal = false;
-      failure_description += "The constraints have different types.\n"
-        "  expected type is '" + expected.type() + "'\n"
-        "    actual type is '" + actual.type() + "'\n";
-    }
-    if (expected.uuid() != actual.uuid())
-    {
-      constraints_equal = false;
-      failure_description += "The constraints have different UUIDs.\n"
-        "  expected UUID is '" + fuse_core::uuid::to_string(expected.uuid()) + "'\n"
-        "    actual UUID is '" + fuse_core::uuid::to_string(actual.uuid()) + "'\n";
-    }
-    if (expected.variables().size() != actual.variables().size())
-    {
-      constraints_equal = false;
-      failure_description += "The constraints involve a different number of variables.\n"
-        "  expected variable count is '" + std::to_string(expected.variables().size()) + "'\n"
-        "    actual variable count is '" + std::to_string(actual.variables().size()) + "'\n";
-    }
-    for (size_t i = 0; i < expected.variables().size(); ++i)
-    {
-      if (expected.variables().at(i) != actual.variables().at(i))
-      {
-        constraints_equal = false;
-        std::string i_str = std::to_string(i);
-        failure_description += "The constraints involve different variable UUIDs.\n"
-          "  expected variables(" + i_str + ") is '" + fuse_core::uuid::to_string(expected.variables()[i]) + "'\n"
-          "    actual variables(" + i_str + ") is '" + fuse_core::uuid::to_string(actual.variables()[i]) + "'\n";
-      }
-    }
-    return constraints_equal;
-  }
-
-  std::string failure_description { "" };  //!< The last failure description. Empty if no failure happened
-};
-
-TEST_F(HashGraphTestFixture, AddVariable)
+TYPED_TEST(GraphTestFixture, AddVariable)
 {
   // Test adding variables to the graph
   // Also tests the variableExists() function
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Create a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -196,12 +102,12 @@ TEST_F(HashGraphTestFixture, AddVariable)
   EXPECT_TRUE(graph.variableExists(variable3->uuid()));
 }
 
-TEST_F(HashGraphTestFixture, RemoveVariable)
+TYPED_TEST(GraphTestFixture, RemoveVariable)
 {
   // Test removing variables from the graph
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Create a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -258,12 +164,12 @@ TEST_F(HashGraphTestFixture, RemoveVariable)
   EXPECT_TRUE(graph.variableExists(variable2->uuid()));
 }
 
-TEST_F(HashGraphTestFixture, GetVariable)
+TYPED_TEST(GraphTestFixture, GetVariable)
 {
   // Test accessing a single variables from the graph
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Create a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -276,18 +182,18 @@ TEST_F(HashGraphTestFixture, GetVariable)
 
   // Verify all of the variables are available
   const fuse_core::Variable& actual1 = graph.getVariable(variable1->uuid());
-  EXPECT_TRUE(compareVariables(*variable1, actual1)) << failure_description;
+  EXPECT_TRUE(this->compareVariables(*variable1, actual1)) << this->failure_description;
 
   const fuse_core::Variable& actual2 = graph.getVariable(variable2->uuid());
-  EXPECT_TRUE(compareVariables(*variable2, actual2)) << failure_description;
+  EXPECT_TRUE(this->compareVariables(*variable2, actual2)) << this->failure_description;
 }
 
-TEST_F(HashGraphTestFixture, GetVariables)
+TYPED_TEST(GraphTestFixture, GetVariables)
 {
   // Test accessing the variables collection from the graph
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Create a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -311,17 +217,17 @@ TEST_F(HashGraphTestFixture, GetVariables)
   {
     if (actual.uuid() == variable1->uuid())
     {
-      EXPECT_TRUE(compareVariables(*variable1, actual)) << failure_description;
+      EXPECT_TRUE(this->compareVariables(*variable1, actual)) << this->failure_description;
       continue;
     }
     if (actual.uuid() == variable2->uuid())
     {
-      EXPECT_TRUE(compareVariables(*variable2, actual)) << failure_description;
+      EXPECT_TRUE(this->compareVariables(*variable2, actual)) << this->failure_description;
       continue;
     }
     if (actual.uuid() == variable3->uuid())
     {
-      EXPECT_TRUE(compareVariables(*variable3, actual)) << failure_description;
+      EXPECT_TRUE(this->compareVariables(*variable3, actual)) << this->failure_description;
       continue;
     }
     // The actual variable is not in the expected set. Fail the test.
@@ -329,12 +235,12 @@ TEST_F(HashGraphTestFixture, GetVariables)
   }
 }
 
-TEST_F(HashGraphTestFixture, GetConnectedVariables)
+TYPED_TEST(GraphTestFixture, GetConnectedVariables)
 {
   // Test accessing the variables connected to a specific constraint
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Create a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -363,7 +269,7 @@ TEST_F(HashGraphTestFixture, GetConnectedVariables)
     {
       if (actual.uuid() == variable1->uuid())
       {
-        EXPECT_TRUE(compareVariables(*variable1, actual)) << failure_description;
+        EXPECT_TRUE(this->compareVariables(*variable1, actual)) << this->failure_description;
         continue;
       }
       // The constraint was not one of the expected constraints. Fail the test.
@@ -378,7 +284,7 @@ TEST_F(HashGraphTestFixture, GetConnectedVariables)
     {
       if (actual.uuid() == variable2->uuid())
       {
-        EXPECT_TRUE(compareVariables(*variable2, actual)) << failure_description;
+        EXPECT_TRUE(this->compareVariables(*variable2, actual)) << this->failure_description;
         continue;
       }
       // The constraint was not one of the expected constraints. Fail the test.
@@ -393,13 +299,13 @@ TEST_F(HashGraphTestFixture, GetConnectedVariables)
   }
 }
 
-TEST_F(HashGraphTestFixture, AddConstraint)
+TYPED_TEST(GraphTestFixture, AddConstraint)
 {
   // Test adding constraints to the graph
   // Also tests the constraintExists() function
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -452,12 +358,12 @@ TEST_F(HashGraphTestFixture, AddConstraint)
   EXPECT_THROW(graph.addConstraint(constraint4), std::logic_error);
 }
 
-TEST_F(HashGraphTestFixture, RemoveConstraint)
+TYPED_TEST(GraphTestFixture, RemoveConstraint)
 {
   // Test removing constraints from the graph
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -497,12 +403,12 @@ TEST_F(HashGraphTestFixture, RemoveConstraint)
   EXPECT_FALSE(graph.removeConstraint(constraint1->uuid()));
 }
 
-TEST_F(HashGraphTestFixture, GetConstraint)
+TYPED_TEST(GraphTestFixture, GetConstraint)
 {
   // Test accessing the constraints in the graph
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -522,18 +428,18 @@ TEST_F(HashGraphTestFixture, GetConstraint)
 
   // Verify all of the constraints are available
   const fuse_core::Constraint& actual1 = graph.getConstraint(constraint1->uuid());
-  EXPECT_TRUE(compareConstraints(*constraint1, actual1)) << failure_description;
+  EXPECT_TRUE(this->compareConstraints(*constraint1, actual1)) << this->failure_description;
 
   const fuse_core::Constraint& actual2 = graph.getConstraint(constraint2->uuid());
-  EXPECT_TRUE(compareConstraints(*constraint2, actual2)) << failure_description;
+  EXPECT_TRUE(this->compareConstraints(*constraint2, actual2)) << this->failure_description;
 }
 
-TEST_F(HashGraphTestFixture, GetConstraints)
+TYPED_TEST(GraphTestFixture, GetConstraints)
 {
   // Test accessing the constraints in the graph
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -561,17 +467,17 @@ TEST_F(HashGraphTestFixture, GetConstraints)
   {
     if (actual.uuid() == constraint1->uuid())
     {
-      EXPECT_TRUE(compareConstraints(*constraint1, actual)) << failure_description;
+      EXPECT_TRUE(this->compareConstraints(*constraint1, actual)) << this->failure_description;
       continue;
     }
     if (actual.uuid() == constraint2->uuid())
     {
-      EXPECT_TRUE(compareConstraints(*constraint2, actual)) << failure_description;
+      EXPECT_TRUE(this->compareConstraints(*constraint2, actual)) << this->failure_description;
       continue;
     }
     if (actual.uuid() == constraint3->uuid())
     {
-      EXPECT_TRUE(compareConstraints(*constraint3, actual)) << failure_description;
+      EXPECT_TRUE(this->compareConstraints(*constraint3, actual)) << this->failure_description;
       continue;
     }
     // The constraint was not one of the expected constraints. Fail the test.
@@ -579,12 +485,12 @@ TEST_F(HashGraphTestFixture, GetConstraints)
   }
 }
 
-TEST_F(HashGraphTestFixture, GetConnectedConstraints)
+TYPED_TEST(GraphTestFixture, GetConnectedConstraints)
 {
   // Test accessing the constraints connected to a specific variable
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Create a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -616,12 +522,12 @@ TEST_F(HashGraphTestFixture, GetConnectedConstraints)
     {
       if (actual.uuid() == constraint1->uuid())
       {
-        EXPECT_TRUE(compareConstraints(*constraint1, actual)) << failure_description;
+        EXPECT_TRUE(this->compareConstraints(*constraint1, actual)) << this->failure_description;
         continue;
       }
       if (actual.uuid() == constraint3->uuid())
       {
-        EXPECT_TRUE(compareConstraints(*constraint3, actual)) << failure_description;
+        EXPECT_TRUE(this->compareConstraints(*constraint3, actual)) << this->failure_description;
         continue;
       }
       // The constraint was not one of the expected constraints. Fail the test.
@@ -636,7 +542,7 @@ TEST_F(HashGraphTestFixture, GetConnectedConstraints)
     {
       if (actual.uuid() == constraint2->uuid())
       {
-        EXPECT_TRUE(compareConstraints(*constraint2, actual)) << failure_description;
+        EXPECT_TRUE(this->compareConstraints(*constraint2, actual)) << this->failure_description;
         continue;
       }
       // The constraint was not one of the expected constraints. Fail the test.
@@ -656,12 +562,75 @@ TEST_F(HashGraphTestFixture, GetConnectedConstraints)
   }
 }
 
-TEST_F(HashGraphTestFixture, Optimize)
+TYPED_TEST(GraphTestFixture, Visitors)
+{
+  // Test visiting the variables and constraints of the graph
+
+  // Create the graph
+  TypeParam graph;
+
+  // Add a few variables
+  auto variable1 = ExampleVariable::make_shared();
+  graph.addVariable(variable1);
+
+  auto variable2 = ExampleVariable::make_shared();
+  graph.addVariable(variable2);
+
+  // Add a few constraints
+  auto constraint1 = ExampleConstraint::make_shared("test", variable1->uuid());
+  graph.addConstraint(constraint1);
+
+  auto constraint2 = ExampleConstraint::make_shared("test", variable2->uuid());
+  graph.addConstraint(constraint2);
+
+  auto constraint3 = ExampleConstraint::make_shared("test", variable1->uuid());
+  graph.addConstraint(constraint3);
+
+  // The visitors must see the same elements as the ranges
+  std::vector<fuse_core::UUID> expected;
+  std::vector<fuse_core::UUID> actual;
+  for (const auto& variable : graph.getVariables())
+  {
+    expected.push_back(variable.uuid());
+  }
+  graph.forEachVariable(
+    [&actual](const fuse_core::Variable& variable) { actual.push_back(variable.uuid()); });  // NOLINT
+  EXPECT_EQ(expected, actual);
+
+  expected.clear();
+  actual.clear();
+  for (const auto& constraint : graph.getConstraints())
+  {
+    expected.push_back(constraint.uuid());
+  }
+  graph.forEachConstraint(
+    [&actual](const fuse_core::Constraint& constraint) { actual.push_back(constraint.uuid()); });  // NOLINT
+  EXPECT_EQ(expected, actual);
+
+  expected.clear();
+  actual.clear();
+  for (const auto& constraint : graph.getConnectedConstraints(variable1->uuid()))
+  {
+    expected.push_back(constraint.uuid());
+  }
+  graph.forEachConnectedConstraint(
+    variable1->uuid(),
+    [&actual](const fuse_core::Constraint& constraint) { actual.push_back(constraint.uuid()); });  // NOLINT
+  EXPECT_EQ(2u, actual.size());
+  EXPECT_EQ(expected, actual);
+
+  // Visiting the constraints of an unknown variable throws
+  auto variable3 = ExampleVariable::make_shared();
+  EXPECT_THROW(graph.forEachConnectedConstraint(variable3->uuid(), [](const fuse_core::Constraint&) {}),  // NOLINT
+               std::logic_error);
+}
+
+TYPED_TEST(GraphTestFixture, Optimize)
 {
   // Test optimizing a set of variables/constraints
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -693,12 +662,12 @@ TEST_F(HashGraphTestFixture, Optimize)
   EXPECT_NEAR(-3.0, variable2->data()[0], 1.0e-7);
 }
 
-TEST_F(HashGraphTestFixture, HoldVariable)
+TYPED_TEST(GraphTestFixture, HoldVariable)
 {
   // Test placing a variable on hold. The value of the variable should remain constant even after the optimization
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -736,7 +705,7 @@ TEST_F(HashGraphTestFixture, HoldVariable)
   EXPECT_FALSE(graph.isVariableOnHold(variable1->uuid()));
 }
 
-TEST_F(HashGraphTestFixture, GetCovariance)
+TYPED_TEST(GraphTestFixture, GetCovariance)
 {
   // Create variables that match the Ceres unit test
   auto x = ExampleVariable::make_shared(2);
@@ -752,7 +721,7 @@ TEST_F(HashGraphTestFixture, GetCovariance)
   auto constraint = CovarianceConstraint::make_shared("test", x->uuid(), y->uuid(), z->uuid());
 
   // Add the variables and constraints to the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
   graph.addVariable(x);
   graph.addVariable(y);
   graph.addVariable(z);
@@ -844,10 +813,92 @@ TEST_F(HashGraphTestFixture, GetCovariance)
   }
 }
 
-TEST_F(HashGraphTestFixture, Copy)
+TYPED_TEST(GraphTestFixture, GetCovarianceRepeatedRequests)
+{
+  // Create the same problem as the GetCovariance test
+  auto x = ExampleVariable::make_shared(2);
+  x->data()[0] = 1;
+  x->data()[1] = 1;
+  auto y = ExampleVariable::make_shared(3);
+  y->data()[0] = 2;
+  y->data()[1] = 2;
+  y->data()[2] = 2;
+  auto z = ExampleVariable::make_shared(1);
+  z->data()[0] = 3;
+  auto constraint = CovarianceConstraint::make_shared("test", x->uuid(), y->uuid(), z->uuid());
+
+  TypeParam graph;
+  graph.addVariable(x);
+  graph.addVariable(y);
+  graph.addVariable(z);
+  graph.addConstraint(constraint);
+  graph.optimize();
+
+  std::vector<double> expected_xx = { 7.0747e-02, -8.4923e-03, -8.4923e-03, 8.1352e-02};
+  std::vector<double> expected_yx = { 1.6821e-02,  2.4758e-02,  3.3643e-02, 4.9517e-02, 5.0464e-02, 7.4275e-02};
+  std::vector<double> expected_zz = { 3.9544e-02 };
+
+  // Issue several independent requests against the same graph. A retained factorization must not change the results.
+  {
+    std::vector<std::pair<fuse_core::UUID, fuse_core::UUID> > covariance_requests;
+    covariance_requests.emplace_back(x->uuid(), x->uuid());
+    std::vector<std::vector<double> > covariance_matrices;
+    graph.getCovariance(covariance_requests, covariance_matrices);
+    ASSERT_EQ(1ul, covariance_matrices.size());
+    ASSERT_EQ(expected_xx.size(), covariance_matrices[0].size());
+    for (size_t i = 0; i < expected_xx.size(); ++i)
+    {
+      EXPECT_NEAR(expected_xx[i], covariance_matrices[0][i], 1.0e-5);
+    }
+  }
+  {
+    std::vector<std::pair<fuse_core::UUID, fuse_core::UUID> > covariance_requests;
+    covariance_requests.emplace_back(y->uuid(), x->uuid());
+    covariance_requests.emplace_back(z->uuid(), z->uuid());
+    std::vector<std::vector<double> > covariance_matrices;
+    graph.getCovariance(covariance_requests, covariance_matrices, ceres::Covariance::Options(), false);
+    ASSERT_EQ(2ul, covariance_matrices.size());
+    ASSERT_EQ(expected_yx.size(), covariance_matrices[0].size());
+    for (size_t i = 0; i < expected_yx.size(); ++i)
+    {
+      EXPECT_NEAR(expected_yx[i], covariance_matrices[0][i], 1.0e-5);
+    }
+    ASSERT_EQ(expected_zz.size(), covariance_matrices[1].size());
+    EXPECT_NEAR(expected_zz[0], covariance_matrices[1][0], 1.0e-5);
+  }
+
+  // A copy of the graph must produce the same results
+  {
+    auto copy = graph.clone();
+    std::vector<std::pair<fuse_core::UUID, fuse_core::UUID> > covariance_requests;
+    covariance_requests.emplace_back(x->uuid(), x->uuid());
+    std::vector<std::vector<double> > covariance_matrices;
+    copy->getCovariance(covariance_requests, covariance_matrices);
+    ASSERT_EQ(1ul, covariance_matrices.size());
+    ASSERT_EQ(expected_xx.size(), covariance_matrices[0].size());
+    for (size_t i = 0; i < expected_xx.size(); ++i)
+    {
+      EXPECT_NEAR(expected_xx[i], covariance_matrices[0][i], 1.0e-5);
+    }
+  }
+
+  // Modifying the graph must invalidate any retained factorization. Variables held constant have zero covariance.
+  {
+    graph.holdVariable(z->uuid(), true);
+    std::vector<std::pair<fuse_core::UUID, fuse_core::UUID> > covariance_requests;
+    covariance_requests.emplace_back(z->uuid(), z->uuid());
+    std::vector<std::vector<double> > covariance_matrices;
+    graph.getCovariance(covariance_requests, covariance_matrices);
+    ASSERT_EQ(1ul, covariance_matrices.size());
+    ASSERT_EQ(1ul, covariance_matrices[0].size());
+    EXPECT_EQ(0.0, covariance_matrices[0][0]);
+  }
+}
+
+TYPED_TEST(GraphTestFixture, Copy)
 {
     // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -869,7 +920,7 @@ TEST_F(HashGraphTestFixture, Copy)
 
   // Test the copy constructor
   {
-    fuse_graphs::HashGraph other(graph);
+    TypeParam other(graph);
     // Verify the copy
     for (const auto& constraint : graph.getConstraints())
     {
@@ -888,7 +939,7 @@ TEST_F(HashGraphTestFixture, Copy)
 
   // Test the assignment operator
   {
-    fuse_graphs::HashGraph other;
+    TypeParam other;
     other = graph;
     // Verify the copy
     for (const auto& constraint : graph.getConstraints())
@@ -926,10 +977,10 @@ TEST_F(HashGraphTestFixture, Copy)
   }
 }
 
-TEST_F(HashGraphTestFixture, Serialization)
+TYPED_TEST(GraphTestFixture, Serialization)
 {
   // Create the graph
-  fuse_graphs::HashGraph expected;
+  TypeParam expected;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -957,7 +1008,7 @@ TEST_F(HashGraphTestFixture, Serialization)
   }
 
   // Deserialize a new graph from that same stream
-  fuse_graphs::HashGraph actual;
+  TypeParam actual;
   {
     fuse_core::TextInputArchive archive(stream);
     actual.deserialize(archive);
@@ -974,14 +1025,69 @@ TEST_F(HashGraphTestFixture, Serialization)
   }
 }
 
-TEST_F(HashGraphTestFixture, GetConstraintCosts)
+/**
+ * @brief Graph that exposes the Ceres loss function ownership, and can be configured to write an archive the way
+ *        graphs did before fuse_core::Loss cached its loss function
+ */
+template <typename GraphType>
+class LossOwnershipGraph : public GraphType
+{
+public:
+  void lossFunctionOwnership(const ceres::Ownership ownership)
+  {
+    this->problem_options_.loss_function_ownership = ownership;
+  }
+
+  ceres::Ownership lossFunctionOwnership() const
+  {
+    return this->problem_options_.loss_function_ownership;
+  }
+};
+
+TYPED_TEST(GraphTestFixture, SerializationLossOwnership)
+{
+  // Write a graph with a loss function the way older versions did, handing the loss function ownership to Ceres
+  LossOwnershipGraph<TypeParam> expected;
+  expected.lossFunctionOwnership(ceres::TAKE_OWNERSHIP);
+
+  auto variable1 = ExampleVariable::make_shared();
+  variable1->data()[0] = 1.0;
+  expected.addVariable(variable1);
+
+  auto constraint1 = ExampleConstraint::make_shared("test", variable1->uuid());
+  constraint1->data = 5.0;
+  constraint1->loss(ExampleLoss::make_shared());
+  expected.addConstraint(constraint1);
+
+  std::stringstream stream;
+  {
+    fuse_core::TextOutputArchive archive(stream);
+    expected.serialize(archive);
+  }
+
+  LossOwnershipGraph<TypeParam> actual;
+  {
+    fuse_core::TextInputArchive archive(stream);
+    actual.deserialize(archive);
+  }
+
+  // The loaded graph must not let Ceres delete the loss function cached by the fuse_core::Loss
+  EXPECT_EQ(fuse_core::Loss::Ownership, actual.lossFunctionOwnership());
+
+  // Optimizing repeatedly reuses the same cached loss function
+  EXPECT_NO_THROW(actual.optimize());
+  EXPECT_NO_THROW(actual.optimize());
+  EXPECT_NEAR(5.0, actual.getVariable(variable1->uuid()).data()[0], 1.0e-7);
+}
+
+TYPED_TEST(GraphTestFixture, GetConstraintCosts)
 {
   // Test the getConstraintCosts method by adding a few variables and constraints to the graph
   // @todo(swilliams) Implement a more thorough test of the getConstraintCosts() method. Only single-variable
   //                  constraints are used, and no loss functions are configured here.
 
   // Create the graph
-  fuse_graphs::HashGraph graph;
+  TypeParam graph;
 
   // Add a few variables
   auto variable1 = ExampleVariable::make_shared();
@@ -0,0 +1,101 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/parameter_arena.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+
+TEST(ParameterArena, Allocate)
+{
+  fuse_graphs::ParameterArena arena(8);
+
+  // Fill several buffers, and verify the earlier blocks are not moved or overwritten
+  std::vector<double*> blocks;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    blocks.push_back(arena.allocate(3));
+    for (size_t j = 0; j < 3; ++j)
+    {
+      blocks.back()[j] = 10.0 * i + j;
+    }
+  }
+  for (size_t i = 0; i < blocks.size(); ++i)
+  {
+    for (size_t j = 0; j < 3; ++j)
+    {
+      EXPECT_EQ(10.0 * i + j, blocks[i][j]);
+    }
+  }
+  EXPECT_EQ(30u, arena.size());
+  EXPECT_EQ(30u, arena.allocated());
+
+  // The first block of every buffer is aligned to a cache line
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(blocks[0]) % fuse_graphs::ParameterArena::alignment);
+  // Oversized blocks get their own aligned buffer
+  auto large_block = arena.allocate(20);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(large_block) % fuse_graphs::ParameterArena::alignment);
+}
+
+TEST(ParameterArena, Release)
+{
+  fuse_graphs::ParameterArena arena(8);
+  for (size_t i = 0; i < 10; ++i)
+  {
+    arena.allocate(2);
+  }
+  EXPECT_FALSE(arena.fragmented());
+
+  // Released space is only reclaimed when the arena is cleared
+  for (size_t i = 0; i < 6; ++i)
+  {
+    arena.release(2);
+  }
+  EXPECT_EQ(8u, arena.size());
+  EXPECT_EQ(20u, arena.allocated());
+  EXPECT_TRUE(arena.fragmented());
+
+  arena.clear();
+  EXPECT_EQ(0u, arena.size());
+  EXPECT_EQ(0u, arena.allocated());
+  EXPECT_FALSE(arena.fragmented());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,194 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_graphs/slot_graph.h>
+#include <test/example_constraint.h>
+#include <test/example_variable.h>
+#include <test/graph_test_fixture.h>
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * The behavior shared with the other graph implementations is covered by the typed tests in test_graphs.cpp. These
+ * tests cover the slot compaction and the parameter arena, which are specific to the SlotGraph.
+ */
+using SlotGraphTestFixture = GraphTestFixture<fuse_graphs::SlotGraph>;
+
+TEST_F(SlotGraphTestFixture, RemoveCompaction)
+{
+  // Removing an entry moves the last entry into the vacated slot. Verify the cross references remain consistent.
+
+  // Create the graph
+  fuse_graphs::SlotGraph graph;
+
+  // Add a few variables
+  auto variable1 = ExampleVariable::make_shared();
+  variable1->data()[0] = 1.0;
+  graph.addVariable(variable1);
+
+  auto variable2 = ExampleVariable::make_shared();
+  variable2->data()[0] = 2.5;
+  graph.addVariable(variable2);
+
+  auto variable3 = ExampleVariable::make_shared();
+  variable3->data()[0] = -1.2;
+  graph.addVariable(variable3);
+
+  // Add a few constraints
+  auto constraint1 = ExampleConstraint::make_shared("test", variable1->uuid());
+  constraint1->data = 5.0;
+  graph.addConstraint(constraint1);
+
+  auto constraint2 = ExampleConstraint::make_shared("test", variable2->uuid());
+  constraint2->data = -3.0;
+  graph.addConstraint(constraint2);
+
+  auto constraint3 = ExampleConstraint::make_shared("test", variable3->uuid());
+  constraint3->data = 7.0;
+  graph.addConstraint(constraint3);
+
+  // Remove the first constraint and variable. The last constraint and variable are moved into their slots.
+  EXPECT_TRUE(graph.removeConstraint(constraint1->uuid()));
+  EXPECT_TRUE(graph.removeVariable(variable1->uuid()));
+  EXPECT_FALSE(graph.constraintExists(constraint1->uuid()));
+  EXPECT_FALSE(graph.variableExists(variable1->uuid()));
+
+  // Verify the moved constraint is still connected to the moved variable
+  {
+    auto actual_constraints = graph.getConnectedConstraints(variable3->uuid());
+    ASSERT_EQ(1, std::distance(actual_constraints.begin(), actual_constraints.end()));
+    EXPECT_TRUE(compareConstraints(*constraint3, actual_constraints.front())) << failure_description;
+  }
+  {
+    auto actual_variables = graph.getConnectedVariables(constraint3->uuid());
+    ASSERT_EQ(1, std::distance(actual_variables.begin(), actual_variables.end()));
+    EXPECT_TRUE(compareVariables(*variable3, actual_variables.front())) << failure_description;
+  }
+
+  // Hold the moved variable, then verify the optimization uses the correct variable for each constraint
+  graph.holdVariable(variable3->uuid());
+  EXPECT_TRUE(graph.isVariableOnHold(variable3->uuid()));
+  EXPECT_NO_THROW(graph.optimize());
+  EXPECT_NEAR(-3.0, variable2->data()[0], 1.0e-7);
+  EXPECT_NEAR(-1.2, variable3->data()[0], 1.0e-7);
+
+  // Remove the remaining entries in reverse order
+  EXPECT_TRUE(graph.removeConstraint(constraint3->uuid()));
+  EXPECT_TRUE(graph.removeConstraint(constraint2->uuid()));
+  EXPECT_TRUE(graph.removeVariable(variable2->uuid()));
+  EXPECT_TRUE(graph.removeVariable(variable3->uuid()));
+  EXPECT_TRUE(graph.getConstraints().empty());
+  EXPECT_TRUE(graph.getVariables().empty());
+
+  // Holding a variable that does not exist throws
+  EXPECT_THROW(graph.holdVariable(variable1->uuid()), std::out_of_range);
+}
+
+TEST_F(SlotGraphTestFixture, ParameterArena)
+{
+  // Test optimizing a graph whose variable values are packed into the parameter arena
+
+  // Create the graph
+  fuse_graphs::SlotGraphParams params;
+  params.use_parameter_arena = true;
+  fuse_graphs::SlotGraph graph(params);
+
+  // Add enough variables and constraints to span several arena buffers
+  std::vector<ExampleVariable::SharedPtr> variables;
+  std::vector<ExampleConstraint::SharedPtr> constraints;
+  for (size_t i = 0; i < 10000; ++i)
+  {
+    auto variable = ExampleVariable::make_shared();
+    variable->data()[0] = 0.0;
+    graph.addVariable(variable);
+    variables.push_back(variable);
+
+    auto constraint = ExampleConstraint::make_shared("test", variable->uuid());
+    constraint->data = static_cast<double>(i);
+    graph.addConstraint(constraint);
+    constraints.push_back(constraint);
+  }
+
+  // Optimize the constraints and variables. The optimized values must be copied back into the variables.
+  EXPECT_NO_THROW(graph.optimize());
+  for (size_t i = 0; i < variables.size(); ++i)
+  {
+    EXPECT_NEAR(static_cast<double>(i), variables[i]->data()[0], 1.0e-7);
+  }
+
+  // A copy of the graph must use its own parameter blocks
+  fuse_graphs::SlotGraph other(graph);
+
+  // Remove most of the variables, which compacts the arena, and change the remaining constraints
+  for (size_t i = 0; i < 9000; ++i)
+  {
+    EXPECT_TRUE(graph.removeConstraint(constraints[i]->uuid()));
+    EXPECT_TRUE(graph.removeVariable(variables[i]->uuid()));
+  }
+  for (size_t i = 9000; i < 10000; ++i)
+  {
+    EXPECT_TRUE(graph.removeConstraint(constraints[i]->uuid()));
+    auto constraint = ExampleConstraint::make_shared("test", variables[i]->uuid());
+    constraint->data = -static_cast<double>(i);
+    graph.addConstraint(constraint);
+  }
+
+  // Optimize again. The remaining variables must still be tied to the correct parameter blocks.
+  EXPECT_NO_THROW(graph.optimize());
+  for (size_t i = 9000; i < 10000; ++i)
+  {
+    EXPECT_NEAR(-static_cast<double>(i), variables[i]->data()[0], 1.0e-7);
+  }
+
+  // Const queries use the current variable values, not the arena
+  variables[9000]->data()[0] += 1.0;
+  double cost = 0.0;
+  EXPECT_TRUE(graph.evaluate(&cost));
+  EXPECT_NEAR(0.5, cost, 1.0e-7);
+
+  // The copy must be unaffected
+  for (size_t i = 0; i < variables.size(); i += 1000)
+  {
+    EXPECT_NEAR(static_cast<double>(i), other.getVariable(variables[i]->uuid()).data()[0], 1.0e-7);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
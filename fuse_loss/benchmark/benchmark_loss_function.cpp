@@ -0,0 +1,175 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_loss/arctan_loss.h>
+#include <fuse_loss/cauchy_loss.h>
+#include <fuse_loss/composed_loss.h>
+#include <fuse_loss/dcs_loss.h>
+#include <fuse_loss/fair_loss.h>
+#include <fuse_loss/geman_mcclure_loss.h>
+#include <fuse_loss/huber_loss.h>
+#include <fuse_loss/softlone_loss.h>
+#include <fuse_loss/tolerant_loss.h>
+#include <fuse_loss/tukey_loss.h>
+#include <fuse_loss/welsch_loss.h>
+
+#include <benchmark/benchmark.h>
+
+#include <ceres/loss_function.h>
+
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Generate squared norms of normally distributed 2D residuals, with 10% of outliers
+ *
+ * The inliers and outliers are interleaved at random, so branching implementations pay for mispredictions like they
+ * would with real residuals.
+ */
+std::vector<double> createSquaredNorms(const size_t count)
+{
+  std::mt19937 generator(42);
+  std::normal_distribution<double> inlier(0.0, 1.0);
+  std::normal_distribution<double> outlier(0.0, 20.0);
+  std::bernoulli_distribution is_outlier(0.1);
+
+  std::vector<double> squared_norms(count);
+  for (auto& squared_norm : squared_norms)
+  {
+    auto& distribution = is_outlier(generator) ? outlier : inlier;
+    const auto x = distribution(generator);
+    const auto y = distribution(generator);
+    squared_norm = x * x + y * y;
+  }
+
+  return squared_norms;
+}
+
+/**
+ * @brief Evaluate the loss one squared norm at a time, through the virtual ceres::LossFunction::Evaluate
+ *
+ * This is how the Ceres residual blocks evaluate the loss, so it serves as the baseline for the batch evaluation.
+ */
+template <class Loss>
+static void BM_evaluate(benchmark::State& state)
+{
+  const Loss loss;
+  const ceres::LossFunction* loss_function = loss.lossFunction();
+
+  const size_t count = state.range(0);
+  const auto squared_norms = createSquaredNorms(count);
+  std::vector<double> rho(count);
+  std::vector<double> rho_derivative(count);
+  std::vector<double> rho_second_derivative(count);
+
+  for (auto _ : state)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      double rho_i[3];
+      loss_function->Evaluate(squared_norms[i], rho_i);
+      rho[i] = rho_i[0];
+      rho_derivative[i] = rho_i[1];
+      rho_second_derivative[i] = rho_i[2];
+    }
+    benchmark::DoNotOptimize(rho.data());
+    benchmark::DoNotOptimize(rho_derivative.data());
+    benchmark::DoNotOptimize(rho_second_derivative.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+/**
+ * @brief Evaluate the loss for all the squared norms with a single fuse_core::Loss::evaluate call
+ */
+template <class Loss>
+static void BM_evaluateBatch(benchmark::State& state)
+{
+  const Loss loss;
+
+  const size_t count = state.range(0);
+  const auto squared_norms = createSquaredNorms(count);
+  std::vector<double> rho(count);
+  std::vector<double> rho_derivative(count);
+  std::vector<double> rho_second_derivative(count);
+
+  for (auto _ : state)
+  {
+    loss.evaluate(squared_norms.data(), count, rho.data(), rho_derivative.data(), rho_second_derivative.data());
+    benchmark::DoNotOptimize(rho.data());
+    benchmark::DoNotOptimize(rho_derivative.data());
+    benchmark::DoNotOptimize(rho_second_derivative.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+/**
+ * @brief Composition of a Cauchy loss applied on top of a Huber loss, to measure the cost of the chunked chain rule
+ */
+class CauchyHuberLoss : public fuse_loss::ComposedLoss
+{
+public:
+  CauchyHuberLoss() :
+    fuse_loss::ComposedLoss(std::make_shared<fuse_loss::CauchyLoss>(), std::make_shared<fuse_loss::HuberLoss>())
+  {
+  }
+};
+
+static void countArguments(benchmark::internal::Benchmark* benchmark)
+{
+  benchmark->RangeMultiplier(16)->Range(64, 65536);
+}
+
+#define BENCHMARK_LOSS(Loss)                                                                                           \
+  BENCHMARK_TEMPLATE(BM_evaluate, Loss)->Apply(countArguments);                                                       \
+  BENCHMARK_TEMPLATE(BM_evaluateBatch, Loss)->Apply(countArguments)
+
+BENCHMARK_LOSS(fuse_loss::ArctanLoss);
+BENCHMARK_LOSS(fuse_loss::CauchyLoss);
+BENCHMARK_LOSS(fuse_loss::DCSLoss);
+BENCHMARK_LOSS(fuse_loss::FairLoss);
+BENCHMARK_LOSS(fuse_loss::GemanMcClureLoss);
+BENCHMARK_LOSS(fuse_loss::HuberLoss);
+BENCHMARK_LOSS(fuse_loss::SoftLOneLoss);
+BENCHMARK_LOSS(fuse_loss::TolerantLoss);
+BENCHMARK_LOSS(fuse_loss::TukeyLoss);
+BENCHMARK_LOSS(fuse_loss::WelschLoss);
+BENCHMARK_LOSS(CauchyHuberLoss);
+
+BENCHMARK_MAIN();
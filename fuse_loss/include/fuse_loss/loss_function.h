@@ -34,6 +34,8 @@
 #ifndef FUSE_LOSS_LOSS_FUNCTION_H
 #define FUSE_LOSS_LOSS_FUNCTION_H
 
+#include <fuse_loss/loss_kernels.h>
+
 #include <ceres/loss_function.h>
 
 // This provides additional loss functions that are not available in:
@@ -134,14 +136,14 @@ namespace ceres
 class DCSLoss : public ceres::LossFunction
 {
 public:
-  explicit DCSLoss(const double a) : a_(a)
+  explicit DCSLoss(const double a) : kernel_(a)
   {
   }
 
   void Evaluate(double, double* rho) const override;
 
 private:
-  const double a_;
+  const fuse_loss::DCSKernel kernel_;
 };
 
 // Fair, similar to tthe L1 - L2 estimators, that try to take the advantage of the L1 estimators to reduce the influence
@@ -158,15 +160,14 @@ private:
 class FairLoss : public ceres::LossFunction
 {
 public:
-  explicit FairLoss(const double a) : a_(a), b_(a * a)
+  explicit FairLoss(const double a) : kernel_(a)
   {
   }
 
   void Evaluate(double, double*) const override;
 
 private:
-  const double a_;
-  const double b_;
+  const fuse_loss::FairKernel kernel_;
 };
 
 // Geman-McClure, similarly to Tukey loss, it tries to reduce the effect of large errors, but it does not suppress
@@ -206,14 +207,14 @@ private:
 class GemanMcClureLoss : public ceres::LossFunction
 {
 public:
-  explicit GemanMcClureLoss(const double a) : b_(a * a)
+  explicit GemanMcClureLoss(const double a) : kernel_(a)
   {
   }
 
   void Evaluate(double, double*) const override;
 
 private:
-  const double b_;
+  const fuse_loss::GemanMcClureKernel kernel_;
 };
 
 // Welsch, similar to Tukey loss, it tries to reduce the effect of large errors, but it does not suppress outliers as
@@ -229,15 +230,14 @@ private:
 class WelschLoss : public ceres::LossFunction
 {
 public:
-  explicit WelschLoss(const double a) : b_(a * a), c_(-1.0 / b_)
+  explicit WelschLoss(const double a) : kernel_(a)
   {
   }
 
   void Evaluate(double, double*) const override;
 
 private:
-  const double b_;
-  const double c_;
+  const fuse_loss::WelschKernel kernel_;
 };
 
 }  // namespace ceres
@@ -0,0 +1,304 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_LOSS_LOSS_KERNELS_H
+#define FUSE_LOSS_LOSS_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Inline kernels of the loss functions, used to evaluate rho(s) for arrays of squared norms.
+//
+// Each kernel computes the same values as the Evaluate() method of the corresponding ceres::LossFunction, for either
+// the Ceres implementation:
+//
+//   https://github.com/ceres-solver/ceres-solver/blob/master/internal/ceres/loss_function.cc
+//
+// or the ones in fuse_loss/loss_function.h. The kernels are branch-free where possible, i.e. both sides of a branch
+// are computed and the result is selected, so the loop in evaluateBatch() can be vectorized by the compiler. The
+// values computed for the unselected side may be infinite or NaN, but they are never returned.
+namespace fuse_loss
+{
+
+/**
+ * @brief Evaluate a loss kernel for an array of squared norms
+ *
+ * @param[in]  kernel                The loss kernel, a functor with an inline operator()(s, rho0, rho1, rho2)
+ * @param[in]  squared_norms         The squared residual norms, s = r^2
+ * @param[in]  count                 The number of elements in every array
+ * @param[out] rho                   The loss values, rho(s)
+ * @param[out] rho_derivative        The first derivatives, rho'(s)
+ * @param[out] rho_second_derivative The second derivatives, rho''(s)
+ */
+template <typename Kernel>
+inline void evaluateBatch(
+  const Kernel& kernel,
+  const double* squared_norms,
+  const size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    kernel(squared_norms[i], rho[i], rho_derivative[i], rho_second_derivative[i]);
+  }
+}
+
+/**
+ * @brief The lower bound Ceres applies to rho'(s), to keep the loss function strictly increasing
+ */
+constexpr double MIN_RHO_DERIVATIVE = std::numeric_limits<double>::min();
+
+/**
+ * @brief Kernel of ceres::ArctanLoss
+ */
+struct ArctanKernel
+{
+  explicit ArctanKernel(const double a) : a(a), b(1.0 / (a * a)) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const double inv = 1.0 / (1.0 + s * s * b);
+    rho0 = a * std::atan2(s, a);
+    rho1 = std::max(MIN_RHO_DERIVATIVE, inv);
+    rho2 = -2.0 * s * b * (inv * inv);
+  }
+
+  double a;
+  double b;
+};
+
+/**
+ * @brief Kernel of ceres::CauchyLoss
+ */
+struct CauchyKernel
+{
+  explicit CauchyKernel(const double a) : b(a * a), c(1.0 / b) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const double sum = 1.0 + s * c;
+    const double inv = 1.0 / sum;
+    rho0 = b * std::log(sum);
+    rho1 = std::max(MIN_RHO_DERIVATIVE, inv);
+    rho2 = -c * (inv * inv);
+  }
+
+  double b;
+  double c;
+};
+
+/**
+ * @brief Kernel of ceres::DCSLoss
+ */
+struct DCSKernel
+{
+  explicit DCSKernel(const double a) : a(a) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const bool outlier = s > a;
+    const double inv = 1.0 / (a + s);
+    const double scale = 2.0 * a * inv;
+    const double outlier_rho1 = scale * scale;
+    rho0 = outlier ? a * (3.0 * s - a) * inv : s;
+    rho1 = outlier ? outlier_rho1 : 1.0;
+    rho2 = outlier ? -2.0 * inv * outlier_rho1 : 0.0;
+  }
+
+  double a;
+};
+
+/**
+ * @brief Kernel of ceres::FairLoss
+ */
+struct FairKernel
+{
+  explicit FairKernel(const double a) : a(a), b(a * a) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const double r = std::sqrt(s);
+    const double ra = r / a;
+    const double sum = 1.0 + ra;
+    rho0 = 2.0 * b * (ra - std::log(sum));
+    rho1 = 1.0 / sum;
+    rho2 = r == 0.0 ? std::numeric_limits<double>::lowest() : -0.5 / (a * r * sum * sum);
+  }
+
+  double a;
+  double b;
+};
+
+/**
+ * @brief Kernel of ceres::GemanMcClureLoss
+ */
+struct GemanMcClureKernel
+{
+  explicit GemanMcClureKernel(const double a) : b(a * a) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const double inv = 1.0 / (b + s);
+    const double scale = b * inv;
+    rho0 = s * scale;
+    rho1 = scale * scale;
+    rho2 = -2.0 * inv * rho1;
+  }
+
+  double b;
+};
+
+/**
+ * @brief Kernel of ceres::HuberLoss
+ */
+struct HuberKernel
+{
+  explicit HuberKernel(const double a) : a(a), b(a * a) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const bool outlier = s > b;
+    const double r = std::sqrt(s);
+    const double outlier_rho1 = std::max(MIN_RHO_DERIVATIVE, a / r);
+    rho0 = outlier ? 2.0 * a * r - b : s;
+    rho1 = outlier ? outlier_rho1 : 1.0;
+    rho2 = outlier ? -outlier_rho1 / (2.0 * s) : 0.0;
+  }
+
+  double a;
+  double b;
+};
+
+/**
+ * @brief Kernel of ceres::SoftLOneLoss
+ */
+struct SoftLOneKernel
+{
+  explicit SoftLOneKernel(const double a) : b(a * a), c(1.0 / b) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const double sum = 1.0 + s * c;
+    const double tmp = std::sqrt(sum);
+    rho0 = 2.0 * b * (tmp - 1.0);
+    rho1 = std::max(MIN_RHO_DERIVATIVE, 1.0 / tmp);
+    rho2 = -(c * rho1) / (2.0 * sum);
+  }
+
+  double b;
+  double c;
+};
+
+/**
+ * @brief Kernel of ceres::TolerantLoss
+ */
+struct TolerantKernel
+{
+  TolerantKernel(const double a, const double b) : a(a), b(b), c(b * std::log(1.0 + std::exp(-a / b))) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    // Beyond this value of x, log(1 + exp(x)) == x in double precision
+    constexpr double LOG_2_POW_53 = 36.7;
+    const double x = (s - a) / b;
+    const bool linear = x > LOG_2_POW_53;
+    const double e_x = std::exp(x);
+    rho0 = linear ? s - a - c : b * std::log(1.0 + e_x) - c;
+    rho1 = linear ? 1.0 : std::max(MIN_RHO_DERIVATIVE, e_x / (1.0 + e_x));
+    rho2 = linear ? 0.0 : 0.5 / (b * (1.0 + std::cosh(x)));
+  }
+
+  double a;
+  double b;
+  double c;
+};
+
+/**
+ * @brief Kernel of ceres::TrivialLoss
+ */
+struct TrivialKernel
+{
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    rho0 = s;
+    rho1 = 1.0;
+    rho2 = 0.0;
+  }
+};
+
+/**
+ * @brief Kernel of ceres::TukeyLoss
+ */
+struct TukeyKernel
+{
+  explicit TukeyKernel(const double a) : a_squared(a * a) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const bool inlier = s <= a_squared;
+    const double value = 1.0 - s / a_squared;
+    const double value_sq = value * value;
+    rho0 = inlier ? a_squared / 3.0 * (1.0 - value_sq * value) : a_squared / 3.0;
+    rho1 = inlier ? value_sq : 0.0;
+    rho2 = inlier ? -2.0 / a_squared * value : 0.0;
+  }
+
+  double a_squared;
+};
+
+/**
+ * @brief Kernel of ceres::WelschLoss
+ */
+struct WelschKernel
+{
+  explicit WelschKernel(const double a) : b(a * a), c(-1.0 / b) {}
+
+  void operator()(const double s, double& rho0, double& rho1, double& rho2) const
+  {
+    const double exp = std::exp(s * c);
+    rho0 = b * (1.0 - exp);
+    rho1 = exp;
+    rho2 = c * exp;
+  }
+
+  double b;
+  double c;
+};
+
+}  // namespace fuse_loss
+
+#endif  // FUSE_LOSS_LOSS_KERNELS_H
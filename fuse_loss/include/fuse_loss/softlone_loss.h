@@ -88,16 +88,26 @@ public:
   void print(std::ostream& stream = std::cout) const override;
 
   /**
-   * @brief Return a raw pointer to a ceres::LossFunction that implements the loss function
+   * @brief Create a new ceres::LossFunction that implements the loss function
    *
-   * The Ceres interface requires a raw pointer. Ceres will take ownership of the pointer and promises to properly
-   * delete the loss function when it is done. Additionally, Fuse promises that the Loss object will outlive any
-   * generated loss functions (i.e. the Ceres objects will be destroyed before the Loss Function objects). This
-   * guarantee may allow optimizations for the creation of the loss function objects.
+   * Ownership of the returned pointer is passed to the caller. Use lossFunction() to access the instance cached by
+   * this Loss.
    *
-   * @return A base pointer to an instance of a derived ceres::LossFunction.
+   * @return A base pointer to a new instance of a derived ceres::LossFunction.
    */
-  ceres::LossFunction* lossFunction() const override;
+  ceres::LossFunction* createLossFunction() const override;
+
+  /**
+   * @brief Evaluate the loss function for an array of squared residual norms
+   *
+   * See fuse_core::Loss::evaluate(). The loss kernel is inlined into the loop, so it can be vectorized.
+   */
+  void evaluate(
+    const double* squared_norms,
+    size_t count,
+    double* rho,
+    double* rho_derivative,
+    double* rho_second_derivative) const override;
 
   /**
    * @brief Parameter 'a' accessor.
@@ -117,6 +127,7 @@ public:
   void a(const double a)
   {
     a_ = a;
+    resetLossFunction();
   }
 
 private:
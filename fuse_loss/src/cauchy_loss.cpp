@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/cauchy_loss.h>
+#include <fuse_loss/loss_kernels.h>
 
 #include <pluginlib/class_list_macros.hpp>
 #include <ros/node_handle.h>
@@ -54,6 +55,8 @@ void CauchyLoss::initialize(const std::string& name)
   ros::NodeHandle private_node_handle(name);
 
   private_node_handle.param("a", a_, a_);
+
+  resetLossFunction();
 }
 
 void CauchyLoss::print(std::ostream& stream) const
@@ -62,11 +65,21 @@ void CauchyLoss::print(std::ostream& stream) const
          << "  a: " << a_ << "\n";
 }
 
-ceres::LossFunction* CauchyLoss::lossFunction() const
+ceres::LossFunction* CauchyLoss::createLossFunction() const
 {
   return new ceres::CauchyLoss(a_);
 }
 
+void CauchyLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(CauchyKernel(a_), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::CauchyLoss)
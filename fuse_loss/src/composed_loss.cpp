@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/composed_loss.h>
+#include <fuse_loss/loss_kernels.h>
 #include <fuse_loss/trivial_loss.h>
 
 #include <fuse_core/parameter.h>
@@ -40,6 +41,7 @@
 
 #include <boost/serialization/export.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -60,6 +62,8 @@ void ComposedLoss::initialize(const std::string& name)
 
   f_loss_ = fuse_core::loadLossConfig(private_node_handle, "f_loss");
   g_loss_ = fuse_core::loadLossConfig(private_node_handle, "g_loss");
+
+  resetLossFunction();
 }
 
 void ComposedLoss::print(std::ostream& stream) const
@@ -77,10 +81,54 @@ void ComposedLoss::print(std::ostream& stream) const
   }
 }
 
-ceres::LossFunction* ComposedLoss::lossFunction() const
+ceres::LossFunction* ComposedLoss::createLossFunction() const
+{
+  // The wrapped losses keep ownership of their cached ceres::LossFunction, so fresh copies are owned by this one
+  return new ceres::ComposedLoss(
+      f_loss_ ? f_loss_->createLossFunction() : TrivialLoss().createLossFunction(), ceres::TAKE_OWNERSHIP,
+      g_loss_ ? g_loss_->createLossFunction() : TrivialLoss().createLossFunction(), ceres::TAKE_OWNERSHIP);
+}
+
+void ComposedLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
 {
-  return new ceres::ComposedLoss(f_loss_ ? f_loss_->lossFunction() : TrivialLoss().lossFunction(), Ownership,
-                                 g_loss_ ? g_loss_->lossFunction() : TrivialLoss().lossFunction(), Ownership);
+  // Same as ceres::ComposedLoss, i.e. f(g(s)), where a missing loss is the trivial loss. Evaluate g(s) into the output
+  // arrays first.
+  if (g_loss_)
+  {
+    g_loss_->evaluate(squared_norms, count, rho, rho_derivative, rho_second_derivative);
+  }
+  else
+  {
+    evaluateBatch(TrivialKernel(), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+  }
+  if (!f_loss_)
+  {
+    // f(g(s)) = g(s) for the trivial loss f
+    return;
+  }
+  // Evaluate f at g(s) in fixed-size chunks, so no memory is allocated, and apply the chain rule
+  constexpr size_t chunk_size = 64;
+  double f_rho[chunk_size];
+  double f_rho_derivative[chunk_size];
+  double f_rho_second_derivative[chunk_size];
+  for (size_t begin = 0; begin < count; begin += chunk_size)
+  {
+    const auto size = std::min(chunk_size, count - begin);
+    f_loss_->evaluate(rho + begin, size, f_rho, f_rho_derivative, f_rho_second_derivative);
+    for (size_t i = 0; i < size; ++i)
+    {
+      const auto g_rho_derivative = rho_derivative[begin + i];
+      rho[begin + i] = f_rho[i];
+      rho_derivative[begin + i] = f_rho_derivative[i] * g_rho_derivative;
+      rho_second_derivative[begin + i] = f_rho_second_derivative[i] * g_rho_derivative * g_rho_derivative +
+                                         f_rho_derivative[i] * rho_second_derivative[begin + i];
+    }
+  }
 }
 
 }  // namespace fuse_loss
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/dcs_loss.h>
+#include <fuse_loss/loss_kernels.h>
 #include <fuse_loss/loss_function.h>
 
 #include <pluginlib/class_list_macros.hpp>
@@ -55,6 +56,8 @@ void DCSLoss::initialize(const std::string& name)
   ros::NodeHandle private_node_handle(name);
 
   private_node_handle.param("a", a_, a_);
+
+  resetLossFunction();
 }
 
 void DCSLoss::print(std::ostream& stream) const
@@ -63,11 +66,21 @@ void DCSLoss::print(std::ostream& stream) const
          << "  a: " << a_ << "\n";
 }
 
-ceres::LossFunction* DCSLoss::lossFunction() const
+ceres::LossFunction* DCSLoss::createLossFunction() const
 {
   return new ceres::DCSLoss(a_);
 }
 
+void DCSLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(DCSKernel(a_), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::DCSLoss)
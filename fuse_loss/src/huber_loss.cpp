@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/huber_loss.h>
+#include <fuse_loss/loss_kernels.h>
 
 #include <pluginlib/class_list_macros.hpp>
 #include <ros/node_handle.h>
@@ -54,6 +55,8 @@ void HuberLoss::initialize(const std::string& name)
   ros::NodeHandle private_node_handle(name);
 
   private_node_handle.param("a", a_, a_);
+
+  resetLossFunction();
 }
 
 void HuberLoss::print(std::ostream& stream) const
@@ -62,11 +65,21 @@ void HuberLoss::print(std::ostream& stream) const
          << "  a: " << a_ << "\n";
 }
 
-ceres::LossFunction* HuberLoss::lossFunction() const
+ceres::LossFunction* HuberLoss::createLossFunction() const
 {
   return new ceres::HuberLoss(a_);
 }
 
+void HuberLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(HuberKernel(a_), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::HuberLoss)
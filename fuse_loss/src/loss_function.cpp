@@ -33,63 +33,28 @@
  */
 #include <fuse_loss/loss_function.h>
 
-#include <cmath>
-#include <limits>
-
 
 namespace ceres
 {
 
 void DCSLoss::Evaluate(double s, double rho[3]) const
 {
-  if (s > a_)
-  {
-    // Outlier region
-    const double inv = 1.0 / (a_ + s);
-    const double scale = 2.0 * a_ * inv;
-
-    rho[0] = a_ * (3.0 * s - a_) * inv;
-    rho[1] = scale * scale;
-    rho[2] = -2.0 * inv * rho[1];
-  }
-  else
-  {
-    // Inlier region
-    rho[0] = s;
-    rho[1] = 1.0;
-    rho[2] = 0.0;
-  }
+  kernel_(s, rho[0], rho[1], rho[2]);
 }
 
 void FairLoss::Evaluate(double s, double rho[3]) const
 {
-  const double r = std::sqrt(s);
-  const double ra = r / a_;
-  const double sum = 1.0 + ra;
-
-  rho[0] = 2.0 * b_ * (ra - std::log(sum));
-  rho[1] = 1.0 / sum;
-  rho[2] = r == 0.0 ? std::numeric_limits<double>::lowest() : -0.5 / (a_ * r * sum * sum);
+  kernel_(s, rho[0], rho[1], rho[2]);
 }
 
 void GemanMcClureLoss::Evaluate(double s, double rho[3]) const
 {
-  const double sum = b_ + s;
-  const double inv = 1.0 / sum;
-  const double scale = b_ * inv;
-
-  rho[0] = s * scale;
-  rho[1] = scale * scale;
-  rho[2] = -2.0 * inv * rho[1];
+  kernel_(s, rho[0], rho[1], rho[2]);
 }
 
 void WelschLoss::Evaluate(double s, double rho[3]) const
 {
-  const double exp = std::exp(s * c_);
-
-  rho[0] = b_ * (1 - exp);
-  rho[1] = exp;
-  rho[2] = c_ * exp;
+  kernel_(s, rho[0], rho[1], rho[2]);
 }
 
 }  // namespace ceres
@@ -58,6 +58,8 @@ void ScaledLoss::initialize(const std::string& name)
   private_node_handle.param("a", a_, a_);
 
   loss_ = fuse_core::loadLossConfig(private_node_handle, "loss");
+
+  resetLossFunction();
 }
 
 void ScaledLoss::print(std::ostream& stream) const
@@ -71,9 +73,37 @@ void ScaledLoss::print(std::ostream& stream) const
   }
 }
 
-ceres::LossFunction* ScaledLoss::lossFunction() const
+ceres::LossFunction* ScaledLoss::createLossFunction() const
+{
+  // The wrapped loss keeps ownership of its cached ceres::LossFunction, so a fresh copy is owned by this one
+  return new ceres::ScaledLoss(loss_ ? loss_->createLossFunction() : nullptr, a_, ceres::TAKE_OWNERSHIP);
+}
+
+void ScaledLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
 {
-  return new ceres::ScaledLoss(loss_ ? loss_->lossFunction() : nullptr, a_, Ownership);
+  // Same as ceres::ScaledLoss, i.e. a * rho(s), where a missing loss is the trivial loss
+  if (!loss_)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      rho[i] = a_ * squared_norms[i];
+      rho_derivative[i] = a_;
+      rho_second_derivative[i] = 0.0;
+    }
+    return;
+  }
+  loss_->evaluate(squared_norms, count, rho, rho_derivative, rho_second_derivative);
+  for (size_t i = 0; i < count; ++i)
+  {
+    rho[i] *= a_;
+    rho_derivative[i] *= a_;
+    rho_second_derivative[i] *= a_;
+  }
 }
 
 }  // namespace fuse_loss
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/softlone_loss.h>
+#include <fuse_loss/loss_kernels.h>
 
 #include <pluginlib/class_list_macros.hpp>
 #include <ros/node_handle.h>
@@ -54,6 +55,8 @@ void SoftLOneLoss::initialize(const std::string& name)
   ros::NodeHandle private_node_handle(name);
 
   private_node_handle.param("a", a_, a_);
+
+  resetLossFunction();
 }
 
 void SoftLOneLoss::print(std::ostream& stream) const
@@ -62,11 +65,21 @@ void SoftLOneLoss::print(std::ostream& stream) const
          << "  a: " << a_ << "\n";
 }
 
-ceres::LossFunction* SoftLOneLoss::lossFunction() const
+ceres::LossFunction* SoftLOneLoss::createLossFunction() const
 {
   return new ceres::SoftLOneLoss(a_);
 }
 
+void SoftLOneLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(SoftLOneKernel(a_), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::SoftLOneLoss)
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/tolerant_loss.h>
+#include <fuse_loss/loss_kernels.h>
 
 #include <pluginlib/class_list_macros.hpp>
 #include <ros/node_handle.h>
@@ -56,6 +57,8 @@ void TolerantLoss::initialize(const std::string& name)
 
   private_node_handle.param("a", a_, a_);
   private_node_handle.param("b", b_, b_);
+
+  resetLossFunction();
 }
 
 void TolerantLoss::print(std::ostream& stream) const
@@ -65,11 +68,21 @@ void TolerantLoss::print(std::ostream& stream) const
          << "  b: " << b_ << "\n";
 }
 
-ceres::LossFunction* TolerantLoss::lossFunction() const
+ceres::LossFunction* TolerantLoss::createLossFunction() const
 {
   return new ceres::TolerantLoss(a_, b_);
 }
 
+void TolerantLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(TolerantKernel(a_, b_), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::TolerantLoss)
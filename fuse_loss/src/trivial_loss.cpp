@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/trivial_loss.h>
+#include <fuse_loss/loss_kernels.h>
 
 #include <pluginlib/class_list_macros.hpp>
 #include <ros/node_handle.h>
@@ -49,11 +50,21 @@ void TrivialLoss::print(std::ostream& stream) const
   stream << type() << "\n";
 }
 
-ceres::LossFunction* TrivialLoss::lossFunction() const
+ceres::LossFunction* TrivialLoss::createLossFunction() const
 {
   return new ceres::TrivialLoss();
 }
 
+void TrivialLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(TrivialKernel(), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::TrivialLoss)
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/tukey_loss.h>
+#include <fuse_loss/loss_kernels.h>
 
 #include <fuse_core/ceres_macros.h>
 
@@ -56,6 +57,8 @@ void TukeyLoss::initialize(const std::string& name)
   ros::NodeHandle private_node_handle(name);
 
   private_node_handle.param("a", a_, a_);
+
+  resetLossFunction();
 }
 
 void TukeyLoss::print(std::ostream& stream) const
@@ -64,7 +67,7 @@ void TukeyLoss::print(std::ostream& stream) const
          << "  a: " << a_ << "\n";
 }
 
-ceres::LossFunction* TukeyLoss::lossFunction() const
+ceres::LossFunction* TukeyLoss::createLossFunction() const
 {
 #if CERES_VERSION_AT_LEAST(2, 0, 0)
   return new ceres::TukeyLoss(a_);
@@ -87,6 +90,16 @@ ceres::LossFunction* TukeyLoss::lossFunction() const
 #endif
 }
 
+void TukeyLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(TukeyKernel(a_), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::TukeyLoss)
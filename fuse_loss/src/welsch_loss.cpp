@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_loss/welsch_loss.h>
+#include <fuse_loss/loss_kernels.h>
 #include <fuse_loss/loss_function.h>
 
 #include <pluginlib/class_list_macros.hpp>
@@ -55,6 +56,8 @@ void WelschLoss::initialize(const std::string& name)
   ros::NodeHandle private_node_handle(name);
 
   private_node_handle.param("a", a_, a_);
+
+  resetLossFunction();
 }
 
 void WelschLoss::print(std::ostream& stream) const
@@ -63,11 +66,21 @@ void WelschLoss::print(std::ostream& stream) const
          << "  a: " << a_ << "\n";
 }
 
-ceres::LossFunction* WelschLoss::lossFunction() const
+ceres::LossFunction* WelschLoss::createLossFunction() const
 {
   return new ceres::WelschLoss(a_);
 }
 
+void WelschLoss::evaluate(
+  const double* squared_norms,
+  size_t count,
+  double* rho,
+  double* rho_derivative,
+  double* rho_second_derivative) const
+{
+  evaluateBatch(WelschKernel(a_), squared_norms, count, rho, rho_derivative, rho_second_derivative);
+}
+
 }  // namespace fuse_loss
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_loss::WelschLoss)
@@ -0,0 +1,126 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/loss.h>
+#include <fuse_loss/arctan_loss.h>
+#include <fuse_loss/cauchy_loss.h>
+#include <fuse_loss/composed_loss.h>
+#include <fuse_loss/dcs_loss.h>
+#include <fuse_loss/fair_loss.h>
+#include <fuse_loss/geman_mcclure_loss.h>
+#include <fuse_loss/huber_loss.h>
+#include <fuse_loss/scaled_loss.h>
+#include <fuse_loss/softlone_loss.h>
+#include <fuse_loss/tolerant_loss.h>
+#include <fuse_loss/trivial_loss.h>
+#include <fuse_loss/tukey_loss.h>
+#include <fuse_loss/welsch_loss.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @brief Check the batch evaluation of a loss matches the per-element evaluation of its ceres::LossFunction
+ *
+ * The squared norms cover the inlier region, the transition around the loss scale and far outliers, and the count is
+ * deliberately not a multiple of any vector width.
+ */
+void AssertBatchMatchesLossFunction(const fuse_core::Loss& loss)
+{
+  std::vector<double> squared_norms;
+  for (double s = 0.0; s < 200.0; s += 0.37)
+  {
+    squared_norms.push_back(s);
+  }
+  squared_norms.push_back(1.0e6);
+
+  const size_t count = squared_norms.size();
+  std::vector<double> rho(count);
+  std::vector<double> rho_derivative(count);
+  std::vector<double> rho_second_derivative(count);
+  loss.evaluate(squared_norms.data(), count, rho.data(), rho_derivative.data(), rho_second_derivative.data());
+
+  const ceres::LossFunction* loss_function = loss.lossFunction();
+  for (size_t i = 0; i < count; ++i)
+  {
+    double expected[3] = { squared_norms[i], 1.0, 0.0 };
+    if (loss_function)
+    {
+      loss_function->Evaluate(squared_norms[i], expected);
+    }
+
+    const double tolerance = 1.0e-12 * std::max(1.0, std::abs(expected[0]));
+    EXPECT_NEAR(expected[0], rho[i], tolerance) << loss.type() << " s = " << squared_norms[i];
+    EXPECT_NEAR(expected[1], rho_derivative[i], 1.0e-12) << loss.type() << " s = " << squared_norms[i];
+    EXPECT_NEAR(expected[2], rho_second_derivative[i], 1.0e-12) << loss.type() << " s = " << squared_norms[i];
+  }
+}
+
+}  // namespace
+
+TEST(BatchEvaluation, Kernels)
+{
+  AssertBatchMatchesLossFunction(fuse_loss::ArctanLoss(1.3));
+  AssertBatchMatchesLossFunction(fuse_loss::CauchyLoss(0.7));
+  AssertBatchMatchesLossFunction(fuse_loss::DCSLoss(2.0));
+  AssertBatchMatchesLossFunction(fuse_loss::FairLoss(1.5));
+  AssertBatchMatchesLossFunction(fuse_loss::GemanMcClureLoss(1.2));
+  AssertBatchMatchesLossFunction(fuse_loss::HuberLoss(2.5));
+  AssertBatchMatchesLossFunction(fuse_loss::SoftLOneLoss(0.9));
+  AssertBatchMatchesLossFunction(fuse_loss::TolerantLoss(3.0, 0.5));
+  AssertBatchMatchesLossFunction(fuse_loss::TrivialLoss());
+  AssertBatchMatchesLossFunction(fuse_loss::TukeyLoss(4.0));
+  AssertBatchMatchesLossFunction(fuse_loss::WelschLoss(1.1));
+}
+
+TEST(BatchEvaluation, ScaledLoss)
+{
+  AssertBatchMatchesLossFunction(fuse_loss::ScaledLoss(0.4));
+  AssertBatchMatchesLossFunction(fuse_loss::ScaledLoss(0.4, std::make_shared<fuse_loss::HuberLoss>(2.0)));
+}
+
+TEST(BatchEvaluation, ComposedLoss)
+{
+  AssertBatchMatchesLossFunction(fuse_loss::ComposedLoss());
+  AssertBatchMatchesLossFunction(fuse_loss::ComposedLoss(std::make_shared<fuse_loss::CauchyLoss>(0.8)));
+  AssertBatchMatchesLossFunction(fuse_loss::ComposedLoss(nullptr, std::make_shared<fuse_loss::HuberLoss>(1.5)));
+  AssertBatchMatchesLossFunction(fuse_loss::ComposedLoss(std::make_shared<fuse_loss::TukeyLoss>(3.0),
+                                                         std::make_shared<fuse_loss::ScaledLoss>(2.0)));
+}
@@ -54,8 +54,8 @@ TEST(ComposedLoss, Constructor)
     EXPECT_EQ(nullptr, composed_loss.gLoss());
 
     // Check nullptr is handled as TrivialLoss internally
-    std::unique_ptr<ceres::LossFunction> composed_loss_function = nullptr;
-    ASSERT_NO_THROW(composed_loss_function.reset(composed_loss.lossFunction()));
+    ceres::LossFunction* composed_loss_function = nullptr;
+    ASSERT_NO_THROW(composed_loss_function = composed_loss.lossFunction());
     ASSERT_NE(nullptr, composed_loss_function);
 
     const double s = 1.5;
@@ -77,11 +77,11 @@ TEST(ComposedLoss, Constructor)
     EXPECT_EQ(nullptr, composed_loss.gLoss());
 
     // Check nullptr is handled as TrivialLoss internally
-    std::unique_ptr<ceres::LossFunction> composed_loss_function = nullptr;
-    ASSERT_NO_THROW(composed_loss_function.reset(composed_loss.lossFunction()));
+    ceres::LossFunction* composed_loss_function = nullptr;
+    ASSERT_NO_THROW(composed_loss_function = composed_loss.lossFunction());
     ASSERT_NE(nullptr, composed_loss_function);
 
-    const auto f_loss_function = std::unique_ptr<ceres::LossFunction>(f_loss->lossFunction());
+    const auto f_loss_function = f_loss->lossFunction();
     ASSERT_NE(nullptr, f_loss_function);
 
     const double s = 1.5;
@@ -111,11 +111,11 @@ TEST(ComposedLoss, Constructor)
     EXPECT_EQ(g_loss.get(), composed_loss.gLoss().get());
 
     // Check nullptr is handled as TrivialLoss internally
-    std::unique_ptr<ceres::LossFunction> composed_loss_function = nullptr;
-    ASSERT_NO_THROW(composed_loss_function.reset(composed_loss.lossFunction()));
+    ceres::LossFunction* composed_loss_function = nullptr;
+    ASSERT_NO_THROW(composed_loss_function = composed_loss.lossFunction());
     ASSERT_NE(nullptr, composed_loss_function);
 
-    const auto g_loss_function = std::unique_ptr<ceres::LossFunction>(g_loss->lossFunction());
+    const auto g_loss_function = g_loss->lossFunction();
     ASSERT_NE(nullptr, g_loss_function);
 
     const double s = 1.5;
@@ -147,14 +147,14 @@ TEST(ComposedLoss, Constructor)
     EXPECT_EQ(g_loss.get(), composed_loss.gLoss().get());
 
     // Check the composed loss is computed as 'f(g(s))'
-    std::unique_ptr<ceres::LossFunction> composed_loss_function = nullptr;
-    ASSERT_NO_THROW(composed_loss_function.reset(composed_loss.lossFunction()));
+    ceres::LossFunction* composed_loss_function = nullptr;
+    ASSERT_NO_THROW(composed_loss_function = composed_loss.lossFunction());
     ASSERT_NE(nullptr, composed_loss_function);
 
-    const auto f_loss_function = std::unique_ptr<ceres::LossFunction>(f_loss->lossFunction());
+    const auto f_loss_function = f_loss->lossFunction();
     ASSERT_NE(nullptr, f_loss_function);
 
-    const auto g_loss_function = std::unique_ptr<ceres::LossFunction>(g_loss->lossFunction());
+    const auto g_loss_function = g_loss->lossFunction();
     ASSERT_NE(nullptr, g_loss_function);
 
     const double s = 1.5;
@@ -299,8 +299,8 @@ TEST(ComposedLoss, Serialization)
   }
 
   // Compare
-  const auto expected_loss_function = std::unique_ptr<ceres::LossFunction>(actual.lossFunction());
-  const auto actual_loss_function = std::unique_ptr<ceres::LossFunction>(actual.lossFunction());
+  const auto expected_loss_function = expected.lossFunction();
+  const auto actual_loss_function = actual.lossFunction();
 
   ASSERT_NE(nullptr, actual_loss_function);
   EXPECT_NE(nullptr, actual.fLoss());
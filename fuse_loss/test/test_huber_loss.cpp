@@ -39,6 +39,8 @@
 #include <ceres/solver.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 TEST(HuberLoss, Constructor)
 {
   // Create a default loss
@@ -55,6 +57,26 @@ TEST(HuberLoss, Constructor)
   }
 }
 
+TEST(HuberLoss, LossFunction)
+{
+  fuse_loss::HuberLoss loss(0.3);
+
+  // The same ceres::LossFunction is returned until the loss parameters change
+  const auto loss_function = loss.lossFunction();
+  ASSERT_NE(nullptr, loss_function);
+  EXPECT_EQ(loss_function, loss.lossFunction());
+
+  // An outlier residual is affected by the value of 'a'
+  const double s = 4.0;
+  double rho[3];
+  loss.lossFunction()->Evaluate(s, rho);
+  EXPECT_NEAR(2.0 * 0.3 * std::sqrt(s) - 0.3 * 0.3, rho[0], 1.0e-9);
+
+  loss.a(0.5);
+  loss.lossFunction()->Evaluate(s, rho);
+  EXPECT_NEAR(2.0 * 0.5 * std::sqrt(s) - 0.5 * 0.5, rho[0], 1.0e-9);
+}
+
 struct CostFunctor
 {
   explicit CostFunctor(const double data)
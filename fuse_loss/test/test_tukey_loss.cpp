@@ -61,7 +61,7 @@ TEST(TukeyLoss, Evaluate)
 {
   // Check that at s = 0: rho = [0, 1, -2 / a^2].
   fuse_loss::TukeyLoss loss(0.7);
-  const std::unique_ptr<ceres::LossFunction> loss_function(loss.lossFunction());
+  const auto loss_function = loss.lossFunction();
 
   double rho[3];
   loss_function->Evaluate(0.0, rho);
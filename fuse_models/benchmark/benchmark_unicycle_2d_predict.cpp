@@ -0,0 +1,142 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/eigen.h>
+#include <fuse_models/unicycle_2d_predict.h>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+
+
+/**
+ * @brief The first state used by all benchmarks: position, yaw, linear velocity, yaw velocity and linear acceleration
+ */
+static fuse_core::Vector8d initialState()
+{
+  fuse_core::Vector8d state;
+  state << 0.3, -1.0, 2.9, 1.2, -0.4, 1.5, 0.7, -0.2;
+  return state;
+}
+
+static constexpr double dt{ 0.005 };  // 200 Hz
+
+/**
+ * @brief Predict and assemble the full Jacobian from the per-parameter-block Jacobians, as the tf2_2d predict overload
+ *        did before the fixed-size state predict was added
+ */
+static void BM_predictJacobianBlocks(benchmark::State& state)
+{
+  const auto state1 = initialState();
+  fuse_core::Vector8d state2;
+  fuse_core::Matrix8d jacobian;
+
+  static const std::array<size_t, 5> block_sizes = {2, 1, 2, 1, 2};
+
+  for (auto _ : state)
+  {
+    std::array<fuse_core::MatrixXd, 5> J;
+    std::array<double*, 5> jacobians;
+
+    for (size_t i = 0; i < block_sizes.size(); ++i)
+    {
+      J[i].resize(8, block_sizes[i]);
+      jacobians[i] = J[i].data();
+    }
+
+    fuse_models::predict(
+      state1[0], state1[1], state1[2], state1[3], state1[4], state1[5], state1[6], state1[7],
+      dt,
+      state2[0], state2[1], state2[2], state2[3], state2[4], state2[5], state2[6], state2[7],
+      jacobians.data());
+
+    jacobian << J[0], J[1], J[2], J[3], J[4];
+
+    benchmark::DoNotOptimize(state2);
+    benchmark::DoNotOptimize(jacobian);
+  }
+}
+
+BENCHMARK(BM_predictJacobianBlocks);
+
+/**
+ * @brief Predict with the allocation-free fixed-size state predict
+ */
+static void BM_predictStateVector(benchmark::State& state)
+{
+  const auto state1 = initialState();
+  fuse_core::Vector8d state2;
+  fuse_core::Matrix8d jacobian;
+
+  for (auto _ : state)
+  {
+    fuse_models::predict(state1, dt, state2, jacobian);
+
+    benchmark::DoNotOptimize(state2);
+    benchmark::DoNotOptimize(jacobian);
+  }
+}
+
+BENCHMARK(BM_predictStateVector);
+
+/**
+ * @brief Predict the state and propagate the covariance over a number of steps, e.g. one per IMU measurement
+ */
+static void BM_predictStateVectorWithCovariance(benchmark::State& state)
+{
+  const fuse_core::Matrix8d process_noise_covariance = 1e-3 * fuse_core::Matrix8d::Identity();
+  fuse_core::Matrix8d jacobian;
+  fuse_core::Matrix8d predicted_covariance;
+
+  for (auto _ : state)
+  {
+    auto state1 = initialState();
+    fuse_core::Matrix8d covariance = 1e-2 * fuse_core::Matrix8d::Identity();
+
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+      fuse_models::predict(state1, dt, state1, jacobian);
+      predicted_covariance.noalias() = jacobian * covariance * jacobian.transpose();
+      covariance = predicted_covariance;
+      covariance.noalias() += dt * process_noise_covariance;
+    }
+
+    benchmark::DoNotOptimize(state1);
+    benchmark::DoNotOptimize(covariance);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_predictStateVectorWithCovariance)->Arg(1)->Arg(10)->Arg(100);
+
+BENCHMARK_MAIN();
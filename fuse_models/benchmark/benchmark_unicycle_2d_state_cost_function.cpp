@@ -154,4 +154,24 @@ BENCHMARK_F(Unicycle2DStateCostFunction, AutoDiffUnicycle2DStateCostFunction)(be
   }
 }
 
+BENCHMARK_F(Unicycle2DStateCostFunction, AnalyticUnicycle2DCostFunctionResiduals)(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    cost_function.Evaluate(parameters, residuals.data(), nullptr);
+  }
+}
+
+BENCHMARK_F(Unicycle2DStateCostFunction, AutoDiffUnicycle2DStateCostFunctionResiduals)(benchmark::State& state)
+{
+  // Create cost function using automatic differentiation on the cost functor
+  ceres::AutoDiffCostFunction<fuse_models::Unicycle2DStateCostFunctor, 8, 2, 1, 2, 1, 2, 2, 1, 2, 1, 2>
+      cost_function_autodiff(new fuse_models::Unicycle2DStateCostFunctor(dt, sqrt_information));
+
+  for (auto _ : state)
+  {
+    cost_function_autodiff.Evaluate(parameters, residuals.data(), nullptr);
+  }
+}
+
 BENCHMARK_MAIN();
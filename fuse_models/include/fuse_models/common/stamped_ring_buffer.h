@@ -0,0 +1,293 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_MODELS_COMMON_STAMPED_RING_BUFFER_H
+#define FUSE_MODELS_COMMON_STAMPED_RING_BUFFER_H
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace fuse_models
+{
+
+namespace common
+{
+
+/**
+ * @brief A contiguous, stamp-ordered ring buffer
+ *
+ * This is a replacement for a std::map<Stamp, T> used as a time-ordered history, where new elements are almost always
+ * newer than the existing ones and old elements are removed from the front. Appending and removing from the front
+ * are constant time, and lookups by stamp are binary searches over contiguous memory. Inserting an element older
+ * than the newest one shifts the newer elements, like a std::vector insertion. The capacity grows in powers of two,
+ * so a history that reaches a steady size performs no further allocations.
+ *
+ * Elements are addressed by their position, from 0 (the oldest) to size() - 1 (the newest). Positions are invalidated
+ * by insertions and removals.
+ *
+ * @tparam Stamp A copyable type with a strict weak ordering, e.g. ros::Time
+ * @tparam T     A default-constructible element type
+ */
+template <typename Stamp, typename T>
+class StampedRingBuffer
+{
+public:
+  using value_type = std::pair<Stamp, T>;
+
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();  //!< Returned by find() if there is no match
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] capacity The initial capacity. It is rounded up to a power of two.
+   */
+  explicit StampedRingBuffer(const size_t capacity = 16) :
+    head_(0),
+    size_(0)
+  {
+    size_t rounded_capacity = 1;
+    while (rounded_capacity < capacity)
+    {
+      rounded_capacity *= 2;
+    }
+    buffer_.resize(rounded_capacity);
+  }
+
+  /**
+   * @brief The number of elements
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Returns true if there are no elements
+   */
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief Remove all elements. The capacity is retained.
+   */
+  void clear()
+  {
+    for (size_t i = 0; i < size_; ++i)
+    {
+      (*this)[i] = value_type();
+    }
+    head_ = 0;
+    size_ = 0;
+  }
+
+  /**
+   * @brief Access an element by position, from 0 (the oldest) to size() - 1 (the newest)
+   */
+  value_type& operator[](const size_t position) { return buffer_[(head_ + position) & (buffer_.size() - 1)]; }
+
+  /**
+   * @brief Access an element by position, from 0 (the oldest) to size() - 1 (the newest)
+   */
+  const value_type& operator[](const size_t position) const
+  {
+    return buffer_[(head_ + position) & (buffer_.size() - 1)];
+  }
+
+  /**
+   * @brief Access the oldest element. The buffer must not be empty.
+   */
+  value_type& front() { return (*this)[0]; }
+
+  /**
+   * @brief Access the oldest element. The buffer must not be empty.
+   */
+  const value_type& front() const { return (*this)[0]; }
+
+  /**
+   * @brief Access the newest element. The buffer must not be empty.
+   */
+  value_type& back() { return (*this)[size_ - 1]; }
+
+  /**
+   * @brief Access the newest element. The buffer must not be empty.
+   */
+  const value_type& back() const { return (*this)[size_ - 1]; }
+
+  /**
+   * @brief Access the element with the provided stamp
+   *
+   * @throws std::out_of_range if there is no element with the provided stamp
+   */
+  T& at(const Stamp& stamp)
+  {
+    const auto position = find(stamp);
+    if (position == npos)
+    {
+      throw std::out_of_range("There is no element with the requested stamp.");
+    }
+    return (*this)[position].second;
+  }
+
+  /**
+   * @brief Access the element with the provided stamp
+   *
+   * @throws std::out_of_range if there is no element with the provided stamp
+   */
+  const T& at(const Stamp& stamp) const
+  {
+    return const_cast<StampedRingBuffer*>(this)->at(stamp);
+  }
+
+  /**
+   * @brief The position of the first element with a stamp greater than the provided one, or size() if there is none
+   */
+  size_t upperBound(const Stamp& stamp) const
+  {
+    size_t first = 0;
+    size_t count = size_;
+    while (count > 0)
+    {
+      const size_t step = count / 2;
+      const size_t middle = first + step;
+      if (!(stamp < (*this)[middle].first))
+      {
+        first = middle + 1;
+        count -= step + 1;
+      }
+      else
+      {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+  /**
+   * @brief The position of the element with the provided stamp, or npos if there is none
+   */
+  size_t find(const Stamp& stamp) const
+  {
+    const auto position = upperBound(stamp);
+    if ((position == 0) || ((*this)[position - 1].first < stamp))
+    {
+      return npos;
+    }
+    return position - 1;
+  }
+
+  /**
+   * @brief Insert an element in stamp order, unless an element with the same stamp already exists
+   *
+   * @param[in] stamp The stamp of the new element
+   * @param[in] value The new element
+   * @return The position of the element with the provided stamp, and true if the element was inserted or false if an
+   *         element with the same stamp already existed
+   */
+  std::pair<size_t, bool> emplace(const Stamp& stamp, T value)
+  {
+    // Fast path: the new element is the newest one
+    if (empty() || (back().first < stamp))
+    {
+      reserve(size_ + 1);
+      ++size_;
+      back() = value_type(stamp, std::move(value));
+      return {size_ - 1, true};
+    }
+    const auto position = upperBound(stamp);
+    if ((position > 0) && !((*this)[position - 1].first < stamp))
+    {
+      return {position - 1, false};
+    }
+    // Shift the newer elements to make room for the new one
+    reserve(size_ + 1);
+    ++size_;
+    for (size_t i = size_ - 1; i > position; --i)
+    {
+      (*this)[i] = std::move((*this)[i - 1]);
+    }
+    (*this)[position] = value_type(stamp, std::move(value));
+    return {position, true};
+  }
+
+  /**
+   * @brief Remove the oldest elements
+   *
+   * @param[in] count The number of elements to remove. It must not be greater than size().
+   */
+  void popFront(const size_t count = 1)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      front() = value_type();
+      head_ = (head_ + 1) & (buffer_.size() - 1);
+      --size_;
+    }
+  }
+
+  /**
+   * @brief Ensure the buffer can hold the provided number of elements without allocating
+   */
+  void reserve(const size_t capacity)
+  {
+    if (capacity <= buffer_.size())
+    {
+      return;
+    }
+    size_t new_capacity = buffer_.size();
+    while (new_capacity < capacity)
+    {
+      new_capacity *= 2;
+    }
+    std::vector<value_type> new_buffer(new_capacity);
+    for (size_t i = 0; i < size_; ++i)
+    {
+      new_buffer[i] = std::move((*this)[i]);
+    }
+    buffer_.swap(new_buffer);
+    head_ = 0;
+  }
+
+private:
+  std::vector<value_type> buffer_;  //!< The element storage. Its size is the capacity, always a power of two.
+  size_t head_;  //!< The storage index of the oldest element
+  size_t size_;  //!< The number of elements
+};
+
+template <typename Stamp, typename T>
+constexpr size_t StampedRingBuffer<Stamp, T>::npos;
+
+}  // namespace common
+
+}  // namespace fuse_models
+
+#endif  // FUSE_MODELS_COMMON_STAMPED_RING_BUFFER_H
@@ -38,22 +38,28 @@
 
 #include <fuse_core/async_publisher.h>
 #include <fuse_core/console.h>
+#include <fuse_core/covariance_blocks.h>
+#include <fuse_core/eigen.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
 #include <fuse_core/variable.h>
+#include <fuse_publishers/covariance_worker.h>
 #include <fuse_publishers/stamped_variable_synchronizer.h>
 
 #include <geometry_msgs/AccelWithCovarianceStamped.h>
 #include <nav_msgs/Odometry.h>
 #include <ros/ros.h>
+#include <sensor_msgs/Imu.h>
 #include <tf2_ros/buffer.h>
 #include <tf2_ros/transform_broadcaster.h>
 #include <tf2_ros/transform_listener.h>
 
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace fuse_models
 {
@@ -71,6 +77,14 @@ namespace fuse_models
  *                                                   specifies whether we should predict, using the 2D unicycle model,
  *                                                   the state at the time of the tf publication, rather than the last
  *                                                   posterior (optimized) state.
+ *  - use_imu (bool, default: false) When predicting to the current time, use the yaw velocity, and the linear
+ *                                  acceleration if predict_with_acceleration is set, measured by an IMU after the
+ *                                  last optimized state instead of assuming they are constant. The IMU measurements
+ *                                  must be expressed in the base_link_frame_id, with the gravity removed.
+ *  - imu_topic (string, default: "imu")  The ROS topic of the IMU measurements, if use_imu is set
+ *  - imu_queue_size (int, default: 10)  The size of the IMU subscriber queue
+ *  - imu_buffer_length (double, default: 1.0)  The maximum age, in seconds, of the buffered IMU measurements relative
+ *                                              to the newest one
  *  - publish_frequency (double, default: 10.0)  How often, in Hz, we publish the filtered state data and broadcast the
  *                                               transform
  *  - tf_cache_time (double, default: 10.0)  The length of our tf cache (only used if the world_frame_id and the
@@ -84,12 +98,23 @@ namespace fuse_models
  *  - world_frame_id (string, default: "odom")  The frame_id that will be published as the parent frame for the output.
  *                                              Must be either the map_frame_id or the odom_frame_id.
  *  - topic (string, default: "~odometry/filtered")  The ROS topic to which we will publish the filtered state data
+ *  - shared_covariance (bool, default: false)  Whether the state covariance should be requested from the
+ *                                              optimizer, which computes the covariance requests of all publishers
+ *                                              in a single batch using the default covariance options, ignoring the
+ *                                              covariance_options. If false, the covariance is computed by this
+ *                                              publisher using the covariance_options.
+ *  - async_covariance (bool, default: false)  When the covariance is computed by this publisher, compute it in a
+ *                                             dedicated worker thread instead of the notify callback. The state is
+ *                                             published with the last covariance computed until the new one is
+ *                                             ready. If a newer state arrives before the computation starts, the
+ *                                             older one is dropped.
  *
  * Publishes:
  *  - odometry/filtered (nav_msgs::Odometry)  The most recent optimized state, gives as an odometry message
  *  - tf (via a tf2_ros::TransformBroadcaster)  The most recent optimized state, as a tf transform
  *
  * Subscribes:
+ *  - imu (sensor_msgs::Imu)  IMU measurements used to predict the state to the current time, if use_imu is set
  *  - tf, tf_static (tf2_msgs::TFMessage)  Subscribes to tf data to obtain the requisite odom->base_link transform,
  *                                         but only if the world_frame_id is set to the value of the map_frame_id.
  */
@@ -119,12 +144,73 @@ protected:
   /**
    * @brief Fires whenever an optimized graph has been computed
    *
-   * @param[in] transaction A Transaction object, describing the set of variables that have been added and/or removed
-   * @param[in] graph       A read-only pointer to the graph object, allowing queries to be performed whenever needed
+   * @param[in] transaction       A Transaction object, describing the set of variables that have been added and/or
+   *                              removed
+   * @param[in] graph             A read-only pointer to the graph object, allowing queries to be performed whenever
+   *                              needed
+   * @param[in] covariance_blocks The covariance blocks computed by the optimizer, or nullptr
    */
   void notifyCallback(
     fuse_core::Transaction::ConstSharedPtr transaction,
-    fuse_core::Graph::ConstSharedPtr graph) override;
+    fuse_core::Graph::ConstSharedPtr graph,
+    fuse_core::CovarianceBlocks::ConstSharedPtr covariance_blocks) override;
+
+  /**
+   * @brief Request the covariance of the most recent state from the optimizer
+   *
+   * This is executed in the optimizer's thread, so it uses a dedicated synchronizer and throttle stamp that mirror
+   * the ones used by notifyCallback().
+   *
+   * @param[in]  transaction A Transaction object, describing the set of variables that have been added and/or removed
+   * @param[in]  graph       The optimized graph
+   * @param[out] requests    The container that collects the covariance requests
+   */
+  void covarianceRequestCallback(
+    const fuse_core::Transaction& transaction,
+    const fuse_core::Graph& graph,
+    std::vector<fuse_core::CovarianceBlocks::Request>& requests);
+
+  /**
+   * @brief Create the covariance requests needed for the state at the provided stamp
+   *
+   * @param[in] stamp The time stamp of the state
+   * @return The covariance requests, in the order expected by notifyCallback()
+   */
+  std::vector<fuse_core::CovarianceBlocks::Request> stateCovarianceRequests(const ros::Time& stamp) const;
+
+  /**
+   * @brief Compute the state covariance from the graph and store it in the latest output messages
+   *
+   * This is executed in the covariance worker thread. The result is discarded if a covariance for a newer stamp has
+   * already been stored.
+   *
+   * @param[in] graph               The graph snapshot used to publish the state at the provided stamp
+   * @param[in] stamp               The time stamp of the state
+   * @param[in] covariance_requests The covariance requests created by stateCovarianceRequests()
+   */
+  void computeStateCovarianceAsync(
+    const fuse_core::Graph& graph,
+    const ros::Time& stamp,
+    const std::vector<fuse_core::CovarianceBlocks::Request>& covariance_requests);
+
+  /**
+   * @brief Copy the state covariance blocks into the output messages
+   *
+   * @param[in]  covariance_matrices The covariance blocks, in the order of stateCovarianceRequests()
+   * @param[out] odometry            The pose and twist covariance are written into this message
+   * @param[out] acceleration        The acceleration covariance is written into this message
+   */
+  static void setStateCovariance(
+    const std::vector<std::vector<double>>& covariance_matrices,
+    nav_msgs::Odometry& odometry,
+    geometry_msgs::AccelWithCovarianceStamped& acceleration);
+
+  /**
+   * @brief Set the covariance of the output messages to zero
+   */
+  static void clearStateCovariance(
+    nav_msgs::Odometry& odometry,
+    geometry_msgs::AccelWithCovarianceStamped& acceleration);
 
   /**
    * @brief Perform any required operations before the first call to notify() occurs
@@ -163,6 +249,54 @@ protected:
     nav_msgs::Odometry& odometry,
     geometry_msgs::AccelWithCovarianceStamped& acceleration);
 
+  /**
+   * @brief Predict the state, and optionally its covariance, forward in time using the 2D unicycle model
+   *
+   * This is allocation-free, so it can be called for every IMU measurement from the high-rate publish timer.
+   *
+   * @param[in]    dt                 The time delta across which to predict the state
+   * @param[in]    predict_covariance Whether to predict the covariance as well
+   * @param[inout] state              The state, ordered as the fuse_models::predict() state vector
+   * @param[inout] covariance         The state covariance. Only used if predict_covariance is true.
+   */
+  void predictState(
+    const double dt,
+    const bool predict_covariance,
+    fuse_core::Vector8d& state,
+    fuse_core::Matrix8d& covariance) const;
+
+  /**
+   * @brief Predict the state, and optionally its covariance, from its stamp to the provided time
+   *
+   * If use_imu is set, the buffered IMU samples up to the state stamp are dropped, and the yaw velocity, and the
+   * linear acceleration if predict_with_acceleration is set, are replaced by each IMU sample between the state stamp
+   * and the provided time when the prediction reaches it. Otherwise, they are assumed to be constant.
+   *
+   * @param[in]    state_stamp        The stamp of the state
+   * @param[in]    time               The time to predict the state to
+   * @param[in]    predict_covariance Whether to predict the covariance as well
+   * @param[inout] state              The state, ordered as the fuse_models::predict() state vector
+   * @param[inout] covariance         The state covariance. Only used if predict_covariance is true.
+   */
+  void predictStateToTime(
+    const ros::Time& state_stamp,
+    const ros::Time& time,
+    const bool predict_covariance,
+    fuse_core::Vector8d& state,
+    fuse_core::Matrix8d& covariance);
+
+  /**
+   * @brief Callback for the IMU measurements used to predict the state to the current time
+   * @param[in] msg The IMU message
+   */
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  /**
+   * @brief Drop the buffered IMU samples up to and including the provided stamp
+   * @param[in] stamp The stamp of the newest sample to drop
+   */
+  void pruneImuSamples(const ros::Time& stamp);
+
   /**
    * @brief Timer callback method for the filtered state publication and tf broadcasting
    * @param[in] event The timer event parameters that are associated with the given invocation
@@ -194,6 +328,15 @@ protected:
 
   Synchronizer synchronizer_;  //!< Object that tracks the latest common timestamp of multiple variables
 
+  std::mutex covariance_request_mutex_;  //!< Guards covariance_synchronizer_ and covariance_request_stamp_, which
+                                        //!< are used in the optimizer's thread
+
+  Synchronizer covariance_synchronizer_;  //!< Object that tracks the latest common timestamp of multiple variables
+                                          //!< in the optimizer's thread, used for covariance requests
+
+  ros::Time covariance_request_stamp_;  //!< The stamp of the latest covariance request, used to throttle the
+                                        //!< requests in the optimizer's thread
+
   std::unique_ptr<tf2_ros::Buffer> tf_buffer_;
 
   ros::Publisher odom_pub_;
@@ -209,15 +352,38 @@ protected:
 
   ros::Timer publish_timer_;
 
+  /**
+   * @brief The subset of an IMU measurement used to predict the state
+   */
+  struct ImuSample
+  {
+    ros::Time stamp;  //!< The stamp of the measurement
+    double angular_velocity_z;  //!< The measured yaw velocity
+    double linear_acceleration_x;  //!< The measured linear acceleration along the x axis
+    double linear_acceleration_y;  //!< The measured linear acceleration along the y axis
+  };
+
+  ros::Subscriber imu_subscriber_;  //!< Subscribes to the IMU measurements, using the publish timer callback queue
+
+  std::deque<ImuSample> imu_samples_;  //!< The IMU measurements, sorted by stamp. Only accessed by the publish timer
+                                       //!< callback queue thread.
+
   ros::CallbackQueue publish_timer_callback_queue_;  //!< A dedicated callback queue for the publish timer
   ros::NodeHandle publish_timer_node_handle_;        //!< A dedicated node handle for the publish timer, so it can use
                                                      //!< its own callback queue
   ros::AsyncSpinner publish_timer_spinner_;          //!< A dedicated async spinner for the publish timer that manages
                                                      //!< its callback queue with a dedicated thread
 
-  std::mutex mutex_;  //!< A mutex to protect the access to the attributes used concurrently by the notifyCallback and
-                      //!< publishTimerCallback methods:
-                      //!< latest_stamp_, latest_covariance_stamp_, odom_output_ and acceleration_output_
+  std::mutex mutex_;  //!< A mutex to protect the access to the attributes used concurrently by the notifyCallback,
+                      //!< publishTimerCallback and computeStateCovarianceAsync methods:
+                      //!< latest_stamp_, latest_covariance_stamp_, latest_covariance_valid_, async_covariance_stamp_,
+                      //!< odom_output_ and acceleration_output_
+
+  ros::Time async_covariance_stamp_;  //!< The stamp of the latest covariance computed by the covariance worker
+
+  fuse_publishers::CovarianceWorker::UniquePtr covariance_worker_;  //!< Computes the covariance asynchronously, if
+                                                                    //!< enabled. Declared last so it is destroyed,
+                                                                    //!< and its thread joined, first.
 };
 
 }  // namespace fuse_models
@@ -78,6 +78,11 @@ public:
     nh.getParam("predict_with_acceleration", predict_with_acceleration);
     nh.getParam("publish_frequency", publish_frequency);
 
+    nh.getParam("use_imu", use_imu);
+    nh.getParam("imu_topic", imu_topic);
+    nh.getParam("imu_queue_size", imu_queue_size);
+    fuse_core::getPositiveParam(nh, "imu_buffer_length", imu_buffer_length, false);
+
     process_noise_covariance = fuse_core::getCovarianceDiagonalParam<8>(nh, "process_noise_diagonal", 0.0);
     nh.param("scale_process_noise", scale_process_noise, scale_process_noise);
     nh.param("velocity_norm_min", velocity_norm_min, velocity_norm_min);
@@ -116,6 +121,9 @@ public:
     nh.getParam("topic", topic);
     nh.getParam("acceleration_topic", acceleration_topic);
 
+    nh.getParam("shared_covariance", shared_covariance);
+    nh.getParam("async_covariance", async_covariance);
+
     fuse_core::loadCovarianceOptionsFromROS(ros::NodeHandle(nh, "covariance_options"), covariance_options);
   }
 
@@ -127,6 +135,10 @@ public:
   bool predict_to_current_time { false };
   bool predict_with_acceleration { false };
   double publish_frequency { 10.0 };
+  bool use_imu { false };  //!< Whether to use IMU measurements to predict the state to the current time
+  std::string imu_topic { "imu" };
+  int imu_queue_size { 10 };
+  ros::Duration imu_buffer_length { 1.0 };  //!< The maximum age of the buffered IMU measurements
   fuse_core::Matrix8d process_noise_covariance;   //!< Process noise covariance matrix
   bool scale_process_noise{ false };
   double velocity_norm_min{ 1e-3 };
@@ -142,7 +154,11 @@ public:
   std::string world_frame_id { odom_frame_id };
   std::string topic { "odometry/filtered" };
   std::string acceleration_topic { "acceleration/filtered" };
-  ceres::Covariance::Options covariance_options;
+  bool shared_covariance { false };  //!< Whether to request the covariance from the optimizer instead of computing
+                                    //!< it. The optimizer ignores covariance_options.
+  bool async_covariance { false };  //!< Whether to compute the covariance in a worker thread instead of the notify
+                                   //!< callback, when it is computed by the publisher
+  ceres::Covariance::Options covariance_options;  //!< Used when the covariance is computed by the publisher
 };
 
 }  // namespace parameters
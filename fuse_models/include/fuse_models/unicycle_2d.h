@@ -34,6 +34,8 @@
 #ifndef FUSE_MODELS_UNICYCLE_2D_H
 #define FUSE_MODELS_UNICYCLE_2D_H
 
+#include <fuse_models/common/stamped_ring_buffer.h>
+
 #include <fuse_core/async_motion_model.h>
 #include <fuse_core/constraint.h>
 #include <fuse_core/eigen.h>
@@ -45,7 +47,7 @@
 #include <ros/ros.h>
 #include <tf2_2d/tf2_2d.h>
 
-#include <map>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -103,6 +105,7 @@ protected:
     tf2_2d::Vector2 velocity_linear;      //!< Body-frame linear velocity
     double velocity_yaw{ 0.0 };           //!< Body-frame yaw velocity
     tf2_2d::Vector2 acceleration_linear;  //!< Body-frame linear acceleration
+    uint64_t generation{ 0 };             //!< The graph generation these estimates were last refreshed against
 
     void print(std::ostream& stream = std::cout) const;
 
@@ -113,7 +116,7 @@ protected:
      */
     void validate() const;
   };
-  using StateHistory = std::map<ros::Time, StateHistoryElement>;
+  using StateHistory = common::StampedRingBuffer<ros::Time, StateHistoryElement>;
 
   /**
    * @brief Augment a transaction structure such that the provided timestamps are connected by motion model constraints.
@@ -159,6 +162,46 @@ protected:
    */
   void onStart() override;
 
+  /**
+   * @brief Bring a single state in the state history up to date with the most recent graph
+   *
+   * States are refreshed lazily. A graph update only marks the whole history as stale; the states are refreshed
+   * from the graph when a motion model segment actually needs them. Walking backwards from the requested state, this
+   * stops at the first state that is already up to date, that can be read from the graph, or that is the oldest one,
+   * and predicts forward from there, marking every visited state as up to date.
+   *
+   * The result is the same as refreshing the whole history with updateStateHistoryEstimates() on every graph update,
+   * as long as the oldest state is refreshed on every graph update and the stale states after a new state are
+   * refreshed before it is inserted. onGraphUpdate() and generateMotionModel() take care of both.
+   *
+   * @param[in] position The position of the state in the state history
+   */
+  void refreshState(const size_t position);
+
+  /**
+   * @brief Update a state with the optimized values from the graph, if all of its variables exist in the graph
+   * @param[in]  graph The graph object containing updated variable values
+   * @param[out] state The state to be updated
+   * @return           True if the state was updated, false if any of its variables is missing from the graph
+   */
+  static bool updateStateFromGraph(const fuse_core::Graph& graph, StateHistoryElement& state);
+
+  /**
+   * @brief Count the states that pruneStateHistory() would remove from the state history
+   * @param[in] state_history The state history object to be pruned
+   * @param[in] buffer_length States older than this in the history will be pruned
+   * @return                  The number of states at the front of the history that have expired
+   */
+  static size_t expiredStateCount(const StateHistory& state_history, const ros::Duration& buffer_length);
+
+  /**
+   * @brief Remove states older than the buffer length from the state history, always keeping at least one state at or
+   * before the expiration time
+   * @param[in] state_history The state history object to be pruned
+   * @param[in] buffer_length States older than this in the history will be pruned
+   */
+  static void pruneStateHistory(StateHistory& state_history, const ros::Duration& buffer_length);
+
   /**
    * @brief Update all of the estimated states in the state history container using the optimized values from the graph
    * @param[in] graph         The graph object containing updated variable values
@@ -194,6 +237,8 @@ protected:
   bool disable_checks_{ false };  //!< Whether to disable the validation checks for the current and predicted state,
                                   //!< including the process noise covariance after it is scaled and multiplied by dt
   StateHistory state_history_;    //!< History of optimized graph pose estimates
+  fuse_core::Graph::ConstSharedPtr graph_;  //!< The most recent graph, used to refresh the state history on demand
+  uint64_t graph_generation_{ 0 };          //!< Incremented on every graph update; older states are stale
 };
 
 std::ostream& operator<<(std::ostream& stream, const Unicycle2D& unicycle_2d);
@@ -39,7 +39,6 @@
 #include <fuse_core/eigen.h>
 #include <tf2_2d/tf2_2d.h>
 
-#include <array>
 
 
 namespace fuse_models
@@ -232,6 +231,65 @@ inline void predict(
   }
 }
 
+/**
+ * @brief Given a state and time delta, predicts a new state and the Jacobian wrt the first state
+ *
+ * This is an allocation-free version of the predict functions above, intended for high-rate callers. The states are
+ * ordered as the rows and columns of the Jacobian: position x and y, yaw, linear velocity x and y, yaw velocity, and
+ * linear acceleration x and y. The sine and cosine of the yaw are computed once and shared by the state and Jacobian
+ * computations, and the Jacobian is written directly instead of being assembled from per-parameter-block matrices.
+ *
+ * @param[in] state1 - The first state
+ * @param[in] dt - The time delta across which to predict the state
+ * @param[out] state2 - The second state. It may be the same object as the first state.
+ * @param[out] jacobian - The jacobian wrt the first state
+ */
+inline void predict(
+  const fuse_core::Vector8d& state1,
+  const double dt,
+  fuse_core::Vector8d& state2,
+  fuse_core::Matrix8d& jacobian)
+{
+  // There are better models for this projection, but this matches the one used by r_l.
+  const double sy = ceres::sin(state1[2]);  // Should probably be sin((yaw1 + yaw2) / 2), but r_l uses this model
+  const double cy = ceres::cos(state1[2]);
+
+  const double half_dt2 = 0.5 * dt * dt;
+  const double delta_x = state1[3] * dt + state1[6] * half_dt2;
+  const double delta_y = state1[4] * dt + state1[7] * half_dt2;
+
+  const double delta_x_rot = cy * delta_x - sy * delta_y;
+  const double delta_y_rot = sy * delta_x + cy * delta_y;
+
+  double yaw2 = state1[2] + state1[5] * dt;
+  fuse_core::wrapAngle2D(yaw2);
+
+  // Each element only reads elements of the first state that have not been written yet, so the update can be done
+  // in place
+  state2[0] = state1[0] + delta_x_rot;
+  state2[1] = state1[1] + delta_y_rot;
+  state2[2] = yaw2;
+  state2[3] = state1[3] + state1[6] * dt;
+  state2[4] = state1[4] + state1[7] * dt;
+  state2[5] = state1[5];
+  state2[6] = state1[6];
+  state2[7] = state1[7];
+
+  const double cy_dt = cy * dt;
+  const double sy_dt = sy * dt;
+  const double cy_half_dt2 = cy * half_dt2;
+  const double sy_half_dt2 = sy * half_dt2;
+
+  jacobian << 1, 0, -delta_y_rot, cy_dt, -sy_dt,  0, cy_half_dt2, -sy_half_dt2,
+              0, 1,  delta_x_rot, sy_dt,  cy_dt,  0, sy_half_dt2,  cy_half_dt2,
+              0, 0,            1,     0,      0, dt,           0,            0,
+              0, 0,            0,     1,      0,  0,          dt,            0,
+              0, 0,            0,     0,      1,  0,           0,           dt,
+              0, 0,            0,     0,      0,  1,           0,            0,
+              0, 0,            0,     0,      0,  0,           1,            0,
+              0, 0,            0,     0,      0,  0,           0,            1;
+}
+
 /**
  * @brief Given a state and time delta, predicts a new state
  * @param[in] position1 - First position (array with x at index 0, y at index 1)
@@ -305,60 +363,20 @@ inline void predict(
   tf2_2d::Vector2& acc_linear2,
   fuse_core::Matrix8d& jacobian)
 {
-  double x_pred {};
-  double y_pred {};
-  double yaw_pred {};
-  double vel_linear_x_pred {};
-  double vel_linear_y_pred {};
-  double acc_linear_x_pred {};
-  double acc_linear_y_pred {};
-
-  // fuse_core::Matrix8d is Eigen::RowMajor, so we cannot use pointers to the columns where each parameter block starts.
-  // Instead, we need to create a vector of Eigen::RowMajor matrices per parameter block and later reconstruct the
-  // fuse_core::Matrix8d with the full jacobian.
-  // The parameter blocks have the following sizes: {position1: 2, yaw1: 1, vel_linear1: 2, vel_yaw1: 1, acc_linear1: 2}
-  static constexpr size_t num_residuals{ 8 };
-  static constexpr size_t num_parameter_blocks{ 5 };
-  static const std::array<size_t, num_parameter_blocks> block_sizes = {2, 1, 2, 1, 2};
-
-  std::array<fuse_core::MatrixXd, num_parameter_blocks> J;
-  std::array<double*, num_parameter_blocks> jacobians;
-
-  for (size_t i = 0; i < num_parameter_blocks; ++i)
-  {
-    J[i].resize(num_residuals, block_sizes[i]);
-    jacobians[i] = J[i].data();
-  }
-
-  predict(
-    pose1.x(),
-    pose1.y(),
-    pose1.yaw(),
-    vel_linear1.x(),
-    vel_linear1.y(),
-    vel_yaw1,
-    acc_linear1.x(),
-    acc_linear1.y(),
-    dt,
-    x_pred,
-    y_pred,
-    yaw_pred,
-    vel_linear_x_pred,
-    vel_linear_y_pred,
-    vel_yaw2,
-    acc_linear_x_pred,
-    acc_linear_y_pred,
-    jacobians.data());
-
-  jacobian << J[0], J[1], J[2], J[3], J[4];
-
-  pose2.setX(x_pred);
-  pose2.setY(y_pred);
-  pose2.setYaw(yaw_pred);
-  vel_linear2.setX(vel_linear_x_pred);
-  vel_linear2.setY(vel_linear_y_pred);
-  acc_linear2.setX(acc_linear_x_pred);
-  acc_linear2.setY(acc_linear_y_pred);
+  fuse_core::Vector8d state;
+  state << pose1.x(), pose1.y(), pose1.yaw(), vel_linear1.x(), vel_linear1.y(), vel_yaw1, acc_linear1.x(),
+           acc_linear1.y();
+
+  predict(state, dt, state, jacobian);
+
+  pose2.setX(state[0]);
+  pose2.setY(state[1]);
+  pose2.setYaw(state[2]);
+  vel_linear2.setX(state[3]);
+  vel_linear2.setY(state[4]);
+  vel_yaw2 = state[5];
+  acc_linear2.setX(state[6]);
+  acc_linear2.setY(state[7]);
 }
 
 /**
@@ -41,6 +41,7 @@
 
 #include <geometry_msgs/AccelWithCovarianceStamped.h>
 #include <nav_msgs/Odometry.h>
+#include <sensor_msgs/Imu.h>
 #include <pluginlib/class_list_macros.hpp>
 #include <tf2_2d/tf2_2d.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
@@ -48,6 +49,7 @@
 #include <tf2_ros/transform_listener.h>
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -65,6 +67,8 @@ Odometry2DPublisher::Odometry2DPublisher() :
   device_id_(fuse_core::uuid::NIL),
   latest_stamp_(Synchronizer::TIME_ZERO),
   latest_covariance_stamp_(Synchronizer::TIME_ZERO),
+  covariance_request_stamp_(Synchronizer::TIME_ZERO),
+  async_covariance_stamp_(Synchronizer::TIME_ZERO),
   publish_timer_spinner_(1, &publish_timer_callback_queue_)
 {
 }
@@ -95,12 +99,78 @@ void Odometry2DPublisher::onInit()
     false,
     false);
 
+  if (params_.use_imu)
+  {
+    // The IMU callbacks share the publish timer callback queue, which is serviced by a single thread, so the IMU
+    // samples can be accessed by the publish timer callback without locking
+    imu_subscriber_ = publish_timer_node_handle_.subscribe(
+      ros::names::resolve(params_.imu_topic), params_.imu_queue_size, &Odometry2DPublisher::imuCallback, this);
+  }
+
   publish_timer_spinner_.start();
+
+  if (params_.async_covariance)
+  {
+    covariance_worker_ = fuse_publishers::CovarianceWorker::make_unique();
+  }
+
+  if (params_.shared_covariance)
+  {
+    // Let the optimizer compute the state covariance along with the requests of the other publishers
+    registerCovarianceRequest(std::bind(&Odometry2DPublisher::covarianceRequestCallback, this, std::placeholders::_1,
+                                        std::placeholders::_2, std::placeholders::_3));
+  }
+}
+
+void Odometry2DPublisher::covarianceRequestCallback(
+  const fuse_core::Transaction& transaction,
+  const fuse_core::Graph& graph,
+  std::vector<fuse_core::CovarianceBlocks::Request>& requests)
+{
+  // onStart() resets the synchronizer and the request stamp in the publisher's thread
+  std::lock_guard<std::mutex> lock(covariance_request_mutex_);
+  // Keep the synchronizer up to date even when nobody is listening
+  const auto latest_stamp = covariance_synchronizer_.findLatestCommonStamp(transaction, graph);
+  if (latest_stamp == Synchronizer::TIME_ZERO ||
+      (odom_pub_.getNumSubscribers() == 0 && acceleration_pub_.getNumSubscribers() == 0))
+  {
+    return;
+  }
+  // Apply the same throttling as notifyCallback()
+  if (!params_.covariance_throttle_period.isZero() &&
+      latest_stamp - covariance_request_stamp_ <= params_.covariance_throttle_period)
+  {
+    return;
+  }
+  covariance_request_stamp_ = latest_stamp;
+  const auto state_requests = stateCovarianceRequests(latest_stamp);
+  requests.insert(requests.end(), state_requests.begin(), state_requests.end());
+}
+
+std::vector<fuse_core::CovarianceBlocks::Request> Odometry2DPublisher::stateCovarianceRequests(
+  const ros::Time& stamp) const
+{
+  const auto position_uuid = fuse_variables::Position2DStamped(stamp, device_id_).uuid();
+  const auto orientation_uuid = fuse_variables::Orientation2DStamped(stamp, device_id_).uuid();
+  const auto velocity_linear_uuid = fuse_variables::VelocityLinear2DStamped(stamp, device_id_).uuid();
+  const auto velocity_angular_uuid = fuse_variables::VelocityAngular2DStamped(stamp, device_id_).uuid();
+  const auto acceleration_linear_uuid = fuse_variables::AccelerationLinear2DStamped(stamp, device_id_).uuid();
+
+  std::vector<fuse_core::CovarianceBlocks::Request> covariance_requests;
+  covariance_requests.emplace_back(position_uuid, position_uuid);
+  covariance_requests.emplace_back(position_uuid, orientation_uuid);
+  covariance_requests.emplace_back(orientation_uuid, orientation_uuid);
+  covariance_requests.emplace_back(velocity_linear_uuid, velocity_linear_uuid);
+  covariance_requests.emplace_back(velocity_linear_uuid, velocity_angular_uuid);
+  covariance_requests.emplace_back(velocity_angular_uuid, velocity_angular_uuid);
+  covariance_requests.emplace_back(acceleration_linear_uuid, acceleration_linear_uuid);
+  return covariance_requests;
 }
 
 void Odometry2DPublisher::notifyCallback(
   fuse_core::Transaction::ConstSharedPtr transaction,
-  fuse_core::Graph::ConstSharedPtr graph)
+  fuse_core::Graph::ConstSharedPtr graph,
+  fuse_core::CovarianceBlocks::ConstSharedPtr covariance_blocks)
 {
   // Find the most recent common timestamp
   const auto latest_stamp = synchronizer_.findLatestCommonStamp(*transaction, *graph);
@@ -151,7 +221,8 @@ void Odometry2DPublisher::notifyCallback(
 
   // Don't waste CPU computing the covariance if nobody is listening
   ros::Time latest_covariance_stamp = latest_covariance_stamp_;
-  bool latest_covariance_valid = latest_covariance_valid_;
+  bool latest_covariance_valid = false;
+  bool reuse_covariance = false;
   if (odom_pub_.getNumSubscribers() > 0 || acceleration_pub_.getNumSubscribers() > 0)
   {
     // Throttle covariance computation
@@ -160,56 +231,41 @@ void Odometry2DPublisher::notifyCallback(
     {
       latest_covariance_stamp = latest_stamp;
 
-      try
-      {
-        std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>> covariance_requests;
-        covariance_requests.emplace_back(position_uuid, position_uuid);
-        covariance_requests.emplace_back(position_uuid, orientation_uuid);
-        covariance_requests.emplace_back(orientation_uuid, orientation_uuid);
-        covariance_requests.emplace_back(velocity_linear_uuid, velocity_linear_uuid);
-        covariance_requests.emplace_back(velocity_linear_uuid, velocity_angular_uuid);
-        covariance_requests.emplace_back(velocity_angular_uuid, velocity_angular_uuid);
-        covariance_requests.emplace_back(acceleration_linear_uuid, acceleration_linear_uuid);
-
-        std::vector<std::vector<double>> covariance_matrices;
-        graph->getCovariance(covariance_requests, covariance_matrices, params_.covariance_options);
-
-        odom_output.pose.covariance[0] = covariance_matrices[0][0];
-        odom_output.pose.covariance[1] = covariance_matrices[0][1];
-        odom_output.pose.covariance[5] = covariance_matrices[1][0];
-        odom_output.pose.covariance[6] = covariance_matrices[0][2];
-        odom_output.pose.covariance[7] = covariance_matrices[0][3];
-        odom_output.pose.covariance[11] = covariance_matrices[1][1];
-        odom_output.pose.covariance[30] = covariance_matrices[1][0];
-        odom_output.pose.covariance[31] = covariance_matrices[1][1];
-        odom_output.pose.covariance[35] = covariance_matrices[2][0];
-
-        odom_output.twist.covariance[0] = covariance_matrices[3][0];
-        odom_output.twist.covariance[1] = covariance_matrices[3][1];
-        odom_output.twist.covariance[5] = covariance_matrices[4][0];
-        odom_output.twist.covariance[6] = covariance_matrices[3][2];
-        odom_output.twist.covariance[7] = covariance_matrices[3][3];
-        odom_output.twist.covariance[11] = covariance_matrices[4][1];
-        odom_output.twist.covariance[30] = covariance_matrices[4][0];
-        odom_output.twist.covariance[31] = covariance_matrices[4][1];
-        odom_output.twist.covariance[35] = covariance_matrices[5][0];
-
-        acceleration_output.accel.covariance[0] = covariance_matrices[6][0];
-        acceleration_output.accel.covariance[1] = covariance_matrices[6][1];
-        acceleration_output.accel.covariance[6] = covariance_matrices[6][2];
-        acceleration_output.accel.covariance[7] = covariance_matrices[6][3];
+      const auto covariance_requests = stateCovarianceRequests(latest_stamp);
 
+      // Use the covariance computed by the optimizer, if available
+      std::vector<std::vector<double>> covariance_matrices;
+      if (covariance_blocks && covariance_blocks->get(covariance_requests, covariance_matrices))
+      {
+        setStateCovariance(covariance_matrices, odom_output, acceleration_output);
         latest_covariance_valid = true;
       }
-      catch (const std::exception& e)
+      else if (covariance_worker_)
       {
-        ROS_WARN_STREAM("An error occurred computing the covariance information for " << latest_stamp << ". "
-                        "The covariance will be set to zero.\n" << e.what());
-        std::fill(odom_output.pose.covariance.begin(), odom_output.pose.covariance.end(), 0.0);
-        std::fill(odom_output.twist.covariance.begin(), odom_output.twist.covariance.end(), 0.0);
-        std::fill(acceleration_output.accel.covariance.begin(), acceleration_output.accel.covariance.end(), 0.0);
-
-        latest_covariance_valid = false;
+        // Publish the state with the last covariance computed, and compute the new covariance against the same graph
+        // snapshot in the worker thread. A job still pending when the next state arrives is dropped.
+        reuse_covariance = true;
+        covariance_worker_->submit(
+          [this, graph, latest_stamp, covariance_requests]()
+          {
+            computeStateCovarianceAsync(*graph, latest_stamp, covariance_requests);
+          });  // NOLINT(whitespace/braces)
+      }
+      else
+      {
+        try
+        {
+          graph->getCovariance(covariance_requests, covariance_matrices, params_.covariance_options);
+          setStateCovariance(covariance_matrices, odom_output, acceleration_output);
+          latest_covariance_valid = true;
+        }
+        catch (const std::exception& e)
+        {
+          ROS_WARN_STREAM("An error occurred computing the covariance information for " << latest_stamp << ". "
+                          "The covariance will be set to zero.\n" << e.what());
+          clearStateCovariance(odom_output, acceleration_output);
+          latest_covariance_valid = false;
+        }
       }
     }
     else
@@ -218,26 +274,123 @@ void Odometry2DPublisher::notifyCallback(
       //
       // We do not propagate the latest covariance forward because it would grow unbounded being very different from
       // the actual covariance we would have computed if not throttling.
-      odom_output.pose.covariance = odom_output_.pose.covariance;
-      odom_output.twist.covariance = odom_output_.twist.covariance;
-      acceleration_output.accel.covariance = acceleration_output_.accel.covariance;
+      reuse_covariance = true;
     }
   }
 
   {
     std::lock_guard<std::mutex> lock(mutex_);
 
+    // The last covariance is copied while holding the lock, because it may be updated by the covariance worker
+    if (reuse_covariance)
+    {
+      odom_output.pose.covariance = odom_output_.pose.covariance;
+      odom_output.twist.covariance = odom_output_.twist.covariance;
+      acceleration_output.accel.covariance = acceleration_output_.accel.covariance;
+    }
+    else
+    {
+      latest_covariance_valid_ = latest_covariance_valid;
+    }
+
     latest_stamp_ = latest_stamp;
     latest_covariance_stamp_ = latest_covariance_stamp;
-    latest_covariance_valid_ = latest_covariance_valid;
     odom_output_ = odom_output;
     acceleration_output_ = acceleration_output;
   }
 }
 
+void Odometry2DPublisher::computeStateCovarianceAsync(
+  const fuse_core::Graph& graph,
+  const ros::Time& stamp,
+  const std::vector<fuse_core::CovarianceBlocks::Request>& covariance_requests)
+{
+  std::vector<std::vector<double>> covariance_matrices;
+  bool covariance_valid = true;
+  try
+  {
+    graph.getCovariance(covariance_requests, covariance_matrices, params_.covariance_options);
+  }
+  catch (const std::exception& e)
+  {
+    ROS_WARN_STREAM("An error occurred computing the covariance information for " << stamp << ". "
+                    "The covariance will be set to zero.\n" << e.what());
+    covariance_valid = false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Never replace a covariance with an older one. A covariance with the same stamp comes from a newer graph snapshot.
+  if (stamp < async_covariance_stamp_)
+  {
+    return;
+  }
+  async_covariance_stamp_ = stamp;
+  if (covariance_valid)
+  {
+    setStateCovariance(covariance_matrices, odom_output_, acceleration_output_);
+  }
+  else
+  {
+    clearStateCovariance(odom_output_, acceleration_output_);
+  }
+  latest_covariance_valid_ = covariance_valid;
+}
+
+void Odometry2DPublisher::setStateCovariance(
+  const std::vector<std::vector<double>>& covariance_matrices,
+  nav_msgs::Odometry& odometry,
+  geometry_msgs::AccelWithCovarianceStamped& acceleration)
+{
+  odometry.pose.covariance[0] = covariance_matrices[0][0];
+  odometry.pose.covariance[1] = covariance_matrices[0][1];
+  odometry.pose.covariance[5] = covariance_matrices[1][0];
+  odometry.pose.covariance[6] = covariance_matrices[0][2];
+  odometry.pose.covariance[7] = covariance_matrices[0][3];
+  odometry.pose.covariance[11] = covariance_matrices[1][1];
+  odometry.pose.covariance[30] = covariance_matrices[1][0];
+  odometry.pose.covariance[31] = covariance_matrices[1][1];
+  odometry.pose.covariance[35] = covariance_matrices[2][0];
+
+  odometry.twist.covariance[0] = covariance_matrices[3][0];
+  odometry.twist.covariance[1] = covariance_matrices[3][1];
+  odometry.twist.covariance[5] = covariance_matrices[4][0];
+  odometry.twist.covariance[6] = covariance_matrices[3][2];
+  odometry.twist.covariance[7] = covariance_matrices[3][3];
+  odometry.twist.covariance[11] = covariance_matrices[4][1];
+  odometry.twist.covariance[30] = covariance_matrices[4][0];
+  odometry.twist.covariance[31] = covariance_matrices[4][1];
+  odometry.twist.covariance[35] = covariance_matrices[5][0];
+
+  acceleration.accel.covariance[0] = covariance_matrices[6][0];
+  acceleration.accel.covariance[1] = covariance_matrices[6][1];
+  acceleration.accel.covariance[6] = covariance_matrices[6][2];
+  acceleration.accel.covariance[7] = covariance_matrices[6][3];
+}
+
+void Odometry2DPublisher::clearStateCovariance(
+  nav_msgs::Odometry& odometry,
+  geometry_msgs::AccelWithCovarianceStamped& acceleration)
+{
+  std::fill(odometry.pose.covariance.begin(), odometry.pose.covariance.end(), 0.0);
+  std::fill(odometry.twist.covariance.begin(), odometry.twist.covariance.end(), 0.0);
+  std::fill(acceleration.accel.covariance.begin(), acceleration.accel.covariance.end(), 0.0);
+}
+
 void Odometry2DPublisher::onStart()
 {
+  // Drop any covariance computed before the restart
+  if (covariance_worker_)
+  {
+    covariance_worker_->cancel();
+  }
+  async_covariance_stamp_ = Synchronizer::TIME_ZERO;
   synchronizer_ = Synchronizer(device_id_);
+  {
+    std::lock_guard<std::mutex> lock(covariance_request_mutex_);
+    covariance_synchronizer_ = Synchronizer(device_id_);
+    covariance_request_stamp_ = Synchronizer::TIME_ZERO;
+  }
   latest_stamp_ = latest_covariance_stamp_ = Synchronizer::TIME_ZERO;
   latest_covariance_valid_ = false;
   odom_output_ = nav_msgs::Odometry();
@@ -249,6 +402,10 @@ void Odometry2DPublisher::onStart()
 void Odometry2DPublisher::onStop()
 {
   publish_timer_.stop();
+  if (covariance_worker_)
+  {
+    covariance_worker_->cancel();
+  }
 }
 
 bool Odometry2DPublisher::getState(
@@ -317,6 +474,93 @@ bool Odometry2DPublisher::getState(
   return true;
 }
 
+void Odometry2DPublisher::predictState(
+  const double dt,
+  const bool predict_covariance,
+  fuse_core::Vector8d& state,
+  fuse_core::Matrix8d& covariance) const
+{
+  fuse_core::Matrix8d jacobian;
+  predict(state, dt, state, jacobian);
+
+  if (!predict_covariance)
+  {
+    return;
+  }
+
+  fuse_core::Matrix8d predicted_covariance;
+  predicted_covariance.noalias() = jacobian * covariance * jacobian.transpose();
+  covariance = predicted_covariance;
+
+  if (params_.scale_process_noise)
+  {
+    auto process_noise_covariance = params_.process_noise_covariance;
+    common::scaleProcessNoiseCovariance(process_noise_covariance, tf2_2d::Vector2(state[3], state[4]), state[5],
+                                        params_.velocity_norm_min);
+    covariance.noalias() += dt * process_noise_covariance;
+  }
+  else
+  {
+    covariance.noalias() += dt * params_.process_noise_covariance;
+  }
+}
+
+void Odometry2DPublisher::predictStateToTime(
+  const ros::Time& state_stamp,
+  const ros::Time& time,
+  const bool predict_covariance,
+  fuse_core::Vector8d& state,
+  fuse_core::Matrix8d& covariance)
+{
+  // Use the IMU measurements received after the optimized state, if any, then predict the rest of the way
+  ros::Time stamp = state_stamp;
+  if (params_.use_imu)
+  {
+    pruneImuSamples(stamp);
+    for (const auto& imu_sample : imu_samples_)
+    {
+      if (imu_sample.stamp >= time)
+      {
+        break;
+      }
+      predictState((imu_sample.stamp - stamp).toSec(), predict_covariance, state, covariance);
+      stamp = imu_sample.stamp;
+      state[5] = imu_sample.angular_velocity_z;
+      if (params_.predict_with_acceleration)
+      {
+        state[6] = imu_sample.linear_acceleration_x;
+        state[7] = imu_sample.linear_acceleration_y;
+      }
+    }
+  }
+  predictState((time - stamp).toSec(), predict_covariance, state, covariance);
+}
+
+void Odometry2DPublisher::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  // Drop out-of-order measurements, so the samples remain sorted by stamp
+  if (!imu_samples_.empty() && msg->header.stamp <= imu_samples_.back().stamp)
+  {
+    return;
+  }
+  ImuSample imu_sample;
+  imu_sample.stamp = msg->header.stamp;
+  imu_sample.angular_velocity_z = msg->angular_velocity.z;
+  imu_sample.linear_acceleration_x = msg->linear_acceleration.x;
+  imu_sample.linear_acceleration_y = msg->linear_acceleration.y;
+  imu_samples_.push_back(imu_sample);
+  // Bound the buffer, in case the optimizer stops producing new states
+  pruneImuSamples(imu_sample.stamp - params_.imu_buffer_length);
+}
+
+void Odometry2DPublisher::pruneImuSamples(const ros::Time& stamp)
+{
+  while (!imu_samples_.empty() && imu_samples_.front().stamp <= stamp)
+  {
+    imu_samples_.pop_front();
+  }
+}
+
 void Odometry2DPublisher::publishTimerCallback(const ros::TimerEvent& event)
 {
   ros::Time latest_stamp;
@@ -346,55 +590,25 @@ void Odometry2DPublisher::publishTimerCallback(const ros::TimerEvent& event)
   // If requested, we need to project our state forward in time using the 2D kinematic model
   if (params_.predict_to_current_time)
   {
-    tf2_2d::Vector2 velocity_linear;
-    tf2::fromMsg(odom_output.twist.twist.linear, velocity_linear);
-
-    const double dt = event.current_real.toSec() - odom_output.header.stamp.toSec();
-
-    fuse_core::Matrix8d jacobian;
-
-    tf2_2d::Vector2 acceleration_linear;
-    if (params_.predict_with_acceleration)
-    {
-      tf2::fromMsg(acceleration_output.accel.accel.linear, acceleration_linear);
-    }
-
-    double yaw_vel;
-
-    predict(
-      pose,
-      velocity_linear,
-      odom_output.twist.twist.angular.z,
-      acceleration_linear,
-      dt,
-      pose,
-      velocity_linear,
-      yaw_vel,
-      acceleration_linear,
-      jacobian);
-
-    odom_output.pose.pose.position.x = pose.getX();
-    odom_output.pose.pose.position.y = pose.getY();
-    odom_output.pose.pose.orientation = tf2::toMsg(pose.getRotation());
-
-    odom_output.twist.twist.linear.x = velocity_linear.x();
-    odom_output.twist.twist.linear.y = velocity_linear.y();
-    odom_output.twist.twist.angular.z = yaw_vel;
-
+    fuse_core::Vector8d state;
+    state << pose.x(), pose.y(), pose.yaw(),
+             odom_output.twist.twist.linear.x, odom_output.twist.twist.linear.y, odom_output.twist.twist.angular.z,
+             0.0, 0.0;
     if (params_.predict_with_acceleration)
     {
-      acceleration_output.accel.accel.linear.x = acceleration_linear.x();
-      acceleration_output.accel.accel.linear.y = acceleration_linear.y();
+      state[6] = acceleration_output.accel.accel.linear.x;
+      state[7] = acceleration_output.accel.accel.linear.y;
     }
 
-    odom_output.header.stamp = event.current_real;
-    acceleration_output.header.stamp = event.current_real;
-
     // Either the last covariance computation was skipped because there was no subscriber,
     // or it failed
+    fuse_core::Matrix8d covariance;
     if (latest_covariance_valid)
     {
-      fuse_core::Matrix8d covariance;
+      // TODO(efernandez) for now we set to zero the out-of-diagonal blocks with the correlations between pose, twist
+      // and acceleration, but we could cache them in another attribute when we retrieve the covariance from the ceres
+      // problem
+      covariance.setZero();
       covariance(0, 0) = odom_output.pose.covariance[0];
       covariance(0, 1) = odom_output.pose.covariance[1];
       covariance(0, 2) = odom_output.pose.covariance[5];
@@ -419,26 +633,33 @@ void Odometry2DPublisher::publishTimerCallback(const ros::TimerEvent& event)
       covariance(6, 7) = acceleration_output.accel.covariance[1];
       covariance(7, 6) = acceleration_output.accel.covariance[6];
       covariance(7, 7) = acceleration_output.accel.covariance[7];
+    }
 
-      // TODO(efernandez) for now we set to zero the out-of-diagonal blocks with the correlations between pose, twist
-      // and acceleration, but we could cache them in another attribute when we retrieve the covariance from the ceres
-      // problem
-      covariance.topRightCorner<3, 5>().setZero();
-      covariance.bottomLeftCorner<5, 3>().setZero();
-      covariance.block<3, 2>(3, 6).setZero();
-      covariance.block<2, 3>(6, 3).setZero();
+    predictStateToTime(odom_output.header.stamp, event.current_real, latest_covariance_valid, state, covariance);
 
-      covariance = jacobian * covariance * jacobian.transpose();
+    pose.setX(state[0]);
+    pose.setY(state[1]);
+    pose.setYaw(state[2]);
 
-      auto process_noise_covariance = params_.process_noise_covariance;
-      if (params_.scale_process_noise)
-      {
-        common::scaleProcessNoiseCovariance(process_noise_covariance, velocity_linear,
-                                            odom_output.twist.twist.angular.z, params_.velocity_norm_min);
-      }
+    odom_output.pose.pose.position.x = state[0];
+    odom_output.pose.pose.position.y = state[1];
+    odom_output.pose.pose.orientation = tf2::toMsg(pose.getRotation());
 
-      covariance.noalias() += dt * process_noise_covariance;
+    odom_output.twist.twist.linear.x = state[3];
+    odom_output.twist.twist.linear.y = state[4];
+    odom_output.twist.twist.angular.z = state[5];
 
+    if (params_.predict_with_acceleration)
+    {
+      acceleration_output.accel.accel.linear.x = state[6];
+      acceleration_output.accel.accel.linear.y = state[7];
+    }
+
+    odom_output.header.stamp = event.current_real;
+    acceleration_output.header.stamp = event.current_real;
+
+    if (latest_covariance_valid)
+    {
       odom_output.pose.covariance[0] = covariance(0, 0);
       odom_output.pose.covariance[1] = covariance(0, 1);
       odom_output.pose.covariance[5] = covariance(0, 2);
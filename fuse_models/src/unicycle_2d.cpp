@@ -126,8 +126,9 @@ Unicycle2D::Unicycle2D() :
 void Unicycle2D::print(std::ostream& stream) const
 {
   stream << "state history:\n";
-  for (const auto& state : state_history_)
+  for (size_t i = 0; i < state_history_.size(); ++i)
   {
+    const auto& state = state_history_[i];
     stream << "- stamp: " << state.first << "\n";
     state.second.print(stream);
   }
@@ -188,7 +189,24 @@ bool Unicycle2D::applyCallback(fuse_core::Transaction& transaction)
 
 void Unicycle2D::onGraphUpdate(fuse_core::Graph::ConstSharedPtr graph)
 {
-  updateStateHistoryEstimates(*graph, state_history_, buffer_length_);
+  // Only record the new graph here. The states are refreshed from it when they are next used, so the cost of a graph
+  // update does not grow with the length of the state history.
+  //
+  // The oldest state is never predicted, so it keeps the value of the last graph it was refreshed against. Bring the
+  // state that becomes the oldest after pruning up to date with the previous graph, and refresh the oldest state
+  // against every new graph.
+  const auto expired_count = expiredStateCount(state_history_, buffer_length_);
+  if (expired_count > 0)
+  {
+    refreshState(expired_count);
+    state_history_.popFront(expired_count);
+  }
+  graph_ = std::move(graph);
+  ++graph_generation_;
+  if (!state_history_.empty())
+  {
+    refreshState(0);
+  }
 }
 
 void Unicycle2D::onInit()
@@ -226,6 +244,8 @@ void Unicycle2D::onStart()
 {
   timestamp_manager_.clear();
   state_history_.clear();
+  graph_.reset();
+  graph_generation_ = 0;
 }
 
 void Unicycle2D::generateMotionModel(
@@ -241,8 +261,8 @@ void Unicycle2D::generateMotionModel(
 
   // Find an entry that is > beginning_stamp
   // The entry that is <= will be the one before it
-  auto base_state_pair_it = state_history_.upper_bound(beginning_stamp);
-  if (base_state_pair_it == state_history_.begin())
+  const auto base_state_position = state_history_.upperBound(beginning_stamp);
+  if (base_state_position == 0)
   {
     ROS_WARN_STREAM_COND_NAMED(!state_history_.empty(), "UnicycleModel", "Unable to locate a state in this history "
                                "with stamp <= " << beginning_stamp << ". Variables will all be initialized to 0.");
@@ -250,12 +270,24 @@ void Unicycle2D::generateMotionModel(
   }
   else
   {
-    --base_state_pair_it;
-    base_time = base_state_pair_it->first;
-    base_state = base_state_pair_it->second;
+    refreshState(base_state_position - 1);
+    const auto& base_state_pair = state_history_[base_state_position - 1];
+    base_time = base_state_pair.first;
+    base_state = base_state_pair.second;
+  }
+
+  // The states after a new state are predicted from it once they are refreshed. Refresh the stale ones before a state
+  // is inserted in front of them, so they keep the values they had since the last graph update.
+  if (!state_history_.empty() && (beginning_stamp < state_history_.back().first))
+  {
+    for (size_t i = base_state_position; i < state_history_.size(); ++i)
+    {
+      refreshState(i);
+    }
   }
 
   StateHistoryElement state1;
+  state1.generation = graph_generation_;
 
   // If the nearest state we had was before the beginning stamp, we need to project that state to the beginning stamp
   if (base_time != beginning_stamp)
@@ -294,6 +326,7 @@ void Unicycle2D::generateMotionModel(
 
   // Now predict to get an initial guess for the state at the ending stamp
   StateHistoryElement state2;
+  state2.generation = graph_generation_;
   predict(
     state1.pose,
     state1.velocity_linear,
@@ -401,18 +434,83 @@ void Unicycle2D::generateMotionModel(
   variables.push_back(acceleration_linear2);
 }
 
-void Unicycle2D::updateStateHistoryEstimates(
-  const fuse_core::Graph& graph,
-  StateHistory& state_history,
-  const ros::Duration& buffer_length)
+void Unicycle2D::refreshState(const size_t position)
+{
+  // Walk back to a state that does not need a prediction: one that is already up to date, one that can be read
+  // directly from the graph, or the oldest state in the history
+  size_t first = position;
+  while (true)
+  {
+    auto& state = state_history_[first].second;
+    if (state.generation == graph_generation_)
+    {
+      break;
+    }
+    state.generation = graph_generation_;
+    if ((graph_ && updateStateFromGraph(*graph_, state)) || (first == 0))
+    {
+      break;
+    }
+    --first;
+  }
+
+  // None of the later states are in the graph yet, so we can't update/correct their values directly. However, the
+  // state *before* each of them may have been corrected (or one of its predecessors may have been), so we can use
+  // that corrected value, along with our prediction logic, to provide a more accurate update to each state.
+  for (size_t i = first + 1; i <= position; ++i)
+  {
+    const auto& previous = state_history_[i - 1];
+    auto& current = state_history_[i];
+    predict(
+      previous.second.pose,
+      previous.second.velocity_linear,
+      previous.second.velocity_yaw,
+      previous.second.acceleration_linear,
+      (current.first - previous.first).toSec(),
+      current.second.pose,
+      current.second.velocity_linear,
+      current.second.velocity_yaw,
+      current.second.acceleration_linear);
+  }
+}
+
+bool Unicycle2D::updateStateFromGraph(const fuse_core::Graph& graph, StateHistoryElement& state)
+{
+  if (!graph.variableExists(state.position_uuid) ||
+      !graph.variableExists(state.yaw_uuid) ||
+      !graph.variableExists(state.vel_linear_uuid) ||
+      !graph.variableExists(state.vel_yaw_uuid) ||
+      !graph.variableExists(state.acc_linear_uuid))
+  {
+    return false;
+  }
+
+  const auto& position = graph.getVariable(state.position_uuid);
+  const auto& yaw = graph.getVariable(state.yaw_uuid);
+  const auto& vel_linear = graph.getVariable(state.vel_linear_uuid);
+  const auto& vel_yaw = graph.getVariable(state.vel_yaw_uuid);
+  const auto& acc_linear = graph.getVariable(state.acc_linear_uuid);
+
+  state.pose.setX(position.data()[fuse_variables::Position2DStamped::X]);
+  state.pose.setY(position.data()[fuse_variables::Position2DStamped::Y]);
+  state.pose.setAngle(yaw.data()[fuse_variables::Orientation2DStamped::YAW]);
+  state.velocity_linear.setX(vel_linear.data()[fuse_variables::VelocityLinear2DStamped::X]);
+  state.velocity_linear.setY(vel_linear.data()[fuse_variables::VelocityLinear2DStamped::Y]);
+  state.velocity_yaw = vel_yaw.data()[fuse_variables::VelocityAngular2DStamped::YAW];
+  state.acceleration_linear.setX(acc_linear.data()[fuse_variables::AccelerationLinear2DStamped::X]);
+  state.acceleration_linear.setY(acc_linear.data()[fuse_variables::AccelerationLinear2DStamped::Y]);
+  return true;
+}
+
+size_t Unicycle2D::expiredStateCount(const StateHistory& state_history, const ros::Duration& buffer_length)
 {
   if (state_history.empty())
   {
-    return;
+    return 0;
   }
 
   // Compute the expiration time carefully, as ROS can't handle negative times
-  const auto& ending_stamp = state_history.rbegin()->first;
+  const auto& ending_stamp = state_history.back().first;
   auto expiration_time =
       ending_stamp.toSec() > buffer_length.toSec() ? ending_stamp - buffer_length : ros::Time(0, 0);
 
@@ -420,61 +518,50 @@ void Unicycle2D::updateStateHistoryEstimates(
   // Be careful to ensure that:
   //  - at least one entry remains at all times
   //  - the history covers *at least* until the expiration time. Longer is acceptable.
-  auto expiration_iter = state_history.upper_bound(expiration_time);
-  if (expiration_iter != state_history.begin())
+  const auto expiration_position = state_history.upperBound(expiration_time);
+  if (expiration_position > 1)
   {
-    // expiration_iter points to the first element > expiration_time.
+    // expiration_position is the first element > expiration_time.
     // Back up one entry, to a point that is <= expiration_time
-    state_history.erase(state_history.begin(), std::prev(expiration_iter));
+    return expiration_position - 1;
   }
+  return 0;
+}
+
+void Unicycle2D::pruneStateHistory(StateHistory& state_history, const ros::Duration& buffer_length)
+{
+  const auto expired_count = expiredStateCount(state_history, buffer_length);
+  if (expired_count > 0)
+  {
+    state_history.popFront(expired_count);
+  }
+}
+
+void Unicycle2D::updateStateHistoryEstimates(
+  const fuse_core::Graph& graph,
+  StateHistory& state_history,
+  const ros::Duration& buffer_length)
+{
+  pruneStateHistory(state_history, buffer_length);
 
   // Update the states in the state history with information from the graph
   // If a state is not in the graph yet, predict the state in question from the closest previous state
-  for (auto current_iter = state_history.begin(); current_iter != state_history.end(); ++current_iter)
-  {
-    const auto& current_stamp = current_iter->first;
-    auto& current_state = current_iter->second;
-    if (graph.variableExists(current_state.position_uuid) &&
-        graph.variableExists(current_state.yaw_uuid) &&
-        graph.variableExists(current_state.vel_linear_uuid) &&
-        graph.variableExists(current_state.vel_yaw_uuid) &&
-        graph.variableExists(current_state.acc_linear_uuid))
-    {
-      // This pose does exist in the graph. Update it directly.
-      const auto& position = graph.getVariable(current_state.position_uuid);
-      const auto& yaw = graph.getVariable(current_state.yaw_uuid);
-      const auto& vel_linear = graph.getVariable(current_state.vel_linear_uuid);
-      const auto& vel_yaw = graph.getVariable(current_state.vel_yaw_uuid);
-      const auto& acc_linear = graph.getVariable(current_state.acc_linear_uuid);
-
-      current_state.pose.setX(position.data()[fuse_variables::Position2DStamped::X]);
-      current_state.pose.setY(position.data()[fuse_variables::Position2DStamped::Y]);
-      current_state.pose.setAngle(yaw.data()[fuse_variables::Orientation2DStamped::YAW]);
-      current_state.velocity_linear.setX(vel_linear.data()[fuse_variables::VelocityLinear2DStamped::X]);
-      current_state.velocity_linear.setY(vel_linear.data()[fuse_variables::VelocityLinear2DStamped::Y]);
-      current_state.velocity_yaw = vel_yaw.data()[fuse_variables::VelocityAngular2DStamped::YAW];
-      current_state.acceleration_linear.setX(acc_linear.data()[fuse_variables::AccelerationLinear2DStamped::X]);
-      current_state.acceleration_linear.setY(acc_linear.data()[fuse_variables::AccelerationLinear2DStamped::Y]);
-    }
-    else if (current_iter != state_history.begin())
+  for (size_t i = 0; i < state_history.size(); ++i)
+  {
+    auto& current = state_history[i];
+    if (!updateStateFromGraph(graph, current.second) && (i > 0))
     {
-      auto previous_iter = std::prev(current_iter);
-      const auto& previous_stamp = previous_iter->first;
-      const auto& previous_state = previous_iter->second;
-
-      // This state is not in the graph yet, so we can't update/correct the value in our state history. However, the
-      // state *before* this one may have been corrected (or one of its predecessors may have been), so we can use
-      // that corrected value, along with our prediction logic, to provide a more accurate update to this state.
+      const auto& previous = state_history[i - 1];
       predict(
-        previous_state.pose,
-        previous_state.velocity_linear,
-        previous_state.velocity_yaw,
-        previous_state.acceleration_linear,
-        (current_stamp - previous_stamp).toSec(),
-        current_state.pose,
-        current_state.velocity_linear,
-        current_state.velocity_yaw,
-        current_state.acceleration_linear);
+        previous.second.pose,
+        previous.second.velocity_linear,
+        previous.second.velocity_yaw,
+        previous.second.acceleration_linear,
+        (current.first - previous.first).toSec(),
+        current.second.pose,
+        current.second.velocity_linear,
+        current.second.velocity_yaw,
+        current.second.acceleration_linear);
     }
   }
 }
@@ -0,0 +1,220 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/eigen.h>
+#include <fuse_models/odometry_2d_publisher.h>
+#include <ros/ros.h>
+#include <sensor_msgs/Imu.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+
+#include <cmath>
+
+
+/**
+ * @brief Odometry2DPublisher with the IMU prediction exposed for testing
+ */
+class Odometry2DPublisherTest : public fuse_models::Odometry2DPublisher
+{
+public:
+  Odometry2DPublisherTest()
+  {
+    params_.predict_with_acceleration = true;
+    params_.use_imu = true;
+    params_.imu_buffer_length = ros::Duration(10.0);
+    params_.process_noise_covariance.setZero();
+  }
+
+  ParameterType& params() { return params_; }
+
+  size_t imuSampleCount() const { return imu_samples_.size(); }
+
+  void addImuSample(
+    const double stamp,
+    const double angular_velocity_z,
+    const double linear_acceleration_x = 0.0,
+    const double linear_acceleration_y = 0.0)
+  {
+    auto msg = boost::make_shared<sensor_msgs::Imu>();
+    msg->header.stamp = ros::Time(stamp);
+    msg->angular_velocity.z = angular_velocity_z;
+    msg->linear_acceleration.x = linear_acceleration_x;
+    msg->linear_acceleration.y = linear_acceleration_y;
+    imuCallback(msg);
+  }
+
+  /**
+   * @brief Predict the state from the provided stamp to the provided time, without its covariance
+   */
+  fuse_core::Vector8d predict(const double state_stamp, const double time, const fuse_core::Vector8d& state)
+  {
+    auto predicted_state = state;
+    fuse_core::Matrix8d covariance = fuse_core::Matrix8d::Zero();
+    predictStateToTime(ros::Time(state_stamp), ros::Time(time), false, predicted_state, covariance);
+    return predicted_state;
+  }
+};
+
+/**
+ * @brief Create a state vector, ordered as the fuse_models::predict() state vector
+ */
+fuse_core::Vector8d makeState(
+  const double x,
+  const double y,
+  const double yaw,
+  const double vel_linear_x,
+  const double vel_yaw,
+  const double acc_linear_x)
+{
+  fuse_core::Vector8d state;
+  state << x, y, yaw, vel_linear_x, 0.0, vel_yaw, acc_linear_x, 0.0;
+  return state;
+}
+
+TEST(Odometry2DPublisher, ImuIntegration)
+{
+  Odometry2DPublisherTest publisher;
+  publisher.addImuSample(10.5, 0.2, 0.4);
+  publisher.addImuSample(11.0, -0.1);
+  // Measured after the prediction time, so it must be ignored
+  publisher.addImuSample(12.0, 5.0, 5.0);
+
+  const auto state = publisher.predict(10.0, 11.5, makeState(0.0, 0.0, 0.0, 1.0, 0.0, 0.0));
+
+  // [10.0, 10.5]: the optimized state velocity, 1m/s straight ahead
+  // [10.5, 11.0]: the first IMU sample, turning at 0.2rad/s and accelerating at 0.4m/s^2
+  // [11.0, 11.5]: the second IMU sample, turning back at 0.1rad/s, at the constant 1.2m/s reached
+  const auto x = 0.5 + (0.5 + 0.5 * 0.4 * 0.25) + 1.2 * 0.5 * std::cos(0.1);
+  const auto y = 1.2 * 0.5 * std::sin(0.1);
+  EXPECT_NEAR(x, state[0], 1.0e-9);
+  EXPECT_NEAR(y, state[1], 1.0e-9);
+  EXPECT_NEAR(0.05, state[2], 1.0e-9);
+  EXPECT_NEAR(1.2, state[3], 1.0e-9);
+  EXPECT_NEAR(0.0, state[4], 1.0e-9);
+  EXPECT_NEAR(-0.1, state[5], 1.0e-9);
+  EXPECT_NEAR(0.0, state[6], 1.0e-9);
+  EXPECT_NEAR(0.0, state[7], 1.0e-9);
+
+  // The samples after the state stamp are kept for the next prediction
+  EXPECT_EQ(3u, publisher.imuSampleCount());
+}
+
+TEST(Odometry2DPublisher, ImuIntegrationWithoutAcceleration)
+{
+  Odometry2DPublisherTest publisher;
+  publisher.params().predict_with_acceleration = false;
+  publisher.addImuSample(10.5, 0.2, 0.4);
+
+  const auto state = publisher.predict(10.0, 11.0, makeState(0.0, 0.0, 0.0, 1.0, 0.0, 0.0));
+
+  // Only the yaw velocity of the IMU is used
+  EXPECT_NEAR(1.0, state[0], 1.0e-9);
+  EXPECT_NEAR(0.0, state[1], 1.0e-9);
+  EXPECT_NEAR(0.1, state[2], 1.0e-9);
+  EXPECT_NEAR(1.0, state[3], 1.0e-9);
+  EXPECT_NEAR(0.2, state[5], 1.0e-9);
+  EXPECT_NEAR(0.0, state[6], 1.0e-9);
+}
+
+TEST(Odometry2DPublisher, ImuPruning)
+{
+  Odometry2DPublisherTest publisher;
+  publisher.addImuSample(9.5, 1.0, 10.0);
+  publisher.addImuSample(10.0, 2.0, 10.0);
+  publisher.addImuSample(10.5, 0.2);
+  ASSERT_EQ(3u, publisher.imuSampleCount());
+
+  const auto state = publisher.predict(10.0, 11.0, makeState(0.0, 0.0, 0.0, 1.0, 0.0, 0.0));
+
+  // The samples up to the optimized stamp are dropped, and do not affect the prediction
+  EXPECT_EQ(1u, publisher.imuSampleCount());
+  EXPECT_NEAR(1.0, state[0], 1.0e-9);
+  EXPECT_NEAR(0.0, state[1], 1.0e-9);
+  EXPECT_NEAR(0.1, state[2], 1.0e-9);
+  EXPECT_NEAR(1.0, state[3], 1.0e-9);
+  EXPECT_NEAR(0.2, state[5], 1.0e-9);
+  EXPECT_NEAR(0.0, state[6], 1.0e-9);
+
+  // A newer optimized state drops the rest
+  publisher.predict(10.5, 11.0, state);
+  EXPECT_EQ(0u, publisher.imuSampleCount());
+}
+
+TEST(Odometry2DPublisher, ImuBuffer)
+{
+  Odometry2DPublisherTest publisher;
+  publisher.params().imu_buffer_length = ros::Duration(1.0);
+  publisher.addImuSample(10.0, 0.1);
+  publisher.addImuSample(10.5, 0.2);
+  EXPECT_EQ(2u, publisher.imuSampleCount());
+
+  // Out-of-order and duplicated samples are dropped
+  publisher.addImuSample(10.2, 0.3);
+  publisher.addImuSample(10.5, 0.3);
+  EXPECT_EQ(2u, publisher.imuSampleCount());
+
+  // Samples older than the buffer length relative to the newest one are dropped
+  publisher.addImuSample(11.2, 0.4);
+  EXPECT_EQ(2u, publisher.imuSampleCount());
+}
+
+TEST(Odometry2DPublisher, NoImuSamples)
+{
+  // Without any IMU sample, the velocity and acceleration of the optimized state are assumed to be constant
+  Odometry2DPublisherTest publisher;
+  const auto state = publisher.predict(10.0, 11.0, makeState(1.0, 2.0, 0.0, 1.0, 0.1, 0.2));
+
+  EXPECT_NEAR(1.0 + 1.0 + 0.5 * 0.2, state[0], 1.0e-9);
+  EXPECT_NEAR(2.0, state[1], 1.0e-9);
+  EXPECT_NEAR(0.1, state[2], 1.0e-9);
+  EXPECT_NEAR(1.2, state[3], 1.0e-9);
+  EXPECT_NEAR(0.1, state[5], 1.0e-9);
+  EXPECT_NEAR(0.2, state[6], 1.0e-9);
+
+  // Same if the IMU is disabled, even with buffered samples
+  publisher.params().use_imu = false;
+  publisher.addImuSample(10.5, 5.0, 5.0);
+  const auto imu_disabled_state = publisher.predict(10.0, 11.0, makeState(1.0, 2.0, 0.0, 1.0, 0.1, 0.2));
+  EXPECT_TRUE(state.isApprox(imu_disabled_state, 1.0e-12));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "odometry_2d_publisher_test");
+  int ret = RUN_ALL_TESTS();
+  ros::shutdown();
+  return ret;
+}
@@ -0,0 +1,150 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_models/common/stamped_ring_buffer.h>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <stdexcept>
+
+using fuse_models::common::StampedRingBuffer;
+
+TEST(StampedRingBuffer, AppendAndAccess)
+{
+  StampedRingBuffer<int, double> buffer(2);
+  EXPECT_TRUE(buffer.empty());
+
+  for (int i = 0; i < 10; ++i)
+  {
+    const auto result = buffer.emplace(i, 0.5 * i);
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(static_cast<size_t>(i), result.first);
+  }
+
+  ASSERT_EQ(10u, buffer.size());
+  EXPECT_EQ(0, buffer.front().first);
+  EXPECT_EQ(9, buffer.back().first);
+  for (size_t i = 0; i < buffer.size(); ++i)
+  {
+    EXPECT_EQ(static_cast<int>(i), buffer[i].first);
+    EXPECT_DOUBLE_EQ(0.5 * i, buffer[i].second);
+  }
+  EXPECT_DOUBLE_EQ(2.0, buffer.at(4));
+  EXPECT_THROW(buffer.at(10), std::out_of_range);
+}
+
+TEST(StampedRingBuffer, EmplaceKeepsOrderAndExistingElements)
+{
+  StampedRingBuffer<int, int> buffer;
+  buffer.emplace(10, 10);
+  buffer.emplace(30, 30);
+  buffer.emplace(20, 20);
+  buffer.emplace(5, 5);
+
+  // An existing stamp is not overwritten
+  const auto result = buffer.emplace(20, 99);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(2u, result.first);
+  EXPECT_EQ(20, buffer.at(20));
+
+  ASSERT_EQ(4u, buffer.size());
+  EXPECT_EQ(5, buffer[0].first);
+  EXPECT_EQ(10, buffer[1].first);
+  EXPECT_EQ(20, buffer[2].first);
+  EXPECT_EQ(30, buffer[3].first);
+}
+
+TEST(StampedRingBuffer, Search)
+{
+  StampedRingBuffer<int, int> buffer;
+  for (int stamp = 10; stamp <= 50; stamp += 10)
+  {
+    buffer.emplace(stamp, stamp);
+  }
+
+  EXPECT_EQ(0u, buffer.upperBound(5));
+  EXPECT_EQ(1u, buffer.upperBound(10));
+  EXPECT_EQ(1u, buffer.upperBound(15));
+  EXPECT_EQ(5u, buffer.upperBound(50));
+  EXPECT_EQ(5u, buffer.upperBound(60));
+
+  EXPECT_EQ(2u, buffer.find(30));
+  EXPECT_EQ(buffer.npos, buffer.find(35));
+  EXPECT_EQ(buffer.npos, buffer.find(5));
+}
+
+TEST(StampedRingBuffer, WrapAround)
+{
+  // Keep a sliding window of elements, so the head wraps around the storage many times, and compare against a map
+  StampedRingBuffer<int, int> buffer(8);
+  std::map<int, int> expected;
+  for (int stamp = 0; stamp < 100; ++stamp)
+  {
+    buffer.emplace(stamp, -stamp);
+    expected.emplace(stamp, -stamp);
+    if (buffer.size() > 6)
+    {
+      buffer.popFront(2);
+      expected.erase(expected.begin(), std::next(expected.begin(), 2));
+    }
+
+    ASSERT_EQ(expected.size(), buffer.size());
+    size_t i = 0;
+    for (const auto& stamp__value : expected)
+    {
+      EXPECT_EQ(stamp__value.first, buffer[i].first);
+      EXPECT_EQ(stamp__value.second, buffer[i].second);
+      ++i;
+    }
+  }
+
+  // Inserting an older element into a wrapped buffer shifts the newer elements
+  const auto oldest = buffer.front().first;
+  const auto size = buffer.size();
+  buffer.popFront();
+  buffer.emplace(oldest, 0);
+  ASSERT_EQ(size, buffer.size());
+  EXPECT_EQ(oldest, buffer.front().first);
+  EXPECT_EQ(oldest + 1, buffer[1].first);
+  EXPECT_EQ(99, buffer.back().first);
+
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
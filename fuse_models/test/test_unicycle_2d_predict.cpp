@@ -451,6 +451,76 @@ TEST(Predict, predictJacobians)
     << "\nAnalytic Jacobian =\n" << J_analytic.format(HeavyFmt);
 }
 
+TEST(Predict, predictStateVector)
+{
+  fuse_core::Vector8d state1;
+  state1 << 0.3, -1.0, 2.9, 1.2, -0.4, 1.5, 0.7, -0.2;
+  const double dt = 0.13;
+
+  // Predict with the per-parameter-block Jacobians
+  double position2_x = 0.0;
+  double position2_y = 0.0;
+  double yaw2 = 0.0;
+  double vel_linear2_x = 0.0;
+  double vel_linear2_y = 0.0;
+  double vel_yaw2 = 0.0;
+  double acc_linear2_x = 0.0;
+  double acc_linear2_y = 0.0;
+
+  const std::array<size_t, 5> block_sizes = {2, 1, 2, 1, 2};
+  const auto num_parameter_blocks = block_sizes.size();
+
+  const size_t num_residuals{ 8 };
+
+  std::array<fuse_core::MatrixXd, num_parameter_blocks> J;
+  std::array<double*, num_parameter_blocks> jacobians;
+
+  for (size_t i = 0; i < num_parameter_blocks; ++i)
+  {
+    J[i].resize(num_residuals, block_sizes[i]);
+    jacobians[i] = J[i].data();
+  }
+
+  fuse_models::predict(
+    state1[0],
+    state1[1],
+    state1[2],
+    state1[3],
+    state1[4],
+    state1[5],
+    state1[6],
+    state1[7],
+    dt,
+    position2_x,
+    position2_y,
+    yaw2,
+    vel_linear2_x,
+    vel_linear2_y,
+    vel_yaw2,
+    acc_linear2_x,
+    acc_linear2_y,
+    jacobians.data());
+
+  fuse_core::Matrix8d J_blocks;
+  J_blocks << J[0], J[1], J[2], J[3], J[4];
+
+  // Predict with the fixed-size state vector, in place
+  fuse_core::Vector8d state2 = state1;
+  fuse_core::Matrix8d J_state;
+  fuse_models::predict(state2, dt, state2, J_state);
+
+  EXPECT_DOUBLE_EQ(position2_x, state2[0]);
+  EXPECT_DOUBLE_EQ(position2_y, state2[1]);
+  EXPECT_DOUBLE_EQ(yaw2, state2[2]);
+  EXPECT_DOUBLE_EQ(vel_linear2_x, state2[3]);
+  EXPECT_DOUBLE_EQ(vel_linear2_y, state2[4]);
+  EXPECT_DOUBLE_EQ(vel_yaw2, state2[5]);
+  EXPECT_DOUBLE_EQ(acc_linear2_x, state2[6]);
+  EXPECT_DOUBLE_EQ(acc_linear2_y, state2[7]);
+
+  EXPECT_MATRIX_NEAR(J_blocks, J_state, std::numeric_limits<double>::epsilon());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
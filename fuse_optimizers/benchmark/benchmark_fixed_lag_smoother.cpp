@@ -0,0 +1,345 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/absolute_pose_3d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_3d_stamped_constraint.h>
+#include <fuse_core/allocation_counter.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/time.h>
+#include <fuse_core/transaction.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_optimizers/fixed_lag_smoother.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/orientation_3d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+#include <fuse_variables/position_3d_stamped.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/range/size.hpp>
+#include <Eigen/Geometry>
+#include <rclcpp/rclcpp.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+
+
+// Count the heap allocations per thread, including Eigen's, so the allocations of each optimization cycle stage can be
+// reported
+FUSE_MALLOC_COUNTING_HOOKS()
+
+constexpr double OPTIMIZATION_PERIOD = 0.1;  //!< The simulated optimization period, in seconds
+constexpr size_t ABSOLUTE_POSE_DECIMATION = 10;  //!< Every n-th pose also gets an absolute pose constraint
+
+/**
+ * @brief Generates the transactions of a robot driving around a circle in 2D
+ *
+ * Each transaction adds a new pose and a relative pose constraint to the previous one, as an odometry sensor would.
+ * Every ABSOLUTE_POSE_DECIMATION-th pose also gets an absolute pose constraint, as a localization sensor would
+ * provide. The first pose gets a prior. The new poses start slightly away from the true trajectory, so the solver
+ * has some work to do.
+ */
+class Workload2D
+{
+public:
+  fuse_core::Transaction::SharedPtr next(const fuse_core::TimeStamp& stamp)
+  {
+    auto transaction = fuse_core::Transaction::make_shared();
+    transaction->stamp(stamp);
+    transaction->addInvolvedStamp(stamp);
+
+    auto position = fuse_variables::Position2DStamped::make_shared(stamp);
+    auto orientation = fuse_variables::Orientation2DStamped::make_shared(stamp);
+    position->x() = x_ + 0.01;
+    position->y() = y_ - 0.01;
+    orientation->yaw() = yaw_ + 0.01;
+    transaction->addVariable(position);
+    transaction->addVariable(orientation);
+
+    const fuse_core::Matrix3d covariance = fuse_core::Vector3d(0.01, 0.01, 0.001).asDiagonal();
+    if (!position_)
+    {
+      transaction->addConstraint(fuse_constraints::AbsolutePose2DStampedConstraint::make_shared(
+        "prior", *position, *orientation, fuse_core::Vector3d(x_, y_, yaw_), covariance));
+    }
+    else
+    {
+      transaction->addConstraint(fuse_constraints::RelativePose2DStampedConstraint::make_shared(
+        "odometry", *position_, *orientation_, *position, *orientation, fuse_core::Vector3d(STEP, 0.0, TURN),
+        covariance));
+      if (step_ % ABSOLUTE_POSE_DECIMATION == 0)
+      {
+        transaction->addConstraint(fuse_constraints::AbsolutePose2DStampedConstraint::make_shared(
+          "localization", *position, *orientation, fuse_core::Vector3d(x_, y_, yaw_), 10.0 * covariance));
+      }
+    }
+
+    position_ = std::move(position);
+    orientation_ = std::move(orientation);
+    ++step_;
+    x_ += STEP * std::cos(yaw_);
+    y_ += STEP * std::sin(yaw_);
+    yaw_ += TURN;
+    return transaction;
+  }
+
+private:
+  static constexpr double STEP = 0.1;   //!< The distance driven between two poses
+  static constexpr double TURN = 0.01;  //!< The yaw change between two poses
+
+  fuse_variables::Position2DStamped::SharedPtr position_;  //!< The previous position
+  fuse_variables::Orientation2DStamped::SharedPtr orientation_;  //!< The previous orientation
+  size_t step_{ 0 };  //!< The number of poses generated
+  double x_{ 0.0 };    //!< The true x position of the next pose
+  double y_{ 0.0 };    //!< The true y position of the next pose
+  double yaw_{ 0.0 };  //!< The true yaw of the next pose
+};
+
+constexpr double Workload2D::STEP;
+constexpr double Workload2D::TURN;
+
+/**
+ * @brief Generates the transactions of a robot climbing a helix in 3D. See Workload2D.
+ */
+class Workload3D
+{
+public:
+  fuse_core::Transaction::SharedPtr next(const fuse_core::TimeStamp& stamp)
+  {
+    auto transaction = fuse_core::Transaction::make_shared();
+    transaction->stamp(stamp);
+    transaction->addInvolvedStamp(stamp);
+
+    const Eigen::Quaterniond rotation(pose_.rotation());
+    auto position = fuse_variables::Position3DStamped::make_shared(stamp);
+    auto orientation = fuse_variables::Orientation3DStamped::make_shared(stamp);
+    position->x() = pose_.translation().x() + 0.01;
+    position->y() = pose_.translation().y() - 0.01;
+    position->z() = pose_.translation().z() + 0.01;
+    orientation->w() = rotation.w();
+    orientation->x() = rotation.x();
+    orientation->y() = rotation.y();
+    orientation->z() = rotation.z();
+    transaction->addVariable(position);
+    transaction->addVariable(orientation);
+
+    fuse_core::Matrix6d covariance = fuse_core::Matrix6d::Zero();
+    covariance.diagonal() << 0.01, 0.01, 0.01, 0.001, 0.001, 0.001;
+    if (!position_)
+    {
+      transaction->addConstraint(fuse_constraints::AbsolutePose3DStampedConstraint::make_shared(
+        "prior", *position, *orientation, toVector(pose_), covariance));
+    }
+    else
+    {
+      transaction->addConstraint(fuse_constraints::RelativePose3DStampedConstraint::make_shared(
+        "odometry", *position_, *orientation_, *position, *orientation, toVector(delta()), covariance));
+      if (step_ % ABSOLUTE_POSE_DECIMATION == 0)
+      {
+        transaction->addConstraint(fuse_constraints::AbsolutePose3DStampedConstraint::make_shared(
+          "localization", *position, *orientation, toVector(pose_), 10.0 * covariance));
+      }
+    }
+
+    position_ = std::move(position);
+    orientation_ = std::move(orientation);
+    ++step_;
+    pose_ = pose_ * delta();
+    return transaction;
+  }
+
+private:
+  /**
+   * @brief The motion between two poses: forward, slightly up and turning left
+   */
+  static Eigen::Isometry3d delta()
+  {
+    return Eigen::Translation3d(0.1, 0.0, 0.001) * Eigen::AngleAxisd(0.01, Eigen::Vector3d::UnitZ());
+  }
+
+  /**
+   * @brief Convert a pose to the (x, y, z, qw, qx, qy, qz) vector used by the 3D pose constraints
+   */
+  static fuse_core::Vector7d toVector(const Eigen::Isometry3d& pose)
+  {
+    const Eigen::Quaterniond rotation(pose.rotation());
+    fuse_core::Vector7d vector;
+    vector << pose.translation(), rotation.w(), rotation.x(), rotation.y(), rotation.z();
+    return vector;
+  }
+
+  fuse_variables::Position3DStamped::SharedPtr position_;  //!< The previous position
+  fuse_variables::Orientation3DStamped::SharedPtr orientation_;  //!< The previous orientation
+  size_t step_{ 0 };  //!< The number of poses generated
+  Eigen::Isometry3d pose_{ Eigen::Isometry3d::Identity() };  //!< The true pose of the next pose
+};
+
+/**
+ * @brief A FixedLagSmoother that exposes the stage timings and the graph size of its last optimization cycle
+ */
+class BenchmarkSmoother : public fuse_optimizers::FixedLagSmoother
+{
+public:
+  using FixedLagSmoother::CycleAllocations;
+  using FixedLagSmoother::CycleTimings;
+
+  explicit BenchmarkSmoother(const double lag_duration) :
+    FixedLagSmoother(
+      rclcpp::NodeOptions().parameter_overrides(
+        {
+          rclcpp::Parameter("lag_duration", lag_duration),
+          rclcpp::Parameter("optimization_period", OPTIMIZATION_PERIOD)
+        }),  // NOLINT(whitespace/braces)
+      "benchmark_fixed_lag_smoother",
+      fuse_graphs::HashGraph::make_unique())
+  {
+  }
+
+  const CycleTimings& cycleTimings() const { return cycle_timings_; }
+
+  const CycleAllocations& cycleAllocations() const { return cycle_allocations_; }
+
+  size_t variableCount() const { return boost::size(graph_->getVariables()); }
+};
+
+/**
+ * @brief Run complete fixed-lag smoother optimization cycles on a window that is already full
+ *
+ * Each iteration replays the transactions of one optimization period and runs one optimization cycle, which
+ * processes the pending transaction queue, updates and optimizes the graph, notifies the plugins with a clone of the
+ * graph and marginalizes out the variables that left the window. The time spent in each stage, and the heap
+ * allocations and allocated bytes of each stage and of the whole cycle, are reported per cycle.
+ *
+ * Arguments: the lag duration in seconds, and the odometry rate in Hz.
+ */
+template <typename Workload>
+static void BM_fixedLagSmoother(benchmark::State& state)
+{
+  BenchmarkSmoother smoother(state.range(0));
+  Workload workload;
+  const auto transactions_per_cycle = static_cast<size_t>(state.range(1) * OPTIMIZATION_PERIOD);
+  const auto transaction_period = fuse_core::fromSec(1.0 / state.range(1));
+  auto stamp = fuse_core::TimeStamp(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(
+    std::chrono::seconds(1000)));
+
+  auto cycle = [&]()
+  {
+    for (size_t i = 0; i < transactions_per_cycle; ++i)
+    {
+      smoother.replayTransaction("odometry", workload.next(stamp));
+      stamp = stamp + transaction_period;
+    }
+    smoother.optimizePending();
+  };  // NOLINT(whitespace/braces)
+
+  // Fill the window, so marginalization happens in every measured cycle
+  const auto warmup_cycles = static_cast<size_t>(state.range(0) / OPTIMIZATION_PERIOD) + 2;
+  for (size_t i = 0; i < warmup_cycles; ++i)
+  {
+    cycle();
+  }
+
+  using Seconds = std::chrono::duration<double>;
+  auto timings = BenchmarkSmoother::CycleTimings();
+  auto allocations = BenchmarkSmoother::CycleAllocations();
+  auto cycle_allocations = fuse_core::AllocationCount();
+  for (auto _ : state)
+  {
+    fuse_core::AllocationCounter allocation_counter;
+    cycle();
+    cycle_allocations += allocation_counter.elapsed();
+
+    const auto& cycle_timings = smoother.cycleTimings();
+    timings.process_queue += cycle_timings.process_queue;
+    timings.update_graph += cycle_timings.update_graph;
+    timings.optimize += cycle_timings.optimize;
+    timings.notify += cycle_timings.notify;
+    timings.marginalize += cycle_timings.marginalize;
+
+    const auto& stage_allocations = smoother.cycleAllocations();
+    allocations.process_queue += stage_allocations.process_queue;
+    allocations.update_graph += stage_allocations.update_graph;
+    allocations.optimize += stage_allocations.optimize;
+    allocations.notify += stage_allocations.notify;
+    allocations.marginalize += stage_allocations.marginalize;
+  }
+
+  const auto average = benchmark::Counter::kAvgIterations;
+  auto add_stage = [&state, average](const std::string& stage, const std::chrono::nanoseconds& time,
+                                     const fuse_core::AllocationCount& count)
+  {
+    state.counters[stage] = benchmark::Counter(Seconds(time).count(), average);
+    state.counters[stage + "_allocations"] = benchmark::Counter(count.allocations, average);
+    state.counters[stage + "_bytes"] = benchmark::Counter(count.bytes, average);
+  };  // NOLINT(whitespace/braces)
+  add_stage("process_queue", timings.process_queue, allocations.process_queue);
+  add_stage("update_graph", timings.update_graph, allocations.update_graph);
+  add_stage("optimize", timings.optimize, allocations.optimize);
+  add_stage("notify", timings.notify, allocations.notify);
+  add_stage("marginalize", timings.marginalize, allocations.marginalize);
+  state.counters["allocations"] = benchmark::Counter(cycle_allocations.allocations, average);
+  state.counters["bytes"] = benchmark::Counter(cycle_allocations.bytes, average);
+  state.counters["variables"] = smoother.variableCount();
+}
+
+/**
+ * @brief The benchmark arguments: the lag duration in seconds, and the odometry rate in Hz
+ */
+static void smootherArguments(benchmark::internal::Benchmark* benchmark)
+{
+  for (const auto lag_duration : { 1, 5, 20 })
+  {
+    for (const auto rate : { 10, 50, 100 })
+    {
+      benchmark->Args({lag_duration, rate});
+    }
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE(BM_fixedLagSmoother, Workload2D)->Apply(smootherArguments);
+BENCHMARK_TEMPLATE(BM_fixedLagSmoother, Workload3D)->Apply(smootherArguments);
+
+int main(int argc, char** argv)
+{
+  // The smoother is a ROS node, so ROS must be initialized first
+  rclcpp::init(argc, argv);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -117,6 +117,11 @@ public:
    */
   virtual ~BatchOptimizer();
 
+  /**
+   * @brief Run one optimization cycle on the calling thread, if the optimizer has started and has pending transactions
+   */
+  void optimizePending() override;
+
 protected:
   /**
    * Structure containing the information required to process a transaction after it was received.
@@ -177,6 +182,11 @@ protected:
    */
   void optimizationLoop();
 
+  /**
+   * @brief Apply the combined transaction to the graph, optimize it and notify the plugins
+   */
+  void optimizationCycle();
+
   /**
    * @brief Callback fired at a fixed frequency to trigger a new optimization cycle.
    *
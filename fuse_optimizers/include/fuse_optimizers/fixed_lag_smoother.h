@@ -34,6 +34,7 @@
 #ifndef FUSE_OPTIMIZERS_FIXED_LAG_SMOOTHER_H
 #define FUSE_OPTIMIZERS_FIXED_LAG_SMOOTHER_H
 
+#include <fuse_core/allocation_counter.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/time.h>
 #include <fuse_core/transaction.h>
@@ -47,6 +48,7 @@
 #include <std_srvs/srv/empty.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -131,6 +133,11 @@ public:
    */
   virtual ~FixedLagSmoother();
 
+  /**
+   * @brief Run one optimization cycle on the calling thread, if the smoother has started and has pending transactions
+   */
+  void optimizePending() override;
+
 protected:
   /**
    * Structure containing the information required to process a transaction after it was received.
@@ -157,6 +164,33 @@ protected:
    */
   using TransactionQueue = std::vector<TransactionQueueElement>;
 
+  /**
+   * @brief The time spent in each stage of an optimization cycle
+   */
+  struct CycleTimings
+  {
+    std::chrono::nanoseconds process_queue{ 0 };  //!< Applying the motion models to the pending transactions
+    std::chrono::nanoseconds update_graph{ 0 };   //!< Preparing the marginalization and updating the graph
+    std::chrono::nanoseconds optimize{ 0 };       //!< Optimizing the graph
+    std::chrono::nanoseconds notify{ 0 };         //!< Cloning the graph and notifying the plugins
+    std::chrono::nanoseconds marginalize{ 0 };    //!< Computing the marginal transaction for the next cycle
+  };
+
+  /**
+   * @brief The heap allocations made by the optimization thread in each stage of an optimization cycle
+   *
+   * The counts stay zero unless the executable installed the hooks with FUSE_MALLOC_COUNTING_HOOKS(), which counts
+   * every heap allocation, or FUSE_ALLOCATION_COUNTING_HOOKS(), which only counts the operator new allocations.
+   */
+  struct CycleAllocations
+  {
+    fuse_core::AllocationCount process_queue;  //!< Applying the motion models to the pending transactions
+    fuse_core::AllocationCount update_graph;   //!< Preparing the marginalization and updating the graph
+    fuse_core::AllocationCount optimize;       //!< Optimizing the graph
+    fuse_core::AllocationCount notify;         //!< Cloning the graph and notifying the plugins
+    fuse_core::AllocationCount marginalize;    //!< Computing the marginal transaction for the next cycle
+  };
+
   // Read-only after construction
   std::thread optimization_thread_;  //!< Thread used to run the optimizer as a background process
   ParameterType params_;  //!< Configuration settings for this fixed-lag smoother
@@ -180,6 +214,8 @@ protected:
   fuse_core::Transaction marginal_transaction_;  //!< The marginals to add during the next optimization cycle
   VariableStampIndex timestamp_tracking_;  //!< Object that tracks the timestamp associated with each variable
   ceres::Solver::Summary summary_;  //!< Optimization summary, written by optimizationLoop and read by setDiagnostics
+  CycleTimings cycle_timings_;  //!< Stage timings of the last complete optimization cycle, read by setDiagnostics
+  CycleAllocations cycle_allocations_;  //!< Stage allocations of the last complete optimization cycle
 
   // Guarded by optimization_requested_mutex_
   std::mutex optimization_requested_mutex_;  //!< Required condition variable mutex
@@ -248,6 +284,17 @@ protected:
    */
   void optimizationLoop();
 
+  /**
+   * @brief Add the pending transactions to the graph, optimize it, notify the plugins and marginalize out the
+   *        variables that left the lag window
+   *
+   * The caller must hold the optimization_mutex_.
+   *
+   * @param[in] optimization_deadline The time the cycle should be complete by, or an uninitialised stamp for none
+   * @return False if the graph could not be updated or optimized. Node shutdown has been requested in that case.
+   */
+  bool optimizationCycle(const fuse_core::TimeStamp& optimization_deadline);
+
   /**
    * @brief Callback fired at a fixed frequency to trigger a new optimization cycle.
    *
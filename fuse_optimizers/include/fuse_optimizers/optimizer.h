@@ -35,16 +35,20 @@
 #define FUSE_OPTIMIZERS_OPTIMIZER_H
 
 #include <diagnostic_updater/diagnostic_updater.hpp>
+#include <fuse_core/covariance_blocks.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/fuse_macros.h>
 #include <fuse_core/motion_model.h>
 #include <fuse_core/publisher.h>
 #include <fuse_core/sensor_model.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/transaction_log.h>
 #include <fuse_core/callback_wrapper.h>
 #include <pluginlib/class_loader.hpp>
 #include <rclcpp/rclcpp.hpp>
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -89,7 +93,13 @@ namespace fuse_optimizers
  *  - name: string
  *    type: string
  *  - ...
+ * transaction_log: string
  * @endcode
+ *
+ * If the transaction_log parameter is set, every transaction received from the sensor models is appended to that
+ * file, along with the sensor name and arrival time. See fuse_core::TransactionLogWriter. The log may be replayed
+ * offline, faster than real time, with replayTransaction() and optimizePending(). Recording stops after the first
+ * write error.
  */
 class Optimizer : public rclcpp::Node
 {
@@ -115,6 +125,27 @@ public:
    */
   virtual ~Optimizer();
 
+  /**
+   * @brief Handle a recorded transaction on the calling thread, bypassing the callback queue
+   *
+   * This is used to replay a transaction log. The transaction is processed as if it had been received from the named
+   * sensor model, which must be configured in this optimizer. The node must not be spun while replaying.
+   *
+   * @param[in] sensor_name The name of the sensor that produced the Transaction
+   * @param[in] transaction The recorded Transaction
+   */
+  void replayTransaction(
+    const std::string& sensor_name,
+    fuse_core::Transaction::SharedPtr transaction);
+
+  /**
+   * @brief Run one optimization cycle on the calling thread, if the optimizer is ready and has pending transactions
+   *
+   * This replaces the optimization timer when replaying a transaction log, so the log can be processed as fast as
+   * possible and with the same result every time. The default implementation throws std::logic_error.
+   */
+  virtual void optimizePending();
+
 protected:
   // The unique ptrs returned by pluginlib have a custom deleter. This makes specifying the type rather annoying
   // as it is not equivalent to Class::UniquePtr
@@ -162,6 +193,8 @@ protected:
   diagnostic_updater::Updater diagnostic_updater_;  //!< Diagnostic updater
 
   std::shared_ptr<fuse_core::CallbackAdapter> callback_queue_;
+  std::unique_ptr<fuse_core::TransactionLogWriter> transaction_log_;  //!< Records the received transactions, if enabled
+  std::atomic<bool> transaction_log_failed_{ false };  //!< Recording stopped after the first write error
 
 
   /**
@@ -215,9 +248,26 @@ protected:
     const std::string& sensor_name,
     fuse_core::Transaction& transaction) const;
 
+  /**
+   * @brief Compute the covariance blocks requested by all publishers in a single batch
+   *
+   * This runs in the optimizer's thread, before any publisher is notified. Publishers only request covariance blocks
+   * when configured to, so nothing is computed by default.
+   *
+   * @param[in] transaction A transaction containing all recent additions and removals
+   * @param[in] graph       The optimized graph snapshot that will be sent to the publishers
+   * @return The computed covariance blocks, or nullptr if no publisher requested any or the computation failed
+   */
+  fuse_core::CovarianceBlocks::ConstSharedPtr computeCovarianceRequests(
+    const fuse_core::Transaction& transaction,
+    const fuse_core::Graph& graph);
+
   /**
    * @brief Send the sensors, motion models, and publishers updated graph information
    *
+   * The covariance blocks requested by the publishers are computed once from \p graph and delivered to all
+   * publishers along with the graph.
+   *
    * @param[in] transaction A read-only pointer to a transaction containing all recent additions and removals
    * @param[in] graph       A read-only pointer to the graph object
    */
@@ -228,6 +278,8 @@ protected:
   /**
    * @brief Inject a transaction callback function into the global callback queue
    *
+   * The transaction is recorded in the transaction log first, if one is configured.
+   *
    * @param[in] sensor_name The name of the sensor that produced the Transaction
    * @param[in] transaction The populated Transaction object created by the loaded SensorModel plugin
    */
@@ -0,0 +1,233 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_OPTIMIZERS_WORKLOAD_GENERATOR_H
+#define FUSE_OPTIMIZERS_WORKLOAD_GENERATOR_H
+
+#include <fuse_core/constraint.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_variables/point_2d_landmark.h>
+#include <fuse_variables/position_2d_stamped.h>
+
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fuse_optimizers
+{
+
+/**
+ * @brief Configuration of a WorkloadGenerator
+ *
+ * The defaults reproduce the fuse_tutorials range_sensor_simulator at the same scale: one robot driving a circle
+ * through a 100m site with 36 beacons, and ranges to every beacon at 10Hz.
+ */
+struct WorkloadGeneratorParams
+{
+  unsigned int seed { 0 };  //!< Seed of the random number generator. The same seed generates the same transactions.
+  double start_time { 1000.0 };  //!< The stamp of the first transaction, in seconds since the epoch
+  double duration { 60.0 };  //!< The simulated time span, in seconds
+  double site_width { 100.0 };  //!< The width/length of the test area in meters
+
+  size_t robot_count { 1 };  //!< The number of robots. Each one has its own odometry and range sensor.
+  double robot_velocity { 10.0 };  //!< The forward velocity of each robot, in m/s
+
+  size_t beacon_count { 36 };  //!< The number of beacons, placed at random within the site
+  double beacon_sigma { 4.0 };  //!< Std dev of the beacon position priors, in meters
+
+  double odometry_rate { 10.0 };  //!< The rate of the odometry sensor of each robot, in Hz
+  double odometry_position_sigma { 0.1 };  //!< Std dev of the odometry position change, in meters
+  double odometry_yaw_sigma { 0.05 };  //!< Std dev of the odometry yaw change, in radians
+
+  size_t range_decimation { 1 };  //!< A range measurement is taken every range_decimation odometry measurements
+  double range_limit { std::numeric_limits<double>::infinity() };  //!< Max distance to a measured beacon, in meters
+  double range_sigma { 0.5 };  //!< Std dev of the range measurement noise, in meters
+  double outlier_fraction { 0.0 };  //!< Fraction of range measurements replaced by a uniformly random range
+
+  /**
+   * @brief Set a parameter from its name and value as strings
+   *
+   * This lets headless tools configure the generator from the command line without a parameter server.
+   *
+   * @param[in] name  The parameter name, e.g. "robot_count"
+   * @param[in] value The parameter value, e.g. "10"
+   * @throws std::invalid_argument if the parameter name is unknown or the value cannot be parsed
+   */
+  void set(const std::string& name, const std::string& value);
+
+  /**
+   * @brief Throws std::invalid_argument if any parameter is out of range
+   */
+  void validate() const;
+};
+
+/**
+ * @brief A headless, deterministic generator of the transactions of a fleet of robots measuring ranges to beacons
+ *
+ * This is the fuse_tutorials range_sensor_simulator grown into a stress test. Instead of publishing ROS messages for
+ * the sensor models to convert, it creates the sensor transactions directly, so they can be fed to an in-process graph
+ * or optimizer without any ROS transport or wall clock:
+ *  - Each robot drives its own circle around the site center. Each circle has a different radius and starting phase.
+ *  - The "robot_<i>/odometry" sensor creates the 2D pose of the robot at each odometry stamp. It adds a
+ *    fuse_constraints::RelativePose2DStampedConstraint with the noisy pose change since the previous stamp. The first
+ *    transaction has a fuse_constraints::AbsolutePose2DStampedConstraint prior on the true starting pose instead.
+ *  - The "robot_<i>/ranges" sensor creates a range constraint for each beacon within range of the robot position,
+ *    using the RangeConstraintFactory, e.g. one that creates a fuse_tutorials::RangeConstraint. The constraints refer
+ *    to the pose of the odometry transaction with the same stamp. The first measurement of each beacon also adds a
+ *    prior on the noisy beacon position, like the fuse_tutorials RangeSensorModel does.
+ *
+ * The transactions are emitted in stamp order. All randomness comes from a single std::mt19937_64 seeded by the
+ * params. The uniform and normal samples are computed from its output here, instead of with the <random>
+ * distributions, whose algorithms are left to the standard library implementation. So the same params produce the
+ * same transaction stream with any compiler.
+ */
+class WorkloadGenerator
+{
+public:
+  /**
+   * @brief The true position of a beacon
+   */
+  struct Beacon
+  {
+    double x;
+    double y;
+  };
+
+  /**
+   * @brief The callback that receives each transaction, along with the name of the sensor that created it
+   */
+  using TransactionCallback =
+    std::function<void(const std::string& sensor_name, fuse_core::Transaction::SharedPtr transaction)>;
+
+  /**
+   * @brief Creates the constraint of a range measurement between a robot position and a beacon position
+   *
+   * The arguments are the sensor name, the robot position, the beacon position, the measured range and its standard
+   * deviation, in meters.
+   */
+  using RangeConstraintFactory = std::function<fuse_core::Constraint::SharedPtr(
+    const std::string& source,
+    const fuse_variables::Position2DStamped& robot_position,
+    const fuse_variables::Point2DLandmark& beacon_position,
+    const double z,
+    const double sigma)>;
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] params                   The workload configuration. Throws std::invalid_argument if it is not valid.
+   * @param[in] range_constraint_factory Creates the range measurement constraints. Throws std::invalid_argument if it
+   *                                     is empty.
+   */
+  WorkloadGenerator(const WorkloadGeneratorParams& params, RangeConstraintFactory range_constraint_factory);
+
+  /**
+   * @brief The true beacon positions, indexed by the beacon ID used by the fuse_variables::Point2DLandmark variables
+   */
+  const std::vector<Beacon>& beacons() const { return beacons_; }
+
+  /**
+   * @brief The device ID of the pose variables of each robot
+   */
+  const fuse_core::UUID& deviceId(const size_t robot) const { return robots_.at(robot).device_id; }
+
+  /**
+   * @brief Generate all the transactions over the configured duration, in stamp order
+   *
+   * @param[in] callback Called for each transaction, in the calling thread
+   */
+  void generate(const TransactionCallback& callback);
+
+private:
+  /**
+   * @brief The true state of a robot and the state of its sensors
+   */
+  struct Robot
+  {
+    std::string odometry_name;
+    std::string ranges_name;
+    fuse_core::UUID device_id;
+    double radius;  //!< The radius of the circle the robot drives
+    double phase;  //!< The angle of the robot position around the site center at the start
+    double x { 0.0 };
+    double y { 0.0 };
+    double yaw { 0.0 };
+    double estimate_x { 0.0 };  //!< The dead-reckoned pose, used as the initial value of the pose variables
+    double estimate_y { 0.0 };
+    double estimate_yaw { 0.0 };
+  };
+
+  /**
+   * @brief Move the robot to its true pose at the given time since the start
+   */
+  void moveRobot(Robot& robot, const double t) const;
+
+  /**
+   * @brief Create the odometry transaction of the robot at the given stamp, and update its dead-reckoned pose
+   */
+  fuse_core::Transaction::SharedPtr createOdometryTransaction(
+    const Robot& previous,
+    Robot& robot,
+    const fuse_core::TimeStamp& previous_stamp,
+    const fuse_core::TimeStamp& stamp);
+
+  /**
+   * @brief Create the range transaction of the robot at the given stamp, or nullptr if no beacon is within range
+   */
+  fuse_core::Transaction::SharedPtr createRangeTransaction(const Robot& robot, const fuse_core::TimeStamp& stamp);
+
+  /**
+   * @brief Draw a sample from the uniform distribution over [min, max)
+   */
+  double uniform(const double min, const double max);
+
+  /**
+   * @brief Draw a sample from the zero-mean normal distribution with the given standard deviation
+   */
+  double normal(const double sigma);
+
+  WorkloadGeneratorParams params_;
+  RangeConstraintFactory range_constraint_factory_;
+  std::mt19937_64 generator_;
+  std::vector<Beacon> beacons_;  //!< The true beacon positions
+  std::vector<Beacon> noisy_beacons_;  //!< The beacon position priors
+  std::vector<bool> beacon_initialized_;  //!< Whether the prior of each beacon was sent
+  std::vector<Robot> robots_;
+};
+
+}  // namespace fuse_optimizers
+
+#endif  // FUSE_OPTIMIZERS_WORKLOAD_GENERATOR_H
@@ -33,6 +33,8 @@
  */
 #include <fuse_optimizers/fixed_lag_smoother.h>
 
+#include <chrono>
+
 namespace
 {
 /**
@@ -177,79 +179,130 @@ void FixedLagSmoother::optimizationLoop()
     // Optimize
     {
       std::lock_guard<std::mutex> lock(optimization_mutex_);
-      // Apply motion models
-      auto new_transaction = fuse_core::Transaction::make_shared();
-      // DANGER: processQueue obtains a lock from the pending_transactions_mutex_
-      //         We do this to ensure state of the graph does not change between unlocking the pending_transactions
-      //         queue and obtaining the lock for the graph. But we have now obtained two different locks. If we are
-      //         not extremely careful, we could get a deadlock.
-      //  XXX make sure lag_expiration_ has been initialised
-      processQueue(*new_transaction, lag_expiration_);
-      // Skip this optimization cycle if the transaction is empty because something failed while processing the pending
-      // transactions queue.
-      if (new_transaction->empty())
-      {
-        continue;
-      }
-      // Prepare for selecting the marginal variables
-      preprocessMarginalization(*new_transaction);
-      // Combine the new transactions with any marginal transaction from the end of the last cycle
-      new_transaction->merge(marginal_transaction_);
-      // Update the graph
-      try
-      {
-        graph_->update(*new_transaction);
-      }
-      catch (const std::exception& ex)
+      if (!optimizationCycle(optimization_deadline))
       {
-        std::ostringstream oss;
-        oss << "Graph:\n";
-        graph_->print(oss);
-        oss << "\nTransaction:\n";
-        new_transaction->print(oss);
-
-        RCLCPP_FATAL_STREAM(this->get_logger(), "Failed to update graph with transaction: " << ex.what()
-                                                                     << "\nLeaving optimization loop and requesting "
-                                                                        "node shutdown...\n" << oss.str());
-        rclcpp::shutdown();
         break;
       }
-      // Optimize the entire graph
-      summary_ = graph_->optimize(params_.solver_options);
+    }
+  }
+}
 
-      // Optimization is complete. Notify all the things about the graph changes.
-      const auto new_transaction_stamp = new_transaction->stamp();
-      notify(std::move(new_transaction), graph_->clone());
+bool FixedLagSmoother::optimizationCycle(const fuse_core::TimeStamp& optimization_deadline)
+{
+  // Time each stage of the cycle and count its allocations. The stage statistics are only published once the cycle is
+  // complete.
+  using Clock = std::chrono::steady_clock;
+  auto timings = CycleTimings();
+  auto allocations = CycleAllocations();
+  auto stage_start = Clock::now();
+  auto allocation_counter = fuse_core::AllocationCounter();
+  auto end_stage = [&stage_start, &allocation_counter](
+    std::chrono::nanoseconds& stage_time,
+    fuse_core::AllocationCount& stage_allocations)
+  {
+    const auto now = Clock::now();
+    stage_time = now - stage_start;
+    stage_start = now;
+    stage_allocations = allocation_counter.restart();
+  };  // NOLINT(whitespace/braces)
+
+  // Apply motion models
+  auto new_transaction = fuse_core::Transaction::make_shared();
+  // DANGER: processQueue obtains a lock from the pending_transactions_mutex_
+  //         We do this to ensure state of the graph does not change between unlocking the pending_transactions
+  //         queue and obtaining the lock for the graph. But we have now obtained two different locks. If we are
+  //         not extremely careful, we could get a deadlock.
+  //  XXX make sure lag_expiration_ has been initialised
+  processQueue(*new_transaction, lag_expiration_);
+  end_stage(timings.process_queue, allocations.process_queue);
+  // Skip this optimization cycle if the transaction is empty because something failed while processing the pending
+  // transactions queue.
+  if (new_transaction->empty())
+  {
+    return true;
+  }
+  // Prepare for selecting the marginal variables
+  preprocessMarginalization(*new_transaction);
+  // Combine the new transactions with any marginal transaction from the end of the last cycle
+  new_transaction->merge(marginal_transaction_);
+  // Update the graph
+  try
+  {
+    graph_->update(*new_transaction);
+  }
+  catch (const std::exception& ex)
+  {
+    std::ostringstream oss;
+    oss << "Graph:\n";
+    graph_->print(oss);
+    oss << "\nTransaction:\n";
+    new_transaction->print(oss);
+
+    RCLCPP_FATAL_STREAM(this->get_logger(), "Failed to update graph with transaction: " << ex.what()
+                                                                 << "\nLeaving optimization loop and requesting "
+                                                                    "node shutdown...\n" << oss.str());
+    rclcpp::shutdown();
+    return false;
+  }
+  end_stage(timings.update_graph, allocations.update_graph);
+  // Optimize the entire graph
+  summary_ = graph_->optimize(params_.solver_options);
+  end_stage(timings.optimize, allocations.optimize);
+
+  // Optimization is complete. Notify all the things about the graph changes.
+  const auto new_transaction_stamp = new_transaction->stamp();
+  notify(std::move(new_transaction), graph_->clone());
+  end_stage(timings.notify, allocations.notify);
+
+  // Abort if optimization failed. Not converging is not a failure because the solution found is usable.
+  if (!summary_.IsSolutionUsable())
+  {
+    RCLCPP_FATAL_STREAM(get_logger(), "Optimization failed after updating the graph with the transaction with timestamp "
+                      << new_transaction_stamp << ". Leaving optimization loop and requesting node shutdown...");
+    RCLCPP_INFO(get_logger(), summary_.FullReport().c_str());
+    rclcpp::shutdown();
+    return false;
+  }
 
-      // Abort if optimization failed. Not converging is not a failure because the solution found is usable.
-      if (!summary_.IsSolutionUsable())
-      {
-        RCLCPP_FATAL_STREAM(get_logger(), "Optimization failed after updating the graph with the transaction with timestamp "
-                          << new_transaction_stamp << ". Leaving optimization loop and requesting node shutdown...");
-        RCLCPP_INFO(get_logger(), summary_.FullReport().c_str());
-        rclcpp::shutdown();
-        break;
-      }
+  // Compute a transaction that marginalizes out those variables.
+  lag_expiration_ = computeLagExpirationTime();
+  marginal_transaction_ = fuse_constraints::marginalizeVariables(
+    get_name(),
+    computeVariablesToMarginalize(lag_expiration_),
+    *graph_);
+  // Perform any post-marginal cleanup
+  postprocessMarginalization(marginal_transaction_);
+  end_stage(timings.marginalize, allocations.marginalize);
+  cycle_timings_ = timings;
+  cycle_allocations_ = allocations;
+  // Note: The marginal transaction will not be applied until the next optimization iteration
+  // Log a warning if the optimization took too long
+  auto optimization_complete = fuse_core::stamp_from_ros(get_clock()->now());  // XXX use the timestamp tracking to tell the robot time
+  if (optimization_deadline.initialised() && optimization_complete > optimization_deadline)
+  {
+    auto clk = rclcpp::Clock(RCL_SYSTEM_TIME);
+    RCLCPP_WARN_STREAM_THROTTLE(get_logger(), clk, 10.0, "Optimization exceeded the configured duration by "
+                                       << std::chrono::duration<double>(optimization_complete - optimization_deadline).count() << "s");
+  }
+  return true;
+}
 
-      // Compute a transaction that marginalizes out those variables.
-      lag_expiration_ = computeLagExpirationTime();
-      marginal_transaction_ = fuse_constraints::marginalizeVariables(
-        get_name(),
-        computeVariablesToMarginalize(lag_expiration_),
-        *graph_);
-      // Perform any post-marginal cleanup
-      postprocessMarginalization(marginal_transaction_);
-      // Note: The marginal transaction will not be applied until the next optimization iteration
-      // Log a warning if the optimization took too long
-      auto optimization_complete = fuse_core::stamp_from_ros(get_clock()->now());  // XXX use the timestamp tracking to tell the robot time
-      if (optimization_complete > optimization_deadline)
-      {
-        auto clk = rclcpp::Clock(RCL_SYSTEM_TIME);
-        RCLCPP_WARN_STREAM_THROTTLE(get_logger(), clk, 10.0, "Optimization exceeded the configured duration by "
-                                           << std::chrono::duration<double>(optimization_complete - optimization_deadline).count() << "s");
-      }
+void FixedLagSmoother::optimizePending()
+{
+  // Mirror the checks of the optimizer timer, but run the optimization cycle on the calling thread
+  if (!started_)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(pending_transactions_mutex_);
+    if (pending_transactions_.empty())
+    {
+      return;
     }
   }
+  std::lock_guard<std::mutex> lock(optimization_mutex_);
+  optimizationCycle(fuse_core::TimeStamp());
 }
 
 void FixedLagSmoother::optimizerTimerCallback()
@@ -585,11 +638,15 @@ void FixedLagSmoother::setDiagnostics(diagnostic_updater::DiagnosticStatusWrappe
   {
     // Add some optimization summary report fields to the diagnostics status if the optimizer has started
     auto summary = decltype(summary_)();
+    auto cycle_timings = CycleTimings();
+    auto cycle_allocations = CycleAllocations();
     {
       const std::unique_lock<std::mutex> lock(optimization_mutex_, std::try_to_lock);
       if (lock)
       {
         summary = summary_;
+        cycle_timings = cycle_timings_;
+        cycle_allocations = cycle_allocations_;
       }
       else
       {
@@ -604,6 +661,28 @@ void FixedLagSmoother::setDiagnostics(diagnostic_updater::DiagnosticStatusWrappe
       status.add("Optimization Iterations", summary.iterations.size());
       status.add("Initial Cost", summary.initial_cost);
       status.add("Final Cost", summary.final_cost);
+      status.add("Process Queue Time [s]", std::chrono::duration<double>(cycle_timings.process_queue).count());
+      status.add("Update Graph Time [s]", std::chrono::duration<double>(cycle_timings.update_graph).count());
+      status.add("Optimize Time [s]", std::chrono::duration<double>(cycle_timings.optimize).count());
+      status.add("Notify Time [s]", std::chrono::duration<double>(cycle_timings.notify).count());
+      status.add("Marginalize Time [s]", std::chrono::duration<double>(cycle_timings.marginalize).count());
+
+      if (fuse_core::allocationCountingEnabled())
+      {
+        // Without the malloc hooks, only the operator new share of the allocations is counted
+        const std::string allocator =
+          (fuse_core::allocationCounting() == fuse_core::AllocationCounting::MALLOC) ? "Heap" : "Operator New";
+        auto add_allocations = [&status, &allocator](const std::string& stage, const fuse_core::AllocationCount& count)
+        {
+          status.add(stage + " " + allocator + " Allocations", count.allocations);
+          status.add(stage + " " + allocator + " Allocated Bytes", count.bytes);
+        };  // NOLINT(whitespace/braces)
+        add_allocations("Process Queue", cycle_allocations.process_queue);
+        add_allocations("Update Graph", cycle_allocations.update_graph);
+        add_allocations("Optimize", cycle_allocations.optimize);
+        add_allocations("Notify", cycle_allocations.notify);
+        add_allocations("Marginalize", cycle_allocations.marginalize);
+      }
 
       status.mergeSummary(terminationTypeToDiagnosticStatus(summary.termination_type));
     }
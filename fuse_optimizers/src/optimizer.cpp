@@ -32,8 +32,11 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <fuse_core/callback_wrapper.h>
+#include <fuse_core/covariance_blocks.h>
 #include <fuse_core/graph.h>
+#include <fuse_core/time.h>
 #include <fuse_core/transaction.h>
+#include <fuse_core/transaction_log.h>
 #include <fuse_core/uuid.h>
 #include <fuse_optimizers/optimizer.h>
 #include <fuse_graphs/hash_graph.h>
@@ -41,6 +44,7 @@
 //#include <XmlRpcValue.h>
 
 #include <functional>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
@@ -73,6 +77,16 @@ Optimizer::Optimizer(
   diagnostic_updater_.add(this->get_namespace(), this, &Optimizer::setDiagnostics);
   diagnostic_updater_.setHardwareID("fuse");
 
+  // Record the received transactions, if requested. This must be ready before the sensor models are started.
+  rcl_interfaces::msg::ParameterDescriptor transaction_log_descr;
+  transaction_log_descr.description = "the file the received sensor transactions are appended to, or empty to disable";
+  const auto transaction_log = this->declare_parameter("transaction_log", std::string(), transaction_log_descr);
+  if (!transaction_log.empty())
+  {
+    transaction_log_ = std::make_unique<fuse_core::TransactionLogWriter>(transaction_log);
+    RCLCPP_INFO_STREAM(this->get_logger(), "Recording the received transactions in '" << transaction_log << "'.");
+  }
+
   // Load all configured plugins
   loadMotionModels();
   loadSensorModels();
@@ -442,6 +456,40 @@ bool Optimizer::applyMotionModels(
   return success;
 }
 
+fuse_core::CovarianceBlocks::ConstSharedPtr Optimizer::computeCovarianceRequests(
+  const fuse_core::Transaction& transaction,
+  const fuse_core::Graph& graph)
+{
+  std::vector<fuse_core::CovarianceBlocks::Request> requests;
+  for (const auto& name__publisher : publishers_)
+  {
+    try
+    {
+      name__publisher.second->covarianceRequests(transaction, graph, requests);
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR_STREAM(this->get_logger(), "Failed calling covarianceRequests() on publisher '" <<
+                       name__publisher.first << "'. Error: " << e.what());
+      continue;
+    }
+  }
+  if (requests.empty())
+  {
+    return nullptr;
+  }
+  try
+  {
+    return fuse_core::CovarianceBlocks::compute(requests, graph);
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR_STREAM(this->get_logger(), "Failed to compute the requested covariance blocks. Publishers will " <<
+                     "compute their own covariance. Error: " << e.what());
+    return nullptr;
+  }
+}
+
 void Optimizer::notify(
   fuse_core::Transaction::ConstSharedPtr transaction,
   fuse_core::Graph::ConstSharedPtr graph)
@@ -472,11 +520,13 @@ void Optimizer::notify(
       continue;
     }
   }
+  // Publishers opt in to the shared covariance computation, as it delays every publisher and the next cycle
+  auto covariance_blocks = computeCovarianceRequests(*transaction, *graph);
   for (const auto& name__publisher : publishers_)
   {
     try
     {
-      name__publisher.second->notify(transaction, graph);
+      name__publisher.second->notify(transaction, graph, covariance_blocks);
     }
     catch (const std::exception& e)
     {
@@ -496,9 +546,41 @@ void Optimizer::injectCallback(
   // This returns execution to the sensor's thread quickly by moving the transaction processing to the optimizer's
   // thread. And by using the existing ROS callback queue, we simplify the threading model of the optimizer.
 
-  auto callback = std::make_shared<fuse_core::CallbackWrapper<void>>(
-      std::bind(&Optimizer::transactionCallback, this, sensor_name, std::move(transaction)));
-  callback_queue_->addCallback(callback);
+  // Record the transaction as it arrived, before the optimizer or the motion models get to modify it
+  if (transaction_log_ && !transaction_log_failed_)
+  {
+    try
+    {
+      transaction_log_->write(sensor_name, *transaction, fuse_core::stamp_from_ros(get_clock()->now()));
+    }
+    catch (const std::exception& e)
+    {
+      // A failed stream fails every later write as well, so stop recording instead of reporting each transaction
+      if (!transaction_log_failed_.exchange(true))
+      {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Failed to record the transaction from sensor '" << sensor_name <<
+                         "'. Recording is disabled. Error: " << e.what());
+      }
+    }
+  }
+
+  callback_queue_->postCallback(
+    [this, sensor_name, transaction = std::move(transaction)]()
+    {
+      transactionCallback(sensor_name, transaction);
+    });  // NOLINT(whitespace/braces)
+}
+
+void Optimizer::replayTransaction(
+  const std::string& sensor_name,
+  fuse_core::Transaction::SharedPtr transaction)
+{
+  transactionCallback(sensor_name, std::move(transaction));
+}
+
+void Optimizer::optimizePending()
+{
+  throw std::logic_error("This optimizer does not support synchronous optimization.");
 }
 
 void Optimizer::clearCallbacks()
@@ -0,0 +1,197 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/time.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/transaction_deserializer.h>
+#include <fuse_core/transaction_log.h>
+#include <fuse_optimizers/batch_optimizer.h>
+#include <fuse_optimizers/fixed_lag_smoother.h>
+#include <fuse_optimizers/optimizer.h>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * @brief A transaction log record, decoded ahead of the replay so decoding is not part of the measured time
+ */
+struct Record
+{
+  std::string sensor_name;
+  fuse_core::TimeStamp arrival_time;
+  fuse_core::Transaction::SharedPtr transaction;
+};
+
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " <fixed_lag_smoother|batch_optimizer> <transaction log> "
+            << "--ros-args --params-file <optimizer config>\n"
+            << "\n"
+            << "Replays a transaction log recorded with the optimizer 'transaction_log' parameter as fast as\n"
+            << "possible. The optimizer timer is replaced by the arrival times of the recorded transactions: an\n"
+            << "optimization cycle runs whenever a transaction arrives one 'optimization_period' or more after the\n"
+            << "previous cycle was due. The optimizer must be configured with the sensor and motion models used for\n"
+            << "the recording.\n";
+}
+
+}  // namespace
+
+/**
+ * @brief Replay a transaction log into a FixedLagSmoother or BatchOptimizer, without wall timers
+ *
+ * All transactions are handled on the main thread and the node is never spun, so a replay only depends on the log
+ * and the optimizer configuration. This allows optimizer changes to be regression-tested and profiled offline.
+ */
+int main(int argc, char **argv)
+{
+  rclcpp::init(argc, argv);
+  const auto args = rclcpp::remove_ros_arguments(argc, argv);
+  if (args.size() != 3 || (args[1] != "fixed_lag_smoother" && args[1] != "batch_optimizer"))
+  {
+    printUsage(argv[0]);
+    rclcpp::shutdown();
+    return EXIT_FAILURE;
+  }
+
+  // The deserializer loads the variable and constraint libraries, so it must outlive the optimizer graph
+  fuse_core::TransactionDeserializer deserializer;
+  std::vector<Record> records;
+  auto log_truncated = false;
+  try
+  {
+    fuse_core::TransactionLogReader reader(args[2]);
+    fuse_core::TransactionLogEntry entry;
+    while (reader.next(entry))
+    {
+      records.push_back(
+        { entry.sensor_name, entry.arrival_time,
+          fuse_core::Transaction::make_shared(deserializer.deserialize(entry.data)) });  // NOLINT(whitespace/braces)
+    }
+    log_truncated = reader.truncated();
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "Failed to read the transaction log: " << ex.what() << "\n";
+    rclcpp::shutdown();
+    return EXIT_FAILURE;
+  }
+  if (log_truncated)
+  {
+    std::cerr << "The transaction log ends with a partially written record, which is ignored.\n";
+  }
+
+  rclcpp::NodeOptions options;
+  fuse_optimizers::Optimizer::SharedPtr optimizer;
+  if (args[1] == "fixed_lag_smoother")
+  {
+    optimizer = std::make_shared<fuse_optimizers::FixedLagSmoother>(options);
+  }
+  else
+  {
+    optimizer = std::make_shared<fuse_optimizers::BatchOptimizer>(options);
+  }
+  const auto optimization_period = fuse_core::fromSec(optimizer->get_parameter("optimization_period").as_double());
+
+  using Clock = std::chrono::steady_clock;
+  auto optimization_count = size_t{0};
+  auto optimize_time = Clock::duration::zero();
+  auto max_optimize_time = Clock::duration::zero();
+  auto optimize = [&]()
+  {
+    const auto start = Clock::now();
+    optimizer->optimizePending();
+    const auto elapsed = Clock::now() - start;
+    optimize_time += elapsed;
+    max_optimize_time = std::max(max_optimize_time, elapsed);
+    ++optimization_count;
+  };  // NOLINT(whitespace/braces)
+
+  const auto start = Clock::now();
+  auto next_optimization = fuse_core::TimeStamp();
+  for (auto& record : records)
+  {
+    if (!rclcpp::ok())
+    {
+      break;
+    }
+    if (!next_optimization.initialised())
+    {
+      next_optimization = record.arrival_time + optimization_period;
+    }
+    else if (record.arrival_time >= next_optimization)
+    {
+      optimize();
+      // Keep the phase of the optimizer timer, skipping the periods that did not receive any transactions
+      const auto periods = (record.arrival_time - next_optimization) / optimization_period + 1;
+      next_optimization = next_optimization + periods * optimization_period;
+    }
+    optimizer->replayTransaction(record.sensor_name, std::move(record.transaction));
+  }
+  if (rclcpp::ok())
+  {
+    optimize();
+  }
+  const auto total_time = Clock::now() - start;
+
+  const auto seconds = [](const Clock::duration& duration)
+  {
+    return std::chrono::duration<double>(duration).count();
+  };  // NOLINT(whitespace/braces)
+  const auto recorded_time = records.empty() ?
+    0.0 : fuse_core::toSec(records.back().arrival_time - records.front().arrival_time);
+
+  std::cout << "transactions:   " << records.size() << "\n"
+            << "recorded time:  " << recorded_time << " s\n"
+            << "replay time:    " << seconds(total_time) << " s (" << recorded_time / seconds(total_time)
+            << "x real time)\n"
+            << "optimizations:  " << optimization_count << "\n"
+            << "  optimize:     " << seconds(optimize_time) << " s (max " << seconds(max_optimize_time) << " s)\n";
+
+  // The optimization threads only exit once ROS is shut down
+  const auto success = rclcpp::ok();
+  rclcpp::shutdown();
+  optimizer.reset();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -80,19 +80,19 @@ void VariableStampIndex::addMarginalTransaction(const fuse_core::Transaction& tr
 
 void VariableStampIndex::applyAddedConstraints(const fuse_core::Transaction& transaction)
 {
-  for (const auto& constraint : transaction.addedConstraints())
+  transaction.forEachAddedConstraint([this](const fuse_core::Constraint& constraint)
   {
     constraints_[constraint.uuid()].insert(constraint.variables().begin(), constraint.variables().end());
     for (const auto& variable_uuid : constraint.variables())
     {
       variables_[variable_uuid].insert(constraint.uuid());
     }
-  }
+  });  // NOLINT(whitespace/braces)
 }
 
 void VariableStampIndex::applyAddedVariables(const fuse_core::Transaction& transaction)
 {
-  for (const auto& variable : transaction.addedVariables())
+  transaction.forEachAddedVariable([this](const fuse_core::Variable& variable)
   {
     auto stamped_variable = dynamic_cast<const fuse_variables::Stamped*>(&variable);
     if (stamped_variable)
@@ -100,7 +100,7 @@ void VariableStampIndex::applyAddedVariables(const fuse_core::Transaction& trans
       stamped_index_[variable.uuid()] = stamped_variable->stamp();
     }
     variables_[variable.uuid()];  // Add an empty set of constraints
-  }
+  });  // NOLINT(whitespace/braces)
 }
 
 void VariableStampIndex::applyRemovedConstraints(const fuse_core::Transaction& transaction)
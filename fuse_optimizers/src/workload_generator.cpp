@@ -0,0 +1,390 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_optimizers/workload_generator.h>
+
+#include <fuse_constraints/absolute_constraint.h>
+#include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_core/eigen.h>
+#include <fuse_core/util.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/point_2d_landmark.h>
+#include <fuse_variables/position_2d_stamped.h>
+
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace fuse_optimizers
+{
+
+namespace
+{
+
+/**
+ * @brief Convert a time in seconds since the epoch into a stamp, with nanosecond resolution
+ */
+fuse_core::TimeStamp toStamp(const double seconds)
+{
+  return fuse_core::TimeStamp(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(
+    std::chrono::nanoseconds(std::llround(seconds * 1e9))));
+}
+
+}  // namespace
+
+void WorkloadGeneratorParams::set(const std::string& name, const std::string& value)
+{
+  const std::unordered_map<std::string, double*> double_params =
+  {
+    {"start_time", &start_time},
+    {"duration", &duration},
+    {"site_width", &site_width},
+    {"robot_velocity", &robot_velocity},
+    {"beacon_sigma", &beacon_sigma},
+    {"odometry_rate", &odometry_rate},
+    {"odometry_position_sigma", &odometry_position_sigma},
+    {"odometry_yaw_sigma", &odometry_yaw_sigma},
+    {"range_limit", &range_limit},
+    {"range_sigma", &range_sigma},
+    {"outlier_fraction", &outlier_fraction}
+  };  // NOLINT(whitespace/braces)
+  const std::unordered_map<std::string, size_t*> size_params =
+  {
+    {"robot_count", &robot_count},
+    {"beacon_count", &beacon_count},
+    {"range_decimation", &range_decimation}
+  };  // NOLINT(whitespace/braces)
+
+  try
+  {
+    if (name == "seed")
+    {
+      seed = std::stoul(value);
+      return;
+    }
+
+    const auto double_param = double_params.find(name);
+    if (double_param != double_params.end())
+    {
+      *double_param->second = std::stod(value);
+      return;
+    }
+
+    const auto size_param = size_params.find(name);
+    if (size_param != size_params.end())
+    {
+      *size_param->second = std::stoul(value);
+      return;
+    }
+  }
+  catch (const std::logic_error&)
+  {
+    throw std::invalid_argument("Invalid value '" + value + "' for the workload parameter '" + name + "'.");
+  }
+
+  throw std::invalid_argument("Unknown workload parameter '" + name + "'.");
+}
+
+void WorkloadGeneratorParams::validate() const
+{
+  if (duration < 0.0)
+  {
+    throw std::invalid_argument("The workload duration must be non-negative.");
+  }
+  if (site_width <= 0.0)
+  {
+    throw std::invalid_argument("The workload site_width must be positive.");
+  }
+  if (robot_count == 0)
+  {
+    throw std::invalid_argument("The workload robot_count must be positive.");
+  }
+  if (robot_velocity <= 0.0)
+  {
+    throw std::invalid_argument("The workload robot_velocity must be positive.");
+  }
+  if (odometry_rate <= 0.0)
+  {
+    throw std::invalid_argument("The workload odometry_rate must be positive.");
+  }
+  if (range_decimation == 0)
+  {
+    throw std::invalid_argument("The workload range_decimation must be positive.");
+  }
+  if (beacon_sigma <= 0.0 || odometry_position_sigma <= 0.0 || odometry_yaw_sigma <= 0.0 || range_sigma <= 0.0)
+  {
+    throw std::invalid_argument("The workload standard deviations must be positive.");
+  }
+  if (range_limit <= 0.0)
+  {
+    throw std::invalid_argument("The workload range_limit must be positive.");
+  }
+  if (outlier_fraction < 0.0 || outlier_fraction > 1.0)
+  {
+    throw std::invalid_argument("The workload outlier_fraction must be in the [0, 1] range.");
+  }
+}
+
+WorkloadGenerator::WorkloadGenerator(
+  const WorkloadGeneratorParams& params,
+  RangeConstraintFactory range_constraint_factory) :
+    params_(params),
+    range_constraint_factory_(std::move(range_constraint_factory)),
+    generator_(params.seed)
+{
+  params_.validate();
+  if (!range_constraint_factory_)
+  {
+    throw std::invalid_argument("The workload generator requires a range constraint factory.");
+  }
+
+  // Place the beacons uniformly at random within the site, and create the noisy priors of their positions
+  const auto half_width = params_.site_width / 2;
+  beacons_.reserve(params_.beacon_count);
+  noisy_beacons_.reserve(params_.beacon_count);
+  for (size_t id = 0; id < params_.beacon_count; ++id)
+  {
+    const auto x = uniform(-half_width, half_width);
+    const auto y = uniform(-half_width, half_width);
+    beacons_.push_back({x, y});  // NOLINT(whitespace/braces)
+    const auto noisy_x = x + normal(params_.beacon_sigma);
+    const auto noisy_y = y + normal(params_.beacon_sigma);
+    noisy_beacons_.push_back({noisy_x, noisy_y});  // NOLINT(whitespace/braces)
+  }
+  beacon_initialized_.assign(params_.beacon_count, false);
+
+  // Spread the robot circles between half and all of the tutorial robot path radius, and their starting phases
+  // evenly around the circle, so the robots do not drive on top of each other
+  const auto max_radius = 0.35 * params_.site_width;
+  robots_.resize(params_.robot_count);
+  for (size_t i = 0; i < params_.robot_count; ++i)
+  {
+    auto& robot = robots_[i];
+    const auto name = "robot_" + std::to_string(i);
+    robot.odometry_name = name + "/odometry";
+    robot.ranges_name = name + "/ranges";
+    robot.device_id = fuse_core::uuid::generate(name);
+    robot.radius = params_.robot_count == 1 ?
+      max_radius :
+      max_radius * (0.5 + 0.5 * static_cast<double>(i) / (params_.robot_count - 1));
+    robot.phase = 2.0 * M_PI * static_cast<double>(i) / params_.robot_count;
+  }
+}
+
+void WorkloadGenerator::generate(const TransactionCallback& callback)
+{
+  const auto step_count = static_cast<size_t>(std::floor(params_.duration * params_.odometry_rate));
+
+  auto previous_stamp = toStamp(params_.start_time);
+  for (size_t step = 0; step <= step_count; ++step)
+  {
+    const auto t = step / params_.odometry_rate;
+    const auto stamp = toStamp(params_.start_time + t);
+
+    for (auto& robot : robots_)
+    {
+      const auto previous = robot;
+      moveRobot(robot, t);
+
+      // The previous stamp of the first step is the stamp itself, which marks the first pose of the robot
+      callback(robot.odometry_name, createOdometryTransaction(previous, robot, previous_stamp, stamp));
+
+      if (step % params_.range_decimation == 0)
+      {
+        auto transaction = createRangeTransaction(robot, stamp);
+        if (transaction)
+        {
+          callback(robot.ranges_name, std::move(transaction));
+        }
+      }
+    }
+
+    previous_stamp = stamp;
+  }
+}
+
+void WorkloadGenerator::moveRobot(Robot& robot, const double t) const
+{
+  const auto theta = robot.phase + t * params_.robot_velocity / robot.radius;
+  robot.x = robot.radius * std::cos(theta);
+  robot.y = robot.radius * std::sin(theta);
+  robot.yaw = fuse_core::wrapAngle2D(theta + M_PI / 2);
+}
+
+fuse_core::Transaction::SharedPtr WorkloadGenerator::createOdometryTransaction(
+  const Robot& previous,
+  Robot& robot,
+  const fuse_core::TimeStamp& previous_stamp,
+  const fuse_core::TimeStamp& stamp)
+{
+  auto transaction = fuse_core::Transaction::make_shared();
+  transaction->stamp(stamp);
+  transaction->addInvolvedStamp(stamp);
+
+  auto position = fuse_variables::Position2DStamped::make_shared(stamp, robot.device_id);
+  auto orientation = fuse_variables::Orientation2DStamped::make_shared(stamp, robot.device_id);
+  transaction->addVariable(position);
+  transaction->addVariable(orientation);
+
+  if (stamp == previous_stamp)
+  {
+    // The first pose of each robot starts at, and gets a prior on, its true value, which anchors the robot trajectory
+    robot.estimate_x = robot.x;
+    robot.estimate_y = robot.y;
+    robot.estimate_yaw = robot.yaw;
+
+    position->x() = robot.x;
+    position->y() = robot.y;
+    orientation->yaw() = robot.yaw;
+
+    fuse_core::Vector3d mean;
+    mean << robot.x, robot.y, robot.yaw;
+    const fuse_core::Matrix3d covariance = fuse_core::Vector3d(0.01, 0.01, 0.01).asDiagonal();
+    transaction->addConstraint(fuse_constraints::AbsolutePose2DStampedConstraint::make_shared(
+      robot.odometry_name, *position, *orientation, mean, covariance));
+    return transaction;
+  }
+
+  // Measure the noisy pose change since the previous stamp, in the frame of the previous pose
+  const auto dx = robot.x - previous.x;
+  const auto dy = robot.y - previous.y;
+  const auto cos_yaw = std::cos(previous.yaw);
+  const auto sin_yaw = std::sin(previous.yaw);
+  // The noise is drawn in separate statements, as the evaluation order of the comma initializer is unspecified
+  const auto x_noise = normal(params_.odometry_position_sigma);
+  const auto y_noise = normal(params_.odometry_position_sigma);
+  const auto yaw_noise = normal(params_.odometry_yaw_sigma);
+  fuse_core::Vector3d delta;
+  delta << cos_yaw * dx + sin_yaw * dy + x_noise,
+           -sin_yaw * dx + cos_yaw * dy + y_noise,
+           fuse_core::wrapAngle2D(robot.yaw - previous.yaw + yaw_noise);
+  const fuse_core::Matrix3d covariance = fuse_core::Vector3d(
+    params_.odometry_position_sigma * params_.odometry_position_sigma,
+    params_.odometry_position_sigma * params_.odometry_position_sigma,
+    params_.odometry_yaw_sigma * params_.odometry_yaw_sigma).asDiagonal();
+
+  auto previous_position = fuse_variables::Position2DStamped::make_shared(previous_stamp, robot.device_id);
+  auto previous_orientation = fuse_variables::Orientation2DStamped::make_shared(previous_stamp, robot.device_id);
+  previous_position->x() = previous.estimate_x;
+  previous_position->y() = previous.estimate_y;
+  previous_orientation->yaw() = previous.estimate_yaw;
+  transaction->addInvolvedStamp(previous_stamp);
+  transaction->addVariable(previous_position);
+  transaction->addVariable(previous_orientation);
+
+  transaction->addConstraint(fuse_constraints::RelativePose2DStampedConstraint::make_shared(
+    robot.odometry_name, *previous_position, *previous_orientation, *position, *orientation, delta, covariance));
+
+  // Start the new pose at the dead-reckoned estimate, so the optimizer has to correct the odometry drift
+  const auto cos_estimate_yaw = std::cos(previous.estimate_yaw);
+  const auto sin_estimate_yaw = std::sin(previous.estimate_yaw);
+  robot.estimate_x = previous.estimate_x + cos_estimate_yaw * delta.x() - sin_estimate_yaw * delta.y();
+  robot.estimate_y = previous.estimate_y + sin_estimate_yaw * delta.x() + cos_estimate_yaw * delta.y();
+  robot.estimate_yaw = fuse_core::wrapAngle2D(previous.estimate_yaw + delta.z());
+  position->x() = robot.estimate_x;
+  position->y() = robot.estimate_y;
+  orientation->yaw() = robot.estimate_yaw;
+
+  return transaction;
+}
+
+fuse_core::Transaction::SharedPtr WorkloadGenerator::createRangeTransaction(
+  const Robot& robot,
+  const fuse_core::TimeStamp& stamp)
+{
+  auto transaction = fuse_core::Transaction::make_shared();
+  transaction->stamp(stamp);
+  transaction->addInvolvedStamp(stamp);
+
+  auto position = fuse_variables::Position2DStamped::make_shared(stamp, robot.device_id);
+  position->x() = robot.estimate_x;
+  position->y() = robot.estimate_y;
+  transaction->addVariable(position);
+
+  auto measured = false;
+  for (size_t id = 0; id < beacons_.size(); ++id)
+  {
+    const auto& beacon = beacons_[id];
+    const auto range = std::hypot(robot.x - beacon.x, robot.y - beacon.y);
+    if (range > params_.range_limit)
+    {
+      continue;
+    }
+
+    const auto& noisy_beacon = noisy_beacons_[id];
+    auto beacon_position = fuse_variables::Point2DLandmark::make_shared(id);
+    beacon_position->x() = noisy_beacon.x;
+    beacon_position->y() = noisy_beacon.y;
+    transaction->addVariable(beacon_position);
+
+    const auto is_outlier = uniform(0.0, 1.0) < params_.outlier_fraction;
+    const auto z = is_outlier ? uniform(0.0, std::sqrt(2.0) * params_.site_width) : range + normal(params_.range_sigma);
+    transaction->addConstraint(
+      range_constraint_factory_(robot.ranges_name, *position, *beacon_position, z, params_.range_sigma));
+
+    if (!beacon_initialized_[id])
+    {
+      const fuse_core::Vector2d mean(noisy_beacon.x, noisy_beacon.y);
+      const fuse_core::Matrix2d covariance =
+        fuse_core::Vector2d::Constant(params_.beacon_sigma * params_.beacon_sigma).asDiagonal();
+      transaction->addConstraint(fuse_constraints::AbsoluteConstraint<fuse_variables::Point2DLandmark>::make_shared(
+        robot.ranges_name, *beacon_position, mean, covariance));
+      beacon_initialized_[id] = true;
+    }
+
+    measured = true;
+  }
+
+  return measured ? transaction : nullptr;
+}
+
+double WorkloadGenerator::uniform(const double min, const double max)
+{
+  // The 53 high bits of the 64 bit output fill the mantissa of a double in [0, 1) exactly
+  const auto unit = std::ldexp(static_cast<double>(generator_() >> 11), -53);
+  return min + unit * (max - min);
+}
+
+double WorkloadGenerator::normal(const double sigma)
+{
+  // Box-Muller transform. The first sample is taken from (0, 1] so the logarithm is finite.
+  const auto u1 = 1.0 - uniform(0.0, 1.0);
+  const auto u2 = uniform(0.0, 1.0);
+  return sigma * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+}  // namespace fuse_optimizers
@@ -0,0 +1,251 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_constraints/absolute_constraint.h>
+#include <fuse_constraints/absolute_pose_2d_stamped_constraint.h>
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_core/constraint.h>
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_optimizers/workload_generator.h>
+#include <fuse_variables/point_2d_landmark.h>
+#include <fuse_variables/position_2d_stamped.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * @brief The content of a generated transaction, without the random UUIDs of its constraints
+ */
+struct TransactionRecord
+{
+  std::string sensor_name;
+  int64_t stamp;
+  std::vector<fuse_core::UUID> variables;  //!< The UUIDs of the added variables, and of each constraint's variables
+  std::vector<double> values;  //!< The initial variable values, followed by the measured values of the constraints
+  std::vector<std::string> constraints;  //!< The type and source of each added constraint
+
+  bool operator==(const TransactionRecord& other) const
+  {
+    return sensor_name == other.sensor_name && stamp == other.stamp && variables == other.variables &&
+           values == other.values && constraints == other.constraints;
+  }
+};
+
+/**
+ * @brief A range measurement received by the range constraint factory
+ */
+struct RangeRecord
+{
+  std::string source;
+  fuse_core::UUID robot_position;
+  fuse_core::UUID beacon_position;
+  double z;
+  double sigma;
+
+  bool operator==(const RangeRecord& other) const
+  {
+    return source == other.source && robot_position == other.robot_position &&
+           beacon_position == other.beacon_position && z == other.z && sigma == other.sigma;
+  }
+};
+
+/**
+ * @brief The transactions and range measurements of a generated workload
+ */
+struct Workload
+{
+  std::vector<fuse_optimizers::WorkloadGenerator::Beacon> beacons;
+  std::vector<TransactionRecord> transactions;
+  std::vector<RangeRecord> ranges;
+};
+
+/**
+ * @brief Run a generator with the provided params to completion, and record everything it creates
+ */
+Workload generateWorkload(const fuse_optimizers::WorkloadGeneratorParams& params)
+{
+  Workload workload;
+
+  // The generator does not depend on the range constraint type. A beacon prior stands in for the range constraint
+  // here, and the measurement itself is recorded.
+  auto range_constraint_factory = [&workload](
+    const std::string& source,
+    const fuse_variables::Position2DStamped& robot_position,
+    const fuse_variables::Point2DLandmark& beacon_position,
+    const double z,
+    const double sigma) -> fuse_core::Constraint::SharedPtr
+  {
+    workload.ranges.push_back({source, robot_position.uuid(), beacon_position.uuid(), z, sigma});  // NOLINT
+    return fuse_constraints::AbsoluteConstraint<fuse_variables::Point2DLandmark>::make_shared(
+      source,
+      beacon_position,
+      fuse_core::Vector2d(z, 0.0),
+      fuse_core::Matrix2d::Identity() * sigma * sigma);
+  };  // NOLINT(whitespace/braces)
+
+  fuse_optimizers::WorkloadGenerator generator(params, range_constraint_factory);
+  workload.beacons = workload.beacons;
+  generator.generate(
+    [&workload](const std::string& sensor_name, fuse_core::Transaction::SharedPtr transaction)
+    {
+      TransactionRecord record;
+      record.sensor_name = sensor_name;
+      record.stamp = transaction->stamp().time_since_epoch().count();
+      for (const auto& variable : transaction->addedVariables())
+      {
+        record.variables.push_back(variable.uuid());
+        record.values.insert(record.values.end(), variable.data(), variable.data() + variable.size());
+      }
+      for (const auto& constraint : transaction->addedConstraints())
+      {
+        record.constraints.push_back(constraint.type() + " " + constraint.source());
+        record.variables.insert(record.variables.end(), constraint.variables().begin(), constraint.variables().end());
+
+        if (auto relative = dynamic_cast<const fuse_constraints::RelativePose2DStampedConstraint*>(&constraint))
+        {
+          record.values.insert(record.values.end(), relative->delta().data(), relative->delta().data() + 3);
+        }
+        else if (auto absolute = dynamic_cast<const fuse_constraints::AbsolutePose2DStampedConstraint*>(&constraint))
+        {
+          record.values.insert(record.values.end(), absolute->mean().data(), absolute->mean().data() + 3);
+        }
+        else if (auto beacon =
+          dynamic_cast<const fuse_constraints::AbsoluteConstraint<fuse_variables::Point2DLandmark>*>(&constraint))
+        {
+          record.values.insert(record.values.end(), beacon->mean().data(), beacon->mean().data() + 2);
+        }
+      }
+      workload.transactions.push_back(std::move(record));
+    });  // NOLINT(whitespace/braces)
+
+  return workload;
+}
+
+/**
+ * @brief A workload with several robots, limited range, and outliers, so every random draw is exercised
+ */
+fuse_optimizers::WorkloadGeneratorParams busyParams()
+{
+  fuse_optimizers::WorkloadGeneratorParams params;
+  params.seed = 42;
+  params.duration = 5.0;
+  params.robot_count = 3;
+  params.beacon_count = 50;
+  params.range_decimation = 2;
+  params.range_limit = 40.0;
+  params.outlier_fraction = 0.2;
+  return params;
+}
+
+}  // namespace
+
+TEST(WorkloadGenerator, SameSeed)
+{
+  const auto params = busyParams();
+  const auto expected = generateWorkload(params);
+  const auto actual = generateWorkload(params);
+
+  // 3 robots with 51 odometry transactions each, and 26 range measurement steps each
+  ASSERT_EQ(3u * 51u, static_cast<size_t>(std::count_if(
+    expected.transactions.begin(),
+    expected.transactions.end(),
+    [](const TransactionRecord& record) { return record.sensor_name.find("/odometry") != std::string::npos; })));
+  ASSERT_FALSE(expected.ranges.empty());
+
+  ASSERT_EQ(expected.transactions.size(), actual.transactions.size());
+  for (size_t i = 0; i < expected.transactions.size(); ++i)
+  {
+    EXPECT_TRUE(expected.transactions[i] == actual.transactions[i]) << "transaction " << i;
+  }
+  ASSERT_EQ(expected.ranges.size(), actual.ranges.size());
+  for (size_t i = 0; i < expected.ranges.size(); ++i)
+  {
+    EXPECT_TRUE(expected.ranges[i] == actual.ranges[i]) << "range " << i;
+  }
+}
+
+TEST(WorkloadGenerator, DifferentSeed)
+{
+  auto params = busyParams();
+  const auto expected = generateWorkload(params);
+  params.seed = 43;
+  const auto actual = generateWorkload(params);
+
+  // The trajectories do not depend on the seed, only the noise and the beacons do
+  ASSERT_FALSE(expected.ranges.empty());
+  ASSERT_FALSE(actual.ranges.empty());
+  EXPECT_NE(expected.ranges.front().z, actual.ranges.front().z);
+}
+
+TEST(WorkloadGenerator, KnownValues)
+{
+  // The generator does not use the standard library distributions, whose algorithms are implementation defined. So
+  // the workload of a seed is the same on every platform. The uniform samples are exact. The normal samples go
+  // through std::log and std::cos, which may differ in the last bit.
+  fuse_optimizers::WorkloadGeneratorParams params;
+  params.duration = 0.0;
+  const auto workload = generateWorkload(params);
+
+  ASSERT_EQ(36u, workload.beacons.size());
+  EXPECT_EQ(-34.020663662953922, workload.beacons[0].x);
+  EXPECT_EQ(49.214520962982874, workload.beacons[0].y);
+  EXPECT_EQ(13.152837450995094, workload.beacons[1].x);
+  EXPECT_EQ(-7.6429470146186986, workload.beacons[1].y);
+  EXPECT_EQ(43.043109893667804, workload.beacons[2].x);
+  EXPECT_EQ(-15.561444170606386, workload.beacons[2].y);
+
+  // The robot starts at (35, 0), 84.7698m from the first beacon
+  ASSERT_EQ(36u, workload.ranges.size());
+  EXPECT_EQ("robot_0/ranges", workload.ranges.front().source);
+  EXPECT_EQ(fuse_variables::Point2DLandmark(0).uuid(), workload.ranges.front().beacon_position);
+  EXPECT_NEAR(84.277881742844528, workload.ranges.front().z, 1.0e-9);
+  EXPECT_EQ(0.5, workload.ranges.front().sigma);
+}
+
+TEST(WorkloadGenerator, MissingRangeConstraintFactory)
+{
+  EXPECT_THROW(
+    fuse_optimizers::WorkloadGenerator(fuse_optimizers::WorkloadGeneratorParams(), nullptr),
+    std::invalid_argument);
+}
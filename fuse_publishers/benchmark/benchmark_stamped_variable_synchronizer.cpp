@@ -0,0 +1,144 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_publishers/stamped_variable_synchronizer.h>
+
+#include <fuse_core/transaction.h>
+#include <fuse_core/uuid.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+
+#include <benchmark/benchmark.h>
+
+
+using fuse_publishers::StampedVariableSynchronizer;
+using fuse_variables::Orientation2DStamped;
+using fuse_variables::Position2DStamped;
+
+using Synchronizer = StampedVariableSynchronizer<Orientation2DStamped, Position2DStamped>;
+
+/**
+ * @brief Helper function to add a pose, i.e. an orientation and a position, to a transaction
+ *
+ * @param[in]  seconds   The stamp of the pose, in seconds
+ * @param[in]  device_id The device id of the pose
+ * @param[out] transaction The transaction to add the pose variables to
+ */
+void addPose(const int32_t seconds, const fuse_core::UUID& device_id, fuse_core::Transaction& transaction)
+{
+  transaction.addVariable(Orientation2DStamped::make_shared(ros::Time(seconds, 0), device_id));
+  transaction.addVariable(Position2DStamped::make_shared(ros::Time(seconds, 0), device_id));
+}
+
+/**
+ * @brief Helper function to remove a pose, i.e. an orientation and a position, with a transaction
+ *
+ * @param[in]  seconds   The stamp of the pose, in seconds
+ * @param[in]  device_id The device id of the pose
+ * @param[out] transaction The transaction to remove the pose variables with
+ */
+void removePose(const int32_t seconds, const fuse_core::UUID& device_id, fuse_core::Transaction& transaction)
+{
+  transaction.removeVariable(Orientation2DStamped(ros::Time(seconds, 0), device_id).uuid());
+  transaction.removeVariable(Position2DStamped(ros::Time(seconds, 0), device_id).uuid());
+}
+
+/**
+ * @brief Helper function to populate a graph with a window of poses
+ *
+ * @param[in]  num_poses The number of poses in the window, with stamps 1 to num_poses seconds
+ * @param[in]  device_id The device id of the poses
+ * @param[out] graph     The graph to populate
+ */
+void populateGraph(const int32_t num_poses, const fuse_core::UUID& device_id, fuse_core::Graph& graph)
+{
+  fuse_core::Transaction transaction;
+  for (int32_t i = 1; i <= num_poses; ++i)
+  {
+    addPose(i, device_id, transaction);
+  }
+  graph.update(transaction);
+}
+
+/**
+ * @brief The initial search of a new synchronizer, which scans the whole graph
+ */
+static void BM_findLatestCommonStamp_fullSearch(benchmark::State& state)
+{
+  const auto device_id = fuse_core::uuid::generate("robot");
+  fuse_graphs::HashGraph graph;
+  populateGraph(state.range(0), device_id, graph);
+  const fuse_core::Transaction transaction;
+
+  for (auto _ : state)
+  {
+    Synchronizer synchronizer(device_id);
+    benchmark::DoNotOptimize(synchronizer.findLatestCommonStamp(transaction, graph));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_findLatestCommonStamp_fullSearch)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+/**
+ * @brief Slide the window by one pose per notification, adding the newest pose and removing the oldest one
+ */
+static void BM_findLatestCommonStamp_slidingWindow(benchmark::State& state)
+{
+  const auto device_id = fuse_core::uuid::generate("robot");
+  fuse_graphs::HashGraph graph;
+  const int32_t num_poses = state.range(0);
+  populateGraph(num_poses, device_id, graph);
+
+  Synchronizer synchronizer(device_id);
+  synchronizer.findLatestCommonStamp(fuse_core::Transaction(), graph);
+
+  int32_t oldest = 1;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    fuse_core::Transaction transaction;
+    addPose(oldest + num_poses, device_id, transaction);
+    removePose(oldest, device_id, transaction);
+    graph.update(transaction);
+    ++oldest;
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(synchronizer.findLatestCommonStamp(transaction, graph));
+  }
+}
+
+BENCHMARK(BM_findLatestCommonStamp_slidingWindow)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+BENCHMARK_MAIN();
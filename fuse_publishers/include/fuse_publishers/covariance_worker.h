@@ -0,0 +1,118 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_PUBLISHERS_COVARIANCE_WORKER_H
+#define FUSE_PUBLISHERS_COVARIANCE_WORKER_H
+
+#include <fuse_core/fuse_macros.h>
+#include <rclcpp/logger.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace fuse_publishers
+{
+
+/**
+ * @brief A dedicated thread that executes expensive covariance computations outside of a publisher's notify path
+ *
+ * The worker holds at most one pending job. Submitting a new job while another one is pending replaces (drops) the
+ * pending job, so the worker only ever computes the covariance of the most recent graph snapshot it has been given.
+ * A job that is already running is allowed to finish. Jobs should capture everything they need by value, i.e. the
+ * graph shared pointer and the variable UUIDs, so they operate on the same snapshot used to publish the mean.
+ */
+class CovarianceWorker
+{
+public:
+  FUSE_SMART_PTR_DEFINITIONS(CovarianceWorker)
+
+  using Job = std::function<void()>;
+
+  /**
+   * @brief Constructor. Starts the worker thread.
+   *
+   * @param[in] logger The logger used to report the errors of failed jobs
+   */
+  explicit CovarianceWorker(const rclcpp::Logger& logger = rclcpp::get_logger("fuse_publishers.covariance_worker"));
+
+  /**
+   * @brief Destructor. Drops any pending job, waits for the running job to finish, and joins the worker thread.
+   */
+  ~CovarianceWorker();
+
+  CovarianceWorker(const CovarianceWorker&) = delete;
+  CovarianceWorker& operator=(const CovarianceWorker&) = delete;
+
+  /**
+   * @brief Queue a job for execution, replacing the pending job if there is one
+   *
+   * @param[in] job The job to execute in the worker thread
+   * @return True if a pending job was dropped to make room for this one, false otherwise
+   */
+  bool submit(Job job);
+
+  /**
+   * @brief Drop the pending job, if any, and wait for the running job to finish
+   *
+   * After this returns, no job submitted before the call will be executed or still be running.
+   */
+  void cancel();
+
+  /**
+   * @brief The number of jobs dropped because a newer job was submitted or the worker was cancelled
+   */
+  size_t dropped() const;
+
+private:
+  /**
+   * @brief The worker thread main loop
+   */
+  void run();
+
+  rclcpp::Logger logger_;  //!< Reports the errors of failed jobs
+  mutable std::mutex mutex_;  //!< Guards all of the members below
+  std::condition_variable condition_;  //!< Signals a new job, a finished job, or a stop request
+  Job pending_;  //!< The job waiting to be executed, or empty
+  bool running_;  //!< Flag indicating a job is currently being executed
+  bool stop_;  //!< Flag indicating the worker thread should exit
+  size_t dropped_;  //!< The number of dropped jobs
+  std::thread thread_;  //!< The worker thread. Declared last so it starts after the other members are initialized.
+};
+
+}  // namespace fuse_publishers
+
+#endif  // FUSE_PUBLISHERS_COVARIANCE_WORKER_H
@@ -37,15 +37,21 @@
 #include <fuse_core/async_publisher.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/fuse_macros.h>
+#include <fuse_core/time.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
 #include <rclcpp/rclcpp.hpp>
 
 #include <nav_msgs/msg/path.hpp>
 #include <geometry_msgs/msg/pose_array.hpp>
 #include <geometry_msgs/msg/pose_stamped.hpp>
 
+#include <deque>
+#include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 
 namespace fuse_publishers
@@ -54,10 +60,19 @@ namespace fuse_publishers
 /**
  * @brief Publisher plugin that publishes all of the stamped 2D poses as a nav_msgs::Path message.
  *
+ * The publisher keeps its own stamp-ordered cache of the poses in the graph. The cache is updated from the variables
+ * added and removed by each notify transaction, so the graph is only scanned once after the publisher is started.
+ * Only the poses still in the graph are refreshed before publishing.
+ *
  * Parameters:
  *  - device_id (uuid string, default: 00000000-0000-0000-0000-000000000000) The device/robot ID to publish
  *  - device_name (string) Used to generate the device/robot ID if the device_id is not provided
  *  - frame_id (string, default: map)  Name for the robot's map frame
+ *  - keep_history (bool, default: false) Continue publishing poses after they have been removed from the graph, e.g.
+ *                                        by a fixed-lag smoother, so the path extends beyond the optimization window
+ *  - max_history_length (int, default: 0) The maximum number of removed poses kept when keep_history is set. The
+ *                                         oldest ones are dropped first. If 0, the history is unbounded, and its
+ *                                         memory and the cost of each publication grow for the node's whole lifetime.
  */
 class Path2DPublisher : public fuse_core::AsyncPublisher
 {
@@ -80,6 +95,11 @@ public:
    */
   void onInit() override;
 
+  /**
+   * @brief Clear the path cache. The next notification will rebuild it from the full graph.
+   */
+  void onStart() override;
+
   /**
    * @brief Notify the publisher about variables that have been added or removed
    *
@@ -91,8 +111,42 @@ public:
     fuse_core::Graph::ConstSharedPtr graph) override;
 
 protected:
+  /**
+   * @brief A cached pose of a variable pair still in the graph
+   */
+  struct PathEntry
+  {
+    fuse_core::UUID orientation_uuid;  //!< The UUID of the orientation variable
+    fuse_core::UUID position_uuid;  //!< The UUID of the position variable with the same stamp and device
+    geometry_msgs::msg::PoseStamped pose;  //!< The most recently published value of the pose
+    bool valid = false;  //!< Flag indicating both variables were found in the graph on the last refresh
+  };
+
+  /**
+   * @brief Add the variable to the path cache if it is an orientation belonging to the published device
+   */
+  void addVariable(const fuse_core::Variable& variable);
+
+  /**
+   * @brief Remove the pose associated with the variable UUID from the path cache, moving it into the history if needed
+   *
+   * The oldest poses are dropped from the history once it exceeds the max_history_length.
+   */
+  void removeVariable(const fuse_core::UUID& variable_uuid);
+
+  /**
+   * @brief Copy the current variable values from the graph into every cached pose
+   */
+  void refreshPoses(const fuse_core::Graph& graph);
+
   fuse_core::UUID device_id_;  //!< The UUID of the device to be published
   std::string frame_id_;  //!< The name of the frame for this path
+  bool keep_history_;  //!< Continue publishing poses that have been removed from the graph
+  size_t max_history_length_;  //!< The maximum number of poses in the history, or 0 if unbounded
+  bool synchronized_;  //!< Flag indicating the cache has been populated from a full graph since the last start
+  std::deque<geometry_msgs::msg::PoseStamped> history_;  //!< Poses removed from the graph, ordered by stamp
+  std::map<fuse_core::TimeStamp, PathEntry> window_;  //!< The poses still in the graph, ordered by stamp
+  std::unordered_map<fuse_core::UUID, fuse_core::TimeStamp> window_stamps_;  //!< Orientation UUID to window_ key
   rclcpp::Publisher<nav_msgs::msg::Path>::SharedPtr path_publisher_;  //!< The publisher that sends the entire robot trajectory as a path
   rclcpp::Publisher<geometry_msgs::msg::PoseArray>::SharedPtr pose_array_publisher_;  //!< The publisher that sends the entire robot trajectory as a pose array
 };
@@ -36,11 +36,13 @@
 
 #include <fuse_core/async_publisher.h>
 
+#include <fuse_publishers/covariance_worker.h>
 #include <fuse_publishers/stamped_variable_synchronizer.h>
 
 #include <fuse_variables/orientation_2d_stamped.h>
 #include <fuse_variables/position_2d_stamped.h>
 
+#include <fuse_core/covariance_blocks.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/transaction.h>
 #include <fuse_core/uuid.h>
@@ -61,7 +63,9 @@
 
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 
 namespace fuse_publishers
@@ -86,6 +90,11 @@ namespace fuse_publishers
  * transform data so that other nodes can execute tf queries.
  *
  * Parameters:
+ *  - async_covariance (bool, default: false)  Compute the pose covariance in a dedicated worker thread when it is not
+ *                                             provided by the optimizer. The pose is published immediately, and the
+ *                                             pose with covariance is published once the computation completes. If
+ *                                             a newer pose arrives before the computation starts, the older one is
+ *                                             dropped.
  *  - base_frame (string, default: base_link)  Name for the robot's base frame
  *  - device_id (uuid string, default: 00000000-0000-0000-0000-000000000000) The device/robot ID to publish
  *  - device_name (string) Used to generate the device/robot ID if the device_id is not provided
@@ -93,6 +102,10 @@ namespace fuse_publishers
  *  - odom_frame (string, default: odom)  Name for the robot's odom frame (or {empty} if the frame map->base should be
  *                                        published to tf instead of map->odom)
  *  - publish_to_tf (bool, default: false)  Flag indicating that the optimized pose should be published to tf
+ *  - shared_covariance (bool, default: false)  Whether the pose covariance should be requested from the optimizer,
+ *                                              which computes the covariance requests of all publishers in a single
+ *                                              batch in its own thread before notifying them. If false, the
+ *                                              covariance is computed by this publisher.
  *  - tf_cache_time (seconds, default: 10.0)  How long to keep a history of transforms (for map->odom lookup)
  *  - tf_publish_frequency (Hz, default: 10.0)  How often the latest pose should be published to tf
  *  - tf_timeout (seconds, default: 0.1)  The maximum amount of time to wait for a transform to become available
@@ -144,12 +157,47 @@ public:
    * recent pose UUID can be maintained without performing an exhaustive search through the entire Graph during
    * the Publisher::publish() call.
    *
-   * @param[in] transaction A Transaction object, describing the set of variables that have been added and/or removed
-   * @param[in] graph       A read-only pointer to the graph object, allowing queries to be performed whenever needed
+   * The pose covariance is taken from the covariance blocks computed by the optimizer, if available. Otherwise it
+   * is computed from the graph, either immediately or in the covariance worker thread if async_covariance is set.
+   *
+   * @param[in] transaction       A Transaction object, describing the set of variables that have been added and/or
+   *                              removed
+   * @param[in] graph             A read-only pointer to the graph object, allowing queries to be performed whenever
+   *                              needed
+   * @param[in] covariance_blocks The covariance blocks computed by the optimizer, or nullptr
    */
   void notifyCallback(
     fuse_core::Transaction::ConstSharedPtr transaction,
-    fuse_core::Graph::ConstSharedPtr graph) override;
+    fuse_core::Graph::ConstSharedPtr graph,
+    fuse_core::CovarianceBlocks::ConstSharedPtr covariance_blocks) override;
+
+  /**
+   * @brief Request the covariance of the most recent pose from the optimizer
+   *
+   * This is executed in the optimizer's thread, so it uses a dedicated synchronizer to find the most recent pose.
+   *
+   * @param[in]  transaction A Transaction object, describing the set of variables that have been added and/or removed
+   * @param[in]  graph       The optimized graph
+   * @param[out] requests    The container that collects the covariance requests
+   */
+  void covarianceRequestCallback(
+    const fuse_core::Transaction& transaction,
+    const fuse_core::Graph& graph,
+    std::vector<fuse_core::CovarianceBlocks::Request>& requests);
+
+  /**
+   * @brief Publish the pose with covariance message, unless a pose with a newer stamp has already been published
+   *
+   * This may be called from the covariance worker thread.
+   *
+   * @param[in] stamp               The stamp of the pose
+   * @param[in] pose                The pose
+   * @param[in] covariance_matrices The position, position-orientation and orientation covariance blocks
+   */
+  void publishPoseWithCovariance(
+    const fuse_core::TimeStamp& stamp,
+    const geometry_msgs::msg::Pose& pose,
+    const std::vector<std::vector<double>>& covariance_matrices);
 
   /**
    * @brief Timer-based callback that publishes the latest map->odom transform
@@ -171,7 +219,11 @@ protected:
   rclcpp::Publisher<geometry_msgs::msg::PoseStamped>::SharedPtr pose_publisher_;  //!< Publish the pose as a geometry_msgs::PoseStamped
   rclcpp::Publisher<geometry_msgs::msg::PoseWithCovarianceStamped>::SharedPtr pose_with_covariance_publisher_;  //!< Publish the pose as a geometry_msgs::PoseWithCovarianceStamped
   bool publish_to_tf_;  //!< Flag indicating the pose should be sent to the tf system as well as the pose topics
+  bool shared_covariance_;  //!< Flag indicating the pose covariance is requested from the optimizer
   Synchronizer::UniquePtr synchronizer_;  //!< Object that tracks the latest common timestamp of multiple variables
+  std::mutex covariance_request_mutex_;  //!< Guards covariance_synchronizer_, which is used in the optimizer's thread
+  Synchronizer::UniquePtr covariance_synchronizer_;  //!< Object that tracks the latest common timestamp in the
+                                                     //!< optimizer's thread, used for covariance requests
   std::unique_ptr<tf2_ros::Buffer> tf_buffer_;  //!< TF2 object that supports querying transforms by time and frame id
   std::unique_ptr<tf2_ros::TransformListener> tf_listener_;  //!< TF2 object that subscribes to the tf topics and
                                                              //!< inserts the received transforms into the tf buffer
@@ -180,6 +232,10 @@ protected:
   fuse_core::Duration tf_timeout_;  //!< The max time to wait for a tf transform to become available
   geometry_msgs::msg::TransformStamped tf_transform_;  //!< The transform to be published to tf
   bool use_tf_lookup_;  //!< Internal flag indicating that a tf frame lookup is required
+  std::mutex covariance_mutex_;  //!< Guards covariance_stamp_, which is accessed from the covariance worker thread
+  fuse_core::TimeStamp covariance_stamp_;  //!< The stamp of the latest pose with covariance published
+  CovarianceWorker::UniquePtr covariance_worker_;  //!< Computes the covariance asynchronously, if enabled. Declared
+                                                   //!< last so it is destroyed, and its thread joined, first.
 };
 
 }  // namespace fuse_publishers
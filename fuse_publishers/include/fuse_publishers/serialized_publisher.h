@@ -35,12 +35,14 @@
 #define FUSE_PUBLISHERS_SERIALIZED_PUBLISHER_H
 
 #include <fuse_core/async_publisher.h>
+#include <fuse_core/flat_serialization.h>
 #include <fuse_core/graph.h>
 #include <fuse_core/fuse_macros.h>
 #include <fuse_core/throttled_callback.h>
 #include <fuse_core/transaction.h>
 #include <rclcpp/rclcpp.h>
 
+#include <cstdint>
 #include <string>
 
 
@@ -49,6 +51,11 @@ namespace fuse_publishers
 
 /**
  * @brief Publisher plugin that publishes the transaction and graph as serialized messages
+ *
+ * The complete graph is published on the "graph" topic, throttled by the graph_throttle_period parameter. The graph is
+ * also published on the "graph_delta" topic as a stream of keyframes and deltas: a complete graph every
+ * graph_delta_keyframe_interval messages, and only the changes since the previous message otherwise. The stream is
+ * published every cycle, and is read back with a fuse_core::GraphReconstructor.
  */
 class SerializedPublisher : public fuse_core::AsyncPublisher
 {
@@ -91,8 +98,12 @@ protected:
   void graphPublisherCallback(fuse_core::Graph::ConstSharedPtr graph, const ros::Time& stamp) const;
 
   std::string frame_id_;  //!< The name of the frame for the serialized graph and transaction messages published
+  fuse_core::SerializationFormat serialization_format_;  //!< The encoding of the published messages
   ros::Publisher graph_publisher_;
+  ros::Publisher graph_delta_publisher_;
   ros::Publisher transaction_publisher_;
+  fuse_core::flat::GraphDeltaEncoder graph_delta_encoder_;  //!< Remembers the graph state sent on graph_delta
+  uint32_t graph_delta_subscriber_count_;  //!< The number of graph_delta subscribers when last published
 
   using GraphPublisherCallback = std::function<void(fuse_core::Graph::ConstSharedPtr, const ros::Time&)>;
   using GraphPublisherThrottledCallback = fuse_core::ThrottledCallback<GraphPublisherCallback>;
@@ -42,7 +42,12 @@
 #include <fuse_variables/stamped.h>
 #include <fuse_core/time.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
 #include <type_traits>
+#include <unordered_map>
 
 
 namespace fuse_publishers
@@ -51,10 +56,13 @@ namespace fuse_publishers
 /**
  * @brief A utility class that finds the most recent timestamp shared by a set of stamped variables
  *
- * This is designed to be used by derived fuse_core::Publisher classes. The class remembers the last common timestamp
- * from the previous call, and attempts to find a more recent common timestamp using the provided transaction
- * information. If no common timestamp is found after searching the transaction, a full search of the graph will
- * be conducted. If no common timestamp is found after searching the full graph, a zero timestamp will be returned.
+ * This is designed to be used by derived fuse_core::Publisher classes. The class keeps an index of the stamps of the
+ * requested variable types that exist in the graph, along with the set of stamps for which all of the requested types
+ * exist. The first call populates the index with a full search of the graph. Every following call only applies the
+ * variables added and removed by the provided transaction, so the latest common timestamp is found in O(log n) time
+ * without searching the graph again. This requires every transaction applied to the graph to be provided to the
+ * synchronizer, which is the case for the transactions received by fuse_core::Publisher::notify(). If no common
+ * timestamp exists, a zero timestamp will be returned.
  *
  * The set of variable types are provided in the template parameters. e.g.
  * @code{.cpp}
@@ -87,19 +95,39 @@ public:
   fuse_core::TimeStamp findLatestCommonStamp(const fuse_core::Transaction& transaction, const fuse_core::Graph& graph);
 
 private:
+  using Mask = uint32_t;  //!< A set of the template types, one bit per type in the parameter pack order
+
+  static_assert(sizeof...(Ts) < 32, "At most 31 types can be synchronized.");
+  static constexpr Mask ALL_TYPES = (Mask(1) << sizeof...(Ts)) - 1;  //!< The set containing all of the types
+
+  /**
+   * @brief The index entry of a variable of one of the requested types
+   */
+  struct IndexedVariable
+  {
+    fuse_core::TimeStamp stamp;  //!< The stamp of the variable
+    Mask type;  //!< The bit of the variable type
+  };
+
   fuse_core::UUID device_id_;  //!< The device_id to use with the Stamped classes
-  bool time_zero;               //!< true if latest_common_stamp_ is not initialised
-  fuse_core::TimeStamp latest_common_stamp_;  //!< The previously discovered common stamp
+  bool synchronized_;  //!< Flag indicating the index has been populated from the full graph
+  std::map<fuse_core::TimeStamp, Mask> stamp_index_;  //!< The set of types present at each stamp
+  std::set<fuse_core::TimeStamp> common_stamps_;  //!< The stamps for which all of the types are present
+  std::unordered_map<fuse_core::UUID, IndexedVariable> variable_index_;  //!< Indexed variables, used for removals
+
+  /**
+   * @brief Add the variable to the index if it is one of the requested types and belongs to the requested device
+   *
+   * @param[in] variable The variable added to the graph
+   */
+  void addVariable(const fuse_core::Variable& variable);
 
   /**
-   * @brief Search the variables in the provided range for more recent timestamps. Update the \p latest_common_stamp_
-   *        member variable if a newer common timestamp is found.
+   * @brief Remove the variable from the index, if it was indexed
    *
-   * @param[in] variable_range The collection of variables to test
-   * @param[in] graph          The complete graph, used to verify that all requested variables exist for a given time
+   * @param[in] variable_uuid The UUID of the variable removed from the graph
    */
-  template <typename VariableRange>
-  void updateTime(const VariableRange& variable_range, const fuse_core::Graph& graph);
+  void removeVariable(const fuse_core::UUID& variable_uuid);
 };
 
 namespace detail
@@ -180,83 +208,47 @@ template<typename ...Ts>
 constexpr bool allStampedVariables = all_stamped_variables<Ts...>::value;
 
 /**
- * @brief Test if instances of all the template parameter pack types exist in the graph
- *
- * This version accepts an empty parameter pack, and is used to terminate the recursive template parameter pack
- * expansion.
- *
- * This would be much easier to write in C++17 using 'if constexpr (sizeof...(Ts) > 0)'
- *
- * @param[in] graph     The complete graph, used to verify the existence of a variable
- * @param[in] stamp     The timestamp used to construct all variable types
- * @param[in] device_id The device id used to construct all variable types
- * @return True if all variables exist, false otherwise
- */
-template <typename...>
-struct all_variables_exist
-{
-  static bool value(const fuse_core::Graph& /*graph*/, const fuse_core::TimeStamp& /*stamp*/, const fuse_core::UUID& /*device_id*/)
-  {
-    return true;
-  }
-};
-
-/**
- * @brief Test if instances of all the template parameter pack types exist in the graph
- *
- * This version accepts two or more template arguments. The template parameter pack is expanded recursively.
- *
- * @param[in] graph     The complete graph, used to verify the existence of a variable
- * @param[in] stamp     The timestamp used to construct all variable types
- * @param[in] device_id The device id used to construct all variable types
- * @return True if all variables exist, false otherwise
- */
-template <typename T, typename ...Ts>
-struct all_variables_exist<T, Ts...>
-{
-  static bool value(const fuse_core::Graph& graph, const fuse_core::TimeStamp& stamp, const fuse_core::UUID& device_id)
-  {
-    return graph.variableExists(T(stamp, device_id).uuid()) &&
-           all_variables_exist<Ts...>::value(graph, stamp, device_id);
-  }
-};
-
-/**
- * @brief Test if a given variable is included in the template parameter pack types
+ * @brief Find the position of the variable type in the template parameter pack types
  *
  * This version accepts an empty parameter pack, and is used to terminate the recursive template parameter pack
  * expansion.
  *
- * This would be much easier to write in C++17 using 'if constexpr (sizeof...(Ts) > 0)'
- *
- * @param[in] variable The variable to check against the template parameter pack
- * @return True if the variable's type is part of the template parameter pack, false otherwise
+ * @param[in]  variable The variable to check against the template parameter pack
+ * @param[out] index    The position of the first matching type in the template parameter pack
+ * @return The variable cast to the Stamped base class if its type is part of the template parameter pack, nullptr
+ *         otherwise
  */
-template <typename...>
-struct is_variable_in_pack
+template <size_t I, typename...>
+struct find_variable_in_pack
 {
-  static bool value(const fuse_core::Variable& /*variable*/)
+  static const fuse_variables::Stamped* value(const fuse_core::Variable& /*variable*/, size_t& /*index*/)
   {
-    return false;
+    return nullptr;
   }
 };
 
 /**
- * @brief Test if a given variable is included in the template parameter pack types
+ * @brief Find the position of the variable type in the template parameter pack types
  *
- * This version accepts two or more template arguments. The template parameter pack is expanded recursively.
+ * This version accepts one or more template arguments. The template parameter pack is expanded recursively.
  *
- * @param[in] variable The variable to check against the template parameter pack
- * @return True if the variable's type is part of the template parameter pack, false otherwise
+ * @param[in]  variable The variable to check against the template parameter pack
+ * @param[out] index    The position of the first matching type in the template parameter pack
+ * @return The variable cast to the Stamped base class if its type is part of the template parameter pack, nullptr
+ *         otherwise
  */
-template <typename T, typename ...Ts>
-struct is_variable_in_pack<T, Ts...>
+template <size_t I, typename T, typename ...Ts>
+struct find_variable_in_pack<I, T, Ts...>
 {
-  static bool value(const fuse_core::Variable& variable)
+  static const fuse_variables::Stamped* value(const fuse_core::Variable& variable, size_t& index)
   {
     auto derived = dynamic_cast<const T*>(&variable);
-    return static_cast<bool>(derived) ||
-           is_variable_in_pack<Ts...>::value(variable);
+    if (derived)
+    {
+      index = I;
+      return derived;
+    }
+    return find_variable_in_pack<I + 1, Ts...>::value(variable, index);
   }
 };
 
@@ -268,8 +260,7 @@ struct is_variable_in_pack<T, Ts...>
 template <typename ...Ts>
 StampedVariableSynchronizer<Ts...>::StampedVariableSynchronizer(const fuse_core::UUID& device_id) :
   device_id_(device_id),
-  time_zero(true)//,
-  //latest_common_stamp_(TIME_ZERO)
+  synchronized_(false)
 {
   static_assert(detail::allStampedVariables<Ts...>, "All synchronized types must be derived from both "
                                                     "fuse_core::Variable and fuse_variable::Stamped.");
@@ -281,41 +272,78 @@ fuse_core::TimeStamp StampedVariableSynchronizer<Ts...>::findLatestCommonStamp(
   const fuse_core::Transaction& transaction,
   const fuse_core::Graph& graph)
 {
-  // Clear the previous stamp if the variable was deleted
-  if (time_zero &&
-      !detail::all_variables_exist<Ts...>::value(graph, latest_common_stamp_, device_id_))
+  auto add_variable = [this](const fuse_core::Variable& variable)
   {
-    time_zero = true;
+    addVariable(variable);
+  };
+  if (synchronized_)
+  {
+    // Apply the changes to the graph since the last call
+    for (const auto& variable_uuid : transaction.removedVariables())
+    {
+      removeVariable(variable_uuid);
+    }
+    transaction.forEachAddedVariable(add_variable);
   }
-  // Search the transaction for more recent variables
-  updateTime(transaction.addedVariables(), graph);
-  // If no common timestamp was found, search the whole graph for the most recent variable set
-  if (time_zero)
+  else
   {
-    updateTime(graph.getVariables(), graph);
+    // Populate the index from the whole graph. The graph already contains the transaction changes.
+    graph.forEachVariable(add_variable);
+    synchronized_ = true;
   }
-  return latest_common_stamp_;
+  if (common_stamps_.empty())
+  {
+    return fuse_core::TimeStamp();
+  }
+  return *common_stamps_.rbegin();
 }
 
 template <typename ...Ts>
-template <typename VariableRange>
-void StampedVariableSynchronizer<Ts...>::updateTime(
-  const VariableRange& variable_range,
-  const fuse_core::Graph& graph)
+void StampedVariableSynchronizer<Ts...>::addVariable(const fuse_core::Variable& variable)
 {
-  for (const auto& candidate_variable : variable_range)
+  size_t index = 0;
+  auto stamped_variable = detail::find_variable_in_pack<0, Ts...>::value(variable, index);
+  if (!stamped_variable ||
+      (stamped_variable->deviceId() != device_id_))
   {
-    if (detail::is_variable_in_pack<Ts...>::value(candidate_variable))
+    return;
+  }
+  const auto type = Mask(1) << index;
+  if (!variable_index_.emplace(variable.uuid(), IndexedVariable{stamped_variable->stamp(), type}).second)
+  {
+    return;
+  }
+  auto& types = stamp_index_[stamped_variable->stamp()];
+  types |= type;
+  if (types == ALL_TYPES)
+  {
+    common_stamps_.insert(stamped_variable->stamp());
+  }
+}
+
+template <typename ...Ts>
+void StampedVariableSynchronizer<Ts...>::removeVariable(const fuse_core::UUID& variable_uuid)
+{
+  auto variable_iter = variable_index_.find(variable_uuid);
+  if (variable_iter == variable_index_.end())
+  {
+    return;
+  }
+  const auto& indexed_variable = variable_iter->second;
+  auto stamp_iter = stamp_index_.find(indexed_variable.stamp);
+  if (stamp_iter != stamp_index_.end())
+  {
+    if (stamp_iter->second == ALL_TYPES)
+    {
+      common_stamps_.erase(indexed_variable.stamp);
+    }
+    stamp_iter->second &= ~indexed_variable.type;
+    if (stamp_iter->second == 0)
     {
-      const auto& stamped_variable = dynamic_cast<const fuse_variables::Stamped&>(candidate_variable);
-      if ((stamped_variable.stamp() > latest_common_stamp_) &&
-          (stamped_variable.deviceId() == device_id_) &&
-          (detail::all_variables_exist<Ts...>::value(graph, stamped_variable.stamp(), device_id_)))
-      {
-        latest_common_stamp_ = stamped_variable.stamp();
-      }
+      stamp_index_.erase(stamp_iter);
     }
   }
+  variable_index_.erase(variable_iter);
 }
 
 }  // namespace fuse_publishers
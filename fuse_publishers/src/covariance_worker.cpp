@@ -0,0 +1,133 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_publishers/covariance_worker.h>
+#include <rclcpp/clock.hpp>
+#include <rclcpp/logging.hpp>
+
+#include <exception>
+#include <utility>
+
+
+namespace fuse_publishers
+{
+
+CovarianceWorker::CovarianceWorker(const rclcpp::Logger& logger) :
+  logger_(logger),
+  running_(false),
+  stop_(false),
+  dropped_(0),
+  thread_(&CovarianceWorker::run, this)
+{
+}
+
+CovarianceWorker::~CovarianceWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_all();
+  thread_.join();
+}
+
+bool CovarianceWorker::submit(Job job)
+{
+  bool replaced = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    replaced = static_cast<bool>(pending_);
+    if (replaced)
+    {
+      ++dropped_;
+    }
+    pending_ = std::move(job);
+  }
+  condition_.notify_all();
+  return replaced;
+}
+
+void CovarianceWorker::cancel()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (pending_)
+  {
+    pending_ = nullptr;
+    ++dropped_;
+  }
+  condition_.wait(lock, [this]() { return !running_; });  // NOLINT(whitespace/braces)
+}
+
+size_t CovarianceWorker::dropped() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+void CovarianceWorker::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    condition_.wait(lock, [this]() { return stop_ || static_cast<bool>(pending_); });  // NOLINT(whitespace/braces)
+    if (stop_)
+    {
+      return;
+    }
+    Job job = std::move(pending_);
+    pending_ = nullptr;
+    running_ = true;
+    lock.unlock();
+    // Jobs should handle their own errors. Never let an exception terminate the worker thread, but report it, as no
+    // covariance is published for a failed job.
+    try
+    {
+      job();
+    }
+    catch (const std::exception& e)
+    {
+      auto clk = rclcpp::Clock(RCL_SYSTEM_TIME);
+      RCLCPP_ERROR_STREAM_THROTTLE(logger_, clk, 10000, "A covariance job failed. Error: " << e.what());
+    }
+    catch (...)
+    {
+      auto clk = rclcpp::Clock(RCL_SYSTEM_TIME);
+      RCLCPP_ERROR_STREAM_THROTTLE(logger_, clk, 10000, "A covariance job failed. Error: unknown");
+    }
+    lock.lock();
+    running_ = false;
+    condition_.notify_all();
+  }
+}
+
+}  // namespace fuse_publishers
@@ -56,7 +56,10 @@ namespace fuse_publishers
 Path2DPublisher::Path2DPublisher() :
   fuse_core::AsyncPublisher(1),
   device_id_(fuse_core::uuid::NIL),
-  frame_id_("map")
+  frame_id_("map"),
+  keep_history_(false),
+  max_history_length_(0),
+  synchronized_(false)
 {
 }
 
@@ -77,44 +80,71 @@ void Path2DPublisher::onInit()
     }
   }
   fuse_core::getParam(node_, "frame_id", frame_id_);
+  keep_history_ = fuse_core::getParam(node_, "keep_history", keep_history_);
+  int max_history_length = fuse_core::getParam(node_, "max_history_length", 0);
+  if (max_history_length < 0)
+  {
+    RCLCPP_WARN_STREAM(node_->get_logger(), "The requested max_history_length is < 0. Using the default value (0, "
+                    "unbounded) instead.");
+    max_history_length = 0;
+  }
+  max_history_length_ = static_cast<size_t>(max_history_length);
 
   // Advertise the topic
   path_publisher_ = node_->create_publisher<nav_msgs::msg::Path>("path", 1);
   pose_array_publisher_ = node_->create_publisher<geometry_msgs::msg::PoseArray>("pose_array", 1);
 }
 
+void Path2DPublisher::onStart()
+{
+  history_.clear();
+  window_.clear();
+  window_stamps_.clear();
+  synchronized_ = false;
+}
+
 void Path2DPublisher::notifyCallback(
-  fuse_core::Transaction::ConstSharedPtr /*transaction*/,
+  fuse_core::Transaction::ConstSharedPtr transaction,
   fuse_core::Graph::ConstSharedPtr graph)
 {
-  // Exit early if no one is listening
-  if ((path_publisher_->get_subscription_count() == 0) && (pose_array_publisher_->get_subscription_count() == 0))
+  // Keep the path cache in sync with the graph, even if no one is listening. The first notification after a start
+  // populates the cache from the full graph; every later one only applies the changes described by the transaction.
+  if (synchronized_)
+  {
+    for (const auto& variable_uuid : transaction->removedVariables())
+    {
+      removeVariable(variable_uuid);
+    }
+    transaction->forEachAddedVariable([this](const fuse_core::Variable& variable) { addVariable(variable); });
+  }
+  else
+  {
+    graph->forEachVariable([this](const fuse_core::Variable& variable) { addVariable(variable); });
+    synchronized_ = true;
+  }
+  // Exit early if no one is listening. When keeping the history, the cached poses must still be refreshed so that
+  // poses removed by a later transaction are stored with their final values.
+  const bool listening = (path_publisher_->get_subscription_count() > 0) ||
+                         (pose_array_publisher_->get_subscription_count() > 0);
+  if (!listening && !keep_history_)
+  {
+    return;
+  }
+  // Copy the latest values of the poses still in the graph. The removed poses in the history never change.
+  refreshPoses(*graph);
+  if (!listening)
   {
     return;
   }
-  // Extract all of the 2D pose variables to the path
+  // Collect the history followed by the current window. Both are already ordered by stamp.
   std::vector<geometry_msgs::msg::PoseStamped> poses;
-  for (const auto& variable : graph->getVariables())
+  poses.reserve(history_.size() + window_.size());
+  poses.insert(poses.end(), history_.begin(), history_.end());
+  for (const auto& stamp__entry : window_)
   {
-    auto orientation = dynamic_cast<const fuse_variables::Orientation2DStamped*>(&variable);
-    if (orientation &&
-       (orientation->deviceId() == device_id_))
+    if (stamp__entry.second.valid)
     {
-      const auto& stamp = orientation->stamp();
-      auto position_uuid = fuse_variables::Position2DStamped(stamp, device_id_).uuid();
-      if (!graph->variableExists(position_uuid))
-      {
-        continue;
-      }
-      auto position = dynamic_cast<const fuse_variables::Position2DStamped*>(&graph->getVariable(position_uuid));
-      geometry_msgs::msg::PoseStamped pose;
-      pose.header.stamp = fuse_core::stamp_to_ros(stamp);
-      pose.header.frame_id = frame_id_;
-      pose.pose.position.x = position->x();
-      pose.pose.position.y = position->y();
-      pose.pose.position.z = 0.0;
-      pose.pose.orientation = tf2::toMsg(tf2::Quaternion(tf2::Vector3(0, 0, 1), orientation->yaw()));
-      poses.push_back(std::move(pose));
+      poses.push_back(stamp__entry.second.pose);
     }
   }
   // Exit if there are no poses
@@ -122,37 +152,16 @@ void Path2DPublisher::notifyCallback(
   {
     return;
   }
-  // Sort the poses by timestamp
-  auto compare_stamps = [](const geometry_msgs::msg::PoseStamped& pose1, const geometry_msgs::msg::PoseStamped& pose2)
-  {
-    if(pose1.header.stamp.sec == pose2.header.stamp.sec){
-      return pose1.header.stamp.nanosec < pose2.header.stamp.nanosec;
-    }
-    else
-    {
-      return pose1.header.stamp.sec < pose2.header.stamp.sec;
-    }
-
-
-  };
-  std::sort(poses.begin(), poses.end(), compare_stamps);
   // Define the header for the aggregate message
   std_msgs::msg::Header header;
   header.stamp = poses.back().header.stamp;
   header.frame_id = frame_id_;
-  // Convert the sorted poses into a Path msg
-  if (path_publisher_->get_subscription_count() > 0)
-  {
-    nav_msgs::msg::Path path_msg;
-    path_msg.header = header;
-    path_msg.poses = poses;
-    path_publisher_->publish(path_msg);
-  }
   // Convert the sorted poses into a PoseArray msg
   if (pose_array_publisher_->get_subscription_count() > 0)
   {
     geometry_msgs::msg::PoseArray pose_array_msg;
     pose_array_msg.header = header;
+    pose_array_msg.poses.reserve(poses.size());
     std::transform(poses.begin(),
                    poses.end(),
                    std::back_inserter(pose_array_msg.poses),
@@ -162,6 +171,93 @@ void Path2DPublisher::notifyCallback(
                    });  // NOLINT(whitespace/braces)
     pose_array_publisher_->publish(pose_array_msg);
   }
+  // Convert the sorted poses into a Path msg
+  if (path_publisher_->get_subscription_count() > 0)
+  {
+    nav_msgs::msg::Path path_msg;
+    path_msg.header = header;
+    path_msg.poses = std::move(poses);
+    path_publisher_->publish(path_msg);
+  }
+}
+
+void Path2DPublisher::addVariable(const fuse_core::Variable& variable)
+{
+  auto orientation = dynamic_cast<const fuse_variables::Orientation2DStamped*>(&variable);
+  if (!orientation ||
+      (orientation->deviceId() != device_id_) ||
+      (window_stamps_.count(orientation->uuid()) > 0))
+  {
+    return;
+  }
+  const auto& stamp = orientation->stamp();
+  // The position UUID is computed once, when the pose enters the window
+  PathEntry entry;
+  entry.orientation_uuid = orientation->uuid();
+  entry.position_uuid = fuse_variables::Position2DStamped(stamp, device_id_).uuid();
+  entry.pose.header.stamp = fuse_core::stamp_to_ros(stamp);
+  entry.pose.header.frame_id = frame_id_;
+  window_[stamp] = std::move(entry);
+  window_stamps_.emplace(orientation->uuid(), stamp);
+}
+
+void Path2DPublisher::removeVariable(const fuse_core::UUID& variable_uuid)
+{
+  auto stamp_iter = window_stamps_.find(variable_uuid);
+  if (stamp_iter == window_stamps_.end())
+  {
+    return;
+  }
+  auto entry_iter = window_.find(stamp_iter->second);
+  window_stamps_.erase(stamp_iter);
+  if (entry_iter == window_.end())
+  {
+    return;
+  }
+  // Poses leave the graph oldest first, so they are almost always appended to the end of the history
+  if (keep_history_ && entry_iter->second.valid)
+  {
+    auto& pose = entry_iter->second.pose;
+    auto position = std::upper_bound(
+      history_.begin(),
+      history_.end(),
+      pose,
+      [](const geometry_msgs::msg::PoseStamped& pose1, const geometry_msgs::msg::PoseStamped& pose2)
+      {
+        return rclcpp::Time(pose1.header.stamp) < rclcpp::Time(pose2.header.stamp);
+      });  // NOLINT(whitespace/braces)
+    history_.insert(position, std::move(pose));
+    while (max_history_length_ > 0 && history_.size() > max_history_length_)
+    {
+      history_.pop_front();
+    }
+  }
+  window_.erase(entry_iter);
+}
+
+void Path2DPublisher::refreshPoses(const fuse_core::Graph& graph)
+{
+  for (auto& stamp__entry : window_)
+  {
+    auto& entry = stamp__entry.second;
+    entry.valid = graph.variableExists(entry.orientation_uuid) && graph.variableExists(entry.position_uuid);
+    if (!entry.valid)
+    {
+      continue;
+    }
+    auto orientation = dynamic_cast<const fuse_variables::Orientation2DStamped*>(
+      &graph.getVariable(entry.orientation_uuid));
+    auto position = dynamic_cast<const fuse_variables::Position2DStamped*>(&graph.getVariable(entry.position_uuid));
+    if (!orientation || !position)
+    {
+      entry.valid = false;
+      continue;
+    }
+    entry.pose.pose.position.x = position->x();
+    entry.pose.pose.position.y = position->y();
+    entry.pose.pose.position.z = 0.0;
+    entry.pose.pose.orientation = tf2::toMsg(tf2::Quaternion(tf2::Vector3(0, 0, 1), orientation->yaw()));
+  }
 }
 
 }  // namespace fuse_publishers
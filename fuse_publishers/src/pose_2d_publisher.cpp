@@ -37,6 +37,8 @@
 #include <fuse_core/parameter.h>
 
 #include <exception>
+#include <functional>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -94,6 +96,7 @@ Pose2DPublisher::Pose2DPublisher() :
   fuse_core::AsyncPublisher(1),
   device_id_(fuse_core::uuid::NIL)//,
   publish_to_tf_(false),
+  shared_covariance_(false),
   use_tf_lookup_(false)
 {
 }
@@ -119,6 +122,11 @@ void Pose2DPublisher::onInit()
     }
   }
   publish_to_tf_ = fuse_core::getParam(node_, "publish_to_tf", false);
+  shared_covariance_ = fuse_core::getParam(node_, "shared_covariance", false);
+  if (fuse_core::getParam(node_, "async_covariance", false))
+  {
+    covariance_worker_ = fuse_publishers::CovarianceWorker::make_unique(node_->get_logger());
+  }
 
   // Configure tf, if requested
   if (publish_to_tf_)
@@ -176,14 +184,31 @@ void Pose2DPublisher::onInit()
 
   pose_with_covariance_publisher_ = node_->create_publisher<geometry_msgs::msg::PoseWithCovarianceStamped>(
     "pose_with_covariance", 1);
+
+  if (shared_covariance_)
+  {
+    // Let the optimizer compute the pose covariance along with the requests of the other publishers
+    registerCovarianceRequest(std::bind(&Pose2DPublisher::covarianceRequestCallback, this, std::placeholders::_1,
+                                        std::placeholders::_2, std::placeholders::_3));
+  }
 }
 
 void Pose2DPublisher::onStart()
 {
+  // Drop any covariance computed before the restart
+  if (covariance_worker_)
+  {
+    covariance_worker_->cancel();
+  }
+  covariance_stamp_ = fuse_core::TimeStamp();
   // Clear the transform
   tf_transform_ = geometry_msgs::msg::TransformStamped();
-  // Clear the synchronizer
+  // Clear the synchronizers
   synchronizer_ = Synchronizer::make_unique(device_id_);
+  {
+    std::lock_guard<std::mutex> lock(covariance_request_mutex_);
+    covariance_synchronizer_ = Synchronizer::make_unique(device_id_);
+  }
   // Start the tf timer
   if (publish_to_tf_)
   {
@@ -193,6 +218,11 @@ void Pose2DPublisher::onStart()
 
 void Pose2DPublisher::onStop()
 {
+  // Drop any pending covariance computation
+  if (covariance_worker_)
+  {
+    covariance_worker_->cancel();
+  }
   // Stop the tf timer
   if (publish_to_tf_)
   {
@@ -200,9 +230,35 @@ void Pose2DPublisher::onStop()
   }
 }
 
+void Pose2DPublisher::covarianceRequestCallback(
+  const fuse_core::Transaction& transaction,
+  const fuse_core::Graph& graph,
+  std::vector<fuse_core::CovarianceBlocks::Request>& requests)
+{
+  // onStart() resets the synchronizer in the publisher's thread
+  std::lock_guard<std::mutex> lock(covariance_request_mutex_);
+  if (!covariance_synchronizer_)
+  {
+    return;
+  }
+  // Keep the synchronizer up to date even when nobody is listening
+  auto latest_stamp = covariance_synchronizer_->findLatestCommonStamp(transaction, graph);
+  if ((latest_stamp == Synchronizer::TIME_ZERO) ||
+      (pose_with_covariance_publisher_->get_subscription_count() == 0))
+  {
+    return;
+  }
+  const auto orientation_uuid = fuse_variables::Orientation2DStamped(latest_stamp, device_id_).uuid();
+  const auto position_uuid = fuse_variables::Position2DStamped(latest_stamp, device_id_).uuid();
+  requests.emplace_back(position_uuid, position_uuid);
+  requests.emplace_back(position_uuid, orientation_uuid);
+  requests.emplace_back(orientation_uuid, orientation_uuid);
+}
+
 void Pose2DPublisher::notifyCallback(
   fuse_core::Transaction::ConstSharedPtr transaction,
-  fuse_core::Graph::ConstSharedPtr graph)
+  fuse_core::Graph::ConstSharedPtr graph,
+  fuse_core::CovarianceBlocks::ConstSharedPtr covariance_blocks)
 {
   auto latest_stamp = synchronizer_->findLatestCommonStamp(*transaction, *graph);
   if (latest_stamp == Synchronizer::TIME_ZERO)
@@ -268,28 +324,76 @@ void Pose2DPublisher::notifyCallback(
   }
   if (pose_with_covariance_publisher_->get_subscription_count() > 0)
   {
-    // Get the covariance from the graph
+    // Get the covariance computed by the optimizer, or compute it from the graph if it is not available
     std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>> requests;
     requests.emplace_back(position_uuid, position_uuid);
     requests.emplace_back(position_uuid, orientation_uuid);
     requests.emplace_back(orientation_uuid, orientation_uuid);
-    std::vector<std::vector<double>> covariance_blocks;
-    graph->getCovariance(requests, covariance_blocks);
-    geometry_msgs::msg::PoseWithCovarianceStamped msg;
-    msg.header.stamp = fuse_core::stamp_to_ros(latest_stamp);
-    msg.header.frame_id = map_frame_;
-    msg.pose.pose = pose;
-    msg.pose.covariance[0] = covariance_blocks[0][0];
-    msg.pose.covariance[1] = covariance_blocks[0][1];
-    msg.pose.covariance[6] = covariance_blocks[0][2];
-    msg.pose.covariance[7] = covariance_blocks[0][3];
-    msg.pose.covariance[5] = covariance_blocks[1][0];
-    msg.pose.covariance[11] = covariance_blocks[1][1];
-    msg.pose.covariance[30] = covariance_blocks[1][0];
-    msg.pose.covariance[31] = covariance_blocks[1][1];
-    msg.pose.covariance[35] = covariance_blocks[2][0];
-    pose_with_covariance_publisher_->publish(msg);
+    std::vector<std::vector<double>> covariance_matrices;
+    if (covariance_blocks && covariance_blocks->get(requests, covariance_matrices))
+    {
+      publishPoseWithCovariance(latest_stamp, pose, covariance_matrices);
+    }
+    else if (covariance_worker_)
+    {
+      // Compute the covariance against the same graph snapshot in the worker thread. If the worker is still busy
+      // when the next pose arrives, this job is replaced by the newer one.
+      covariance_worker_->submit(
+        [this, graph, latest_stamp, pose, requests]()
+        {
+          std::vector<std::vector<double>> covariance_matrices;
+          try
+          {
+            graph->getCovariance(requests, covariance_matrices);
+          }
+          catch (const std::exception& e)
+          {
+            auto clk = rclcpp::Clock(RCL_SYSTEM_TIME);
+            RCLCPP_WARN_STREAM_THROTTLE(node_->get_logger(), clk, 10.0, "Failed to compute the covariance of the "
+                                        "pose at time " << latest_stamp << ". Error: " << e.what());
+            return;
+          }
+          publishPoseWithCovariance(latest_stamp, pose, covariance_matrices);
+        });  // NOLINT(whitespace/braces)
+    }
+    else
+    {
+      graph->getCovariance(requests, covariance_matrices);
+      publishPoseWithCovariance(latest_stamp, pose, covariance_matrices);
+    }
+  }
+}
+
+void Pose2DPublisher::publishPoseWithCovariance(
+  const fuse_core::TimeStamp& stamp,
+  const geometry_msgs::msg::Pose& pose,
+  const std::vector<std::vector<double>>& covariance_matrices)
+{
+  {
+    // Never publish an older pose after a newer one, which could happen when an asynchronous covariance job finishes
+    // after a newer pose was published with the covariance computed by the optimizer. A pose with the same stamp is
+    // still published, because it carries the estimate refined by the latest optimization cycle.
+    std::lock_guard<std::mutex> lock(covariance_mutex_);
+    if (stamp < covariance_stamp_)
+    {
+      return;
+    }
+    covariance_stamp_ = stamp;
   }
+  geometry_msgs::msg::PoseWithCovarianceStamped msg;
+  msg.header.stamp = fuse_core::stamp_to_ros(stamp);
+  msg.header.frame_id = map_frame_;
+  msg.pose.pose = pose;
+  msg.pose.covariance[0] = covariance_matrices[0][0];
+  msg.pose.covariance[1] = covariance_matrices[0][1];
+  msg.pose.covariance[6] = covariance_matrices[0][2];
+  msg.pose.covariance[7] = covariance_matrices[0][3];
+  msg.pose.covariance[5] = covariance_matrices[1][0];
+  msg.pose.covariance[11] = covariance_matrices[1][1];
+  msg.pose.covariance[30] = covariance_matrices[1][0];
+  msg.pose.covariance[31] = covariance_matrices[1][1];
+  msg.pose.covariance[35] = covariance_matrices[2][0];
+  pose_with_covariance_publisher_->publish(msg);
 }
 
 void Pose2DPublisher::tfPublishTimerCallback()
@@ -44,6 +44,9 @@
 #include <pluginlib/class_list_macros.hpp>
 #include <ros/ros.h>
 
+#include <stdexcept>
+#include <string>
+
 
 // Register this publisher with ROS as a plugin.
 PLUGINLIB_EXPORT_CLASS(fuse_publishers::SerializedPublisher, fuse_core::Publisher)
@@ -54,6 +57,8 @@ namespace fuse_publishers
 SerializedPublisher::SerializedPublisher() :
   fuse_core::AsyncPublisher(1),
   frame_id_("map"),
+  serialization_format_(fuse_core::SerializationFormat::BOOST_BINARY),
+  graph_delta_subscriber_count_(0),
   graph_publisher_throttled_callback_(
       std::bind(&SerializedPublisher::graphPublisherCallback, this, std::placeholders::_1, std::placeholders::_2))
 {
@@ -64,6 +69,23 @@ void SerializedPublisher::onInit()
   // Configure the publisher
   private_node_handle_.getParam("frame_id", frame_id_);
 
+  // Either "boost" or "flat". Subscribers detect the encoding of each message.
+  std::string serialization_format = "boost";
+  private_node_handle_.getParam("serialization_format", serialization_format);
+  if (serialization_format == "boost")
+  {
+    serialization_format_ = fuse_core::SerializationFormat::BOOST_BINARY;
+  }
+  else if (serialization_format == "flat")
+  {
+    serialization_format_ = fuse_core::SerializationFormat::FLAT;
+  }
+  else
+  {
+    throw std::runtime_error("Invalid serialization_format '" + serialization_format +
+                             "'. Expected 'boost' or 'flat'.");
+  }
+
   bool latch = false;
   private_node_handle_.getParam("latch", latch);
 
@@ -73,11 +95,21 @@ void SerializedPublisher::onInit()
   bool graph_throttle_use_wall_time{ false };
   private_node_handle_.getParam("graph_throttle_use_wall_time", graph_throttle_use_wall_time);
 
+  int graph_delta_keyframe_interval{ 10 };
+  private_node_handle_.getParam("graph_delta_keyframe_interval", graph_delta_keyframe_interval);
+  if (graph_delta_keyframe_interval < 0)
+  {
+    throw std::runtime_error("Invalid negative graph_delta_keyframe_interval of " +
+                             std::to_string(graph_delta_keyframe_interval) + " specified.");
+  }
+  graph_delta_encoder_ = fuse_core::flat::GraphDeltaEncoder(static_cast<size_t>(graph_delta_keyframe_interval));
+
   graph_publisher_throttled_callback_.setThrottlePeriod(graph_throttle_period);
   graph_publisher_throttled_callback_.setUseWallTime(graph_throttle_use_wall_time);
 
   // Advertise the topics
   graph_publisher_ = private_node_handle_.advertise<fuse_msgs::SerializedGraph>("graph", 1, latch);
+  graph_delta_publisher_ = private_node_handle_.advertise<fuse_msgs::SerializedGraph>("graph_delta", 10);
   transaction_publisher_ = private_node_handle_.advertise<fuse_msgs::SerializedTransaction>("transaction", 1, latch);
 }
 
@@ -91,12 +123,29 @@ void SerializedPublisher::notifyCallback(
     graph_publisher_throttled_callback_(graph, stamp);
   }
 
+  // A delta is only useful to a subscriber that received the message before it, so start the stream over with a
+  // keyframe whenever a subscriber connects
+  const uint32_t graph_delta_subscriber_count = graph_delta_publisher_.getNumSubscribers();
+  if (graph_delta_subscriber_count > graph_delta_subscriber_count_)
+  {
+    graph_delta_encoder_.requestKeyframe();
+  }
+  graph_delta_subscriber_count_ = graph_delta_subscriber_count;
+  if (graph_delta_subscriber_count > 0)
+  {
+    fuse_msgs::SerializedGraph msg;
+    msg.header.stamp = stamp;
+    msg.header.frame_id = frame_id_;
+    fuse_core::serializeGraphDelta(*graph, graph_delta_encoder_, msg);
+    graph_delta_publisher_.publish(msg);
+  }
+
   if (transaction_publisher_.getNumSubscribers() > 0)
   {
     fuse_msgs::SerializedTransaction msg;
     msg.header.stamp = stamp;
     msg.header.frame_id = frame_id_;
-    fuse_core::serializeTransaction(*transaction, msg);
+    fuse_core::serializeTransaction(*transaction, msg, serialization_format_);
     transaction_publisher_.publish(msg);
   }
 }
@@ -106,7 +155,7 @@ void SerializedPublisher::graphPublisherCallback(fuse_core::Graph::ConstSharedPt
   fuse_msgs::SerializedGraph msg;
   msg.header.stamp = stamp;
   msg.header.frame_id = frame_id_;
-  fuse_core::serializeGraph(*graph, msg);
+  fuse_core::serializeGraph(*graph, msg, serialization_format_);
   graph_publisher_.publish(msg);
 }
 
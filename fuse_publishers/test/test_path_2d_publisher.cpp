@@ -47,6 +47,7 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
 #include <vector>
 
 
@@ -153,6 +154,66 @@ public:
     received_pose_array_msg_ = true;
   }
 
+  /**
+   * @brief Remove the pose of the default device at the provided stamp, and its prior, from the graph
+   *
+   * @return The transaction applied to the graph
+   */
+  fuse_core::Transaction::SharedPtr removePose(const ros::Time& stamp)
+  {
+    auto transaction = fuse_core::Transaction::make_shared();
+    transaction->stamp(stamp);
+    const auto position_uuid = fuse_variables::Position2DStamped(stamp).uuid();
+    const auto orientation_uuid = fuse_variables::Orientation2DStamped(stamp).uuid();
+    for (const auto& constraint : graph_->getConnectedConstraints(position_uuid))
+    {
+      transaction->removeConstraint(constraint.uuid());
+    }
+    transaction->removeVariable(position_uuid);
+    transaction->removeVariable(orientation_uuid);
+    graph_->update(*transaction);
+    return transaction;
+  }
+
+  /**
+   * @brief Send the transaction and graph to the publisher, and wait for the resulting path message
+   *
+   * @return True if a path message was received
+   */
+  bool notifyAndWaitForPath(
+    fuse_publishers::Path2DPublisher& publisher,
+    const fuse_core::Transaction::SharedPtr& transaction)
+  {
+    received_path_msg_ = false;
+    publisher.notify(transaction, graph_);
+
+    ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+    while ((!received_path_msg_) && (ros::Time::now() < timeout))
+    {
+      ros::Duration(0.10).sleep();
+    }
+    return received_path_msg_;
+  }
+
+  /**
+   * @brief Subscribe to the path topic of the named publisher, and wait for the connection
+   */
+  ros::Subscriber subscribePath(const std::string& publisher_name)
+  {
+    auto subscriber = private_node_handle_.subscribe(
+      publisher_name + "/path",
+      1,
+      &Path2DPublisherTestFixture::pathCallback,
+      this);
+
+    ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+    while ((subscriber.getNumPublishers() == 0) && (ros::Time::now() < timeout))
+    {
+      ros::Duration(0.10).sleep();
+    }
+    return subscriber;
+  }
+
 protected:
   ros::NodeHandle node_handle_;
   ros::NodeHandle private_node_handle_;
@@ -246,6 +307,62 @@ TEST_F(Path2DPublisherTestFixture, PublishPath)
   EXPECT_NEAR(3.02, tf2::getYaw(pose_array_msg_.poses[2].orientation), 1.0e-9);
 }
 
+TEST_F(Path2DPublisherTestFixture, PublishPathWithoutHistory)
+{
+  // Test that the poses removed from the graph are removed from the path
+  private_node_handle_.setParam("test_no_history_publisher/frame_id", "test_map");
+  fuse_publishers::Path2DPublisher publisher;
+  publisher.initialize("test_no_history_publisher");
+  publisher.start();
+  ros::Subscriber subscriber = subscribePath("test_no_history_publisher");
+
+  ASSERT_TRUE(notifyAndWaitForPath(publisher, transaction_));
+  ASSERT_EQ(3ul, path_msg_.poses.size());
+
+  ASSERT_TRUE(notifyAndWaitForPath(publisher, removePose(ros::Time(1234, 10))));
+  ASSERT_EQ(2ul, path_msg_.poses.size());
+  EXPECT_EQ(ros::Time(1235, 9), path_msg_.poses[0].header.stamp);
+  EXPECT_EQ(ros::Time(1235, 10), path_msg_.poses[1].header.stamp);
+  EXPECT_NEAR(1.02, path_msg_.poses[1].pose.position.x, 1.0e-9);
+  EXPECT_NEAR(2.02, path_msg_.poses[1].pose.position.y, 1.0e-9);
+  EXPECT_NEAR(3.02, tf2::getYaw(path_msg_.poses[1].pose.orientation), 1.0e-9);
+}
+
+TEST_F(Path2DPublisherTestFixture, PublishPathWithHistory)
+{
+  // Test that the poses removed from the graph are kept in the path, up to the max history length
+  private_node_handle_.setParam("test_history_publisher/frame_id", "test_map");
+  private_node_handle_.setParam("test_history_publisher/keep_history", true);
+  private_node_handle_.setParam("test_history_publisher/max_history_length", 1);
+  fuse_publishers::Path2DPublisher publisher;
+  publisher.initialize("test_history_publisher");
+  publisher.start();
+  ros::Subscriber subscriber = subscribePath("test_history_publisher");
+
+  ASSERT_TRUE(notifyAndWaitForPath(publisher, transaction_));
+  ASSERT_EQ(3ul, path_msg_.poses.size());
+
+  // The removed pose is published with its last optimized value
+  ASSERT_TRUE(notifyAndWaitForPath(publisher, removePose(ros::Time(1234, 10))));
+  ASSERT_EQ(3ul, path_msg_.poses.size());
+  EXPECT_EQ(ros::Time(1234, 10), path_msg_.poses[0].header.stamp);
+  EXPECT_EQ("test_map", path_msg_.poses[0].header.frame_id);
+  EXPECT_NEAR(1.01, path_msg_.poses[0].pose.position.x, 1.0e-9);
+  EXPECT_NEAR(2.01, path_msg_.poses[0].pose.position.y, 1.0e-9);
+  EXPECT_NEAR(3.01, tf2::getYaw(path_msg_.poses[0].pose.orientation), 1.0e-9);
+  EXPECT_EQ(ros::Time(1235, 9), path_msg_.poses[1].header.stamp);
+  EXPECT_EQ(ros::Time(1235, 10), path_msg_.poses[2].header.stamp);
+
+  // The history only keeps the most recently removed pose
+  ASSERT_TRUE(notifyAndWaitForPath(publisher, removePose(ros::Time(1235, 9))));
+  ASSERT_EQ(2ul, path_msg_.poses.size());
+  EXPECT_EQ(ros::Time(1235, 9), path_msg_.poses[0].header.stamp);
+  EXPECT_NEAR(1.03, path_msg_.poses[0].pose.position.x, 1.0e-9);
+  EXPECT_NEAR(2.03, path_msg_.poses[0].pose.position.y, 1.0e-9);
+  EXPECT_NEAR(3.03, tf2::getYaw(path_msg_.poses[0].pose.orientation), 1.0e-9);
+  EXPECT_EQ(ros::Time(1235, 10), path_msg_.poses[1].header.stamp);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -48,9 +48,44 @@
 
 #include <gtest/gtest.h>
 
+#include <future>
+#include <memory>
+#include <utility>
 #include <vector>
 
 
+/**
+ * @brief Graph that holds every covariance computation until it is released
+ */
+class BlockingCovarianceGraph : public fuse_graphs::HashGraph
+{
+public:
+  explicit BlockingCovarianceGraph(const fuse_graphs::HashGraph& graph) :
+    fuse_graphs::HashGraph(graph),
+    released_(release_.get_future().share())
+  {
+  }
+
+  void getCovariance(
+    const std::vector<std::pair<fuse_core::UUID, fuse_core::UUID>>& covariance_requests,
+    std::vector<std::vector<double>>& covariance_matrices,
+    const ceres::Covariance::Options& options = ceres::Covariance::Options(),
+    const bool use_tangent_space = true) const override
+  {
+    released_.wait();
+    fuse_graphs::HashGraph::getCovariance(covariance_requests, covariance_matrices, options, use_tangent_space);
+  }
+
+  void release()
+  {
+    release_.set_value();
+  }
+
+private:
+  std::promise<void> release_;
+  std::shared_future<void> released_;
+};
+
 /**
  * @brief Test fixture for the LatestStampedPose2DPublisher
  *
@@ -280,6 +315,73 @@ TEST_F(Pose2DPublisherTestFixture, PublishPoseWithCovariance)
   }
 }
 
+TEST_F(Pose2DPublisherTestFixture, PublishPoseWithCovarianceAsync)
+{
+  // Test that the covariance is computed in the worker thread when async_covariance is set, and that the poses are
+  // still published while it is being computed
+
+  // Create a publisher and send it the graph
+  private_node_handle_.setParam("test_async_publisher/map_frame", "test_map");
+  private_node_handle_.setParam("test_async_publisher/odom_frame", "test_odom");
+  private_node_handle_.setParam("test_async_publisher/base_frame", "test_base");
+  private_node_handle_.setParam("test_async_publisher/publish_to_tf", false);
+  private_node_handle_.setParam("test_async_publisher/async_covariance", true);
+  fuse_publishers::Pose2DPublisher publisher;
+  publisher.initialize("test_async_publisher");
+  publisher.start();
+
+  // Subscribe to the "pose" and "pose_with_covariance" topics
+  ros::Subscriber pose_subscriber = private_node_handle_.subscribe(
+    "test_async_publisher/pose",
+    1,
+    &Pose2DPublisherTestFixture::poseCallback,
+    reinterpret_cast<Pose2DPublisherTestFixture*>(this));
+  ros::Subscriber pose_with_covariance_subscriber = private_node_handle_.subscribe(
+    "test_async_publisher/pose_with_covariance",
+    1,
+    &Pose2DPublisherTestFixture::poseWithCovarianceCallback,
+    reinterpret_cast<Pose2DPublisherTestFixture*>(this));
+
+  // Send the graph to the Publisher. The covariance computation blocks until the graph is released.
+  auto graph = std::make_shared<BlockingCovarianceGraph>(*graph_);
+  publisher.notify(transaction_, graph);
+  ros::Time timeout = ros::Time::now() + ros::Duration(10.0);
+  while ((!received_pose_msg_) && (ros::Time::now() < timeout))
+  {
+    ros::Duration(0.10).sleep();
+  }
+  EXPECT_TRUE(received_pose_msg_);
+
+  // The covariance is computed in the worker thread, so the publisher is free to publish the next pose
+  received_pose_msg_ = false;
+  publisher.notify(transaction_, graph);
+  timeout = ros::Time::now() + ros::Duration(10.0);
+  while ((!received_pose_msg_) && (ros::Time::now() < timeout))
+  {
+    ros::Duration(0.10).sleep();
+  }
+  EXPECT_TRUE(received_pose_msg_);
+  EXPECT_FALSE(received_pose_with_covariance_msg_);
+
+  // Once the computation completes, the pose with covariance is published
+  graph->release();
+  timeout = ros::Time::now() + ros::Duration(10.0);
+  while ((!received_pose_with_covariance_msg_) && (ros::Time::now() < timeout))
+  {
+    ros::Duration(0.10).sleep();
+  }
+
+  ASSERT_TRUE(received_pose_with_covariance_msg_);
+  EXPECT_EQ(ros::Time(1235, 10), pose_with_covariance_msg_.header.stamp);
+  EXPECT_EQ("test_map", pose_with_covariance_msg_.header.frame_id);
+  EXPECT_NEAR(1.02, pose_with_covariance_msg_.pose.pose.position.x, 1.0e-9);
+  EXPECT_NEAR(2.02, pose_with_covariance_msg_.pose.pose.position.y, 1.0e-9);
+  EXPECT_NEAR(3.02, tf2::getYaw(pose_with_covariance_msg_.pose.pose.orientation), 1.0e-9);
+  EXPECT_NEAR(1.02, pose_with_covariance_msg_.pose.covariance[0], 1.0e-9);
+  EXPECT_NEAR(2.02, pose_with_covariance_msg_.pose.covariance[7], 1.0e-9);
+  EXPECT_NEAR(3.02, pose_with_covariance_msg_.pose.covariance[35], 1.0e-9);
+}
+
 TEST_F(Pose2DPublisherTestFixture, PublishTfWithoutOdom)
 {
   // Test that the expected TFMessage is published
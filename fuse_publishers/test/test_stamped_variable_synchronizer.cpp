@@ -155,6 +155,52 @@ TEST(StampedVariableSynchronizer, Remove)
   EXPECT_EQ(ros::Time(20, 0), actual2);
 }
 
+TEST(StampedVariableSynchronizer, SlidingWindow)
+{
+  // Add and remove variables in the same transactions, as a fixed-lag smoother would
+
+  // Create the synchronizer
+  auto sync = StampedVariableSynchronizer<Orientation2DStamped, Position2DStamped>(generate("blank"));
+
+  // Define the first transaction and graph
+  auto transaction1 = fuse_core::Transaction();
+  auto graph = fuse_graphs::HashGraph();
+  graph.addVariable(fuse_variables::Orientation2DStamped::make_shared(ros::Time(10, 0), generate("blank")));
+  graph.addVariable(fuse_variables::Position2DStamped::make_shared(ros::Time(10, 0), generate("blank")));
+  graph.addVariable(fuse_variables::Orientation2DStamped::make_shared(ros::Time(20, 0), generate("blank")));
+  graph.addVariable(fuse_variables::Position2DStamped::make_shared(ros::Time(20, 0), generate("blank")));
+
+  // Use the synchronizer
+  auto actual1 = sync.findLatestCommonStamp(transaction1, graph);
+  EXPECT_EQ(ros::Time(20, 0), actual1);
+
+  // Add a partial set and complete it in the next transaction, while removing the oldest set
+  auto transaction2 = fuse_core::Transaction();
+  transaction2.addVariable(fuse_variables::Orientation2DStamped::make_shared(ros::Time(30, 0), generate("blank")));
+  transaction2.removeVariable(fuse_variables::Orientation2DStamped(ros::Time(10, 0), generate("blank")).uuid());
+  transaction2.removeVariable(fuse_variables::Position2DStamped(ros::Time(10, 0), generate("blank")).uuid());
+  graph.update(transaction2);
+
+  auto actual2 = sync.findLatestCommonStamp(transaction2, graph);
+  EXPECT_EQ(ros::Time(20, 0), actual2);
+
+  auto transaction3 = fuse_core::Transaction();
+  transaction3.addVariable(fuse_variables::Position2DStamped::make_shared(ros::Time(30, 0), generate("blank")));
+  transaction3.removeVariable(fuse_variables::Orientation2DStamped(ros::Time(20, 0), generate("blank")).uuid());
+  graph.update(transaction3);
+
+  auto actual3 = sync.findLatestCommonStamp(transaction3, graph);
+  EXPECT_EQ(ros::Time(30, 0), actual3);
+
+  // Remove the only remaining complete set
+  auto transaction4 = fuse_core::Transaction();
+  transaction4.removeVariable(fuse_variables::Position2DStamped(ros::Time(30, 0), generate("blank")).uuid());
+  graph.update(transaction4);
+
+  auto actual4 = sync.findLatestCommonStamp(transaction4, graph);
+  EXPECT_EQ(fuse_core::TimeStamp(), actual4);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
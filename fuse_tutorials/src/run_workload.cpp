@@ -0,0 +1,308 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fuse_core/time.h>
+#include <fuse_core/transaction.h>
+#include <fuse_graphs/hash_graph.h>
+#include <fuse_optimizers/fixed_lag_smoother.h>
+#include <fuse_optimizers/workload_generator.h>
+#include <fuse_tutorials/range_constraint.h>
+#include <fuse_variables/point_2d_landmark.h>
+#include <fuse_variables/position_2d_stamped.h>
+
+#include <boost/range/size.hpp>
+#include <ceres/solver.h>
+#include <rclcpp/rclcpp.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * @brief A FixedLagSmoother that exposes its graph and the results of its last optimization cycle
+ */
+class WorkloadSmoother : public fuse_optimizers::FixedLagSmoother
+{
+public:
+  using FixedLagSmoother::CycleTimings;
+
+  explicit WorkloadSmoother(const std::vector<rclcpp::Parameter>& parameters) :
+    FixedLagSmoother(
+      rclcpp::NodeOptions().parameter_overrides(parameters),
+      "run_workload",
+      fuse_graphs::HashGraph::make_unique())
+  {
+  }
+
+  /**
+   * @brief Run one optimization cycle on the calling thread, if there are pending transactions
+   *
+   * @return True if an optimization cycle ran
+   */
+  bool optimizeCycle()
+  {
+    // Clear the results of the previous cycle, so a call without pending transactions is not counted twice
+    cycle_timings_ = CycleTimings();
+    summary_ = ceres::Solver::Summary();
+    optimizePending();
+    return !summary_.iterations.empty();
+  }
+
+  const fuse_core::Graph& graph() const { return *graph_; }
+
+  const CycleTimings& cycleTimings() const { return cycle_timings_; }
+
+  size_t iterationCount() const { return summary_.iterations.size(); }
+};
+
+/**
+ * @brief Print the command line usage
+ */
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [name:=value]... [--ros-args --params-file <optimizer config>]\n"
+            << "\n"
+            << "Feeds the transactions of a fuse_optimizers::WorkloadGenerator into an in-process\n"
+            << "fuse_optimizers::FixedLagSmoother, without any ROS transport, timers or wall clock pacing. The\n"
+            << "optimizer timer is replaced by the simulated time: an optimization cycle runs whenever a transaction\n"
+            << "arrives one 'optimization_period' or more after the previous cycle was due.\n"
+            << "\n"
+            << "Optimizer parameters, which take precedence over the optimizer config:\n"
+            << "  lag_duration         The smoothing window, in simulated seconds\n"
+            << "  optimization_period  Simulated seconds between optimization cycles\n"
+            << "  max_num_iterations   Max solver iterations per optimization cycle\n"
+            << "\n"
+            << "Any other parameter is a member of fuse_optimizers::WorkloadGeneratorParams, e.g.\n"
+            << "  " << program << " robot_count:=20 beacon_count:=5000 range_limit:=15 outlier_fraction:=0.1\n";
+}
+
+}  // namespace
+
+/**
+ * @brief Stress test the optimizer with a synthetic, deterministic range sensor workload
+ *
+ * The transactions are replayed into a FixedLagSmoother as fast as they are generated, and each optimization cycle
+ * runs on the main thread with optimizePending(), so the complete pipeline is exercised: the pending transaction
+ * queue, the graph update, the optimization, the plugin notification and the marginalization. No sensor models need
+ * to be configured, so the smoother starts immediately. The time spent in each stage, the final graph size and the
+ * beacon position error are printed at the end, so the same command line can be used to compare builds.
+ */
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  const auto args = rclcpp::remove_ros_arguments(argc, argv);
+
+  auto params = fuse_optimizers::WorkloadGeneratorParams();
+  auto optimizer_parameters = std::vector<rclcpp::Parameter>();
+  try
+  {
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+      const auto& arg = args[i];
+      const auto separator = arg.find(":=");
+      if (separator == std::string::npos)
+      {
+        printUsage(argv[0]);
+        rclcpp::shutdown();
+        return EXIT_FAILURE;
+      }
+
+      const auto name = arg.substr(0, separator);
+      const auto value = arg.substr(separator + 2);
+      if (name == "lag_duration" || name == "optimization_period")
+      {
+        optimizer_parameters.emplace_back(name, std::stod(value));
+      }
+      else if (name == "max_num_iterations")
+      {
+        optimizer_parameters.emplace_back(name, std::stoi(value));
+      }
+      else
+      {
+        params.set(name, value);
+      }
+    }
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << "\n\n";
+    printUsage(argv[0]);
+    rclcpp::shutdown();
+    return EXIT_FAILURE;
+  }
+
+  auto generator = fuse_optimizers::WorkloadGenerator(
+    params,
+    [](
+      const std::string& source,
+      const fuse_variables::Position2DStamped& robot_position,
+      const fuse_variables::Point2DLandmark& beacon_position,
+      const double z,
+      const double sigma)
+    {
+      return fuse_tutorials::RangeConstraint::make_shared(source, robot_position, beacon_position, z, sigma);
+    });  // NOLINT(whitespace/braces)
+  auto optimizer = std::make_shared<WorkloadSmoother>(optimizer_parameters);
+  const auto optimization_period = fuse_core::fromSec(optimizer->get_parameter("optimization_period").as_double());
+
+  using Clock = std::chrono::steady_clock;
+  auto generate_time = Clock::duration::zero();
+  auto replay_time = Clock::duration::zero();
+  auto cycle_time = Clock::duration::zero();
+  auto max_cycle_time = Clock::duration::zero();
+  auto timings = WorkloadSmoother::CycleTimings();
+  auto transaction_count = size_t{0};
+  auto optimization_count = size_t{0};
+  auto iteration_count = size_t{0};
+
+  auto optimize = [&]()
+  {
+    const auto start = Clock::now();
+    if (!optimizer->optimizeCycle())
+    {
+      return;
+    }
+    const auto elapsed = Clock::now() - start;
+    cycle_time += elapsed;
+    max_cycle_time = std::max(max_cycle_time, elapsed);
+    ++optimization_count;
+
+    const auto& cycle_timings = optimizer->cycleTimings();
+    timings.process_queue += cycle_timings.process_queue;
+    timings.update_graph += cycle_timings.update_graph;
+    timings.optimize += cycle_timings.optimize;
+    timings.notify += cycle_timings.notify;
+    timings.marginalize += cycle_timings.marginalize;
+    iteration_count += optimizer->iterationCount();
+  };  // NOLINT(whitespace/braces)
+
+  const auto start = Clock::now();
+  auto next_optimization = fuse_core::TimeStamp();
+  auto last_callback = Clock::now();
+  generator.generate(
+    [&](const std::string& sensor_name, fuse_core::Transaction::SharedPtr transaction)
+    {
+      const auto replay_start = Clock::now();
+      generate_time += replay_start - last_callback;
+
+      // The smoother shuts ROS down if an optimization fails. Generate the rest of the workload without replaying it.
+      if (!rclcpp::ok())
+      {
+        last_callback = Clock::now();
+        return;
+      }
+
+      // Run a cycle once a full optimization period was replayed, before the first transaction of the next one
+      if (!next_optimization.initialised())
+      {
+        next_optimization = transaction->stamp() + optimization_period;
+      }
+      else if (transaction->stamp() >= next_optimization)
+      {
+        optimize();
+        // Keep the phase of the optimizer timer, skipping the periods that did not receive any transactions
+        const auto periods = (transaction->stamp() - next_optimization) / optimization_period + 1;
+        next_optimization = next_optimization + periods * optimization_period;
+      }
+
+      const auto optimized = Clock::now();
+      optimizer->replayTransaction(sensor_name, std::move(transaction));
+      ++transaction_count;
+
+      last_callback = Clock::now();
+      replay_time += last_callback - optimized;
+    });  // NOLINT(whitespace/braces)
+  if (rclcpp::ok())
+  {
+    optimize();
+  }
+  const auto total_time = Clock::now() - start;
+
+  // Compare the optimized positions of the beacons still in the smoothing window with the truth
+  const auto& graph = optimizer->graph();
+  auto squared_error = 0.0;
+  auto beacon_count = size_t{0};
+  for (auto id = 0u; id < generator.beacons().size(); ++id)
+  {
+    const auto uuid = fuse_variables::Point2DLandmark(id).uuid();
+    if (!graph.variableExists(uuid))
+    {
+      continue;
+    }
+
+    const auto& beacon = generator.beacons()[id];
+    const auto& variable = graph.getVariable(uuid);
+    const auto dx = variable.data()[fuse_variables::Point2DLandmark::X] - beacon.x;
+    const auto dy = variable.data()[fuse_variables::Point2DLandmark::Y] - beacon.y;
+    squared_error += dx * dx + dy * dy;
+    ++beacon_count;
+  }
+
+  const auto seconds = [](const Clock::duration& duration)
+  {
+    return std::chrono::duration<double>(duration).count();
+  };  // NOLINT(whitespace/braces)
+
+  std::cout << "transactions:        " << transaction_count << "\n"
+            << "variables:           " << boost::size(graph.getVariables()) << "\n"
+            << "constraints:         " << boost::size(graph.getConstraints()) << "\n"
+            << "optimizations:       " << optimization_count << " (" << iteration_count << " iterations)\n"
+            << "total time:          " << seconds(total_time) << " s\n"
+            << "  generate:          " << seconds(generate_time) << " s\n"
+            << "  replay:            " << seconds(replay_time) << " s\n"
+            << "  optimizer cycles:  " << seconds(cycle_time) << " s (max " << seconds(max_cycle_time) << " s)\n"
+            << "    process queue:   " << seconds(timings.process_queue) << " s\n"
+            << "    update graph:    " << seconds(timings.update_graph) << " s\n"
+            << "    optimize:        " << seconds(timings.optimize) << " s\n"
+            << "    notify:          " << seconds(timings.notify) << " s\n"
+            << "    marginalize:     " << seconds(timings.marginalize) << " s\n"
+            << "beacon RMSE:         "
+            << (beacon_count == 0 ? 0.0 : std::sqrt(squared_error / beacon_count)) << " m (" << beacon_count
+            << " beacons)\n";
+
+  // The optimization thread only exits once ROS is shut down
+  const auto success = rclcpp::ok();
+  rclcpp::shutdown();
+  optimizer.reset();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,90 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FUSE_VARIABLES_STAMPED_FLAT_CODEC_H
+#define FUSE_VARIABLES_STAMPED_FLAT_CODEC_H
+
+#include <fuse_core/flat_serialization.h>
+#include <fuse_core/uuid.h>
+#include <fuse_core/variable.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace fuse_variables
+{
+
+/**
+ * @brief A flat serialization codec for stamped variables
+ *
+ * This works for any variable type derived from both fuse_core::Variable and Stamped that can be constructed from a
+ * stamp and device id, and whose UUID is generated from them. The payload holds the stamp and device id; the values
+ * are already stored in the fixed part of the record.
+ *
+ * Register it in the source file of the variable:
+ * @code{.cpp}
+ * FUSE_FLAT_VARIABLE_CODEC_EXPORT(fuse_variables::Position2DStamped,
+ *                                 fuse_variables::StampedFlatCodec<fuse_variables::Position2DStamped>)
+ * @endcode
+ */
+template <typename VariableType>
+class StampedFlatCodec : public fuse_core::flat::VariableCodec
+{
+public:
+  void write(const fuse_core::Variable& variable, fuse_core::flat::PayloadWriter& payload) const override
+  {
+    const auto& stamped = static_cast<const VariableType&>(variable);
+    payload.write(fuse_core::flat::encodeStamp(stamped.stamp()));
+    payload.write(stamped.deviceId());
+  }
+
+  fuse_core::Variable::SharedPtr read(const fuse_core::flat::VariableView& view) const override
+  {
+    auto payload = view.payload();
+    const auto stamp = fuse_core::flat::decodeStamp(payload.read<int64_t>());
+    const auto device_id = payload.read<fuse_core::UUID>();
+    auto variable = VariableType::make_shared(stamp, device_id);
+    if (variable->uuid() != view.uuid() || variable->size() != view.size())
+    {
+      throw std::runtime_error("Flat buffer record for variable " + fuse_core::uuid::to_string(view.uuid()) +
+                               " does not match the " + view.type() + " built from its stamp and device id.");
+    }
+    std::copy(view.data(), view.data() + view.size(), variable->data());
+    return variable;
+  }
+};
+
+}  // namespace fuse_variables
+
+#endif  // FUSE_VARIABLES_STAMPED_FLAT_CODEC_H
@@ -36,6 +36,7 @@
 #include <fuse_core/uuid.h>
 #include <fuse_variables/fixed_size_variable.h>
 #include <fuse_variables/stamped.h>
+#include <fuse_variables/stamped_flat_codec.h>
 #include <pluginlib/class_list_macros.hpp>
 
 #include <boost/serialization/export.hpp>
@@ -71,3 +72,5 @@ void AccelerationAngular3DStamped::print(std::ostream& stream) const
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_variables::AccelerationAngular3DStamped)
 PLUGINLIB_EXPORT_CLASS(fuse_variables::AccelerationAngular3DStamped, fuse_core::Variable)
+FUSE_FLAT_VARIABLE_CODEC_EXPORT(fuse_variables::AccelerationAngular3DStamped,
+                                fuse_variables::StampedFlatCodec<fuse_variables::AccelerationAngular3DStamped>)
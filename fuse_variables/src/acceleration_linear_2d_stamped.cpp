@@ -36,6 +36,7 @@
 #include <fuse_core/uuid.h>
 #include <fuse_variables/fixed_size_variable.h>
 #include <fuse_variables/stamped.h>
+#include <fuse_variables/stamped_flat_codec.h>
 #include <pluginlib/class_list_macros.hpp>
 
 #include <boost/serialization/export.hpp>
@@ -68,3 +69,5 @@ void AccelerationLinear2DStamped::print(std::ostream& stream) const
 
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_variables::AccelerationLinear2DStamped)
 PLUGINLIB_EXPORT_CLASS(fuse_variables::AccelerationLinear2DStamped, fuse_core::Variable)
+FUSE_FLAT_VARIABLE_CODEC_EXPORT(fuse_variables::AccelerationLinear2DStamped,
+                                fuse_variables::StampedFlatCodec<fuse_variables::AccelerationLinear2DStamped>)
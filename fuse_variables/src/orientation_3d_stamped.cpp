@@ -37,6 +37,7 @@
 #include <fuse_core/uuid.h>
 #include <fuse_variables/fixed_size_variable.h>
 #include <fuse_variables/stamped.h>
+#include <fuse_variables/stamped_flat_codec.h>
 #include <pluginlib/class_list_macros.hpp>
 
 #include <boost/serialization/export.hpp>
@@ -78,3 +79,5 @@ fuse_core::LocalParameterization* Orientation3DStamped::localParameterization()
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_variables::Orientation3DLocalParameterization)
 BOOST_CLASS_EXPORT_IMPLEMENT(fuse_variables::Orientation3DStamped)
 PLUGINLIB_EXPORT_CLASS(fuse_variables::Orientation3DStamped, fuse_core::Variable)
+FUSE_FLAT_VARIABLE_CODEC_EXPORT(fuse_variables::Orientation3DStamped,
+                                fuse_variables::StampedFlatCodec<fuse_variables::Orientation3DStamped>)
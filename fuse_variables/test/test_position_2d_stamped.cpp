@@ -31,7 +31,9 @@
  *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  *  POSSIBILITY OF SUCH DAMAGE.
  */
+#include <fuse_core/flat_serialization.h>
 #include <fuse_core/serialization.h>
+#include <fuse_core/transaction.h>
 #include <fuse_variables/position_2d_stamped.h>
 #include <fuse_variables/stamped.h>
 #include <fuse_core/time.h>
@@ -41,6 +43,7 @@
 #include <ceres/solver.h>
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <sstream>
 #include <vector>
 
@@ -172,6 +175,41 @@ TEST(Position2DStamped, Serialization)
   EXPECT_EQ(expected.y(), actual.y());
 }
 
+TEST(Position2DStamped, FlatSerialization)
+{
+  // Create a Position2DStamped
+  auto expected = Position2DStamped::make_shared(fuse_core::TimeStamp(12345678, 910111213),
+                                                 fuse_core::uuid::generate("hal9000"));
+  expected->x() = 1.5;
+  expected->y() = -3.0;
+
+  // Serialize a transaction holding the variable into a flat buffer
+  fuse_core::Transaction transaction;
+  transaction.addVariable(expected);
+  std::vector<uint8_t> data;
+  fuse_core::flat::serializeTransaction(transaction, data);
+
+  // The values can be read in place
+  fuse_core::flat::BufferReader reader(data);
+  ASSERT_EQ(1u, reader.variableCount());
+  auto view = reader.variable(0);
+  EXPECT_EQ(expected->type(), view.type());
+  EXPECT_EQ(expected->uuid(), view.uuid());
+  ASSERT_EQ(2u, view.size());
+  EXPECT_EQ(1.5, view.data()[0]);
+  EXPECT_EQ(-3.0, view.data()[1]);
+
+  // The registered codec recreates the variable without a plugin factory
+  fuse_core::flat::ObjectFactory no_plugins;
+  fuse_core::flat::ObjectReader objects(reader, no_plugins);
+  auto actual = std::dynamic_pointer_cast<Position2DStamped>(objects.variable(0));
+  ASSERT_TRUE(static_cast<bool>(actual));
+  EXPECT_EQ(expected->deviceId(), actual->deviceId());
+  EXPECT_EQ(expected->stamp(), actual->stamp());
+  EXPECT_EQ(expected->x(), actual->x());
+  EXPECT_EQ(expected->y(), actual->y());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,150 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FUSE_VIZ_GRAPH_CHANGE_TRACKER_H
+#define FUSE_VIZ_GRAPH_CHANGE_TRACKER_H
+
+#include <fuse_viz/relative_pose_2d_stamped_constraint_batch_visual.h>
+
+#include <fuse_core/graph.h>
+#include <fuse_core/uuid.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fuse_constraints
+{
+
+class RelativePose2DStampedConstraint;
+
+}  // namespace fuse_constraints
+
+namespace fuse_variables
+{
+
+class Orientation2DStamped;
+class Position2DStamped;
+
+}  // namespace fuse_variables
+
+namespace rviz
+{
+
+/**
+ * @brief The visuals to update after a new graph was received, as computed by GraphChangeTracker
+ *
+ * The pointers refer to objects owned by the graph, which the changes keep alive.
+ */
+struct GraphChanges
+{
+  struct Pose
+  {
+    const fuse_variables::Position2DStamped* position;
+    const fuse_variables::Orientation2DStamped* orientation;
+  };
+
+  struct Constraint
+  {
+    const fuse_constraints::RelativePose2DStampedConstraint* constraint;
+    RelativePose2DStampedConstraintSegment segment;  //!< Only computed in batched mode
+  };
+
+  struct RemovedConstraint
+  {
+    fuse_core::UUID uuid;
+    std::string source;
+  };
+
+  fuse_core::Graph::ConstSharedPtr graph;  //!< The graph the changes refer to
+  bool batched{ false };  //!< Whether the graph must be drawn with the batch visuals
+  bool rebuild{ false };  //!< Whether all visuals must be cleared first, because the rendering mode changed
+  std::vector<Pose> poses;  //!< The poses added or changed
+  std::vector<fuse_core::UUID> removed_poses;  //!< The position UUID of the poses removed
+  std::vector<Constraint> constraints;  //!< The constraints added, or whose variables changed
+  std::vector<RemovedConstraint> removed_constraints;  //!< The constraints removed
+};
+
+/**
+ * @brief Compute the visuals touched by each new graph, with respect to the previous one
+ *
+ * A 2D pose is a fuse_variables::Position2DStamped and fuse_variables::Orientation2DStamped pair with the same stamp
+ * and device ID. It is touched if it is new or its value changed. A fuse_constraints::RelativePose2DStampedConstraint
+ * is touched if it is new or any of its variables was touched, because its lines and loss brightness depend on them.
+ * Everything else in the graph is ignored.
+ *
+ * The tracker does not use any Ogre or Qt object, so it can run on a background thread.
+ */
+class GraphChangeTracker
+{
+public:
+  /**
+   * @brief Compute the changes from the previous graph to this one
+   *
+   * @param[in] graph           The new graph
+   * @param[in] batch_threshold The number of poses and constraints above which the batch visuals are used
+   * @return The visuals to update
+   */
+  GraphChanges update(fuse_core::Graph::ConstSharedPtr graph, const size_t batch_threshold);
+
+  /**
+   * @brief Forget the previous graph, so the next one is reported as a rebuild
+   */
+  void clear();
+
+private:
+  struct PoseState
+  {
+    std::array<double, 3> pose;  //!< The x, y and yaw last reported
+    uint64_t generation;  //!< The last update() the pose was in the graph
+  };
+
+  struct ConstraintState
+  {
+    std::string source;
+    uint64_t generation;  //!< The last update() the constraint was in the graph
+  };
+
+  std::unordered_map<fuse_core::UUID, PoseState, fuse_core::uuid::hash> poses_;  //!< By position UUID
+  std::unordered_map<fuse_core::UUID, ConstraintState, fuse_core::uuid::hash> constraints_;
+  uint64_t generation_{ 0 };
+  bool batched_{ false };
+  bool initialized_{ false };
+};
+
+}  // namespace rviz
+
+#endif  // FUSE_VIZ_GRAPH_CHANGE_TRACKER_H
@@ -0,0 +1,135 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FUSE_VIZ_POSE_2D_STAMPED_BATCH_VISUAL_H
+#define FUSE_VIZ_POSE_2D_STAMPED_BATCH_VISUAL_H
+
+#include <fuse_core/uuid.h>
+
+#include <rviz/ogre_helpers/point_cloud.h>
+
+#include <OgreColourValue.h>
+#include <OgreVector3.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Ogre
+{
+
+class SceneManager;
+class SceneNode;
+
+}  // namespace Ogre
+
+namespace rviz
+{
+
+/**
+ * @class Pose2DStampedBatchVisual
+ *
+ * @brief Batched visual of many 2D pose variables, drawn as the billboard spheres of a single rviz::PointCloud.
+ *
+ * All the spheres are drawn by a handful of renderables, instead of the several scene nodes per variable of
+ * Pose2DStampedVisual, so large graphs render interactively. Only the position sphere is drawn; the axes and the text
+ * are not available in batched mode.
+ *
+ * The variables are stored densely, so inserting, updating or erasing one is O(1). The point cloud is only rebuilt by
+ * update(), and only if something changed since the last call.
+ */
+class Pose2DStampedBatchVisual
+{
+private:
+  /**
+   * @brief Private Constructor
+   *
+   * Pose2DStampedBatchVisual can only be constructed by friend class Pose2DStampedProperty.
+   *
+   * @param[in] scene_manager The scene manager to use to construct any necessary objects
+   * @param[in] parent_node A scene node the visual will be attached to
+   */
+  Pose2DStampedBatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node);
+
+public:
+  ~Pose2DStampedBatchVisual();
+
+  /**
+   * @brief Insert or update the position of a 2D pose variable
+   * @param[in] uuid     The UUID of the fuse_variables::Position2DStamped variable
+   * @param[in] position The variable position
+   */
+  void setPose2DStamped(const fuse_core::UUID& uuid, const Ogre::Vector3& position);
+
+  /**
+   * @brief Erase a 2D pose variable. Erasing a variable that is not in the visual is a no-op.
+   * @param[in] uuid The UUID of the fuse_variables::Position2DStamped variable
+   */
+  void erase(const fuse_core::UUID& uuid);
+
+  /**
+   * @brief Erase all the variables
+   */
+  void clear();
+
+  /**
+   * @brief Rebuild the point cloud if any variable changed since the last call
+   */
+  void update();
+
+  void setSphereColor(const float r, const float g, const float b, const float a);
+
+  void setScale(const float scale);
+
+  void setVisible(const bool visible);
+
+private:
+  Ogre::SceneManager* scene_manager_;
+  Ogre::SceneNode* root_node_;
+  std::unique_ptr<PointCloud> point_cloud_;
+
+  std::vector<PointCloud::Point> points_;  //!< The sphere of each variable, in no particular order
+  std::vector<fuse_core::UUID> uuids_;  //!< The UUID of the variable of each point
+  std::unordered_map<fuse_core::UUID, size_t, fuse_core::uuid::hash> indices_;  //!< The point of each variable
+
+  Ogre::ColourValue color_;
+  bool changed_{ false };  //!< Whether the point cloud must be rebuilt
+
+  // Make Pose2DStampedProperty friend class so it create Pose2DStampedBatchVisual objects
+  friend class Pose2DStampedProperty;
+};
+
+}  // namespace rviz
+
+#endif  // FUSE_VIZ_POSE_2D_STAMPED_BATCH_VISUAL_H
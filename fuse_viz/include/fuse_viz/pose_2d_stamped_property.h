@@ -61,6 +61,7 @@ class Orientation2DStamped;
 namespace rviz
 {
 
+class Pose2DStampedBatchVisual;
 class Pose2DStampedVisual;
 
 class Property;
@@ -73,6 +74,8 @@ class Pose2DStampedProperty : public BoolProperty
 public:
   using Visual = Pose2DStampedVisual;
   using VisualPtr = std::shared_ptr<Visual>;
+  using BatchVisual = Pose2DStampedBatchVisual;
+  using BatchVisualPtr = std::shared_ptr<BatchVisual>;
 
   Pose2DStampedProperty(const QString& name = "Pose2DStamped", bool default_value = true,
                         const QString& description = QString(), Property* parent = NULL,
@@ -86,6 +89,12 @@ public:
   void eraseVisual(const fuse_core::UUID& uuid);
   void clearVisual();
 
+  /**
+   * @brief Get the visual that draws all the variables in batched mode, creating it on the first call
+   */
+  BatchVisualPtr getOrCreateBatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node);
+  void clearBatchVisual();
+
 public Q_SLOTS:
   void updateVisibility();
 
@@ -104,7 +113,10 @@ private:
   void updateTextScale(const VisualPtr& constraint);
   void updateVisibility(const VisualPtr& constraint);
 
+  void updateBatchVisual();
+
   std::unordered_map<fuse_core::UUID, VisualPtr, fuse_core::uuid::hash> variables_;
+  BatchVisualPtr batch_visual_;
 
   ColorProperty* color_property_;
   BoolProperty* show_text_property_;
@@ -0,0 +1,180 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FUSE_VIZ_RELATIVE_POSE_2D_STAMPED_CONSTRAINT_BATCH_VISUAL_H
+#define FUSE_VIZ_RELATIVE_POSE_2D_STAMPED_CONSTRAINT_BATCH_VISUAL_H
+
+#include <fuse_core/uuid.h>
+
+#include <OgreColourValue.h>
+#include <OgreVector3.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Ogre
+{
+
+class SceneManager;
+class SceneNode;
+
+}  // namespace Ogre
+
+namespace fuse_core
+{
+
+class Graph;
+
+}  // namespace fuse_core
+
+namespace fuse_constraints
+{
+
+class RelativePose2DStampedConstraint;
+
+}  // namespace fuse_constraints
+
+namespace rviz
+{
+
+class BillboardLine;
+
+/**
+ * @brief The lines drawn for a relative 2D pose constraint, see RelativePose2DStampedConstraintVisual
+ */
+struct RelativePose2DStampedConstraintSegment
+{
+  Ogre::Vector3 position1;          //!< The first/source variable position
+  Ogre::Vector3 relative_position;  //!< The relative position wrt the first/source variable
+  Ogre::Vector3 position2;          //!< The second/target variable position
+  float loss_scale{ -1.0 };         //!< The loss scale, see computeLossScale()
+};
+
+/**
+ * @brief Compute the lines drawn for a relative 2D pose constraint
+ *
+ * @param[in] constraint fuse_constraints::RelativePose2DStampedConstraint constraint.
+ * @param[in] graph fuse_core::Graph, used to retrieve the first/source and second/target constraint variables pose.
+ * @return The constraint lines.
+ */
+RelativePose2DStampedConstraintSegment computeSegment(
+    const fuse_constraints::RelativePose2DStampedConstraint& constraint, const fuse_core::Graph& graph);
+
+/**
+ * @class RelativePose2DStampedConstraintBatchVisual
+ *
+ * @brief Batched visual of many relative 2D pose constraints of the same source.
+ *
+ * The relative pose lines of all the constraints are drawn by a single rviz::BillboardLine, and so are the error
+ * lines, instead of the several scene nodes per constraint of RelativePose2DStampedConstraintVisual. The error lines
+ * keep their per-constraint loss brightness. The axes, the covariance and the text are not available in batched mode.
+ *
+ * The constraints are stored densely, so inserting, updating or erasing one is O(1). The lines are only rebuilt by
+ * update(), and only if something changed since the last call.
+ */
+class RelativePose2DStampedConstraintBatchVisual
+{
+private:
+  /**
+   * @brief Private Constructor
+   *
+   * RelativePose2DStampedConstraintBatchVisual can only be constructed by friend class
+   * RelativePose2DStampedConstraintProperty.
+   *
+   * @param[in] scene_manager The scene manager to use to construct any necessary objects
+   * @param[in] parent_node A scene node the visual will be attached to
+   */
+  RelativePose2DStampedConstraintBatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node);
+
+public:
+  ~RelativePose2DStampedConstraintBatchVisual();
+
+  /**
+   * @brief Insert or update the lines of a constraint
+   * @param[in] uuid    The constraint UUID
+   * @param[in] segment The constraint lines, see computeSegment()
+   */
+  void setConstraint(const fuse_core::UUID& uuid, const RelativePose2DStampedConstraintSegment& segment);
+
+  /**
+   * @brief Erase a constraint. Erasing a constraint that is not in the visual is a no-op.
+   * @param[in] uuid The constraint UUID
+   */
+  void erase(const fuse_core::UUID& uuid);
+
+  /**
+   * @brief Erase all the constraints
+   */
+  void clear();
+
+  /**
+   * @brief Rebuild the lines if any constraint changed since the last call
+   */
+  void update();
+
+  void setRelativePoseLineWidth(const float line_width);
+
+  void setErrorLineWidth(const float line_width);
+
+  void setLossMinBrightness(const float min_brightness);
+
+  void setRelativePoseLineColor(const float r, const float g, const float b, const float a);
+
+  void setErrorLineColor(const float r, const float g, const float b, const float a);
+
+  void setVisible(const bool visible);
+
+private:
+  Ogre::SceneManager* scene_manager_;
+  Ogre::SceneNode* root_node_;
+  std::unique_ptr<BillboardLine> relative_pose_line_;
+  std::unique_ptr<BillboardLine> error_line_;
+
+  std::vector<RelativePose2DStampedConstraintSegment> segments_;  //!< The lines of each constraint, in no order
+  std::vector<fuse_core::UUID> uuids_;  //!< The UUID of the constraint of each segment
+  std::unordered_map<fuse_core::UUID, size_t, fuse_core::uuid::hash> indices_;  //!< The segment of each constraint
+
+  Ogre::ColourValue error_line_color_;
+  float min_brightness_{ 0.0 };
+  bool changed_{ false };  //!< Whether the lines must be rebuilt
+
+  // Make RelativePose2DStampedConstraintProperty friend class so it create RelativePose2DStampedConstraintBatchVisual
+  // objects
+  friend class RelativePose2DStampedConstraintProperty;
+};
+
+}  // namespace rviz
+
+#endif  // FUSE_VIZ_RELATIVE_POSE_2D_STAMPED_CONSTRAINT_BATCH_VISUAL_H
@@ -70,6 +70,7 @@ namespace rviz
 {
 
 class Pose2DStampedVisual;
+class RelativePose2DStampedConstraintBatchVisual;
 class RelativePose2DStampedConstraintVisual;
 
 class Property;
@@ -83,6 +84,8 @@ class RelativePose2DStampedConstraintProperty : public BoolProperty
 public:
   using Visual = RelativePose2DStampedConstraintVisual;
   using VisualPtr = std::shared_ptr<Visual>;
+  using BatchVisual = RelativePose2DStampedConstraintBatchVisual;
+  using BatchVisualPtr = std::shared_ptr<BatchVisual>;
 
   RelativePose2DStampedConstraintProperty(const QString& name = "RelativePose2DStampedConstraint",
                                           bool default_value = true, const QString& description = QString(),
@@ -97,6 +100,12 @@ public:
   void eraseVisual(const fuse_core::UUID& uuid);
   void clearVisual();
 
+  /**
+   * @brief Get the visual that draws all the constraints in batched mode, creating it on the first call
+   */
+  BatchVisualPtr getOrCreateBatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node);
+  void clearBatchVisual();
+
   void setColor(const QColor& color);
 
 public Q_SLOTS:
@@ -127,7 +136,10 @@ private:
   void updateTextScale(const VisualPtr& constraint);
   void updateVisibility(const VisualPtr& constraint);
 
+  void updateBatchVisual();
+
   std::unordered_map<fuse_core::UUID, VisualPtr, fuse_core::uuid::hash> constraints_;
+  BatchVisualPtr batch_visual_;
 
   ColorProperty* color_property_;
   BoolProperty* show_text_property_;
@@ -39,6 +39,8 @@
 
 #include <rviz/ogre_helpers/object.h>
 
+#include <tf2/LinearMath/Transform.h>
+
 #include <OgreColourValue.h>
 #include <OgreVector3.h>
 
@@ -78,6 +80,28 @@ class MovableText;
 class Pose2DStampedVisual;
 class RelativePose2DStampedConstraintProperty;
 
+/**
+ * @brief Compute the ratio between the constraint cost with and without its loss function
+ *
+ * @param[in] constraint fuse_constraints::RelativePose2DStampedConstraint constraint.
+ * @param[in] pose1 The first/source variable pose.
+ * @param[in] pose2 The second/target variable pose.
+ * @return The loss scale in the [0, 1] range, or -1 if the constraint has no loss.
+ */
+float computeLossScale(const fuse_constraints::RelativePose2DStampedConstraint& constraint, const tf2::Transform& pose1,
+                       const tf2::Transform& pose2);
+
+/**
+ * @brief Darken a constraint error line color by the loss function impact on the constraint cost
+ *
+ * @param[in] color The error line color without the loss function impact.
+ * @param[in] loss_scale The loss scale, as computed by computeLossScale(). A negative value leaves the color unchanged.
+ * @param[in] min_brightness The brightness of the color for a zero loss scale.
+ * @return The error line color with the loss function impact.
+ */
+Ogre::ColourValue computeLossErrorLineColor(const Ogre::ColourValue& color, const float loss_scale,
+                                            const float min_brightness);
+
 /**
  * @class RelativePose2DStampedConstraintVisual
  *
@@ -39,6 +39,7 @@
 #include <fuse_core/graph_deserializer.h>
 #include <fuse_core/uuid.h>
 #include <fuse_msgs/SerializedGraph.h>
+#include <fuse_viz/graph_change_tracker.h>
 
 #include <rviz/message_filter_display.h>
 
@@ -46,9 +47,13 @@
 #include <OgreSceneNode.h>
 #endif  // Q_MOC_RUN
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 namespace rviz
@@ -58,11 +63,19 @@ class Pose2DStampedVisual;
 class RelativePose2DStampedConstraintVisual;
 
 class BoolProperty;
+class IntProperty;
 class Pose2DStampedProperty;
 class RelativePose2DStampedConstraintProperty;
 
 /**
  * @brief An rviz dispaly for fuse_msgs::SerializedGraph messages.
+ *
+ * The messages are deserialized on a background thread, which also finds the variables and constraints that changed
+ * since the previous graph, see GraphChangeTracker. Only the visuals of those objects are updated on the rviz thread.
+ * If a new message arrives before the previous one was drawn, the previous one is dropped.
+ *
+ * Graphs with more poses and constraints than the "Batch Threshold" are drawn with the batch visuals, which draw all
+ * the poses, and all the constraints of each source, with a handful of renderables.
  */
 class SerializedGraphDisplay : public MessageFilterDisplay<fuse_msgs::SerializedGraph>
 {
@@ -74,6 +87,8 @@ public:
 
   void reset() override;
 
+  void update(float wall_dt, float ros_dt) override;
+
 protected:
   void onInitialize() override;
 
@@ -86,9 +101,9 @@ protected:
 private Q_SLOTS:
   void updateShowVariables();
   void updateShowConstraints();
+  void updateBatchThreshold();
 
 private:
-  using ChangedByUUIDMap = std::unordered_map<fuse_core::UUID, bool, fuse_core::uuid::hash>;
   using ConstraintByUUIDMap =
       std::unordered_map<fuse_core::UUID, std::shared_ptr<RelativePose2DStampedConstraintVisual>,
                          fuse_core::uuid::hash>;
@@ -100,23 +115,49 @@ private:
 
   void processMessage(const fuse_msgs::SerializedGraph::ConstPtr& msg) override;
 
+  /**
+   * @brief Deserialize the pending messages and compute their changes, until the display is destroyed
+   */
+  void deserializeMessages();
+
+  /**
+   * @brief Update the visuals touched by the changes
+   */
+  void applyChanges(const GraphChanges& changes);
+
+  /**
+   * @brief Get the property of a constraint source, creating it the first time a constraint of that source is drawn
+   */
+  RelativePose2DStampedConstraintProperty* getOrCreateConstraintSourceProperty(const std::string& constraint_source,
+                                                                               const std::string& constraint_type);
+
   Ogre::SceneNode* root_node_;
 
   ConstraintByUUIDMap constraint_visuals_;
 
   ColorBySourceMap source_color_map_;
 
-  ChangedByUUIDMap variables_changed_map_;
-  ChangedByUUIDMap constraints_changed_map_;
-
   BoolProperty* show_variables_property_;
   BoolProperty* show_constraints_property_;
   Pose2DStampedProperty* variable_property_;
   ConstraintPropertyBySourceMap constraint_source_properties_;
+  IntProperty* batch_threshold_property_;
 
   ConfigBySourceMap constraint_source_configs_;
 
+  // The deserializer must outlive any graph it creates, so it is declared before the changes that hold them
   fuse_core::GraphDeserializer graph_deserializer_;
+  GraphChangeTracker graph_change_tracker_;  //!< Only used by the deserialization thread
+
+  std::mutex mutex_;  //!< Guards the members below, shared with the deserialization thread
+  std::condition_variable condition_;
+  fuse_msgs::SerializedGraph::ConstPtr pending_msg_;  //!< The latest message not deserialized yet
+  std::unique_ptr<GraphChanges> pending_changes_;  //!< The latest changes not drawn yet
+  bool clear_requested_{ false };  //!< Whether the deserialization thread must forget the previous graph
+  bool stop_requested_{ false };  //!< Whether the deserialization thread must exit
+  std::atomic<int> batch_threshold_;
+
+  std::thread deserialization_thread_;
 };
 
 }  // namespace rviz
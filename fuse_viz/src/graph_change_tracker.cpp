@@ -0,0 +1,207 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fuse_viz/graph_change_tracker.h>
+
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_variables/orientation_2d_stamped.h>
+#include <fuse_variables/position_2d_stamped.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <unordered_set>
+#include <utility>
+
+
+namespace rviz
+{
+
+namespace
+{
+
+/**
+ * @brief The stamp and device ID shared by the position and orientation of a 2D pose
+ *
+ * Pairing the variables by key takes a single pass over the graph, instead of generating the UUID of the position of
+ * every orientation and looking it up.
+ */
+struct PoseKey
+{
+  int64_t stamp;
+  fuse_core::UUID device_id;
+
+  bool operator==(const PoseKey& other) const
+  {
+    return stamp == other.stamp && device_id == other.device_id;
+  }
+};
+
+struct PoseKeyHash
+{
+  size_t operator()(const PoseKey& key) const
+  {
+    auto seed = fuse_core::uuid::hash()(key.device_id);
+    boost::hash_combine(seed, key.stamp);
+    return seed;
+  }
+};
+
+template <typename Stamped>
+PoseKey makePoseKey(const Stamped& variable)
+{
+  return { variable.stamp().time_since_epoch().count(), variable.deviceId() };  // NOLINT(whitespace/braces)
+}
+
+}  // namespace
+
+GraphChanges GraphChangeTracker::update(fuse_core::Graph::ConstSharedPtr graph, const size_t batch_threshold)
+{
+  ++generation_;
+
+  // Pair the 2D position and orientation variables:
+  std::unordered_map<PoseKey, GraphChanges::Pose, PoseKeyHash> poses;
+  for (const auto& variable : graph->getVariables())
+  {
+    if (const auto position = dynamic_cast<const fuse_variables::Position2DStamped*>(&variable))
+    {
+      poses[makePoseKey(*position)].position = position;
+    }
+    else if (const auto orientation = dynamic_cast<const fuse_variables::Orientation2DStamped*>(&variable))
+    {
+      poses[makePoseKey(*orientation)].orientation = orientation;
+    }
+  }
+
+  std::vector<const fuse_constraints::RelativePose2DStampedConstraint*> constraints;
+  for (const auto& constraint : graph->getConstraints())
+  {
+    if (const auto relative_pose = dynamic_cast<const fuse_constraints::RelativePose2DStampedConstraint*>(&constraint))
+    {
+      constraints.push_back(relative_pose);
+    }
+  }
+
+  GraphChanges changes;
+  changes.graph = std::move(graph);
+  changes.batched = poses.size() + constraints.size() > batch_threshold;
+  changes.rebuild = !initialized_ || changes.batched != batched_;
+
+  batched_ = changes.batched;
+  initialized_ = true;
+
+  // Report the poses that are new or changed, and remember the variables touched:
+  std::unordered_set<fuse_core::UUID, fuse_core::uuid::hash> touched_variables;
+  for (const auto& entry : poses)
+  {
+    const auto& pose = entry.second;
+    if (!pose.position || !pose.orientation)
+    {
+      continue;
+    }
+
+    const std::array<double, 3> value{ pose.position->x(), pose.position->y(), pose.orientation->yaw() };
+    const auto result = poses_.emplace(pose.position->uuid(), PoseState{ value, generation_ });
+    auto& state = result.first->second;
+    state.generation = generation_;
+
+    if (changes.rebuild || result.second || state.pose != value)
+    {
+      state.pose = value;
+      changes.poses.push_back(pose);
+      touched_variables.insert(pose.position->uuid());
+      touched_variables.insert(pose.orientation->uuid());
+    }
+  }
+
+  for (auto it = poses_.begin(); it != poses_.end();)
+  {
+    if (it->second.generation == generation_)
+    {
+      ++it;
+    }
+    else
+    {
+      changes.removed_poses.push_back(it->first);
+      it = poses_.erase(it);
+    }
+  }
+
+  // Report the constraints that are new or have any touched variable. Constraints are immutable, so nothing else can
+  // change their visual:
+  for (const auto constraint : constraints)
+  {
+    const auto result = constraints_.emplace(constraint->uuid(), ConstraintState{ constraint->source(), generation_ });
+    result.first->second.generation = generation_;
+
+    auto touched = changes.rebuild || result.second;
+    for (const auto& variable_uuid : constraint->variables())
+    {
+      touched = touched || touched_variables.count(variable_uuid) != 0;
+    }
+
+    if (touched)
+    {
+      GraphChanges::Constraint change{ constraint, {} };  // NOLINT(whitespace/braces)
+      if (changes.batched)
+      {
+        change.segment = computeSegment(*constraint, *changes.graph);
+      }
+      changes.constraints.push_back(change);
+    }
+  }
+
+  for (auto it = constraints_.begin(); it != constraints_.end();)
+  {
+    if (it->second.generation == generation_)
+    {
+      ++it;
+    }
+    else
+    {
+      changes.removed_constraints.push_back({ it->first, std::move(it->second.source) });  // NOLINT
+      it = constraints_.erase(it);
+    }
+  }
+
+  return changes;
+}
+
+void GraphChangeTracker::clear()
+{
+  poses_.clear();
+  constraints_.clear();
+  initialized_ = false;
+}
+
+}  // namespace rviz
@@ -0,0 +1,154 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fuse_viz/pose_2d_stamped_batch_visual.h>
+
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+
+#include <utility>
+
+
+namespace rviz
+{
+
+Pose2DStampedBatchVisual::Pose2DStampedBatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node)
+  : scene_manager_(scene_manager)
+  , root_node_(parent_node->createChildSceneNode())
+  , point_cloud_(new PointCloud())
+  , color_(1.0, 0.0, 0.0, 1.0)
+{
+  point_cloud_->setRenderMode(PointCloud::RM_SPHERES);
+  point_cloud_->setDimensions(1.0, 1.0, 1.0);
+  root_node_->attachObject(point_cloud_.get());
+}
+
+Pose2DStampedBatchVisual::~Pose2DStampedBatchVisual()
+{
+  root_node_->detachObject(point_cloud_.get());
+  point_cloud_.reset();
+  scene_manager_->destroySceneNode(root_node_->getName());
+}
+
+void Pose2DStampedBatchVisual::setPose2DStamped(const fuse_core::UUID& uuid, const Ogre::Vector3& position)
+{
+  const auto result = indices_.emplace(uuid, points_.size());
+  if (result.second)
+  {
+    PointCloud::Point point;
+    point.position = position;
+    point.color = color_;
+    points_.push_back(point);
+    uuids_.push_back(uuid);
+  }
+  else
+  {
+    points_[result.first->second].position = position;
+  }
+
+  changed_ = true;
+}
+
+void Pose2DStampedBatchVisual::erase(const fuse_core::UUID& uuid)
+{
+  const auto iter = indices_.find(uuid);
+  if (iter == indices_.end())
+  {
+    return;
+  }
+
+  // Move the last point into the erased slot, so the points stay dense:
+  const auto index = iter->second;
+  indices_.erase(iter);
+  if (index + 1 != points_.size())
+  {
+    points_[index] = points_.back();
+    uuids_[index] = uuids_.back();
+    indices_[uuids_[index]] = index;
+  }
+  points_.pop_back();
+  uuids_.pop_back();
+
+  changed_ = true;
+}
+
+void Pose2DStampedBatchVisual::clear()
+{
+  points_.clear();
+  uuids_.clear();
+  indices_.clear();
+
+  changed_ = true;
+}
+
+void Pose2DStampedBatchVisual::update()
+{
+  if (!changed_)
+  {
+    return;
+  }
+
+  point_cloud_->clear();
+  if (!points_.empty())
+  {
+    point_cloud_->addPoints(points_.begin(), points_.end());
+  }
+
+  changed_ = false;
+}
+
+void Pose2DStampedBatchVisual::setSphereColor(const float r, const float g, const float b, const float a)
+{
+  color_ = Ogre::ColourValue(r, g, b, a);
+
+  for (auto& point : points_)
+  {
+    point.color = color_;
+  }
+  point_cloud_->setAlpha(a);
+
+  changed_ = true;
+}
+
+void Pose2DStampedBatchVisual::setScale(const float scale)
+{
+  point_cloud_->setDimensions(scale, scale, scale);
+}
+
+void Pose2DStampedBatchVisual::setVisible(const bool visible)
+{
+  root_node_->setVisible(visible);
+}
+
+}  // namespace rviz
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <fuse_viz/pose_2d_stamped_batch_visual.h>
 #include <fuse_viz/pose_2d_stamped_property.h>
 #include <fuse_viz/pose_2d_stamped_visual.h>
 
@@ -131,12 +132,32 @@ void Pose2DStampedProperty::clearVisual()
   variables_.clear();
 }
 
+Pose2DStampedProperty::BatchVisualPtr Pose2DStampedProperty::getOrCreateBatchVisual(Ogre::SceneManager* scene_manager,
+                                                                                    Ogre::SceneNode* parent_node)
+{
+  if (!batch_visual_)
+  {
+    batch_visual_.reset(new BatchVisual(scene_manager, parent_node));
+
+    updateBatchVisual();
+  }
+
+  return batch_visual_;
+}
+
+void Pose2DStampedProperty::clearBatchVisual()
+{
+  batch_visual_.reset();
+}
+
 void Pose2DStampedProperty::updateVisibility()
 {
   for (auto& entry : variables_)
   {
     updateVisibility(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void Pose2DStampedProperty::updateAxesAlpha()
@@ -153,6 +174,8 @@ void Pose2DStampedProperty::updateScale()
   {
     updateScale(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void Pose2DStampedProperty::updateShowText()
@@ -169,6 +192,8 @@ void Pose2DStampedProperty::updateSphereColorAlpha()
   {
     updateSphereColorAlpha(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void Pose2DStampedProperty::updateTextScale()
@@ -214,4 +239,19 @@ void Pose2DStampedProperty::updateVisibility(const VisualPtr& variable)
   variable->setTextVisible(visible && show_text_property_->getBool());
 }
 
+void Pose2DStampedProperty::updateBatchVisual()
+{
+  if (!batch_visual_)
+  {
+    return;
+  }
+
+  const auto color = color_property_->getColor();
+
+  batch_visual_->setSphereColor(color.redF(), color.greenF(), color.blueF(), sphere_alpha_property_->getFloat());
+  batch_visual_->setScale(scale_property_->getFloat());
+  batch_visual_->setVisible(getBool());
+  batch_visual_->update();
+}
+
 }  // end namespace rviz
@@ -0,0 +1,209 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2020, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fuse_viz/conversions.h>
+#include <fuse_viz/relative_pose_2d_stamped_constraint_batch_visual.h>
+#include <fuse_viz/relative_pose_2d_stamped_constraint_visual.h>
+
+#include <fuse_constraints/relative_pose_2d_stamped_constraint.h>
+#include <fuse_core/graph.h>
+#include <rviz/ogre_helpers/billboard_line.h>
+
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+
+
+namespace rviz
+{
+
+RelativePose2DStampedConstraintSegment computeSegment(
+    const fuse_constraints::RelativePose2DStampedConstraint& constraint, const fuse_core::Graph& graph)
+{
+  const auto& variables = constraint.variables();
+
+  const auto pose1 = getPose(graph, variables.at(0), variables.at(1));
+  const auto pose2 = getPose(graph, variables.at(2), variables.at(3));
+
+  const auto& delta = constraint.delta();
+  const tf2::Transform pose_delta{ tf2::Quaternion{ tf2::Vector3{ 0, 0, 1 }, delta[2] },
+                                   tf2::Vector3{ delta[0], delta[1], 0 } };
+
+  RelativePose2DStampedConstraintSegment segment;
+  segment.position1 = toOgre(pose1.getOrigin());
+  segment.relative_position = toOgre((pose1 * pose_delta).getOrigin());
+  segment.position2 = toOgre(pose2.getOrigin());
+  segment.loss_scale = computeLossScale(constraint, pose1, pose2);
+
+  return segment;
+}
+
+RelativePose2DStampedConstraintBatchVisual::RelativePose2DStampedConstraintBatchVisual(
+    Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node)
+  : scene_manager_(scene_manager), root_node_(parent_node->createChildSceneNode())
+{
+  relative_pose_line_.reset(new BillboardLine(scene_manager_, root_node_));
+  relative_pose_line_->setMaxPointsPerLine(2);
+
+  error_line_.reset(new BillboardLine(scene_manager_, root_node_));
+  error_line_->setMaxPointsPerLine(2);
+}
+
+RelativePose2DStampedConstraintBatchVisual::~RelativePose2DStampedConstraintBatchVisual()
+{
+  relative_pose_line_.reset();
+  error_line_.reset();
+  scene_manager_->destroySceneNode(root_node_->getName());
+}
+
+void RelativePose2DStampedConstraintBatchVisual::setConstraint(const fuse_core::UUID& uuid,
+                                                               const RelativePose2DStampedConstraintSegment& segment)
+{
+  const auto result = indices_.emplace(uuid, segments_.size());
+  if (result.second)
+  {
+    segments_.push_back(segment);
+    uuids_.push_back(uuid);
+  }
+  else
+  {
+    segments_[result.first->second] = segment;
+  }
+
+  changed_ = true;
+}
+
+void RelativePose2DStampedConstraintBatchVisual::erase(const fuse_core::UUID& uuid)
+{
+  const auto iter = indices_.find(uuid);
+  if (iter == indices_.end())
+  {
+    return;
+  }
+
+  // Move the last segment into the erased slot, so the segments stay dense:
+  const auto index = iter->second;
+  indices_.erase(iter);
+  if (index + 1 != segments_.size())
+  {
+    segments_[index] = segments_.back();
+    uuids_[index] = uuids_.back();
+    indices_[uuids_[index]] = index;
+  }
+  segments_.pop_back();
+  uuids_.pop_back();
+
+  changed_ = true;
+}
+
+void RelativePose2DStampedConstraintBatchVisual::clear()
+{
+  segments_.clear();
+  uuids_.clear();
+  indices_.clear();
+
+  changed_ = true;
+}
+
+void RelativePose2DStampedConstraintBatchVisual::update()
+{
+  if (!changed_)
+  {
+    return;
+  }
+
+  relative_pose_line_->clear();
+  error_line_->clear();
+
+  if (!segments_.empty())
+  {
+    relative_pose_line_->setNumLines(segments_.size());
+    error_line_->setNumLines(segments_.size());
+
+    for (const auto& segment : segments_)
+    {
+      relative_pose_line_->addPoint(segment.position1);
+      relative_pose_line_->addPoint(segment.relative_position);
+      relative_pose_line_->newLine();
+
+      // Each error line has its own brightness, based on the loss function impact on the constraint cost:
+      const auto color = computeLossErrorLineColor(error_line_color_, segment.loss_scale, min_brightness_);
+      error_line_->addPoint(segment.relative_position, color);
+      error_line_->addPoint(segment.position2, color);
+      error_line_->newLine();
+    }
+  }
+
+  changed_ = false;
+}
+
+void RelativePose2DStampedConstraintBatchVisual::setRelativePoseLineWidth(const float line_width)
+{
+  relative_pose_line_->setLineWidth(line_width);
+}
+
+void RelativePose2DStampedConstraintBatchVisual::setErrorLineWidth(const float line_width)
+{
+  error_line_->setLineWidth(line_width);
+}
+
+void RelativePose2DStampedConstraintBatchVisual::setLossMinBrightness(const float min_brightness)
+{
+  min_brightness_ = min_brightness;
+
+  changed_ = true;
+}
+
+void RelativePose2DStampedConstraintBatchVisual::setRelativePoseLineColor(const float r, const float g, const float b,
+                                                                          const float a)
+{
+  relative_pose_line_->setColor(r, g, b, a);
+}
+
+void RelativePose2DStampedConstraintBatchVisual::setErrorLineColor(const float r, const float g, const float b,
+                                                                   const float a)
+{
+  error_line_color_ = Ogre::ColourValue(r, g, b, a);
+
+  // Set the line color too, so the line material gets the right transparency:
+  error_line_->setColor(r, g, b, a);
+
+  changed_ = true;
+}
+
+void RelativePose2DStampedConstraintBatchVisual::setVisible(const bool visible)
+{
+  root_node_->setVisible(visible);
+}
+
+}  // namespace rviz
@@ -34,6 +34,7 @@
 
 #include <fuse_viz/mapped_covariance_property.h>
 #include <fuse_viz/mapped_covariance_visual.h>
+#include <fuse_viz/relative_pose_2d_stamped_constraint_batch_visual.h>
 #include <fuse_viz/relative_pose_2d_stamped_constraint_property.h>
 #include <fuse_viz/relative_pose_2d_stamped_constraint_visual.h>
 
@@ -161,6 +162,24 @@ void RelativePose2DStampedConstraintProperty::clearVisual()
   constraints_.clear();
 }
 
+RelativePose2DStampedConstraintProperty::BatchVisualPtr RelativePose2DStampedConstraintProperty::getOrCreateBatchVisual(
+    Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node)
+{
+  if (!batch_visual_)
+  {
+    batch_visual_.reset(new BatchVisual(scene_manager, parent_node));
+
+    updateBatchVisual();
+  }
+
+  return batch_visual_;
+}
+
+void RelativePose2DStampedConstraintProperty::clearBatchVisual()
+{
+  batch_visual_.reset();
+}
+
 void RelativePose2DStampedConstraintProperty::setColor(const QColor& color)
 {
   color_property_->setColor(color);
@@ -172,6 +191,8 @@ void RelativePose2DStampedConstraintProperty::updateVisibility()
   {
     updateVisibility(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void RelativePose2DStampedConstraintProperty::updateColor()
@@ -180,6 +201,8 @@ void RelativePose2DStampedConstraintProperty::updateColor()
   {
     updateColor(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void RelativePose2DStampedConstraintProperty::updateErrorLineAlpha()
@@ -188,6 +211,8 @@ void RelativePose2DStampedConstraintProperty::updateErrorLineAlpha()
   {
     updateErrorLineAlpha(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void RelativePose2DStampedConstraintProperty::updateErrorLineWidth()
@@ -196,6 +221,8 @@ void RelativePose2DStampedConstraintProperty::updateErrorLineWidth()
   {
     updateErrorLineWidth(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void RelativePose2DStampedConstraintProperty::updateLossMinBrightness()
@@ -204,6 +231,8 @@ void RelativePose2DStampedConstraintProperty::updateLossMinBrightness()
   {
     updateLossMinBrightness(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void RelativePose2DStampedConstraintProperty::updateRelativePoseAxesAlpha()
@@ -228,6 +257,8 @@ void RelativePose2DStampedConstraintProperty::updateRelativePoseLineAlpha()
   {
     updateRelativePoseLineAlpha(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void RelativePose2DStampedConstraintProperty::updateRelativePoseLineWidth()
@@ -236,6 +267,8 @@ void RelativePose2DStampedConstraintProperty::updateRelativePoseLineWidth()
   {
     updateRelativePoseLineWidth(entry.second);
   }
+
+  updateBatchVisual();
 }
 
 void RelativePose2DStampedConstraintProperty::updateShowText()
@@ -324,4 +357,23 @@ void RelativePose2DStampedConstraintProperty::updateVisibility(const VisualPtr&
   constraint->getCovariance()->setVisible(visible && covariance_property_->getBool());
 }
 
+void RelativePose2DStampedConstraintProperty::updateBatchVisual()
+{
+  if (!batch_visual_)
+  {
+    return;
+  }
+
+  const auto color = color_property_->getColor();
+
+  batch_visual_->setRelativePoseLineColor(color.redF(), color.greenF(), color.blueF(),
+                                          relative_pose_line_alpha_property_->getFloat());
+  batch_visual_->setRelativePoseLineWidth(relative_pose_line_width_property_->getFloat());
+  batch_visual_->setErrorLineColor(color.redF(), color.greenF(), color.blueF(), error_line_alpha_property_->getFloat());
+  batch_visual_->setErrorLineWidth(error_line_width_property_->getFloat());
+  batch_visual_->setLossMinBrightness(loss_min_brightness_property_->getFloat());
+  batch_visual_->setVisible(getBool());
+  batch_visual_->update();
+}
+
 }  // end namespace rviz
@@ -69,6 +69,102 @@ std::string constraint_name(const fuse_constraints::RelativePose2DStampedConstra
   return constraint.source() + '@' + constraint.type() + "::" + fuse_core::uuid::to_string(constraint.uuid());
 }
 
+float computeLossScale(const fuse_constraints::RelativePose2DStampedConstraint& constraint, const tf2::Transform& pose1,
+                       const tf2::Transform& pose2)
+{
+  auto loss_function = constraint.lossFunction();
+  if (!loss_function)
+  {
+    return -1.0;
+  }
+
+  // Evaluate cost function without loss:
+  const double position1[] = { pose1.getOrigin().getX(), pose1.getOrigin().getY() };
+  const double yaw1[] = { tf2::getYaw(pose1.getRotation()) };
+  const double position2[] = { pose2.getOrigin().getX(), pose2.getOrigin().getY() };
+  const double yaw2[] = { tf2::getYaw(pose2.getRotation()) };
+
+  const double* parameters[] = { position1, yaw1, position2, yaw2 };
+
+  auto cost_function = constraint.costFunction();
+
+  fuse_core::VectorXd residuals(cost_function->num_residuals());
+
+  cost_function->Evaluate(parameters, residuals.data(), nullptr);
+  delete cost_function;
+
+  // The cost without the loss would be:
+  //
+  // cost = 0.5 * squared_norm
+  //
+  // See https://github.com/ceres-solver/ceres-solver/blob/master/internal/ceres/residual_block.cc#L159
+  const auto squared_norm = residuals.squaredNorm();
+
+  // Evaluate the loss as in:
+  // https://github.com/ceres-solver/ceres-solver/blob/master/internal/ceres/residual_block.cc#L164
+  //
+  // The cost with the loss would be:
+  //
+  // loss_cost = 0.5 * rho[0]
+  //
+  // See https://github.com/ceres-solver/ceres-solver/blob/master/internal/ceres/residual_block.cc#L165
+  double rho[3];
+  loss_function->Evaluate(squared_norm, rho);
+
+  if (rho[0] > squared_norm)
+  {
+    ROS_WARN_STREAM_THROTTLE(10.0, "Detected invalid loss value of "
+                                       << rho[0] << " greater than squared residual of " << squared_norm
+                                       << " for constraint " << constraint_name(constraint) << " with loss type "
+                                       << constraint.loss()->type()
+                                       << ". Loss value clamped to the squared residual.");
+
+    rho[0] = squared_norm;
+  }
+
+  // Interpolate between the constraint's absolute position and its second variable position by the quotient between
+  // the cost with and without loss:
+  //
+  //              loss_cost      0.5 * rho[0]         rho[0]
+  // loss_scale = --------- = ------------------ = ------------
+  //                cost      0.5 * squared_norm   squared_norm
+  //
+  // Remember that in principle `rho[0] <= squared_norm`, with `rho[0] == squared_norm` for the inlier region, and
+  // `rho[0] < squared_norm` for the outlier region:
+  return squared_norm == 0.0 ? 1.0 : rho[0] / squared_norm;
+}
+
+Ogre::ColourValue computeLossErrorLineColor(const Ogre::ColourValue& color, const float loss_scale,
+                                            const float min_brightness)
+{
+  // Skip if the loss scale is negative, which means the constraint has no loss:
+  if (loss_scale < 0.0)
+  {
+    return color;
+  }
+
+  // Get the error line color as HSB:
+  Ogre::ColourValue error_line_color(color.r, color.g, color.b);
+  Ogre::Real hue, saturation, brightness;
+  error_line_color.getHSB(&hue, &saturation, &brightness);
+
+  // We should correct the color brightness if it is smaller than minimum brightness. Otherwise, we would get an
+  // incorrect loss brightness.
+  //
+  // However, we cannot do this because it changes the color of the error line, which should be consistent for all
+  // constraints visuals. Instead, we clamp the minium brightness:
+  const auto clamped_min_brightness = std::min(min_brightness, brightness);
+
+  // Scale brightness by the loss scale within the [min_brightness, 1] range:
+  const auto loss_brightness = clamped_min_brightness + (brightness - clamped_min_brightness) * loss_scale;
+
+  // Set error line color with the loss brightness:
+  Ogre::ColourValue loss_error_line_color;
+  loss_error_line_color.setHSB(hue, saturation, loss_brightness);
+
+  return Ogre::ColourValue(loss_error_line_color.r, loss_error_line_color.g, loss_error_line_color.b, color.a);
+}
+
 RelativePose2DStampedConstraintVisual::RelativePose2DStampedConstraintVisual(
     Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node,
     const fuse_constraints::RelativePose2DStampedConstraint& constraint, const bool visible)
@@ -155,65 +251,9 @@ void RelativePose2DStampedConstraintVisual::setConstraint(
   error_line_->addPoint(toOgre(pose2.getOrigin()));
 
   // Set error line color brightness based on the loss function impact on the constraint cost:
-  auto loss_function = constraint.lossFunction();
-  if (loss_function)
+  loss_scale_ = computeLossScale(constraint, pose1, pose2);
+  if (loss_scale_ >= 0.0)
   {
-    // Evaluate cost function without loss:
-    const double position1[] = { pose1.getOrigin().getX(), pose1.getOrigin().getY() };
-    const double yaw1[] = { tf2::getYaw(pose1.getRotation()) };
-    const double position2[] = { pose2.getOrigin().getX(), pose2.getOrigin().getY() };
-    const double yaw2[] = { tf2::getYaw(pose2.getRotation()) };
-
-    const double* parameters[] = { position1, yaw1, position2, yaw2 };
-
-    auto cost_function = constraint.costFunction();
-
-    fuse_core::VectorXd residuals(cost_function->num_residuals());
-
-    cost_function->Evaluate(parameters, residuals.data(), nullptr);
-    delete cost_function;
-
-    // The cost without the loss would be:
-    //
-    // cost = 0.5 * squared_norm
-    //
-    // See https://github.com/ceres-solver/ceres-solver/blob/master/internal/ceres/residual_block.cc#L159
-    const auto squared_norm = residuals.squaredNorm();
-
-    // Evaluate the loss as in:
-    // https://github.com/ceres-solver/ceres-solver/blob/master/internal/ceres/residual_block.cc#L164
-    //
-    // The cost with the loss would be:
-    //
-    // loss_cost = 0.5 * rho[0]
-    //
-    // See https://github.com/ceres-solver/ceres-solver/blob/master/internal/ceres/residual_block.cc#L165
-    double rho[3];
-    loss_function->Evaluate(squared_norm, rho);
-    delete loss_function;
-
-    if (rho[0] > squared_norm)
-    {
-      ROS_WARN_STREAM_THROTTLE(10.0, "Detected invalid loss value of "
-                                         << rho[0] << " greater than squared residual of " << squared_norm
-                                         << " for constraint " << constraint_name(constraint) << " with loss type "
-                                         << constraint.loss()->type()
-                                         << ". Loss value clamped to the squared residual.");
-
-      rho[0] = squared_norm;
-    }
-
-    // Interpolate between the constraint's absolute position and its second variable position by the quotient between
-    // the cost with and without loss:
-    //
-    //              loss_cost      0.5 * rho[0]         rho[0]
-    // loss_scale = --------- = ------------------ = ------------
-    //                cost      0.5 * squared_norm   squared_norm
-    //
-    // Remember that in principle `rho[0] <= squared_norm`, with `rho[0] == squared_norm` for the inlier region, and
-    // `rho[0] < squared_norm` for the outlier region:
-    loss_scale_ = squared_norm == 0.0 ? 1.0 : rho[0] / squared_norm;
-
     // Compute error line color with the loss function impact:
     const auto loss_error_line_color = computeLossErrorLineColor(error_line_color_, loss_scale_);
     error_line_->setColor(loss_error_line_color.r, loss_error_line_color.g, loss_error_line_color.b,
@@ -334,32 +374,7 @@ void RelativePose2DStampedConstraintVisual::setOrientation(const Ogre::Quaternio
 Ogre::ColourValue RelativePose2DStampedConstraintVisual::computeLossErrorLineColor(const Ogre::ColourValue& color,
                                                                                    const float loss_scale)
 {
-  // Skip if the loss scale is negative, which means the constraint has no loss:
-  if (loss_scale < 0.0)
-  {
-    return color;
-  }
-
-  // Get the error line color as HSB:
-  Ogre::ColourValue error_line_color(color.r, color.g, color.b);
-  Ogre::Real hue, saturation, brightness;
-  error_line_color.getHSB(&hue, &saturation, &brightness);
-
-  // We should correct the color brightness if it is smaller than minimum brightness. Otherwise, we would get an
-  // incorrect loss brightness.
-  //
-  // However, we cannot do this because it changes the color of the error line, which should be consistent for all
-  // constraints visuals. Instead, we clamp the minium brightness:
-  const auto min_brightness = std::min(min_brightness_, brightness);
-
-  // Scale brightness by the loss scale within the [min_brightness, 1] range:
-  const auto loss_brightness = min_brightness + (brightness - min_brightness) * loss_scale;
-
-  // Set error line color with the loss brightness:
-  Ogre::ColourValue loss_error_line_color;
-  loss_error_line_color.setHSB(hue, saturation, loss_brightness);
-
-  return Ogre::ColourValue(loss_error_line_color.r, loss_error_line_color.g, loss_error_line_color.b, color.a);
+  return rviz::computeLossErrorLineColor(color, loss_scale, min_brightness_);
 }
 
 }  // namespace rviz
@@ -40,12 +40,16 @@
 #include <rviz/display_context.h>
 #include <rviz/frame_manager.h>
 
+#include <rviz/properties/int_property.h>
 #include <rviz/properties/parse_color.h>
 #include <rviz/properties/property.h>
 #endif  // Q_MOC_RUN
 
+#include <fuse_viz/conversions.h>
+#include <fuse_viz/pose_2d_stamped_batch_visual.h>
 #include <fuse_viz/pose_2d_stamped_property.h>
 #include <fuse_viz/pose_2d_stamped_visual.h>
+#include <fuse_viz/relative_pose_2d_stamped_constraint_batch_visual.h>
 #include <fuse_viz/relative_pose_2d_stamped_constraint_property.h>
 #include <fuse_viz/relative_pose_2d_stamped_constraint_visual.h>
 #include <fuse_viz/serialized_graph_display.h>
@@ -58,6 +62,9 @@
 
 #include <boost/range.hpp>
 
+#include <string>
+#include <utility>
+
 namespace rviz
 {
 
@@ -73,10 +80,32 @@ SerializedGraphDisplay::SerializedGraphDisplay()
 
   show_constraints_property_ = new BoolProperty("Constraints", true, "The list of all constraints by source.", this,
                                                 SLOT(updateShowConstraints()));
+
+  batch_threshold_property_ =
+      new IntProperty("Batch Threshold", 1000,
+                      "Number of poses and constraints above which the graph is drawn with batched visuals, which "
+                      "only show the variable spheres and the constraint lines, but render large graphs interactively.",
+                      this, SLOT(updateBatchThreshold()));
+  batch_threshold_property_->setMin(0);
+
+  batch_threshold_ = batch_threshold_property_->getInt();
 }
 
 SerializedGraphDisplay::~SerializedGraphDisplay()
 {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = true;
+  }
+  condition_.notify_all();
+
+  if (deserialization_thread_.joinable())
+  {
+    deserialization_thread_.join();
+  }
+
+  pending_changes_.reset();
+
   if (initialized())
   {
     clear();
@@ -89,6 +118,44 @@ SerializedGraphDisplay::~SerializedGraphDisplay()
 void SerializedGraphDisplay::reset()
 {
   MFDClass::reset();
+
+  // Drop the changes not drawn yet, and make the next graph redraw all the visuals:
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_changes_.reset();
+  clear_requested_ = true;
+  condition_.notify_all();
+}
+
+void SerializedGraphDisplay::update(float wall_dt, float ros_dt)
+{
+  MFDClass::update(wall_dt, ros_dt);
+
+  std::unique_ptr<GraphChanges> changes;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    changes = std::move(pending_changes_);
+  }
+
+  if (!changes)
+  {
+    return;
+  }
+
+  // Let the deserialization thread start on the next message while the visuals are updated:
+  condition_.notify_all();
+
+  try
+  {
+    applyChanges(*changes);
+  }
+  catch (const std::exception& ex)
+  {
+    ROS_ERROR_STREAM_THROTTLE(10.0, "Failed to draw graph: " << ex.what());
+
+    // The visuals are out of sync with the changes tracked, so redraw them all with the next graph:
+    std::lock_guard<std::mutex> lock(mutex_);
+    clear_requested_ = true;
+  }
 }
 
 void SerializedGraphDisplay::onInitialize()
@@ -96,6 +163,8 @@ void SerializedGraphDisplay::onInitialize()
   MFDClass::onInitialize();
 
   root_node_ = scene_node_->createChildSceneNode();
+
+  deserialization_thread_ = std::thread(&SerializedGraphDisplay::deserializeMessages, this);
 }
 
 void SerializedGraphDisplay::onEnable()
@@ -148,6 +217,11 @@ void SerializedGraphDisplay::updateShowConstraints()
   }
 }
 
+void SerializedGraphDisplay::updateBatchThreshold()
+{
+  batch_threshold_ = batch_threshold_property_->getInt();
+}
+
 void SerializedGraphDisplay::clear()
 {
   constraint_visuals_.clear();
@@ -159,9 +233,6 @@ void SerializedGraphDisplay::clear()
     delete entry.second;
   }
   constraint_source_properties_.clear();
-
-  variables_changed_map_.clear();
-  constraints_changed_map_.clear();
 }
 
 void SerializedGraphDisplay::processMessage(const fuse_msgs::SerializedGraph::ConstPtr& msg)
@@ -177,149 +248,212 @@ void SerializedGraphDisplay::processMessage(const fuse_msgs::SerializedGraph::Co
   root_node_->setPosition(position);
   root_node_->setOrientation(orientation);
 
-  for (auto& entry : variables_changed_map_)
+  // Hand the message to the deserialization thread, replacing any message it did not start yet:
   {
-    entry.second = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_msg_ = msg;
   }
+  condition_.notify_all();
+}
 
-  for (auto& entry : constraints_changed_map_)
+void SerializedGraphDisplay::deserializeMessages()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
   {
-    entry.second = false;
-  }
+    // Wait until the previous changes were drawn, so the tracker never gets ahead of the visuals by more than one graph
+    condition_.wait(lock, [this]() { return stop_requested_ || (pending_msg_ && !pending_changes_); });  // NOLINT
+    if (stop_requested_)
+    {
+      return;
+    }
 
-  const auto graph = graph_deserializer_.deserialize(msg);
+    const auto msg = std::move(pending_msg_);
+    pending_msg_.reset();
 
-  for (const auto& variable : graph->getVariables())
-  {
-    const auto orientation = dynamic_cast<const fuse_variables::Orientation2DStamped*>(&variable);
-    if (!orientation)
+    if (clear_requested_)
     {
-      continue;
+      graph_change_tracker_.clear();
+      clear_requested_ = false;
     }
 
-    const auto position_uuid = fuse_variables::Position2DStamped(orientation->stamp(), orientation->deviceId()).uuid();
-    if (!graph->variableExists(position_uuid))
+    lock.unlock();
+
+    std::unique_ptr<GraphChanges> changes;
+    try
     {
-      continue;
+      fuse_core::Graph::ConstSharedPtr graph = graph_deserializer_.deserialize(msg);
+      changes.reset(new GraphChanges(graph_change_tracker_.update(std::move(graph), batch_threshold_)));
     }
+    catch (const std::exception& ex)
+    {
+      ROS_ERROR_STREAM_THROTTLE(10.0, "Failed to deserialize graph: " << ex.what());
 
-    const auto position = dynamic_cast<const fuse_variables::Position2DStamped*>(&graph->getVariable(position_uuid));
-
-    variable_property_->createAndInsertOrUpdateVisual(scene_manager_, root_node_, *position, *orientation);
+      // The tracker may have been partially updated, so redraw all the visuals with the next graph:
+      graph_change_tracker_.clear();
+    }
 
-    variables_changed_map_[position_uuid] = true;
+    lock.lock();
+    pending_changes_ = std::move(changes);
   }
+}
 
-  for (const auto& constraint : graph->getConstraints())
+void SerializedGraphDisplay::applyChanges(const GraphChanges& changes)
+{
+  if (changes.rebuild)
   {
-    const auto relative_pose = dynamic_cast<const fuse_constraints::RelativePose2DStampedConstraint*>(&constraint);
-    if (!relative_pose)
-    {
-      continue;
-    }
+    variable_property_->clearVisual();
+    variable_property_->clearBatchVisual();
 
-    const auto constraint_uuid = constraint.uuid();
-    const auto& constraint_source = constraint.source();
-
-    if (source_color_map_.find(constraint_source) == source_color_map_.end())
+    for (auto& entry : constraint_source_properties_)
     {
-      // Generate hue color automatically based on the number of sources including the new one (n)
-      // The hue is computed in such a way that the (dynamic) colormap is always well spread along the spectrum. This is
-      // achieved by traversing a virtual complete binary tree in breadth-first order. Each node represents a sampling
-      // position in the hue interval (0, 1) based on the current level and the number of nodes in that level (m)
-      const auto n = source_color_map_.size() + 1;
-      const size_t level = std::floor(std::log2(n));
-      const auto m = n + 1 - std::pow(2, level);
-      const auto hue = (2 * (m - 1) + 1) / std::pow(2, level + 1);
-
-      auto& source_color = source_color_map_[constraint_source];
-      source_color.setHSB(hue, 1.0, 1.0);
-
-      // Insert constraint sorted alphabetically:
-      const auto description = constraint_source + ' ' + constraint.type() + " constraint.";
+      entry.second->clearVisual();
+      entry.second->clearBatchVisual();
+    }
 
-      const auto constraint_source_property = new RelativePose2DStampedConstraintProperty(
-          QString::fromStdString(constraint_source), true, QString::fromStdString(description), nullptr,
-          SLOT(queueRender()), this);
+    constraint_visuals_.clear();
+  }
 
-      const auto result = constraint_source_properties_.insert(
-          { constraint_source, constraint_source_property });  // NOLINT(whitespace/braces)
+  if (changes.batched)
+  {
+    const auto variables_visual = variable_property_->getOrCreateBatchVisual(scene_manager_, root_node_);
 
-      if (!result.second)
-      {
-        delete constraint_source_property;
+    for (const auto& uuid : changes.removed_poses)
+    {
+      variables_visual->erase(uuid);
+    }
 
-        throw std::runtime_error("Failed to insert " + description);
-      }
+    for (const auto& pose : changes.poses)
+    {
+      variables_visual->setPose2DStamped(pose.position->uuid(), toOgre(*pose.position));
+    }
 
-      show_constraints_property_->addChild(constraint_source_property,
-                                          std::distance(constraint_source_properties_.begin(), result.first));
+    variables_visual->update();
 
-      if (constraint_source_configs_.find(constraint_source) == constraint_source_configs_.end())
-      {
-        constraint_source_properties_[constraint_source]->setColor(ogreToQt(source_color));
-      }
-      else
+    for (const auto& removed : changes.removed_constraints)
+    {
+      const auto iter = constraint_source_properties_.find(removed.source);
+      if (iter != constraint_source_properties_.end())
       {
-        constraint_source_properties_[constraint_source]->load(constraint_source_configs_[constraint_source]);
+        iter->second->getOrCreateBatchVisual(scene_manager_, root_node_)->erase(removed.uuid);
       }
     }
 
-    if (constraint_visuals_.find(constraint_uuid) == constraint_visuals_.end())
+    for (const auto& change : changes.constraints)
     {
-      constraint_visuals_[constraint_uuid] = constraint_source_properties_[constraint_source]->createAndInsertVisual(
-          scene_manager_, root_node_, *relative_pose, *graph);
+      const auto& constraint = *change.constraint;
+      const auto constraint_source_property =
+          getOrCreateConstraintSourceProperty(constraint.source(), constraint.type());
+
+      constraint_source_property->getOrCreateBatchVisual(scene_manager_, root_node_)
+          ->setConstraint(constraint.uuid(), change.segment);
     }
-    else
+
+    for (auto& entry : constraint_source_properties_)
     {
-      constraint_visuals_[constraint_uuid]->setConstraint(*relative_pose, *graph);
+      entry.second->getOrCreateBatchVisual(scene_manager_, root_node_)->update();
     }
 
-    constraints_changed_map_[constraint_uuid] = true;
+    return;
   }
 
-  for (const auto& entry : variables_changed_map_)
+  for (const auto& uuid : changes.removed_poses)
   {
-    if (!entry.second)
-    {
-      variable_property_->eraseVisual(entry.first);
-    }
+    variable_property_->eraseVisual(uuid);
   }
 
-  for (auto it = variables_changed_map_.begin(); it != variables_changed_map_.end();)
+  for (const auto& pose : changes.poses)
   {
-    if (it->second)
-    {
-      ++it;
-    }
-    else
-    {
-      it = variables_changed_map_.erase(it);
-    }
+    variable_property_->createAndInsertOrUpdateVisual(scene_manager_, root_node_, *pose.position, *pose.orientation);
   }
 
-  for (const auto& entry : constraints_changed_map_)
+  for (const auto& removed : changes.removed_constraints)
   {
-    if (!entry.second)
+    const auto iter = constraint_source_properties_.find(removed.source);
+    if (iter != constraint_source_properties_.end())
     {
-      constraint_source_properties_[constraint_visuals_[entry.first]->getSource()]->eraseVisual(entry.first);
-      constraint_visuals_.erase(entry.first);
+      iter->second->eraseVisual(removed.uuid);
     }
+
+    constraint_visuals_.erase(removed.uuid);
   }
 
-  for (auto it = constraints_changed_map_.begin(); it != constraints_changed_map_.end();)
+  for (const auto& change : changes.constraints)
   {
-    if (it->second)
+    const auto& constraint = *change.constraint;
+    const auto constraint_uuid = constraint.uuid();
+    const auto constraint_source_property = getOrCreateConstraintSourceProperty(constraint.source(), constraint.type());
+
+    auto& constraint_visual = constraint_visuals_[constraint_uuid];
+    if (constraint_visual)
     {
-      ++it;
+      constraint_visual->setConstraint(constraint, *changes.graph);
     }
     else
     {
-      it = constraints_changed_map_.erase(it);
+      constraint_visual =
+          constraint_source_property->createAndInsertVisual(scene_manager_, root_node_, constraint, *changes.graph);
     }
   }
 }
 
+RelativePose2DStampedConstraintProperty* SerializedGraphDisplay::getOrCreateConstraintSourceProperty(
+    const std::string& constraint_source, const std::string& constraint_type)
+{
+  const auto iter = constraint_source_properties_.find(constraint_source);
+  if (iter != constraint_source_properties_.end())
+  {
+    return iter->second;
+  }
+
+  // Generate hue color automatically based on the number of sources including the new one (n)
+  // The hue is computed in such a way that the (dynamic) colormap is always well spread along the spectrum. This is
+  // achieved by traversing a virtual complete binary tree in breadth-first order. Each node represents a sampling
+  // position in the hue interval (0, 1) based on the current level and the number of nodes in that level (m)
+  const auto color_result = source_color_map_.emplace(constraint_source, Ogre::ColourValue());
+  auto& source_color = color_result.first->second;
+  if (color_result.second)
+  {
+    const auto n = source_color_map_.size();
+    const size_t level = std::floor(std::log2(n));
+    const auto m = n + 1 - std::pow(2, level);
+    const auto hue = (2 * (m - 1) + 1) / std::pow(2, level + 1);
+
+    source_color.setHSB(hue, 1.0, 1.0);
+  }
+
+  // Insert constraint sorted alphabetically:
+  const auto description = constraint_source + ' ' + constraint_type + " constraint.";
+
+  const auto constraint_source_property = new RelativePose2DStampedConstraintProperty(
+      QString::fromStdString(constraint_source), true, QString::fromStdString(description), nullptr,
+      SLOT(queueRender()), this);
+
+  const auto result = constraint_source_properties_.insert(
+      { constraint_source, constraint_source_property });  // NOLINT(whitespace/braces)
+
+  if (!result.second)
+  {
+    delete constraint_source_property;
+
+    throw std::runtime_error("Failed to insert " + description);
+  }
+
+  show_constraints_property_->addChild(constraint_source_property,
+                                      std::distance(constraint_source_properties_.begin(), result.first));
+
+  if (constraint_source_configs_.find(constraint_source) == constraint_source_configs_.end())
+  {
+    constraint_source_property->setColor(ogreToQt(source_color));
+  }
+  else
+  {
+    constraint_source_property->load(constraint_source_configs_[constraint_source]);
+  }
+
+  return constraint_source_property;
+}
+
 }  // namespace rviz
 
 #include <pluginlib/class_list_macros.hpp>